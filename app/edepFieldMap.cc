@@ -0,0 +1,82 @@
+#include "EDepSimFieldMap.hh"
+#include "EDepSimLog.hh"
+
+#include <G4SystemOfUnits.hh>
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+
+void usage () {
+    std::cout << "Usage: edep-field-map [options] <input> <output>"
+              << std::endl;
+    std::cout << "  Convert a text field map into the binary field map"
+              << std::endl
+              << "  format that is memory mapped by edep-sim."
+              << std::endl;
+    std::cout << "    -B      -- The map is a magnetic field (tesla)"
+              << std::endl;
+    std::cout << "    -E      -- The map is an electric field (volt/cm)"
+              << std::endl;
+    std::cout << "    -h      -- This help message." << std::endl;
+
+    exit(1);
+}
+
+int main(int argc,char** argv) {
+    EDepSim::LogManager::Configure();
+
+    double unit = 0.0;
+    std::string unitName;
+
+    int c = 0;
+    while ((c=getopt(argc,argv,"BEh")) != -1) {
+        switch (c) {
+        case 'B': {
+            unit = tesla;
+            unitName = "tesla";
+            break;
+        }
+        case 'E': {
+            unit = volt/cm;
+            unitName = "volt/cm";
+            break;
+        }
+        case 'h':
+        default:
+            usage();
+        }
+    }
+
+    if (unit <= 0.0) {
+        std::cout << "Either -B or -E must be given" << std::endl;
+        usage();
+    }
+    if (argc - optind != 2) usage();
+
+    std::string input = argv[optind];
+    std::string output = argv[optind+1];
+
+    EDepSim::FieldMap fieldMap;
+    if (!fieldMap.ReadFile(input, unit)) {
+        EDepSimError("Unable to read " << input);
+        return 1;
+    }
+    if (fieldMap.IsMapped()) {
+        EDepSimLog(input << " is already a binary field map");
+    }
+
+    if (!fieldMap.WriteBinary(output, unitName)) {
+        EDepSimError("Unable to write " << output);
+        return 1;
+    }
+
+    EDepSimLog("Wrote " << output
+               << " with " << fieldMap.GetSize(0)
+               << "x" << fieldMap.GetSize(1)
+               << "x" << fieldMap.GetSize(2)
+               << " grid points in " << unitName);
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+#include <TG4Event.h>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TKey.h>
+#include <TDirectory.h>
+#include <TGeoManager.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+
+// The directory and tree names written by EDepSim::RootPersistencyManager
+// and EDepSim::KinemPassThrough.
+#define EVENTTREE "EDepSimEvents"
+#define PASSTHRUDIR "DetSimPassThru"
+#define INPUTKINEM "InputKinem"
+#define INPUTFILES "InputFiles"
+#define GEOMETRY "EDepSimGeometry"
+
+void usage () {
+    std::cout << "Usage: edep-merge [options] <output> <input> [input ...]"
+              << std::endl;
+    std::cout << "  Merge edep-sim output files (e.g. from jobs run with"
+              << std::endl
+              << "  -F and -e) into one file.  The trees are copied"
+              << std::endl
+              << "  without unpacking the baskets when possible, and the"
+              << std::endl
+              << "  geometry is copied from the first input file."
+              << std::endl;
+    std::cout << "    -h      -- This help message." << std::endl;
+
+    exit(1);
+}
+
+namespace {
+    /// Copy all of the entries from an input tree to the output tree with
+    /// the same name, creating the output tree in a directory the first
+    /// time it's seen.  The baskets are copied without being unpacked
+    /// (fast cloning).
+    TTree* FastCopy(TTree* input, TTree* output, TDirectory* directory) {
+        if (!output) {
+            directory->cd();
+            output = input->CloneTree(0);
+        }
+        output->CopyEntries(input, -1, "fast");
+        return output;
+    }
+
+    /// Get the "file:tree:" prefix of the vertex file names for the
+    /// kinematics files that were passed through to an input file.
+    std::set<std::string> PassThroughPrefixes(TTree* inputFiles) {
+        std::set<std::string> prefixes;
+        if (!inputFiles) return prefixes;
+        char fileName[1024];
+        char treeName[128];
+        inputFiles->SetBranchAddress("fileName", fileName);
+        inputFiles->SetBranchAddress("treeName", treeName);
+        for (Long64_t i = 0; i < inputFiles->GetEntries(); ++i) {
+            inputFiles->GetEntry(i);
+            prefixes.insert(std::string(fileName) + ":" + treeName + ":");
+        }
+        inputFiles->ResetBranchAddresses();
+        return prefixes;
+    }
+
+    /// Copy the events, and shift the interaction numbers of the vertices
+    /// that refer to the pass-through tree so they refer to the entry in the
+    /// merged tree.  This has to unpack the events.
+    TTree* ShiftedCopy(TTree* input, TTree* output, TDirectory* directory,
+                       const std::set<std::string>& prefixes, int offset) {
+        if (!output) {
+            directory->cd();
+            output = input->CloneTree(0);
+        }
+        TG4Event* event = NULL;
+        input->SetBranchAddress("Event", &event);
+        output->SetBranchAddress("Event", &event);
+        for (Long64_t i = 0; i < input->GetEntries(); ++i) {
+            input->GetEntry(i);
+            for (TG4PrimaryVertexContainer::iterator v
+                     = event->Primaries.begin();
+                 v != event->Primaries.end(); ++v) {
+                std::string filename(v->GetFilename());
+                for (std::set<std::string>::const_iterator p
+                         = prefixes.begin(); p != prefixes.end(); ++p) {
+                    if (filename.compare(0, p->size(), *p) != 0) continue;
+                    v->InteractionNumber += offset;
+                    break;
+                }
+            }
+            output->Fill();
+        }
+        input->ResetBranchAddresses();
+        output->ResetBranchAddresses();
+        delete event;
+        return output;
+    }
+
+    /// Copy the map from the pass-through entries to the kinematics files,
+    /// shifting the file number so it refers to the merged file list.
+    TTree* ShiftedInputKinem(TTree* input, TTree* output,
+                             TDirectory* directory, int offset) {
+        if (!output) {
+            directory->cd();
+            output = input->CloneTree(0);
+        }
+        int fileNumber = 0;
+        int entryNumber = 0;
+        input->SetBranchAddress("inputFileNum", &fileNumber);
+        input->SetBranchAddress("inputEntryNum", &entryNumber);
+        output->SetBranchAddress("inputFileNum", &fileNumber);
+        output->SetBranchAddress("inputEntryNum", &entryNumber);
+        for (Long64_t i = 0; i < input->GetEntries(); ++i) {
+            input->GetEntry(i);
+            fileNumber += offset;
+            output->Fill();
+        }
+        input->ResetBranchAddresses();
+        output->ResetBranchAddresses();
+        return output;
+    }
+}
+
+int main(int argc,char** argv) {
+    int c = 0;
+    while ((c=getopt(argc,argv,"h")) != -1) {
+        switch (c) {
+        case 'h':
+        default:
+            usage();
+        }
+    }
+
+    if (argc - optind < 2) usage();
+
+    std::string outputName = argv[optind];
+    TFile* output = TFile::Open(outputName.c_str(), "RECREATE",
+                                "EDepSim Root Output");
+    if (!output || !output->IsOpen()) {
+        std::cerr << "Unable to open " << outputName << std::endl;
+        return 1;
+    }
+    TDirectory* passThruDir = NULL;
+
+    // The output trees keyed by the directory and tree name.
+    std::map<std::string, TTree*> trees;
+
+    // The number of pass-through entries and kinematics files in the
+    // preceding input files.
+    int passThruEntries = 0;
+    int inputFiles = 0;
+    bool haveGeometry = false;
+
+    for (int i = optind+1; i < argc; ++i) {
+        std::string inputName = argv[i];
+        TFile* input = TFile::Open(inputName.c_str(), "READ");
+        if (!input || !input->IsOpen()) {
+            std::cerr << "Unable to open " << inputName << std::endl;
+            return 1;
+        }
+        std::cout << "Merge " << inputName << std::endl;
+
+        // Copy the geometry from the first file that has one.
+        if (!haveGeometry) {
+            TGeoManager* geom
+                = dynamic_cast<TGeoManager*>(input->Get(GEOMETRY));
+            if (geom) {
+                output->cd();
+                geom->Write();
+                haveGeometry = true;
+            }
+        }
+
+        // Copy the pass-through trees.  The events need the number of
+        // pass-through entries before this file was merged.
+        TDirectory* inputPassThru
+            = dynamic_cast<TDirectory*>(input->Get(PASSTHRUDIR));
+        std::set<std::string> prefixes;
+        int passThruAdded = 0;
+        int filesAdded = 0;
+        if (inputPassThru) {
+            if (!passThruDir) {
+                passThruDir = output->mkdir(PASSTHRUDIR,
+                                            "DETSIM Pass-Through Information");
+            }
+            prefixes = PassThroughPrefixes(
+                dynamic_cast<TTree*>(inputPassThru->Get(INPUTFILES)));
+            TIter next(inputPassThru->GetListOfKeys());
+            TKey* key;
+            while ((key = dynamic_cast<TKey*>(next()))) {
+                if (std::string(key->GetClassName()) != "TTree") continue;
+                // Only copy the highest cycle of each tree.
+                std::string name(key->GetName());
+                if (key->GetCycle() != inputPassThru->GetKey(
+                        name.c_str())->GetCycle()) continue;
+                TTree* tree
+                    = dynamic_cast<TTree*>(inputPassThru->Get(name.c_str()));
+                if (!tree) continue;
+                std::string path = std::string(PASSTHRUDIR) + "/" + name;
+                if (name == INPUTKINEM) {
+                    trees[path] = ShiftedInputKinem(tree, trees[path],
+                                                    passThruDir, inputFiles);
+                    continue;
+                }
+                if (name == INPUTFILES) filesAdded = tree->GetEntries();
+                else passThruAdded = tree->GetEntries();
+                trees[path] = FastCopy(tree, trees[path], passThruDir);
+            }
+        }
+
+        // Copy the top level trees.  The events are only unpacked when
+        // vertices refer to pass-through entries that have moved.
+        TIter next(input->GetListOfKeys());
+        TKey* key;
+        while ((key = dynamic_cast<TKey*>(next()))) {
+            if (std::string(key->GetClassName()) != "TTree") continue;
+            std::string name(key->GetName());
+            if (key->GetCycle() != input->GetKey(name.c_str())->GetCycle()) {
+                continue;
+            }
+            TTree* tree = dynamic_cast<TTree*>(input->Get(name.c_str()));
+            if (!tree) continue;
+            if (name == EVENTTREE
+                && passThruEntries > 0 && !prefixes.empty()) {
+                trees[name] = ShiftedCopy(tree, trees[name], output,
+                                          prefixes, passThruEntries);
+                continue;
+            }
+            trees[name] = FastCopy(tree, trees[name], output);
+        }
+
+        passThruEntries += passThruAdded;
+        inputFiles += filesAdded;
+
+        input->Close();
+        delete input;
+    }
+
+    if (!haveGeometry) {
+        std::cout << "No geometry found in the input files" << std::endl;
+    }
+
+    for (std::map<std::string, TTree*>::iterator t = trees.begin();
+         t != trees.end(); ++t) {
+        std::cout << "   " << t->first << " has "
+                  << t->second->GetEntries() << " entries" << std::endl;
+    }
+
+    output->Write();
+    output->Close();
+    delete output;
+
+    return 0;
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// End:
@@ -0,0 +1,942 @@
+////////////////////////////////////////////////////////////
+//
+// Time the kernels that are called for every step, hit, or event without
+// running the full simulation.  Each kernel is driven with synthetic
+// inputs (a muon crossing a liquid argon volume with a uniform drift
+// field), or with events recorded in an edep-sim output file, and the
+// time and the number of heap allocations per call are reported.
+
+#include "EDepSimHitSegment.hh"
+#include "EDepSimTrajectory.hh"
+#include "EDepSimTrajectoryMap.hh"
+#include "EDepSimUserEventInformation.hh"
+#include "EDepSimDokeBirksSaturation.hh"
+#include "EDepSimInterpolator.hh"
+#include "EDepSimFieldMap.hh"
+#include "EDepSimPersistencyManager.hh"
+#include "EDepSimArbEMField.hh"
+#include "EDepSimUniformField.hh"
+#include "EDepSimLog.hh"
+
+#include <TG4Event.h>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TBufferFile.h>
+
+#include <G4Event.hh>
+#include <G4TrajectoryContainer.hh>
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4Track.hh>
+#include <G4DynamicParticle.hh>
+#include <G4VProcess.hh>
+#include <G4ProcessType.hh>
+#include <G4EmProcessSubType.hh>
+#include <G4HadronicProcessType.hh>
+#include <G4TransportationProcessType.hh>
+#include <G4NistManager.hh>
+#include <G4Material.hh>
+#include <G4MaterialCutsCouple.hh>
+#include <G4Box.hh>
+#include <G4LogicalVolume.hh>
+#include <G4PVPlacement.hh>
+#include <G4Navigator.hh>
+#include <G4TouchableHistory.hh>
+#include <G4FieldManager.hh>
+#include <G4MuonMinus.hh>
+#include <G4Electron.hh>
+#include <G4Gamma.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    /// The number of heap allocations, and the bytes allocated.  These are
+    /// counted by the replacement operator new functions below.
+    std::size_t gAllocations = 0;
+    std::size_t gAllocatedBytes = 0;
+
+    void* CountedAllocation(std::size_t size) {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        void* memory = std::malloc(size ? size : 1);
+        if (!memory) throw std::bad_alloc();
+        return memory;
+    }
+
+    void* CountedAllocation(std::size_t size,
+                            const std::nothrow_t&) noexcept {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        return std::malloc(size ? size : 1);
+    }
+
+#ifdef __cpp_aligned_new
+    void* CountedAllocation(std::size_t size, std::align_val_t alignment,
+                            const std::nothrow_t&) noexcept {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        // The memory from posix_memalign is released with free.
+        std::size_t align = std::max(static_cast<std::size_t>(alignment),
+                                     sizeof(void*));
+        void* memory = nullptr;
+        if (posix_memalign(&memory, align, size ? size : 1) != 0) {
+            return nullptr;
+        }
+        return memory;
+    }
+
+    void* CountedAllocation(std::size_t size, std::align_val_t alignment) {
+        void* memory = CountedAllocation(size, alignment, std::nothrow);
+        if (!memory) throw std::bad_alloc();
+        return memory;
+    }
+#endif
+}
+
+// Replace the global allocation functions so every heap allocation made by
+// a kernel (including the allocations in Geant4 and ROOT) is counted.  All
+// of the replaceable forms are replaced (including the nothrow and the
+// over-aligned forms) so that none of the allocations are missed, and so
+// memory is never released by a different allocator than the one that
+// allocated it.
+void* operator new(std::size_t size) {return CountedAllocation(size);}
+void* operator new[](std::size_t size) {return CountedAllocation(size);}
+void* operator new(std::size_t size, const std::nothrow_t& tag) noexcept {
+    return CountedAllocation(size, tag);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return CountedAllocation(size, tag);
+}
+void operator delete(void* memory) noexcept {std::free(memory);}
+void operator delete[](void* memory) noexcept {std::free(memory);}
+void operator delete(void* memory, std::size_t) noexcept {std::free(memory);}
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAllocation(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountedAllocation(size, alignment);
+}
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t& tag) noexcept {
+    return CountedAllocation(size, alignment, tag);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t& tag) noexcept {
+    return CountedAllocation(size, alignment, tag);
+}
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory, std::size_t,
+                       std::align_val_t) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+void operator delete[](void* memory, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+#endif
+
+void usage () {
+    std::cout << "Usage: edep-microbench [options]" << std::endl;
+    std::cout << "  Time the per-step, per-hit and per-event kernels, and"
+              << std::endl
+              << "  report the time and the heap allocations per call."
+              << std::endl;
+    std::cout << "    -i <file>  -- An edep-sim output file with events to"
+              << std::endl
+              << "                  stream (the TG4Event kernels are"
+              << std::endl
+              << "                  skipped without it)." << std::endl;
+    std::cout << "    -n <count> -- The number of recorded events to use"
+              << " (default 10)." << std::endl;
+    std::cout << "    -k <name>  -- Only run kernels with <name> in the name."
+              << std::endl;
+    std::cout << "    -t <sec>   -- The minimum time per kernel"
+              << " (default 0.5)." << std::endl;
+    std::cout << "    -h         -- This help message." << std::endl;
+
+    exit(1);
+}
+
+namespace {
+    /// The minimum time to spend timing each kernel (in seconds).
+    double gMinimumTime = 0.5;
+
+    /// Only the kernels with this in their name are run.
+    std::string gSelect;
+
+    /// The kernel results are accumulated here so the calls can't be
+    /// optimized away.
+    volatile double gSink = 0.0;
+
+    /// The number of kernels that failed a consistency check.
+    int gFailures = 0;
+
+    /// Check if a kernel should be run.
+    bool Selected(const std::string& name) {
+        return gSelect.empty() || name.find(gSelect) != std::string::npos;
+    }
+
+    /// Print the result for one kernel.
+    void Report(const std::string& name, long long calls, double seconds,
+                std::size_t allocations, std::size_t bytes) {
+        std::cout << std::left << std::setw(40) << name << std::right
+                  << std::setw(12) << calls
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << 1E+9*seconds/calls
+                  << std::setprecision(2)
+                  << std::setw(12) << 1.0*allocations/calls
+                  << std::setprecision(0)
+                  << std::setw(12) << 1.0*bytes/calls
+                  << std::endl;
+    }
+
+    /// Time a kernel.  The body is called with the number of calls to make,
+    /// and the number of calls is increased until the body takes at least
+    /// the minimum time.  The first call warms up the caches and any
+    /// tables that are filled on the first use.
+    template <typename Body>
+    void Measure(const std::string& name, Body body) {
+        if (!Selected(name)) return;
+        body(1);
+        long long calls = 1;
+        for (;;) {
+            std::size_t allocations = gAllocations;
+            std::size_t bytes = gAllocatedBytes;
+            std::chrono::steady_clock::time_point start
+                = std::chrono::steady_clock::now();
+            body(calls);
+            std::chrono::duration<double> elapsed
+                = std::chrono::steady_clock::now() - start;
+            allocations = gAllocations - allocations;
+            bytes = gAllocatedBytes - bytes;
+            if (elapsed.count() >= gMinimumTime || calls >= (1LL<<40)) {
+                Report(name, calls, elapsed.count(), allocations, bytes);
+                return;
+            }
+            calls *= (elapsed.count() < 0.1*gMinimumTime) ? 10 : 2;
+        }
+    }
+
+    /// A process that is only used to label the synthetic steps.  It is
+    /// never asked to do anything.
+    class LabelProcess : public G4VProcess {
+    public:
+        LabelProcess(const G4String& name, G4ProcessType type, int subtype)
+            : G4VProcess(name, type) {
+            SetProcessSubType(subtype);
+        }
+        virtual ~LabelProcess() {}
+
+        virtual G4double AlongStepGetPhysicalInteractionLength(
+            const G4Track&, G4double, G4double, G4double&,
+            G4GPILSelection*) {return DBL_MAX;}
+        virtual G4double AtRestGetPhysicalInteractionLength(
+            const G4Track&, G4ForceCondition*) {return DBL_MAX;}
+        virtual G4double PostStepGetPhysicalInteractionLength(
+            const G4Track&, G4double, G4ForceCondition*) {return DBL_MAX;}
+        virtual G4VParticleChange* AlongStepDoIt(const G4Track&,
+                                                 const G4Step&) {
+            return nullptr;
+        }
+        virtual G4VParticleChange* AtRestDoIt(const G4Track&,
+                                              const G4Step&) {
+            return nullptr;
+        }
+        virtual G4VParticleChange* PostStepDoIt(const G4Track&,
+                                                const G4Step&) {
+            return nullptr;
+        }
+    };
+
+    /// The event that owns the synthetic trajectories.  The hit segments
+    /// look up their primary trajectory in this event.
+    const G4Event* gEvent = nullptr;
+
+    /// A hit segment that finds the primary trajectory in the synthetic
+    /// event instead of the current G4 event, and exposes the sagitta
+    /// calculation.  This must not add any fields since the hits are
+    /// allocated by the EDepSim::HitSegment allocator.
+    class BenchHitSegment : public EDepSim::HitSegment {
+    public:
+        BenchHitSegment() {}
+        virtual ~BenchHitSegment() {}
+        using EDepSim::HitSegment::FindSagitta;
+    protected:
+        virtual int FindPrimaryId(G4Track* theTrack) {
+            return EDepSim::TrajectoryMap::FindPrimaryId(
+                theTrack->GetTrackID(), gEvent);
+        }
+    };
+
+    /// A persistency manager that exposes the trajectory point selection.
+    class BenchPersistencyManager : public EDepSim::PersistencyManager {
+    public:
+        BenchPersistencyManager() {}
+        virtual ~BenchPersistencyManager() {}
+        using EDepSim::PersistencyManager::SelectTrajectoryPoints;
+    };
+
+    /// The synthetic detector.  A liquid argon volume with a uniform drift
+    /// field, and a water volume (which is not argon, so the default
+    /// saturation is used) inside an air world.
+    struct Detector {
+        G4VPhysicalVolume* fWorld;
+        G4MaterialCutsCouple* fArgonCouple;
+        G4MaterialCutsCouple* fWaterCouple;
+        G4Navigator fNavigator;
+
+        /// Get the touchable for the volume containing a point.
+        G4TouchableHandle Touchable(const G4ThreeVector& point) {
+            fNavigator.LocateGlobalPointAndSetup(point,nullptr,false,true);
+            return G4TouchableHandle(fNavigator.CreateTouchableHistory());
+        }
+    };
+
+    void BuildDetector(Detector& detector) {
+        G4NistManager* nist = G4NistManager::Instance();
+        G4Material* air = nist->FindOrBuildMaterial("G4_AIR");
+        G4Material* argon = nist->FindOrBuildMaterial("G4_lAr");
+        G4Material* water = nist->FindOrBuildMaterial("G4_WATER");
+
+        G4LogicalVolume* worldLV = new G4LogicalVolume(
+            new G4Box("World", 3*m, 3*m, 3*m), air, "World_LV");
+        detector.fWorld = new G4PVPlacement(
+            nullptr, G4ThreeVector(), worldLV, "World_PV",
+            nullptr, false, 0);
+
+        G4LogicalVolume* argonLV = new G4LogicalVolume(
+            new G4Box("Argon", 1*m, 1*m, 1*m), argon, "Argon_LV");
+        new G4PVPlacement(nullptr, G4ThreeVector(0, 0, 1*m), argonLV,
+                          "Argon_PV", worldLV, false, 0);
+        EDepSim::ArbEMField* drift = new EDepSim::ArbEMField(
+            new EDepSim::UniformField(
+                G4ThreeVector(), G4ThreeVector(0, 0, 500*volt/cm)),
+            nullptr);
+        argonLV->SetFieldManager(new G4FieldManager(drift), true);
+
+        G4LogicalVolume* waterLV = new G4LogicalVolume(
+            new G4Box("Water", 1*m, 1*m, 25*cm), water, "Water_LV");
+        new G4PVPlacement(nullptr, G4ThreeVector(0, 0, -50*cm), waterLV,
+                          "Water_PV", worldLV, false, 0);
+
+        detector.fArgonCouple = new G4MaterialCutsCouple(argon);
+        detector.fWaterCouple = new G4MaterialCutsCouple(water);
+        detector.fNavigator.SetWorldVolume(detector.fWorld);
+    }
+
+    /// Fill a step for a muon between two points.
+    void FillStep(G4Step& step, G4Track& track,
+                  const G4ThreeVector& pre, const G4ThreeVector& post,
+                  double time,
+                  const G4TouchableHandle& preTouchable,
+                  const G4TouchableHandle& postTouchable,
+                  G4StepStatus status, const G4VProcess* process,
+                  double deposit) {
+        double length = (post - pre).mag();
+        double mass = track.GetDefinition()->GetPDGMass();
+        G4StepPoint* prePoint = step.GetPreStepPoint();
+        G4StepPoint* postPoint = step.GetPostStepPoint();
+        prePoint->SetPosition(pre);
+        prePoint->SetGlobalTime(time);
+        prePoint->SetTouchableHandle(preTouchable);
+        prePoint->SetMass(mass);
+        prePoint->SetKineticEnergy(track.GetKineticEnergy());
+        prePoint->SetMomentumDirection((post - pre).unit());
+        postPoint->SetPosition(post);
+        postPoint->SetGlobalTime(time + length/c_light);
+        postPoint->SetTouchableHandle(postTouchable);
+        postPoint->SetMass(mass);
+        postPoint->SetKineticEnergy(track.GetKineticEnergy());
+        postPoint->SetMomentumDirection((post - pre).unit());
+        postPoint->SetStepStatus(status);
+        postPoint->SetProcessDefinedStep(process);
+        step.SetStepLength(length);
+        step.SetTotalEnergyDeposit(deposit);
+        step.SetNonIonizingEnergyDeposit(0.0);
+        step.SetTrack(&track);
+    }
+
+    /// The synthetic steps.  Each step is saved as its end points, and is
+    /// copied into a G4Step before it is used.
+    struct StepRecord {
+        G4ThreeVector fPre;
+        G4ThreeVector fPost;
+        double fTime;
+        G4TouchableHandle fPreTouchable;
+        G4TouchableHandle fPostTouchable;
+        G4StepStatus fStatus;
+        const G4VProcess* fProcess;
+        double fDeposit;
+    };
+
+    /// Make the steps for a muon track that bends in a circle with a radius
+    /// of 5 meters while crossing the detector along the Z axis.  A step
+    /// that ends in a new volume is a boundary (transportation) step.
+    std::vector<StepRecord> MakeMuonSteps(
+        Detector& detector, double stepLength,
+        const std::vector<const G4VProcess*>& physics,
+        const G4VProcess* transportation) {
+        std::vector<StepRecord> steps;
+        const double radius = 5*m;
+        const double start = -2.9*m;
+        const double stop = 2.9*m;
+        G4ThreeVector pre(0, 0, start);
+        G4TouchableHandle preTouchable = detector.Touchable(pre);
+        double time = 0.0;
+        for (double z = start + stepLength; z < stop; z += stepLength) {
+            G4ThreeVector post(radius - std::sqrt(radius*radius - z*z),
+                               0, z);
+            // Like G4, the touchable is only changed when the track enters
+            // a new volume.
+            G4TouchableHandle postTouchable = detector.Touchable(post);
+            if (postTouchable->GetVolume() == preTouchable->GetVolume()) {
+                postTouchable = preTouchable;
+            }
+            StepRecord record;
+            record.fPre = pre;
+            record.fPost = post;
+            record.fTime = time;
+            record.fPreTouchable = preTouchable;
+            record.fPostTouchable = postTouchable;
+            if (preTouchable->GetVolume() != postTouchable->GetVolume()) {
+                record.fStatus = fGeomBoundary;
+                record.fProcess = transportation;
+            }
+            else {
+                record.fStatus = fPostStepDoItProc;
+                record.fProcess = physics[steps.size() % physics.size()];
+            }
+            // About 2 MeV/cm, with a larger deposit for the hadronic steps.
+            record.fDeposit = 0.2*MeV*(post - pre).mag()/mm;
+            if (record.fProcess->GetProcessType() == fHadronic) {
+                record.fDeposit += 5*MeV;
+            }
+            steps.push_back(record);
+            time += (post - pre).mag()/c_light;
+            pre = post;
+            preTouchable = postTouchable;
+        }
+        return steps;
+    }
+
+    /// Fill the synthetic event with a shower of trajectories.  Each
+    /// trajectory is a daughter of the trajectory with half of its track
+    /// id, so the primary is found in about log2(count) steps.
+    void FillTrajectories(G4Event& event, G4Track& track, int count) {
+        event.SetUserInformation(new EDepSim::UserEventInformation());
+        G4TrajectoryContainer* container = new G4TrajectoryContainer();
+        event.SetTrajectoryContainer(container);
+        for (int trackId = 1; trackId <= count; ++trackId) {
+            track.SetTrackID(trackId);
+            track.SetParentID(trackId/2);
+            EDepSim::Trajectory* trajectory
+                = new EDepSim::Trajectory(&event, &track);
+            container->push_back(trajectory);
+            EDepSim::TrajectoryMap::Add(trajectory, &event);
+        }
+    }
+
+    /// Time the hit segment kernels.  The hits are made with the steps of
+    /// a muon in argon.
+    void HitSegmentKernels(Detector& detector, G4Track& track,
+                           const std::vector<const G4VProcess*>& physics,
+                           const G4VProcess* transportation) {
+        std::vector<StepRecord> records = MakeMuonSteps(
+            detector, 0.5*mm, physics, transportation);
+        // Use steps from the middle of the argon.
+        std::vector<G4Step*> steps;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            if (records[i].fPre.z() < 0.9*m) continue;
+            if (steps.size() >= 10) break;
+            const StepRecord& r = records[i];
+            G4Step* step = new G4Step();
+            FillStep(*step, track, r.fPre, r.fPost, r.fTime,
+                     r.fPreTouchable, r.fPostTouchable, fAlongStepDoItProc,
+                     nullptr, r.fDeposit);
+            steps.push_back(step);
+        }
+
+        // A hit with nine steps, and the next step of the track.
+        BenchHitSegment* hit = new BenchHitSegment();
+        for (std::size_t i = 0; i+1 < steps.size(); ++i) {
+            hit->AddStep(steps[i]);
+        }
+        G4Step* next = steps.back();
+
+        Measure("HitSegment::SameHit", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) sum += hit->SameHit(next);
+            gSink = gSink + sum;
+        });
+
+        Measure("HitSegment::FindSagitta", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                sum += hit->FindSagitta(next);
+            }
+            gSink = gSink + sum;
+        });
+
+        // The life of a hit as it is used by EDepSim::SegmentSD.
+        Measure("HitSegment make a 10 step hit", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                BenchHitSegment* newHit = new BenchHitSegment();
+                newHit->AddStep(steps[0]);
+                for (std::size_t s = 1; s < steps.size(); ++s) {
+                    if (newHit->SameHit(steps[s])) newHit->AddStep(steps[s]);
+                }
+                sum += newHit->GetEnergyDeposit();
+                delete newHit;
+            }
+            gSink = gSink + sum;
+        });
+
+        delete hit;
+        for (std::size_t i = 0; i < steps.size(); ++i) delete steps[i];
+    }
+
+    /// Time the trajectory map lookups for a shower of trajectories.
+    void TrajectoryMapKernels(const G4Event& event, int count) {
+        std::mt19937 engine(20100);
+        std::uniform_int_distribution<int> uniform(1, count);
+        std::vector<int> trackIds(4096);
+        for (std::size_t i = 0; i < trackIds.size(); ++i) {
+            trackIds[i] = uniform(engine);
+        }
+        const std::size_t mask = trackIds.size() - 1;
+
+        Measure("TrajectoryMap::Get", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                sum += (EDepSim::TrajectoryMap::Get(
+                            trackIds[i & mask], &event) != nullptr);
+            }
+            gSink = gSink + sum;
+        });
+
+        Measure("TrajectoryMap::FindPrimaryId", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                sum += EDepSim::TrajectoryMap::FindPrimaryId(
+                    trackIds[i & mask], &event);
+            }
+            gSink = gSink + sum;
+        });
+    }
+
+    /// Time the visible energy calculation.  The deposits and step lengths
+    /// are spread over the range seen for electrons in argon.
+    void SaturationKernels(Detector& detector, G4Track& track) {
+        EDepSim::DokeBirksSaturation saturation(0);
+        std::mt19937 engine(20100);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        const std::size_t samples = 1024;
+        const std::size_t mask = samples - 1;
+        std::vector<double> deposits(samples);
+        std::vector<double> lengths(samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            deposits[i] = 0.01*MeV*std::pow(100.0, uniform(engine));
+            lengths[i] = 0.01*mm*std::pow(100.0, uniform(engine));
+        }
+
+        G4ThreeVector point(0, 0, 1*m);
+        G4TouchableHandle touchable = detector.Touchable(point);
+        G4Step step;
+        FillStep(step, track, point, point + G4ThreeVector(0, 0, 1*mm),
+                 0.0, touchable, touchable, fAlongStepDoItProc, nullptr,
+                 1*MeV);
+
+        const G4ParticleDefinition* electron = G4Electron::Definition();
+        const G4ParticleDefinition* gamma = G4Gamma::Definition();
+        const G4MaterialCutsCouple* argon = detector.fArgonCouple;
+        const G4MaterialCutsCouple* water = detector.fWaterCouple;
+
+        Measure("DokeBirks LAr electron", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                sum += saturation.VisibleEnergyDeposition(
+                    &step, electron, argon,
+                    lengths[i & mask], deposits[i & mask], 0.0);
+            }
+            gSink = gSink + sum;
+        });
+
+        Measure("DokeBirks LAr gamma", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                sum += saturation.VisibleEnergyDeposition(
+                    &step, gamma, argon,
+                    lengths[i & mask], deposits[i & mask], 0.0);
+            }
+            gSink = gSink + sum;
+        });
+
+        Measure("DokeBirks not argon (G4EmSaturation)",
+                [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                sum += saturation.VisibleEnergyDeposition(
+                    &step, electron, water,
+                    lengths[i & mask], deposits[i & mask], 0.0);
+            }
+            gSink = gSink + sum;
+        });
+    }
+
+    /// Time the field interpolation.  The grid is 50 points on a side with
+    /// a 2 cm spacing, and the points are inside the grid.
+    void InterpolationKernels() {
+        const int size = 50;
+        const double spacing = 2*cm;
+        std::vector<std::vector<std::vector<double>>> grid(
+            size, std::vector<std::vector<double>>(
+                size, std::vector<double>(size)));
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                for (int k = 0; k < size; ++k) {
+                    grid[i][j][k] = std::sin(0.1*i)*std::cos(0.2*j) + 0.01*k;
+                }
+            }
+        }
+
+        std::mt19937 engine(20100);
+        std::uniform_real_distribution<double> uniform(
+            0.0, (size - 1)*spacing);
+        const std::size_t samples = 1024;
+        const std::size_t mask = samples - 1;
+        std::vector<G4ThreeVector> points(samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            points[i].set(uniform(engine), uniform(engine), uniform(engine));
+        }
+
+        EDepSim::Cubic cubic;
+        Measure("Cubic::interpolate", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                const G4ThreeVector& p = points[i & mask];
+                sum += cubic.interpolate(p.x(), p.y(), p.z(), grid,
+                                         spacing, spacing, spacing,
+                                         0.0, 0.0, 0.0);
+            }
+            gSink = gSink + sum;
+        });
+
+        if (!Selected("FieldMap::GetValue cubic")
+            && !Selected("FieldMap::GetValue linear")) return;
+
+        // The field map is filled from a text grid with the same values
+        // for each component.
+        char fileName[] = "/tmp/edep-microbench-XXXXXX";
+        int descriptor = mkstemp(fileName);
+        if (descriptor < 0) {
+            EDepSimError("Cannot write the field map");
+            return;
+        }
+        close(descriptor);
+        std::ofstream output(fileName);
+        output << std::setprecision(17);
+        output << "0 0 0 " << spacing << " " << spacing << " " << spacing
+               << std::endl;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                for (int k = 0; k < size; ++k) {
+                    double v = grid[i][j][k];
+                    output << i*spacing << " " << j*spacing << " "
+                           << k*spacing << " " << v << " " << v << " "
+                           << v << " " << std::sqrt(3.0)*v << std::endl;
+                }
+            }
+        }
+        output.close();
+        EDepSim::FieldMap fieldMap;
+        bool filled = fieldMap.ReadFile(fileName, 1.0);
+        std::remove(fileName);
+        if (!filled) {
+            ++gFailures;
+            return;
+        }
+
+        // Check that the field map gives the same values as
+        // EDepSim::Cubic.  The points extend past the edges of the grid
+        // so the stencils that are partly outside of the map are checked.
+        std::uniform_real_distribution<double> wide(
+            -2.5*spacing, (size + 1.5)*spacing);
+        fieldMap.SetInterpolation(EDepSim::FieldMap::kCubic);
+        double worst = 0.0;
+        for (std::size_t i = 0; i < 10*samples; ++i) {
+            double point[3] = {wide(engine), wide(engine), wide(engine)};
+            double value[3];
+            fieldMap.GetValue(point, value);
+            double expected = cubic.interpolate(point[0], point[1], point[2],
+                                                grid, spacing, spacing,
+                                                spacing, 0.0, 0.0, 0.0);
+            for (int axis = 0; axis < 3; ++axis) {
+                worst = std::max(worst, std::abs(value[axis] - expected));
+            }
+        }
+        if (worst > 1E-12) {
+            EDepSimError("FieldMap::GetValue differs from Cubic::interpolate"
+                         << " by " << worst);
+            ++gFailures;
+        }
+
+        EDepSim::FieldMap::Interpolation methods[] = {
+            EDepSim::FieldMap::kCubic, EDepSim::FieldMap::kLinear};
+        const char* names[] = {
+            "FieldMap::GetValue cubic", "FieldMap::GetValue linear"};
+        for (int method = 0; method < 2; ++method) {
+            fieldMap.SetInterpolation(methods[method]);
+            Measure(names[method], [&](long long calls) {
+                double sum = 0.0;
+                double value[3];
+                for (long long i = 0; i < calls; ++i) {
+                    const G4ThreeVector& p = points[i & mask];
+                    double point[3] = {p.x(), p.y(), p.z()};
+                    fieldMap.GetValue(point, value);
+                    sum += value[0];
+                }
+                gSink = gSink + sum;
+            });
+        }
+    }
+
+    /// Time the trajectory point selection for a muon crossing the
+    /// detector with 5 mm steps.
+    void TrajectoryPointKernels(Detector& detector, G4Event& event,
+                                G4Track& track,
+                                const std::vector<const G4VProcess*>& physics,
+                                const G4VProcess* transportation) {
+        std::vector<StepRecord> records = MakeMuonSteps(
+            detector, 5*mm, physics, transportation);
+        track.SetTrackID(1);
+        track.SetParentID(0);
+        EDepSim::Trajectory* trajectory
+            = new EDepSim::Trajectory(&event, &track);
+        G4Step step;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            const StepRecord& r = records[i];
+            FillStep(step, track, r.fPre, r.fPost, r.fTime,
+                     r.fPreTouchable, r.fPostTouchable, r.fStatus,
+                     r.fProcess, r.fDeposit);
+            trajectory->AppendStep(&step);
+        }
+        trajectory->AddSDEnergyDeposit(400*MeV);
+        trajectory->AddSDLength(2*m);
+
+        BenchPersistencyManager persistency;
+        persistency.AddTrajectoryBoundary("Argon");
+        std::vector<int> selected;
+        std::string name = "SelectTrajectoryPoints ("
+            + std::to_string(trajectory->GetPointEntries()) + " points)";
+        Measure(name, [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                persistency.SelectTrajectoryPoints(selected, trajectory);
+                sum += selected.size();
+            }
+            gSink = gSink + sum;
+        });
+
+        delete trajectory;
+    }
+
+    /// Time streaming the recorded events to and from a buffer.  This is
+    /// the object streaming done when the event tree is filled and read,
+    /// without the compression and the file i/o.
+    void StreamingKernels(const std::string& inputName, int count) {
+        if (!Selected("TG4Event write") && !Selected("TG4Event read")) {
+            return;
+        }
+        if (inputName.empty()) {
+            std::cout << "TG4Event kernels skipped (no recorded events)"
+                      << std::endl;
+            return;
+        }
+        TFile* input = TFile::Open(inputName.c_str(), "READ");
+        if (!input || !input->IsOpen()) {
+            EDepSimError("Unable to open " << inputName);
+            return;
+        }
+        TTree* events = dynamic_cast<TTree*>(input->Get("EDepSimEvents"));
+        if (!events || events->GetEntries() < 1) {
+            EDepSimError("No events in " << inputName);
+            return;
+        }
+        std::vector<TG4Event*> recorded;
+        TG4Event* event = nullptr;
+        events->SetBranchAddress("Event", &event);
+        for (Long64_t i = 0; i < events->GetEntries() && i < count; ++i) {
+            // A new event is allocated for each entry.
+            event = nullptr;
+            events->GetEntry(i);
+            recorded.push_back(event);
+        }
+        events->ResetBranchAddresses();
+        const std::size_t size = recorded.size();
+
+        // Write each event once so the read kernel has input.
+        std::vector<std::vector<char>> buffers(size);
+        TBufferFile writer(TBuffer::kWrite);
+        for (std::size_t i = 0; i < size; ++i) {
+            writer.Reset();
+            writer.WriteClassBuffer(TG4Event::Class(), recorded[i]);
+            buffers[i].assign(writer.Buffer(),
+                              writer.Buffer() + writer.Length());
+        }
+        double bytes = 0.0;
+        for (std::size_t i = 0; i < size; ++i) bytes += buffers[i].size();
+        EDepSimLog("Streaming " << size << " events from " << inputName
+                   << " (" << bytes/size << " bytes per event)");
+
+        Measure("TG4Event write", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                writer.Reset();
+                writer.WriteClassBuffer(TG4Event::Class(), recorded[i % size]);
+                sum += writer.Length();
+            }
+            gSink = gSink + sum;
+        });
+
+        std::vector<TBufferFile*> readers(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            readers[i] = new TBufferFile(TBuffer::kRead, buffers[i].size(),
+                                         buffers[i].data(), kFALSE);
+        }
+        TG4Event target;
+        Measure("TG4Event read", [&](long long calls) {
+            double sum = 0.0;
+            for (long long i = 0; i < calls; ++i) {
+                TBufferFile* reader = readers[i % size];
+                reader->Reset();
+                reader->ReadClassBuffer(TG4Event::Class(), &target);
+                sum += target.Trajectories.size();
+            }
+            gSink = gSink + sum;
+        });
+
+        for (std::size_t i = 0; i < size; ++i) {
+            delete readers[i];
+            delete recorded[i];
+        }
+        input->Close();
+        delete input;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string inputName;
+    int recordedEvents = 10;
+    int c;
+    while ((c=getopt(argc,argv,"i:n:k:t:h")) != -1) {
+        switch (c) {
+        case 'i':
+            inputName = optarg;
+            break;
+        case 'n':
+            recordedEvents = std::atoi(optarg);
+            break;
+        case 'k':
+            gSelect = optarg;
+            break;
+        case 't':
+            gMinimumTime = std::atof(optarg);
+            break;
+        case 'h':
+        default:
+            usage();
+        }
+    }
+    if (optind != argc || recordedEvents < 1) usage();
+
+    Detector detector;
+    BuildDetector(detector);
+
+    // The processes used to label the steps.  Most steps are continuous
+    // ionization, with some multiple scattering, delta-ray production and
+    // hadronic interactions mixed in.
+    LabelProcess transportation("Transportation", fTransportation,
+                                TRANSPORTATION);
+    LabelProcess ionization("muIoni", fElectromagnetic, fIonisation);
+    LabelProcess scattering("muMsc", fElectromagnetic, fMultipleScattering);
+    LabelProcess hadronic("muonNuclear", fHadronic, fHadronInelastic);
+    std::vector<const G4VProcess*> physics;
+    for (int i = 0; i < 12; ++i) physics.push_back(&ionization);
+    for (int i = 0; i < 4; ++i) physics.push_back(&scattering);
+    physics.push_back(&hadronic);
+
+    G4Track track(new G4DynamicParticle(G4MuonMinus::Definition(),
+                                        G4ThreeVector(0, 0, 1), 2*GeV),
+                  0.0, G4ThreeVector());
+    track.SetTouchableHandle(detector.Touchable(G4ThreeVector()));
+    track.SetTrackID(1);
+    track.SetParentID(0);
+
+    // The trajectories for a shower with a thousand particles.
+    const int trajectories = 1000;
+    G4Event event(0);
+    FillTrajectories(event, track, trajectories);
+    gEvent = &event;
+
+    std::cout << std::left << std::setw(40) << "kernel" << std::right
+              << std::setw(12) << "calls"
+              << std::setw(12) << "ns/call"
+              << std::setw(12) << "allocs/call"
+              << std::setw(12) << "bytes/call"
+              << std::endl;
+
+    track.SetTrackID(trajectories);
+    HitSegmentKernels(detector, track, physics, &transportation);
+    TrajectoryMapKernels(event, trajectories);
+    SaturationKernels(detector, track);
+    InterpolationKernels();
+    TrajectoryPointKernels(detector, event, track,
+                           physics, &transportation);
+    StreamingKernels(inputName, recordedEvents);
+
+    return (gFailures > 0) ? 1 : 0;
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// End:
@@ -24,9 +24,15 @@ void usage () {
               << std::endl;
     std::cout << "    -e <n>  -- Add /run/beamOn <n> after last macro."
               << std::endl;
+    std::cout << "    -F <n>  -- Start at event <n> of the kinematics input."
+              << std::endl;
     std::cout << "    -g      -- Set a GDML file" << std::endl;
     std::cout << "    -o      -- Set the output file" << std::endl;
     std::cout << "    -p      -- Select the physics list" << std::endl;
+    std::cout << "    -R      -- Restart from the last checkpoint in the"
+              << std::endl
+              << "               output file (see /edep/db/checkpoint)."
+              << std::endl;
     std::cout << "    -s      -- Set the seed from the time" << std::endl;
     std::cout << "    -u      -- Do update before running the macros"
               << std::endl;
@@ -56,6 +62,7 @@ int main(int argc,char** argv) {
     bool setSeed=false;
     bool doUpdate=false;
     bool validateGeometry=true;
+    bool restart=false;
     int debugLevel = 0;
     std::map<std::string, EDepSim::LogManager::ErrorPriority> namedDebugLevel;
 
@@ -68,9 +75,13 @@ int main(int argc,char** argv) {
     // instead of "-e 10".
     std::string beamOnCount = "";
 
+    // If filled, start at this event in the kinematics input.  This is used
+    // with "-e" to split a run between several jobs.
+    std::string firstEvent = "";
+
     if (argc<2) usage();
 
-    while (!errflg && ((c=getopt(argc,argv,"CdD:e:g:o:p:qsuUvV:h")) != -1)) {
+    while (!errflg && ((c=getopt(argc,argv,"CdD:e:F:g:o:p:qRsuUvV:h")) != -1)) {
         switch (c) {
         case 'C': {
             // Toggle the validateGeometry flag.  The default value is set
@@ -125,6 +136,11 @@ int main(int argc,char** argv) {
             beamOnCount = optarg;
             break;
         }
+        case 'F': {
+            // Skip the input events before the first event.
+            firstEvent = optarg;
+            break;
+        }
         case 'g': {
             gdmlFilename = optarg;
             break;
@@ -137,6 +153,11 @@ int main(int argc,char** argv) {
             physicsList = optarg;
             break;
         }
+        case 'R': {
+            // Restart from the checkpoint saved with the output file.
+            restart = true;
+            break;
+        }
         case 's': {
             // Force a '/edep/random/timeRandomSeed'
             setSeed = true;
@@ -284,6 +305,7 @@ int main(int argc,char** argv) {
 
     // Open the file if one was declared on the command line.
     if (persistencyManager && ! outputFilename.empty()) {
+        if (restart) UI->ApplyCommand("/edep/db/restart");
         UI->ApplyCommand("/edep/db/open "+outputFilename);
     }
 
@@ -299,6 +321,12 @@ int main(int argc,char** argv) {
     // Set the random seed from the time.
     if (setSeed) UI->ApplyCommand("/edep/random/timeRandomSeed");
 
+    // Start part way through the kinematics input.  This must be before the
+    // macros add the generators.
+    if (!firstEvent.empty()) {
+        UI->ApplyCommand("/generator/firstEvent " + firstEvent);
+    }
+
     // Set the defaults for the simulation and get ready to run.  This needs
     // to be done before the first event is generated, but can also be done in
     // the users macro file.  It's executed here if the "-u" option was
@@ -10,7 +10,7 @@
 
 class TG4Event : public TObject {
 public:
-    TG4Event(void) {}
+    TG4Event(void) : RandomSeed(0) {}
     virtual ~TG4Event();
 
     /// The run number
@@ -22,6 +22,13 @@ public:
     /// The event number
     int EventId;
 
+    /// The seed that started the random engine for this event when the
+    /// engine is reseeded for every event (see /edep/random/eventSeeding).
+    /// The seed is derived from the random seed, the run number and the
+    /// event number.  This is zero when the engine is only seeded at the
+    /// start of the job.
+    Long64_t RandomSeed;
+
     /// A container of primary vertices (a vector).  Sometimes, there is only
     /// one element, but you need to be careful since some neutrino events
     /// don't have any primary particles (e.g. neutral current events where
@@ -46,6 +53,6 @@ public:
     /// Keyed by the sensitive-detector name (e.g. "PhotonDetector").
     TG4PhotonHitDetectors PhotonDetectors;
 
-    ClassDef(TG4Event,3)
+    ClassDef(TG4Event,4)
 };
 #endif
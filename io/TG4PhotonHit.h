@@ -25,7 +25,7 @@ public:
     TG4PhotonHit()
         : Stop(0,0,0,0), Start(0,0,0,0),
           PrimaryId(-1), Process(-1),
-          EnergyDeposit(0) {}
+          EnergyDeposit(0), Count(1) {}
     virtual ~TG4PhotonHit();
 
     /// The track id of the particle that created this photon.  If the track
@@ -57,6 +57,13 @@ public:
     /// 0) Cherenkov, 2) Scintillation, and 7) Wave length shifter.
     int GetProcess() const {return Process;}
 
+    /// Get the number of photons summarized by this hit.  This is one
+    /// unless the photons are being accumulated into time bins (see
+    /// `/edep/photonBinning`).  For accumulated photons, the positions,
+    /// times and energy are the averages over the photons in the bin, and a
+    /// sampled photon that is already counted in a bin has a count of zero.
+    int GetCount() const {return Count;}
+
 // The public fields are deprecated but still supported by default in the
 // current version.
 #define EDEPSIM_USE_PUBLIC_FIELDS
@@ -87,7 +94,10 @@ private:
     /// Photon energy.
     Float_t EnergyDeposit;
 
-    ClassDef(TG4PhotonHit, 1)
+    /// The number of photons summarized by this hit.
+    int Count;
+
+    ClassDef(TG4PhotonHit, 2)
 };
 
 #endif
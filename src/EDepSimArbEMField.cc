@@ -38,12 +38,16 @@
 EDepSim::ArbEMField::ArbEMField()
     : efield(nullptr)
     , bfield(nullptr)
+    , efield_owner(true)
+    , bfield_owner(true)
 {
 }
 
 EDepSim::ArbEMField::ArbEMField(G4Field* efield_in, G4Field* bfield_in)
     : efield(efield_in)
     , bfield(bfield_in)
+    , efield_owner(true)
+    , bfield_owner(true)
 {
 }
 
@@ -68,8 +72,10 @@ EDepSim::ArbEMField& EDepSim::ArbEMField::operator=(const ArbEMField& rhs)
 
 EDepSim::ArbEMField::~ArbEMField()
 {
-    delete bfield;
-    delete efield;
+    if(bfield_owner)
+        delete bfield;
+    if(efield_owner)
+        delete efield;
 }
 
 void EDepSim::ArbEMField::GetFieldValue(const G4double pos[4], G4double *field) const
@@ -59,12 +59,27 @@ class EDepSim::ArbEMField : public G4ElectroMagneticField
         virtual void GetFieldValue(const G4double pos[4], G4double *field) const;
         virtual G4bool DoesFieldChangeEnergy() const { return true; };
 
-        void SetEField(G4Field* efield_in) { efield = efield_in; };
-        void SetBField(G4Field* bfield_in) { bfield = bfield_in; };
+        // Set the fields.  The ArbEMField deletes the fields it owns.  A
+        // field map that is shared between several volumes is not owned.
+        void SetEField(G4Field* efield_in, G4bool owner = true)
+        {
+            efield = efield_in;
+            efield_owner = owner;
+        };
+        void SetBField(G4Field* bfield_in, G4bool owner = true)
+        {
+            bfield = bfield_in;
+            bfield_owner = owner;
+        };
+
+        const G4Field* GetEField() const { return efield; };
+        const G4Field* GetBField() const { return bfield; };
 
     private:
         G4Field* efield;
         G4Field* bfield;
+        G4bool efield_owner;
+        G4bool bfield_owner;
 };
 
 #endif
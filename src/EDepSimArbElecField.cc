@@ -41,94 +41,22 @@ EDepSim::ArbElecField::ArbElecField()
 
 bool EDepSim::ArbElecField::ReadFile(const std::string& fname)
 {
-    m_filename = fname;
-    std::fstream fin(fname, std::fstream::in);
-
-    if(!fin.is_open())
-    {
-        EDepSimError("Can't read " << fname << std::endl);
-        return false;
-    }
-    else
-    {
-        EDepSimLog("Reading " << fname << " ...");
-        int xcount{-1}, ycount{-1}, zcount{-1};
-        double xcurr{0}, ycurr{0}, zcurr{0};
-        std::string line;
-
-        while(std::getline(fin >> std::ws, line))
-        {
-            std::stringstream ss(line);
-
-            if(ss.str().front() == '#')
-                continue;
-
-            ss >> m_offset[0] >> m_offset[1] >> m_offset[2]
-                >> m_delta[0] >> m_delta[1] >> m_delta[2];
-            break;
-        }
-
-        while(std::getline(fin >> std::ws, line))
-        {
-            double x{0}, y{0}, z{0}, fx{0}, fy{0}, fz{0}, f{0};
-            std::stringstream ss(line);
-
-            if(ss.str().front() == '#')
-                continue;
-
-            ss >> x >> y >> z >> fx >> fy >> fz >> f;
-
-            if(std::abs(x - xcurr) > 0.0 || xcount < 0)
-            {
-                xcurr = x;
-                xcount += 1;
-                ycount = -1;
-                m_field_x.emplace_back(std::vector<std::vector<double>>{});
-                m_field_y.emplace_back(std::vector<std::vector<double>>{});
-                m_field_z.emplace_back(std::vector<std::vector<double>>{});
-            }
-
-            if(std::abs(y - ycurr) > 0.0 || ycount < 0)
-            {
-                ycurr = y;
-                ycount += 1;
-                zcount = -1;
-                m_field_x[xcount].emplace_back(std::vector<double>{});
-                m_field_y[xcount].emplace_back(std::vector<double>{});
-                m_field_z[xcount].emplace_back(std::vector<double>{});
-            }
-
-            m_field_x[xcount][ycount].push_back(fx * (volt/cm));
-            m_field_y[xcount][ycount].push_back(fy * (volt/cm));
-            m_field_z[xcount][ycount].push_back(fz * (volt/cm));
-
-            if(std::abs(z - zcurr) > 0.0 || zcount < 0)
-            {
-                zcurr = z;
-                zcount += 1;
-            }
-        }
-    }
-
-    return true;
+    return m_field.ReadFile(fname, (volt/cm));
 }
 
 void EDepSim::ArbElecField::GetFieldValue(const G4double pos[4], G4double* field) const
 {
-    const double x = pos[0];
-    const double y = pos[1];
-    const double z = pos[2];
-
-    EDepSim::Cubic interp;
-    field[3] = interp.interpolate(x, y, z, m_field_x, m_delta[0], m_delta[1], m_delta[2], m_offset[0], m_offset[1], m_offset[2]);
-    field[4] = interp.interpolate(x, y, z, m_field_y, m_delta[0], m_delta[1], m_delta[2], m_offset[0], m_offset[1], m_offset[2]);
-    field[5] = interp.interpolate(x, y, z, m_field_z, m_delta[0], m_delta[1], m_delta[2], m_offset[0], m_offset[1], m_offset[2]);
+    m_field.GetValue(pos, field+3);
 }
 
 void EDepSim::ArbElecField::PrintInfo() const
 {
     EDepSimLog("Printing values for electric field.");
-    EDepSimLog("m_filename : " << m_filename
-              << "\nm_offset   : " << m_offset[0] << ", " << m_offset[1] << ", " << m_offset[2]
-              << "\nm_delta    : " << m_delta[0] << ", " << m_delta[1] << ", " << m_delta[2]);
+    const std::array<double, 3>& offset = m_field.GetOffset();
+    const std::array<double, 3>& delta = m_field.GetDelta();
+    EDepSimLog("m_filename : " << m_field.GetFileName()
+              << "\nm_offset   : " << offset[0] << ", " << offset[1] << ", " << offset[2]
+              << "\nm_delta    : " << delta[0] << ", " << delta[1] << ", " << delta[2]
+              << "\nm_size     : " << m_field.GetSize(0) << ", " << m_field.GetSize(1) << ", " << m_field.GetSize(2)
+              << "\nm_interp   : " << (m_field.GetInterpolation() == EDepSim::FieldMap::kLinear ? "linear" : "cubic"));
 }
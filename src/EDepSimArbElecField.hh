@@ -52,7 +52,7 @@
 #include "G4SystemOfUnits.hh"
 
 #include "EDepSimLog.hh"
-#include "EDepSimInterpolator.hh"
+#include "EDepSimFieldMap.hh"
 
 namespace EDepSim { class ArbElecField; }
 
@@ -65,13 +65,14 @@ class EDepSim::ArbElecField : public G4ElectricField
         void PrintInfo() const;
         virtual void GetFieldValue(const G4double pos[4], G4double* field) const;
 
+        /// Set the method used to interpolate the field map.
+        void SetInterpolation(EDepSim::FieldMap::Interpolation method)
+        {
+            m_field.SetInterpolation(method);
+        }
+
     private:
-        std::string m_filename;
-        std::array<double, 3> m_offset;
-        std::array<double, 3> m_delta;
-        std::vector<std::vector<std::vector<double>>> m_field_x;
-        std::vector<std::vector<std::vector<double>>> m_field_y;
-        std::vector<std::vector<std::vector<double>>> m_field_z;
+        EDepSim::FieldMap m_field;
 };
 
 #endif
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimCheckpointManager.hh"
+#include "EDepSimUserPrimaryGeneratorAction.hh"
+#include "EDepSimLog.hh"
+#include "EDepSimException.hh"
+
+#include "kinem/EDepSimPrimaryGenerator.hh"
+#include "kinem/EDepSimVKinematicsGenerator.hh"
+
+#include <G4Event.hh>
+#include <G4Run.hh>
+#include <G4RunManager.hh>
+#include <Randomize.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+EDepSim::CheckpointManager* EDepSim::CheckpointManager::fThis = NULL;
+
+void EDepSim::CheckpointManager::SetOutputFilename(const std::string& name) {
+    fSidecar = name + ".checkpoint";
+}
+
+bool EDepSim::CheckpointManager::ReadSidecar(const std::string& name,
+                                             long long entries) {
+    std::ifstream input(name.c_str());
+    if (!input.is_open()) return false;
+
+    std::string line;
+    std::getline(input, line);
+    if (line != "EDepSimCheckpoint 1") {
+        EDepSimError("Not a checkpoint file: " << name);
+        return false;
+    }
+
+    std::string key;
+    long long savedEntries = -1;
+    int generators = 0;
+    input >> key >> fRunId;
+    if (key != "run") return false;
+    input >> key >> fNextEvent;
+    if (key != "next") return false;
+    input >> key >> fEndEvent;
+    if (key != "end") return false;
+    input >> key >> savedEntries;
+    if (key != "entries") return false;
+    input >> key >> generators;
+    if (key != "generators" || !input) return false;
+    std::getline(input, line);
+
+    if (savedEntries != entries) {
+        EDepSimLog("Checkpoint " << name << " has " << savedEntries
+                   << " events, but the output has " << entries);
+        return false;
+    }
+
+    fGeneratorStates.clear();
+    for (int i = 0; i < generators; ++i) {
+        if (!std::getline(input, line)) return false;
+        fGeneratorStates.push_back(line);
+    }
+
+    std::getline(input, line);
+    if (line != "random") return false;
+    std::ostringstream random;
+    random << input.rdbuf();
+    fRandomState = random.str();
+    return !fRandomState.empty();
+}
+
+bool EDepSim::CheckpointManager::ReadCheckpoint(long long entries) {
+    // The temporary sidecar is used if the job stopped after the output
+    // was flushed, but before the sidecar was moved into place.
+    if (!ReadSidecar(fSidecar, entries)
+        && !ReadSidecar(fSidecar + ".tmp", entries)) {
+        return false;
+    }
+
+    EDepSimLog("Restart run " << fRunId << " at event " << fNextEvent
+               << " from " << fSidecar);
+    fRestoring = true;
+    fRestarted = true;
+    G4RunManager::GetRunManager()->SetRunIDCounter(fRunId);
+    return true;
+}
+
+void EDepSim::CheckpointManager::Restore(
+    const std::vector<G4VPrimaryGenerator*>& generators) {
+    fRestoring = false;
+
+    // The restarted job must have the same generators as the original job,
+    // otherwise it would produce different events.
+    if (generators.size() != fGeneratorStates.size()) {
+        EDepSimThrow("Checkpoint has " << fGeneratorStates.size()
+                     << " generators, but the job has "
+                     << generators.size());
+    }
+    for (std::size_t i = 0; i < generators.size(); ++i) {
+        EDepSim::PrimaryGenerator* generator
+            = dynamic_cast<EDepSim::PrimaryGenerator*>(generators[i]);
+        if (!generator || !generator->GetKinematicsGenerator()) continue;
+        std::istringstream state(fGeneratorStates[i]);
+        generator->GetKinematicsGenerator()->RestoreState(state);
+    }
+
+    std::istringstream random(fRandomState);
+    G4Random::restoreFullState(random);
+    EDepSimLog("Restored the generators and random engine at event "
+               << fNextEvent);
+}
+
+void EDepSim::CheckpointManager::BeginOfRun(const G4Run* aRun) {
+    if (fRestarted) {
+        if (aRun->GetRunID() != fRunId) {
+            EDepSimError("Restarted run " << aRun->GetRunID()
+                         << " does not match the checkpoint run "
+                         << fRunId);
+        }
+        return;
+    }
+
+    int first = 0;
+    const EDepSim::UserPrimaryGeneratorAction* action
+        = dynamic_cast<const EDepSim::UserPrimaryGeneratorAction*>(
+            G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+    if (action) first = action->GetFirstEvent();
+    fRunId = aRun->GetRunID();
+    fEndEvent = first + aRun->GetNumberOfEventToBeProcessed();
+}
+
+void EDepSim::CheckpointManager::EndOfEvent(const G4Event* anEvent) {
+    if (!fRestarted) return;
+    if (anEvent->GetEventID() + 1 < fEndEvent) return;
+    EDepSimLog("Restarted run reached the last event " << fEndEvent - 1);
+    G4RunManager::GetRunManager()->AbortRun(true);
+}
+
+bool EDepSim::CheckpointManager::IsCheckpointEvent(long long entries) const {
+    if (fPeriod < 1 || fSidecar.empty()) return false;
+    return entries > 0 && (entries % fPeriod) == 0;
+}
+
+void EDepSim::CheckpointManager::WriteCheckpoint(const G4Event* anEvent,
+                                                 long long entries) {
+    fNextEvent = anEvent->GetEventID() + 1;
+
+    std::string tmpName = fSidecar + ".tmp";
+    std::ofstream output(tmpName.c_str());
+    if (!output.is_open()) {
+        EDepSimError("Cannot write checkpoint: " << tmpName);
+        return;
+    }
+
+    output << "EDepSimCheckpoint 1" << std::endl;
+    output << "run " << fRunId << std::endl;
+    output << "next " << fNextEvent << std::endl;
+    output << "end " << fEndEvent << std::endl;
+    output << "entries " << entries << std::endl;
+
+    // Each generator state is written on one line.
+    const EDepSim::UserPrimaryGeneratorAction* action
+        = dynamic_cast<const EDepSim::UserPrimaryGeneratorAction*>(
+            G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+    int count = action ? action->GetGeneratorCount() : 0;
+    output << "generators " << count << std::endl;
+    for (int i = 0; i < count; ++i) {
+        const EDepSim::PrimaryGenerator* generator
+            = dynamic_cast<const EDepSim::PrimaryGenerator*>(
+                action->GetGenerator(i));
+        if (generator && generator->GetKinematicsGenerator()) {
+            generator->GetKinematicsGenerator()->SaveState(output);
+        }
+        output << std::endl;
+    }
+
+    // The engine state is last since it takes several lines.
+    output << "random" << std::endl;
+    G4Random::saveFullState(output);
+    output.close();
+}
+
+void EDepSim::CheckpointManager::CommitCheckpoint() {
+    std::string tmpName = fSidecar + ".tmp";
+    if (std::rename(tmpName.c_str(), fSidecar.c_str()) != 0) {
+        EDepSimError("Cannot move checkpoint into place: " << fSidecar);
+        return;
+    }
+    EDepSimLog("Checkpoint before event " << fNextEvent
+               << " saved to " << fSidecar);
+}
+
+void EDepSim::CheckpointManager::Finish() {
+    if (fSidecar.empty()) return;
+    std::remove(fSidecar.c_str());
+    std::remove((fSidecar + ".tmp").c_str());
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_CheckpointManager_hh_seen
+#define EDepSim_CheckpointManager_hh_seen
+
+#include <string>
+#include <vector>
+
+class G4Event;
+class G4Run;
+class G4VPrimaryGenerator;
+
+namespace EDepSim {class CheckpointManager;}
+/// Save checkpoints so that a job which is stopped part way through a run
+/// can be restarted.  A checkpoint is taken after every N events are stored
+/// (see /edep/db/checkpoint).  The output file is flushed so that it is
+/// valid, and a sidecar file (the output file name with ".checkpoint"
+/// added) records the run, the next event, the state of the kinematics
+/// generators (e.g. the rooTracker entries that are left, or the HEPEVT
+/// file offset), and the random engine state.  The pass-through trees are
+/// saved in the output file.
+///
+/// When the job is restarted (see /edep/db/restart, or the edep-sim -R
+/// option) using the same command line, the output file is opened for
+/// update and the trees continue from the checkpoint.  The generators and
+/// random engine are restored before the first event, the event numbers
+/// continue from the checkpoint, and the run is stopped at the last event
+/// of the original run.  A restart applies to a job with one run (i.e. one
+/// /run/beamOn).
+class EDepSim::CheckpointManager {
+public:
+    /// Get the manager.
+    static EDepSim::CheckpointManager* Get() {
+        if (!fThis) fThis = new EDepSim::CheckpointManager();
+        return fThis;
+    }
+
+    virtual ~CheckpointManager() {}
+
+    /// Set the number of events between checkpoints (zero turns off the
+    /// checkpoints).
+    void SetPeriod(int events) {fPeriod = events;}
+
+    /// Get the number of events between checkpoints.
+    int GetPeriod() const {return fPeriod;}
+
+    /// Set if the job should be restarted from the last checkpoint.  This
+    /// must be set before the output file is opened.
+    void SetRestart(bool restart) {fRestart = restart;}
+
+    /// Check if the job should be restarted from the last checkpoint.
+    bool GetRestart() const {return fRestart;}
+
+    /// Set the name of the output file.  The sidecar is named after it.
+    void SetOutputFilename(const std::string& name);
+
+    /// Read the checkpoint that matches the number of events in the output
+    /// file.  This returns false if there isn't a matching checkpoint, in
+    /// which case the job cannot be restarted.
+    bool ReadCheckpoint(long long entries);
+
+    /// Check if the generators still need to be restored from the
+    /// checkpoint.
+    bool IsRestoring() const {return fRestoring;}
+
+    /// Get the event number of the first event after the checkpoint.
+    int GetNextEvent() const {return fNextEvent;}
+
+    /// Restore the kinematics generators and the random engine.  This is
+    /// called by EDepSim::UserPrimaryGeneratorAction before the first event
+    /// after a restart.
+    void Restore(const std::vector<G4VPrimaryGenerator*>& generators);
+
+    /// Record the run and the last event at the beginning of a run.
+    void BeginOfRun(const G4Run* aRun);
+
+    /// Stop a restarted run at the last event of the original run.
+    void EndOfEvent(const G4Event* anEvent);
+
+    /// Check if a checkpoint should be taken after an event.  The entries
+    /// is the number of events in the output file.
+    bool IsCheckpointEvent(long long entries) const;
+
+    /// Write the sidecar for a checkpoint into a temporary file.  The
+    /// entries is the number of events in the output file.  This is called
+    /// before the output file is flushed.
+    void WriteCheckpoint(const G4Event* anEvent, long long entries);
+
+    /// Move the temporary sidecar into place after the output file has been
+    /// flushed.
+    void CommitCheckpoint();
+
+    /// Remove the sidecar after the output file has been closed normally.
+    void Finish();
+
+private:
+    CheckpointManager()
+        : fPeriod(0), fRestart(false), fRestoring(false),
+          fRestarted(false), fRunId(0), fNextEvent(0), fEndEvent(0) {}
+
+    /// Read a sidecar file.  This returns false if the file can't be read,
+    /// or doesn't match the number of events in the output file.
+    bool ReadSidecar(const std::string& name, long long entries);
+
+    /// The pointer to the manager.
+    static EDepSim::CheckpointManager* fThis;
+
+    /// The number of events between checkpoints.
+    int fPeriod;
+
+    /// True if the job should be restarted from the last checkpoint.
+    bool fRestart;
+
+    /// True if the generators need to be restored.
+    bool fRestoring;
+
+    /// True if the job was restarted from a checkpoint.
+    bool fRestarted;
+
+    /// The name of the sidecar file.
+    std::string fSidecar;
+
+    /// The run being checkpointed.
+    int fRunId;
+
+    /// The event number of the next event to generate.
+    int fNextEvent;
+
+    /// The event number after the last event in the run.
+    int fEndEvent;
+
+    /// The saved state of each kinematics generator.
+    std::vector<std::string> fGeneratorStates;
+
+    /// The saved random engine state.
+    std::string fRandomState;
+};
+#endif
@@ -4,10 +4,13 @@
 #include "EDepSimUserDetectorConstruction.hh"
 #include "EDepSimDetectorMessenger.hh"
 #include "EDepSimRootGeometryManager.hh"
+#include "EDepSimRegionManager.hh"
 #include "EDepSimException.hh"
 #include "EDepSimSDFactory.hh"
 #include "EDepSimSegmentSD.hh"
+#include "EDepSimSurfaceSD.hh"
 #include "EDepSimGetExternalActionConstructor.hh"
+#include "EDepSimVRootSolidConverter.hh"
 #include "EDepSimUserRunAction.hh"
 #include "EDepSimUserEventAction.hh"
 #include "EDepSimUserTrackingAction.hh"
@@ -56,6 +59,25 @@ EDepSim::DetectorMessenger::DetectorMessenger(EDepSim::UserDetectorConstruction*
         "Check the geometry for overlaps (set before update).");
     fValidateCmd->AvailableForStates(G4State_PreInit);
 
+    fValidateThreadsCmd
+        = new G4UIcmdWithAnInteger("/edep/validateThreads",this);
+    fValidateThreadsCmd->SetGuidance(
+        "Set the number of threads used to check the geometry for overlaps\n"
+        "(set before update).  When this is more than one, the volumes are\n"
+        "divided between the threads and the overlaps are reported in the\n"
+        "geometry order.");
+    fValidateThreadsCmd->SetParameterName("threads", false);
+    fValidateThreadsCmd->SetRange("threads >= 0");
+    fValidateThreadsCmd->AvailableForStates(G4State_PreInit);
+
+    fGeometryCacheCmd = new G4UIcmdWithAString("/edep/geometryCache",this);
+    fGeometryCacheCmd->SetGuidance(
+        "Set a directory to cache the converted ROOT geometry (set before\n"
+        "update).  The cache is keyed by a hash of the geometry, so it is\n"
+        "only used when the geometry has not changed.");
+    fGeometryCacheCmd->SetParameterName("directory", false);
+    fGeometryCacheCmd->AvailableForStates(G4State_PreInit);
+
     fExportCmd = new G4UIcmdWithAString("/edep/export",this);
     fExportCmd->SetGuidance(
         "Export the geometry to a file.  This is not compatible with event\n"
@@ -132,6 +154,38 @@ EDepSim::DetectorMessenger::DetectorMessenger(EDepSim::UserDetectorConstruction*
     par = new G4UIparameter("Unit", 's', false);
     fHitLengthCmd->SetParameter(par);
 
+    fPhotonBinningCmd = new G4UIcommand("/edep/photonBinning",this);
+    fPhotonBinningCmd->SetGuidance(
+        "Accumulate the photons for a surface detector into time bins.");
+    fPhotonBinningCmd->SetGuidance(
+        "A width of zero makes a hit for each photon (the default).");
+    fPhotonBinningCmd->AvailableForStates(G4State_PreInit);
+
+    // The name of the sensitive detector.
+    par = new G4UIparameter("Sensitive", 's', false);
+    fPhotonBinningCmd->SetParameter(par);
+
+    // The width of the time bins.
+    par = new G4UIparameter("Width", 'd', false);
+    fPhotonBinningCmd->SetParameter(par);
+
+    // The unit for the width.
+    par = new G4UIparameter("Unit", 's', false);
+    fPhotonBinningCmd->SetParameter(par);
+
+    fPhotonSampleCmd = new G4UIcommand("/edep/photonSample",this);
+    fPhotonSampleCmd->SetGuidance(
+        "Keep a sample of the individual photons in each time bin.");
+    fPhotonSampleCmd->AvailableForStates(G4State_PreInit);
+
+    // The name of the sensitive detector.
+    par = new G4UIparameter("Sensitive", 's', false);
+    fPhotonSampleCmd->SetParameter(par);
+
+    // The number of photons kept in each bin.
+    par = new G4UIparameter("Photons", 'i', false);
+    fPhotonSampleCmd->SetParameter(par);
+
     fHitExcludedCmd = new G4UIcommand("/edep/hitExcluded",this);
     fHitExcludedCmd->SetGuidance(
         "Exclude logical volumes from being sensitive.");
@@ -150,6 +204,103 @@ EDepSim::DetectorMessenger::DetectorMessenger(EDepSim::UserDetectorConstruction*
     fGDMLReadCmd->SetGuidance("Set a GDML file to be used for the geometry.");
     fGDMLReadCmd->AvailableForStates(G4State_PreInit);
 
+    /////////////////////////////////////////////////////////////
+    // Add commands for the /edep/field/ sub-directory
+    fFieldDir = new G4UIdirectory("/edep/field/");
+    fFieldDir->SetGuidance("Control the propagation in the GDML fields.");
+
+    fFieldAccuracyCmd = new G4UIcommand("/edep/field/accuracy",this);
+    fFieldAccuracyCmd->SetGuidance(
+        "Set the accuracy of the propagation in the field of a logical"
+        " volume.");
+    fFieldAccuracyCmd->SetGuidance(
+        "The volume \"all\" sets the default for every volume.  A value"
+        " for a volume overrides the GDML auxiliary value.");
+    fFieldAccuracyCmd->AvailableForStates(G4State_PreInit);
+
+    // The name of the logical volume.
+    par = new G4UIparameter("LogicalVolume", 's', false);
+    fFieldAccuracyCmd->SetParameter(par);
+
+    // The accuracy parameter to set.
+    par = new G4UIparameter("Parameter", 's', false);
+    par->SetParameterCandidates(
+        "deltaChord deltaOneStep deltaIntersection epsilonMin epsilonMax");
+    fFieldAccuracyCmd->SetParameter(par);
+
+    // The value of the parameter.
+    par = new G4UIparameter("Value", 'd', false);
+    fFieldAccuracyCmd->SetParameter(par);
+
+    // The unit for the length parameters.
+    par = new G4UIparameter("Unit", 's', true);
+    par->SetDefaultValue("mm");
+    fFieldAccuracyCmd->SetParameter(par);
+
+    /////////////////////////////////////////////////////////////
+    // Add commands for the /edep/region/ sub-directory
+    //
+    // These define regions with their own production cuts and user limits.
+    fRegionDir = new G4UIdirectory("/edep/region/");
+    fRegionDir->SetGuidance(
+        "Define regions with their own production cuts and user limits.");
+
+    fRegionVolumeCmd = new G4UIcommand("/edep/region/volume",this);
+    fRegionVolumeCmd->SetGuidance(
+        "Add a logical volume, and its daughters, to a region.  The region"
+        " is created if it doesn't exist.");
+    fRegionVolumeCmd->AvailableForStates(G4State_PreInit);
+
+    par = new G4UIparameter("Region", 's', false);
+    fRegionVolumeCmd->SetParameter(par);
+
+    par = new G4UIparameter("LogicalVolume", 's', false);
+    fRegionVolumeCmd->SetParameter(par);
+
+    fRegionCutCmd = new G4UIcommand("/edep/region/cut",this);
+    fRegionCutCmd->SetGuidance(
+        "Set the production cut for a particle in a region.  The particle"
+        " \"em\" sets the gamma, electron and positron cuts.");
+    fRegionCutCmd->AvailableForStates(G4State_PreInit);
+
+    par = new G4UIparameter("Region", 's', false);
+    fRegionCutCmd->SetParameter(par);
+
+    par = new G4UIparameter("Particle", 's', false);
+    par->SetParameterCandidates("em gamma e- e+ proton");
+    fRegionCutCmd->SetParameter(par);
+
+    par = new G4UIparameter("Cut", 'd', false);
+    fRegionCutCmd->SetParameter(par);
+
+    par = new G4UIparameter("Unit", 's', true);
+    par->SetDefaultValue("mm");
+    fRegionCutCmd->SetParameter(par);
+
+    fRegionLimitCmd = new G4UIcommand("/edep/region/limit",this);
+    fRegionLimitCmd->SetGuidance(
+        "Set a user limit for the volumes in a region.  Tracks are killed"
+        " when they pass the maximum track length or time, or drop below"
+        " the minimum kinetic energy or range.");
+    fRegionLimitCmd->AvailableForStates(G4State_PreInit);
+
+    par = new G4UIparameter("Region", 's', false);
+    fRegionLimitCmd->SetParameter(par);
+
+    par = new G4UIparameter("Limit", 's', false);
+    par->SetParameterCandidates(
+        "maxStep maxTrackLength maxTime minKineticEnergy minRange");
+    fRegionLimitCmd->SetParameter(par);
+
+    par = new G4UIparameter("Value", 'd', false);
+    fRegionLimitCmd->SetParameter(par);
+
+    par = new G4UIparameter("Unit", 's', false);
+    fRegionLimitCmd->SetParameter(par);
+
+    fRegionListCmd = new G4UIcmdWithoutParameter("/edep/region/list",this);
+    fRegionListCmd->SetGuidance("List the region definitions.");
+
     /////////////////////////////////////////////////////////////
     // Add commands for the /edep/material/ sub-directory
     //
@@ -313,6 +464,34 @@ EDepSim::DetectorMessenger::DetectorMessenger(EDepSim::UserDetectorConstruction*
     fLoadStepActionCMD->GetParameter(2)->SetDefaultValue("unspecified");
     fLoadStepActionCMD->GetParameter(2)->SetGuidance("A user defined value.");
 
+    fLoadSolidConverterCMD
+        = new G4UIcommand("/edep/actions/loadSolidConverter",this);
+    fLoadSolidConverterCMD->SetGuidance(
+        "Load function to construct a converter from a G4 solid to a");
+    fLoadSolidConverterCMD->SetGuidance(
+        "  ROOT shape.  This must be used before /edep/update.");
+    fLoadSolidConverterCMD->SetGuidance("");
+    fLoadSolidConverterCMD->SetGuidance(
+        "  ENVIRONMENT VARIABLE SUBSTITUTION: Environment variables in the");
+    fLoadSolidConverterCMD->SetGuidance(
+        "  path will be expanded, but to work around the G4 macro language");
+    fLoadSolidConverterCMD->SetGuidance(
+        "  they must have the syntax $ENV_VAR or $(ENV_VAR) and not use the");
+    fLoadSolidConverterCMD->SetGuidance(
+        "  more standard ${ENV_VAR} syntax.");
+
+    fLoadSolidConverterCMD->SetParameter(new G4UIparameter("path",'s',false));
+    fLoadSolidConverterCMD->GetParameter(0)->SetGuidance("The library path");
+    fLoadSolidConverterCMD->SetParameter(new G4UIparameter("symbol",'s',true));
+    fLoadSolidConverterCMD->GetParameter(1)
+        ->SetDefaultValue("CreateSolidConverter");
+    fLoadSolidConverterCMD->GetParameter(1)->SetGuidance("Symbol with signature"
+                      " EDepSim::VRootSolidConverter* (*)(char* option)");
+    fLoadSolidConverterCMD->SetParameter(new G4UIparameter("option",'s',true));
+    fLoadSolidConverterCMD->GetParameter(2)->SetDefaultValue("unspecified");
+    fLoadSolidConverterCMD->GetParameter(2)
+        ->SetGuidance("A user defined value.");
+
 }
 
 
@@ -321,14 +500,25 @@ EDepSim::DetectorMessenger::~DetectorMessenger()
     delete fUpdateCmd;
     delete fPrintMassCmd;
     delete fValidateCmd;
+    delete fValidateThreadsCmd;
+    delete fGeometryCacheCmd;
     delete fExportCmd;
     delete fControlCmd;
     delete fHitSagittaCmd;
     delete fHitSeparationCmd;
     delete fHitLengthCmd;
+    delete fPhotonBinningCmd;
+    delete fPhotonSampleCmd;
     delete fHitExcludedCmd;
     delete fGDMLReadCmd;
     delete fGDMLDir;
+    delete fFieldAccuracyCmd;
+    delete fFieldDir;
+    delete fRegionVolumeCmd;
+    delete fRegionCutCmd;
+    delete fRegionLimitCmd;
+    delete fRegionListCmd;
+    delete fRegionDir;
     delete fMaterialBirksCmd;
     delete fMaterialDir;
     delete fEDepSimDir;
@@ -339,6 +529,7 @@ EDepSim::DetectorMessenger::~DetectorMessenger()
     delete fLoadEventActionCMD;
     delete fLoadTrackActionCMD;
     delete fLoadStepActionCMD;
+    delete fLoadSolidConverterCMD;
 
 }
 
@@ -355,6 +546,16 @@ void EDepSim::DetectorMessenger::SetNewValue(G4UIcommand * cmd,
         EDepSimLog("Geometry will be validated");
         fConstruction->ValidateGeometry();
     }
+    else if (cmd == fValidateThreadsCmd) {
+        int threads = fValidateThreadsCmd->GetNewIntValue(newValue);
+        EDepSimLog("Geometry will be validated with " << threads
+                   << " threads");
+        EDepSim::RootGeometryManager::Get()->SetValidateThreads(threads);
+    }
+    else if (cmd == fGeometryCacheCmd) {
+        EDepSimLog("Geometry will be cached in " << newValue);
+        EDepSim::RootGeometryManager::Get()->SetCacheDirectory(newValue);
+    }
     else if (cmd == fExportCmd) {
         EDepSim::RootGeometryManager::Get()->Export(newValue);
     }
@@ -442,12 +643,100 @@ void EDepSim::DetectorMessenger::SetNewValue(G4UIcommand * cmd,
             std::cout << "Invalid sensitive detector" << std::endl;
         }
     }
+    else if (cmd == fPhotonBinningCmd) {
+        std::istringstream input((const char*)newValue);
+        std::string sdName;
+        double width;
+        std::string unitName;
+        input >> sdName >> width >> unitName;
+        width *= G4UnitDefinition::GetValueOf(unitName);
+        SDFactory factory("surface");
+        SurfaceSD* sd = dynamic_cast<SurfaceSD*>(factory.MakeSD(sdName));
+        if (sd) {
+            sd->SetPhotonBinWidth(width);
+        }
+        else {
+            std::cout << "Invalid sensitive detector" << std::endl;
+        }
+    }
+    else if (cmd == fPhotonSampleCmd) {
+        std::istringstream input((const char*)newValue);
+        std::string sdName;
+        int photons;
+        input >> sdName >> photons;
+        SDFactory factory("surface");
+        SurfaceSD* sd = dynamic_cast<SurfaceSD*>(factory.MakeSD(sdName));
+        if (sd) {
+            sd->SetPhotonSampleSize(photons);
+        }
+        else {
+            std::cout << "Invalid sensitive detector" << std::endl;
+        }
+    }
     else if (cmd == fHitExcludedCmd) {
         std::istringstream input((const char*)newValue);
         std::string logName;
         input >> logName;
         fConstruction->AddExcludedSensitiveDetector(logName);
     }
+    else if (cmd == fFieldAccuracyCmd) {
+        std::istringstream input((const char*)newValue);
+        std::string volume;
+        std::string parameter;
+        double value = 0.0;
+        std::string unitName = "mm";
+        input >> volume >> parameter >> value >> unitName;
+        EDepSim::EMFieldSetup::Accuracy& accuracy
+            = fConstruction->GetFieldAccuracy(volume);
+        if (parameter == "deltaChord") {
+            accuracy.fDeltaChord
+                = value*G4UnitDefinition::GetValueOf(unitName);
+        }
+        else if (parameter == "deltaOneStep") {
+            accuracy.fDeltaOneStep
+                = value*G4UnitDefinition::GetValueOf(unitName);
+        }
+        else if (parameter == "deltaIntersection") {
+            accuracy.fDeltaIntersection
+                = value*G4UnitDefinition::GetValueOf(unitName);
+        }
+        else if (parameter == "epsilonMin") {
+            accuracy.fEpsilonMin = value;
+        }
+        else if (parameter == "epsilonMax") {
+            accuracy.fEpsilonMax = value;
+        }
+    }
+    else if (cmd == fRegionVolumeCmd) {
+        std::istringstream input((const char*)newValue);
+        std::string region;
+        std::string volume;
+        input >> region >> volume;
+        EDepSim::RegionManager::Get()->AddVolume(region, volume);
+    }
+    else if (cmd == fRegionCutCmd) {
+        std::istringstream input((const char*)newValue);
+        std::string region;
+        std::string particle;
+        double value = 0.0;
+        std::string unitName = "mm";
+        input >> region >> particle >> value >> unitName;
+        EDepSim::RegionManager::Get()->SetCut(
+            region, particle, value*G4UnitDefinition::GetValueOf(unitName));
+    }
+    else if (cmd == fRegionLimitCmd) {
+        std::istringstream input((const char*)newValue);
+        std::string region;
+        std::string limit;
+        double value = 0.0;
+        std::string unitName;
+        input >> region >> limit >> value >> unitName;
+        EDepSim::RegionManager::Get()->SetLimit(
+            region, limit, value*G4UnitDefinition::GetValueOf(unitName));
+    }
+    else if (cmd == fRegionListCmd) {
+        EDepSim::RegionManager::Get()->ListRegions();
+    }
     else if (cmd == fMaterialBirksCmd) {
         std::istringstream input((const char*)newValue);
         std::string matName;
@@ -582,6 +871,25 @@ void EDepSim::DetectorMessenger::SetNewValue(G4UIcommand * cmd,
             EDepSimThrow("External G4UserStepAction not found");
         }
     }
+    else if (cmd == fLoadSolidConverterCMD) {
+        std::string library;
+        std::string symbol;
+        std::string option;
+        std::istringstream is(newValue);
+        is >> library >> symbol >> option ;
+        EDepSim::VRootSolidConverter* converter
+            = CallExternalConstructor<EDepSim::VRootSolidConverter>(
+                library,symbol,option);
+        if (converter != nullptr) {
+            EDepSimLog("Load solid converter for "
+                       << converter->GetEntityType());
+            converter->SetExternalSource(library,symbol,option);
+            EDepSim::RootGeometryManager::Get()->AddSolidConverter(converter);
+        }
+        else {
+            EDepSimThrow("External VRootSolidConverter not found");
+        }
+    }
     else {
         EDepSimThrow("Missing detector messenger command handler");
     }
@@ -29,16 +29,29 @@ private:
     G4UIcmdWithoutParameter*   fUpdateCmd;
     G4UIcmdWithAString*        fPrintMassCmd;
     G4UIcmdWithoutParameter*   fValidateCmd;
+    G4UIcmdWithAnInteger*      fValidateThreadsCmd;
+    G4UIcmdWithAString*        fGeometryCacheCmd;
     G4UIcmdWithAString*        fExportCmd;
     G4UIcommand*               fControlCmd;
     G4UIcommand*               fHitSagittaCmd;
     G4UIcommand*               fHitSeparationCmd;
     G4UIcommand*               fHitLengthCmd;
+    G4UIcommand*               fPhotonBinningCmd;
+    G4UIcommand*               fPhotonSampleCmd;
     G4UIcommand*               fHitExcludedCmd;
 
     G4UIdirectory*             fGDMLDir;
     G4UIcmdWithAString*        fGDMLReadCmd;
 
+    G4UIdirectory*             fFieldDir;
+    G4UIcommand*               fFieldAccuracyCmd;
+
+    G4UIdirectory*             fRegionDir;
+    G4UIcommand*               fRegionVolumeCmd;
+    G4UIcommand*               fRegionCutCmd;
+    G4UIcommand*               fRegionLimitCmd;
+    G4UIcmdWithoutParameter*   fRegionListCmd;
+
     G4UIdirectory*             fMaterialDir;
     G4UIcommand*               fMaterialBirksCmd;
 
@@ -48,6 +61,7 @@ private:
     G4UIcommand*               fLoadEventActionCMD;
     G4UIcommand*               fLoadTrackActionCMD;
     G4UIcommand*               fLoadStepActionCMD;
+    G4UIcommand*               fLoadSolidConverterCMD;
 
 };
 
@@ -1,4 +1,6 @@
 #include "EDepSimDokeBirksSaturation.hh"
+#include "EDepSimArbEMField.hh"
+#include "EDepSimUniformField.hh"
 #include "EDepSimLog.hh"
 
 #include <G4EmSaturation.hh>
@@ -9,11 +11,30 @@
 #include <G4EventManager.hh>
 #include <G4TrackingManager.hh>
 #include <G4Track.hh>
+#include <G4Step.hh>
 #include <G4FieldManager.hh>
 #include <G4Field.hh>
+#include <G4Gamma.hh>
+#include <G4Electron.hh>
+#include <G4Positron.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // The number of octaves covered by the electron LET table.
+    const int kLETOctaves = 20;
+
+    // The largest number of bins per octave in the electron LET table.
+    const int kLETMaxSubBins = 4096;
+}
 
 EDepSim::DokeBirksSaturation::DokeBirksSaturation(G4int verb)
-    : G4EmSaturation(verb) {}
+    : G4EmSaturation(verb), fLETSubBins(0), fLETTolerance(0.0),
+      fLastVolume(NULL), fLastField(NULL),
+      fLastElectricField(-1.0), fLastDokeBirksA(0.0) {
+    SetLETTolerance(1E-4);
+}
 
 EDepSim::DokeBirksSaturation::~DokeBirksSaturation() {}
 
@@ -22,6 +43,17 @@ EDepSim::DokeBirksSaturation::~DokeBirksSaturation() {}
 // all of the bugs are mine, so there should be a note like "Simplified
 // implementation of the physics described in NEST paper".
 G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
+    const G4ParticleDefinition *particle,
+    const G4MaterialCutsCouple *couple,
+    G4double length,
+    G4double totalEDep,
+    G4double nonIonEDep) const {
+    return VisibleEnergyDeposition(NULL,particle,couple,
+                                   length,totalEDep,nonIonEDep);
+}
+
+G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
+    const G4Step* aStep,
     const G4ParticleDefinition *particle,
     const G4MaterialCutsCouple *couple,
     G4double length,
@@ -36,54 +68,16 @@ G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
     }
 
     const G4Material* aMaterial = couple->GetMaterial();
-
-    // Assume that this is argon.
-    bool inLiquidArgon = true;
-
-    // Check that we are in liquid.
-    if (aMaterial->GetState() != kStateLiquid) {
-        if (aMaterial->GetState() == kStateUndefined) {
-            static int throttle = 5;
-            if (throttle > 0) {
-                EDepSimError("Undefined material state for "
-                             << aMaterial->GetName());
-            }
-        }
-        inLiquidArgon = false;
-    }
-
-    // Find the dominant element.  It should be argon.
-    double dominantZ = -1;
-    double dominantFrac = 0.0;
-    for (std::size_t ele = 0; ele < aMaterial->GetNumberOfElements(); ++ele) {
-        double frac = aMaterial->GetFractionVector()[ele];
-        if (frac > dominantFrac) {
-            dominantFrac = frac;
-            dominantZ = aMaterial->GetElement(ele)->GetZ();
-        }
-    }
-
-    // If the dominant fraction is small its not LAr.  Hard coded to allow 10
-    // PPM contamination.  More than that, there won't be drift anyway, and
-    // it's OK to fall back to something simpler.
-    if (dominantFrac < (1.0 - 1E-5)) {
-        inLiquidArgon = false;
-    }
-
-    // Check that the element is argon.
-    if (std::abs(dominantZ-18.0) > 0.5) {
-        inLiquidArgon = false;
-    }
+    const MaterialInfo& materialInfo = GetMaterialInfo(aMaterial);
 
     // It's not LAr so pass off to the standard handler.
-    if (!inLiquidArgon) {
+    if (!materialInfo.fLiquidArgon) {
         return G4EmSaturation::VisibleEnergyDeposition(
             particle,couple,length,totalEDep,nonIonEDep);
     }
 
     EDepSimTrace("In LAr");
 
-    G4String particleName = particle->GetParticleName();
     // G4StepPoint* pPreStepPoint  = aStep.GetPreStepPoint();
     G4double totalEnergyDeposit = totalEDep - nonIonEDep;
 
@@ -106,56 +100,41 @@ G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
 
     // To go forward we need a little more information: The electric field,
     // and the step number to check if this is a "stopped" electron.
-    G4Track* aTrack = G4EventManager::GetEventManager()
-        ->GetTrackingManager()->GetTrack();
-
-    const G4Step* aStep = aTrack->GetStep();
+    if (!aStep) {
+        aStep = G4EventManager::GetEventManager()
+            ->GetTrackingManager()->GetTrack()->GetStep();
+    }
+    const G4Track* aTrack = aStep->GetTrack();
 
     // Figure out the electric field for the volume.
     double electricField = 0.0;
+    double dokeBirksA = 0.0;
     do {
-        static int throttle = 5;
         G4StepPoint* pPostStepPoint = aStep->GetPostStepPoint();
         const G4VPhysicalVolume* aVolume = pPostStepPoint->GetPhysicalVolume();
-        const G4LogicalVolume* aLogVolume = aVolume->GetLogicalVolume();
-        const G4FieldManager* aFieldManager = aLogVolume->GetFieldManager();
-        if (!aFieldManager) {
-            if (throttle > 0) {
-                EDepSimError("No field manager for " << aLogVolume->GetName());
-                --throttle;
-            }
-            break;
-        }
-        if (!aFieldManager->DoesFieldExist()) {
-            if (throttle > 0) {
-                EDepSimError("Field does not exist for "
-                             << aLogVolume->GetName());
-                --throttle;
-            }
-            break;
+        const FieldInfo& fieldInfo
+            = GetFieldInfo(aVolume->GetLogicalVolume());
+        if (!fieldInfo.fField) break;
+
+        if (fieldInfo.fUniform) {
+            electricField = fieldInfo.fElectricField;
+            dokeBirksA = fieldInfo.fDokeBirksA;
         }
-        const G4Field* aField = aFieldManager->GetDetectorField();
-        if (!aField) {
-            if (throttle > 0) {
-                EDepSimError("No field object for "
-                             << aLogVolume->GetName());
-                --throttle;
-            }
-            break;
+        else {
+            G4ThreeVector thePosition = pPostStepPoint->GetPosition();
+            double theTime = pPostStepPoint->GetGlobalTime();
+            double point[4] = {
+                thePosition.x(), thePosition.y(), thePosition.z(), theTime};
+            double bField[6];
+            fieldInfo.fField->GetFieldValue(point,bField);
+
+            electricField = bField[3]*bField[3];
+            electricField += bField[4]*bField[4];
+            electricField += bField[5]*bField[5];
+            electricField = std::sqrt(electricField);
+            dokeBirksA = DokeBirksA(electricField);
         }
 
-        G4ThreeVector thePosition = pPostStepPoint->GetPosition();
-        double theTime = pPostStepPoint->GetGlobalTime();
-        double point[4] = {
-            thePosition.x(), thePosition.y(), thePosition.z(), theTime};
-        double bField[6];
-        aField->GetFieldValue(point,bField);
-
-        electricField = bField[3]*bField[3];
-        electricField += bField[4]*bField[4];
-        electricField += bField[5]*bField[5];
-        electricField = std::sqrt(electricField);
-
         if (not std::isfinite(electricField)) {
             EDepSimError("Electric field must be valid");
             throw std::runtime_error("Electric field must be valid.");
@@ -168,6 +147,10 @@ G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
 
     } while (false);
 
+    // Without a field, the constant matches the value calculated directly
+    // for a zero field.
+    if (electricField <= 0) dokeBirksA = DokeBirksA(electricField);
+
     EDepSimTrace("Electric field " << electricField/(kilovolt/cm)
                  << " kV/cm");
 
@@ -176,19 +159,19 @@ G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
     // for ARGON only.  The Doke-Birks constants are in kilovolt/cm
     G4double dokeBirks[3];
 
-    dokeBirks[0] = 0.07*pow((electricField/(kilovolt/cm)),-0.85);
+    dokeBirks[0] = dokeBirksA;
     dokeBirks[2] = 0.00;
     dokeBirks[1] = dokeBirks[0]/(1-dokeBirks[2]); //B=A/(1-C) (see paper)
 
     G4double dE = totalEDep/MeV;
     G4double dx = length/cm;
-    G4double density = aMaterial->GetDensity()/(g/cm3);
+    G4double density = materialInfo.fDensity;
     G4double LET = 0.0; //lin. energy transfer (prop. to dE/dx)
     if (dx != 0.0) LET = (dE/dx)*(1/density);
 
     // There was some dEdX for a photon.  This means that the very low energy
     // electrons were not simulated.
-    if (particleName == "gamma") {
+    if (particle == G4Gamma::Definition()) {
         LET = CalculateElectronLET( 1000*dE );
         dx = dE/density/LET;
     }
@@ -208,7 +191,11 @@ G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
     // Special case for electrons that G4 may stop when they get very short
     // and truncate the energy deposition.
     do {
-        if (particleName != "e+" || particleName != "e-") break;
+        // PHYSICS CHECK: This condition is always true, so the correction
+        // is never applied.  It is kept this way so the visible energy
+        // doesn't change, but it probably should be "&&".
+        if (particle != G4Positron::Definition()
+            || particle != G4Electron::Definition()) break;
         if (aTrack->GetCurrentStepNumber() != 1) break;
         double ratio = CalculateElectronLET( 1000.0*dE ) / LET;
         if (ratio > 0.7) break;
@@ -251,6 +238,25 @@ G4double EDepSim::DokeBirksSaturation::VisibleEnergyDeposition(
 // before the call.  A quick look at NEST suggests the energy should be in
 // KeV, but either my code or my comment is wrong.
 G4double EDepSim::DokeBirksSaturation::CalculateElectronLET ( G4double E) const {
+    // Look up the LET in the table.  The binary exponent and mantissa of the
+    // energy choose the octave, and the bin in the octave.
+    if (fLETSubBins > 0 && E >= 1) {
+        int exponent;
+        double mantissa = std::frexp(E, &exponent);
+        int octave = exponent - 1;
+        if (octave < kLETOctaves) {
+            double position = (2.0*mantissa - 1.0)*fLETSubBins;
+            int bin = position;
+            int node = octave*fLETSubBins + bin;
+            double frac = position - bin;
+            return fLETTable[node]
+                + frac*(fLETTable[node+1] - fLETTable[node]);
+        }
+    }
+    return AnalyticElectronLET(E);
+}
+
+G4double EDepSim::DokeBirksSaturation::AnalyticElectronLET ( G4double E) const {
     G4double LET;
     if ( E >= 1 ) LET = 116.70-162.97*log10(E)+99.361*pow(log10(E),2)-
                       33.405*pow(log10(E),3)+6.5069*pow(log10(E),4)-
@@ -259,3 +265,217 @@ G4double EDepSim::DokeBirksSaturation::CalculateElectronLET ( G4double E) const
     else LET = 0;
     return LET;
 }
+
+const EDepSim::DokeBirksSaturation::MaterialInfo&
+EDepSim::DokeBirksSaturation::GetMaterialInfo(
+    const G4Material* aMaterial) const {
+    std::size_t index = aMaterial->GetIndex();
+    if (index < fMaterials.size() && fMaterials[index].fFilled) {
+        return fMaterials[index];
+    }
+    if (index >= fMaterials.size()) {
+        MaterialInfo empty = {false, false, 0.0};
+        fMaterials.resize(index+1, empty);
+    }
+    MaterialInfo& info = fMaterials[index];
+
+    // Assume that this is argon.
+    bool inLiquidArgon = true;
+
+    // Check that we are in liquid.
+    if (aMaterial->GetState() != kStateLiquid) {
+        if (aMaterial->GetState() == kStateUndefined) {
+            EDepSimError("Undefined material state for "
+                         << aMaterial->GetName());
+        }
+        inLiquidArgon = false;
+    }
+
+    // Find the dominant element.  It should be argon.
+    double dominantZ = -1;
+    double dominantFrac = 0.0;
+    for (std::size_t ele = 0; ele < aMaterial->GetNumberOfElements(); ++ele) {
+        double frac = aMaterial->GetFractionVector()[ele];
+        if (frac > dominantFrac) {
+            dominantFrac = frac;
+            dominantZ = aMaterial->GetElement(ele)->GetZ();
+        }
+    }
+
+    // If the dominant fraction is small its not LAr.  Hard coded to allow 10
+    // PPM contamination.  More than that, there won't be drift anyway, and
+    // it's OK to fall back to something simpler.
+    if (dominantFrac < (1.0 - 1E-5)) {
+        inLiquidArgon = false;
+    }
+
+    // Check that the element is argon.
+    if (std::abs(dominantZ-18.0) > 0.5) {
+        inLiquidArgon = false;
+    }
+
+    info.fFilled = true;
+    info.fLiquidArgon = inLiquidArgon;
+    info.fDensity = aMaterial->GetDensity()/(g/cm3);
+
+    EDepSimDebug("DokeBirksSaturation: " << aMaterial->GetName()
+                 << (inLiquidArgon ? " is" : " is not") << " liquid argon");
+
+    return info;
+}
+
+const EDepSim::DokeBirksSaturation::FieldInfo&
+EDepSim::DokeBirksSaturation::GetFieldInfo(
+    const G4LogicalVolume* aLogVolume) const {
+    const G4FieldManager* aFieldManager = aLogVolume->GetFieldManager();
+    if (aLogVolume == fLastVolume && fLastField->fManager == aFieldManager) {
+        return *fLastField;
+    }
+
+    std::map<const G4LogicalVolume*, FieldInfo>::iterator entry
+        = fFields.find(aLogVolume);
+    if (entry != fFields.end() && entry->second.fManager == aFieldManager) {
+        fLastVolume = aLogVolume;
+        fLastField = &entry->second;
+        return entry->second;
+    }
+
+    FieldInfo& info = fFields[aLogVolume];
+    info.fManager = aFieldManager;
+    info.fField = NULL;
+    info.fUniform = false;
+    info.fElectricField = 0.0;
+    info.fDokeBirksA = 0.0;
+    fLastVolume = aLogVolume;
+    fLastField = &info;
+
+    // The errors are only reported when the volume is first seen.
+    if (!aFieldManager) {
+        EDepSimError("No field manager for " << aLogVolume->GetName());
+        return info;
+    }
+    if (!aFieldManager->DoesFieldExist()) {
+        // A volume can be explicitly set to have a zero field.
+        EDepSimLog("Field does not exist for " << aLogVolume->GetName());
+        return info;
+    }
+    const G4Field* aField = aFieldManager->GetDetectorField();
+    if (!aField) {
+        EDepSimError("No field object for " << aLogVolume->GetName());
+        return info;
+    }
+    info.fField = aField;
+
+    // Check if the electric field is uniform so it only needs to be
+    // calculated once.
+    const EDepSim::ArbEMField* arbField
+        = dynamic_cast<const EDepSim::ArbEMField*>(aField);
+    if (arbField && dynamic_cast<const EDepSim::UniformField*>(
+            arbField->GetEField())) {
+        double point[4] = {0.0, 0.0, 0.0, 0.0};
+        double bField[6];
+        aField->GetFieldValue(point,bField);
+        double electricField = bField[3]*bField[3];
+        electricField += bField[4]*bField[4];
+        electricField += bField[5]*bField[5];
+        electricField = std::sqrt(electricField);
+        info.fUniform = true;
+        info.fElectricField = electricField;
+        info.fDokeBirksA = DokeBirksA(electricField);
+    }
+
+    return info;
+}
+
+double EDepSim::DokeBirksSaturation::DokeBirksA(double electricField) const {
+    if (electricField != fLastElectricField) {
+        fLastElectricField = electricField;
+        fLastDokeBirksA = 0.07*pow((electricField/(kilovolt/cm)),-0.85);
+    }
+    return fLastDokeBirksA;
+}
+
+void EDepSim::DokeBirksSaturation::SetLETTolerance(double tolerance) {
+    fLETTolerance = tolerance;
+    BuildLETTable();
+}
+
+void EDepSim::DokeBirksSaturation::BuildLETTable() {
+    fLETTable.clear();
+    fLETSubBins = 0;
+    if (fLETTolerance <= 0.0) {
+        EDepSimLog("Electron LET is calculated (no table)");
+        return;
+    }
+
+    // Refine the table until the error at points between the nodes is
+    // within the tolerance.
+    std::vector<double> table;
+    int subBins = 4;
+    double maxError = 0.0;
+    for (; subBins <= kLETMaxSubBins; subBins *= 2) {
+        table.resize(kLETOctaves*subBins + 1);
+        for (std::size_t node = 0; node < table.size(); ++node) {
+            int octave = node / subBins;
+            int bin = node % subBins;
+            double energy = std::ldexp(1.0 + 1.0*bin/subBins, octave);
+            table[node] = AnalyticElectronLET(energy);
+        }
+        maxError = 0.0;
+        for (std::size_t node = 0; node+1 < table.size(); ++node) {
+            int octave = node / subBins;
+            int bin = node % subBins;
+            for (int i = 1; i < 8; ++i) {
+                double frac = i/8.0;
+                double energy
+                    = std::ldexp(1.0 + (bin + frac)/subBins, octave);
+                double expected = AnalyticElectronLET(energy);
+                double value = table[node]
+                    + frac*(table[node+1] - table[node]);
+                double error = std::abs(value - expected)/expected;
+                maxError = std::max(maxError, error);
+            }
+        }
+        if (maxError <= fLETTolerance) break;
+    }
+
+    if (maxError > fLETTolerance) {
+        EDepSimError("Electron LET table cannot reach tolerance "
+                     << fLETTolerance << " (error " << maxError << ")");
+        return;
+    }
+
+    fLETTable.swap(table);
+    fLETSubBins = subBins;
+
+    // Validate the lookup against the parameterization at points that are
+    // not used to build the table.
+    const int samples = 100000;
+    double maxDiff = 0.0;
+    double worstEnergy = 0.0;
+    for (int i = 0; i < samples; ++i) {
+        double energy
+            = std::exp2(kLETOctaves*(i + 0.37)/samples);
+        double expected = AnalyticElectronLET(energy);
+        double error
+            = std::abs(CalculateElectronLET(energy) - expected)/expected;
+        if (error > maxDiff) {
+            maxDiff = error;
+            worstEnergy = energy;
+        }
+    }
+    if (maxDiff > fLETTolerance) {
+        EDepSimError("Electron LET table failed validation:"
+                     << " relative error " << maxDiff
+                     << " at " << worstEnergy
+                     << " (tolerance " << fLETTolerance << ")");
+        fLETTable.clear();
+        fLETSubBins = 0;
+        return;
+    }
+
+    EDepSimLog("Electron LET table validated: "
+               << fLETTable.size() << " entries,"
+               << " relative error " << maxDiff
+               << " (tolerance " << fLETTolerance << ")");
+}
@@ -4,8 +4,16 @@
 #include <globals.hh>
 #include <G4EmSaturation.hh>
 
+#include <map>
+#include <vector>
+
 class G4ParticleDefinition;
+class G4Step;
 class G4MaterialCutsCouple;
+class G4Material;
+class G4LogicalVolume;
+class G4FieldManager;
+class G4Field;
 
 namespace EDepSim {class DokeBirksSaturation;}
 /// Implement the Doke-Birk recombination probability found in NEST in an
@@ -23,6 +31,12 @@ namespace EDepSim {class DokeBirksSaturation;}
 /// used, the NEST authors should be cited.  They did all of the physics.
 /// This is just an adaptation of their work to LAr so it's faster, but with
 /// much less capability.
+///
+/// This is called for every step with an energy deposit, so the properties
+/// of each material (whether it is LAr, and the density) are looked up once
+/// and saved in a table indexed by the material index.  The field for each
+/// logical volume is also saved, and when the electric field in a volume is
+/// uniform, the field and the Doke-Birks constant are only calculated once.
 class EDepSim::DokeBirksSaturation: public G4EmSaturation
 {
 public:
@@ -38,6 +52,27 @@ public:
                                              G4double edepTotal,
                                              G4double edepNIEL = 0.0) const;
 
+    /// Calculate the visible energy using an explicit step to find the
+    /// electric field.  The method above uses the current step from the
+    /// tracking manager (the step is NULL), and this lets the calculation
+    /// be done outside of the event loop (e.g. by edep-microbench).
+    G4double VisibleEnergyDeposition(const G4Step* aStep,
+                                     const G4ParticleDefinition*,
+                                     const G4MaterialCutsCouple*,
+                                     G4double length,
+                                     G4double edepTotal,
+                                     G4double edepNIEL) const;
+
+    /// Set the maximum relative error allowed when the electron LET is
+    /// looked up in a table instead of being calculated from the
+    /// parameterization.  The table is rebuilt (and validated against the
+    /// parameterization) when this is called.  If the tolerance is zero,
+    /// the LET is always calculated.
+    void SetLETTolerance(double tolerance);
+
+    /// Get the maximum relative error for the tabulated electron LET.
+    double GetLETTolerance() const {return fLETTolerance;}
+
     // hide assignment operator
     DokeBirksSaturation & operator=(
         const DokeBirksSaturation &right) = delete;
@@ -50,5 +85,75 @@ private:
     /// applicable to LAr.
     G4double CalculateElectronLET ( G4double E) const;
 
+    /// Calculate the electron LET from the parameterization.  This is the
+    /// reference used to fill and validate the LET table.
+    G4double AnalyticElectronLET ( G4double E) const;
+
+    /// Fill the electron LET table so the interpolation error is less than
+    /// the tolerance, and validate it against the parameterization.
+    void BuildLETTable();
+
+    /// The electron LET at the table nodes.  The table covers energies from
+    /// 1 to 2^kLETOctaves (in the units of CalculateElectronLET).  Each
+    /// octave is divided into fLETSubBins equal bins so a bin can be found
+    /// from the binary exponent of the energy without a logarithm.
+    std::vector<double> fLETTable;
+
+    /// The number of bins in each octave of the LET table.
+    int fLETSubBins;
+
+    /// The maximum relative error of the tabulated LET.
+    double fLETTolerance;
+
+    /// The material properties needed for each step.
+    struct MaterialInfo {
+        /// True if the properties have been filled.
+        bool fFilled;
+        /// True if the material is liquid argon.
+        bool fLiquidArgon;
+        /// The density of the material in g/cm3.
+        double fDensity;
+    };
+
+    /// Get the properties of a material.  The table is filled the first time
+    /// a material is seen.
+    const MaterialInfo& GetMaterialInfo(const G4Material* aMaterial) const;
+
+    /// The electric field in a logical volume.
+    struct FieldInfo {
+        /// The field manager used to fill the information.
+        const G4FieldManager* fManager;
+        /// The field, or NULL if the volume doesn't have a field.
+        const G4Field* fField;
+        /// True if the electric field is uniform in the volume.
+        bool fUniform;
+        /// The magnitude of a uniform electric field.
+        double fElectricField;
+        /// The Doke-Birks A constant for a uniform electric field.
+        double fDokeBirksA;
+    };
+
+    /// Get the electric field information for a logical volume.  The
+    /// information is refilled if the field manager for the volume changes.
+    const FieldInfo& GetFieldInfo(const G4LogicalVolume* aLogVolume) const;
+
+    /// Calculate the Doke-Birks A constant for an electric field.
+    double DokeBirksA(double electricField) const;
+
+    /// The material properties indexed by the G4Material index.
+    mutable std::vector<MaterialInfo> fMaterials;
+
+    /// The field information for each logical volume.
+    mutable std::map<const G4LogicalVolume*, FieldInfo> fFields;
+
+    /// The last volume that was looked up, and its field information.  Most
+    /// steps are in the same volume as the previous step.
+    mutable const G4LogicalVolume* fLastVolume;
+    mutable const FieldInfo* fLastField;
+
+    /// The last non-uniform field, and the Doke-Birks constant for it.
+    mutable double fLastElectricField;
+    mutable double fLastDokeBirksA;
+
 };
 #endif
@@ -50,6 +50,9 @@
 #include "G4MagIntegratorStepper.hh"
 #include "G4MagIntegratorDriver.hh"
 #include "G4ChordFinder.hh"
+#include "G4InterpolationDriver.hh"
+#include "G4DormandPrince745.hh"
+#include "G4ExactHelixStepper.hh"
 
 #include "G4ExplicitEuler.hh"
 #include "G4ImplicitEuler.hh"
@@ -76,7 +79,8 @@ EDepSim::EMFieldSetup::EMFieldSetup(G4FieldManager* fieldManager)
       fEMfield(0),
       fStepper(0),
       fIntgrDriver(0),
-      fStepperType(4),    // ClassicalRK4 -- the default stepper
+      fFieldType(kElectroMagnetic),
+      fStepperType(-1),   // Choose the stepper from the field type
       fMinStep(0.010*mm)  // minimal step of 10 microns
 {
     fEMfield = new G4UniformElectricField(G4ThreeVector(0.0,500.0*volt/cm,0.0));
@@ -88,17 +92,26 @@ EDepSim::EMFieldSetup::EMFieldSetup(G4FieldManager* fieldManager)
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 EDepSim::EMFieldSetup::EMFieldSetup(G4ElectroMagneticField* field,
-                                    G4FieldManager* fieldManager)
+                                    G4FieldManager* fieldManager,
+                                    FieldType type)
     : fFieldManager(fieldManager),
       fChordFinder(0),
       fEquation(0),
       fEMfield(field),
       fStepper(0),
       fIntgrDriver(0),
-      fStepperType(4),    // ClassicalRK4 -- the default stepper
+      fFieldType(type),
+      fStepperType(-1),   // Choose the stepper from the field type
       fMinStep(0.010*mm)  // minimal step of 10 microns
 {
-    fEquation = new G4EqMagElectricField(fEMfield);
+    // Without an electric field the energy doesn't change, so the cheaper
+    // magnetic equation of motion is used.
+    if (fFieldType == kElectroMagnetic) {
+        fEquation = new G4EqMagElectricField(fEMfield);
+    }
+    else {
+        fEquation = new G4Mag_UsualEqRhs(fEMfield);
+    }
 
     UpdateField();
 }
@@ -128,11 +141,14 @@ void EDepSim::EMFieldSetup::UpdateField()
 
     fFieldManager->SetDetectorField(fEMfield);
 
-    if (fChordFinder) delete fChordFinder;
+    // The field object is electromagnetic, but a magnetic field doesn't
+    // change the particle energy.
+    if (fFieldType != kElectroMagnetic) {
+        fFieldManager->SetFieldChangesEnergy(false);
+    }
 
-    fIntgrDriver = new G4MagInt_Driver(fMinStep,
-                                       fStepper,
-                                       fStepper->GetNumberOfVariables());
+    // The chord finder owns the driver.
+    if (fChordFinder) delete fChordFinder;
 
     fChordFinder = new G4ChordFinder(fIntgrDriver);
 
@@ -141,13 +157,67 @@ void EDepSim::EMFieldSetup::UpdateField()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void EDepSim::EMFieldSetup::SetAccuracy(const Accuracy& accuracy)
+{
+    if (accuracy.fDeltaChord > 0) {
+        fChordFinder->SetDeltaChord(accuracy.fDeltaChord);
+    }
+    if (accuracy.fDeltaOneStep > 0) {
+        fFieldManager->SetDeltaOneStep(accuracy.fDeltaOneStep);
+    }
+    if (accuracy.fDeltaIntersection > 0) {
+        fFieldManager->SetDeltaIntersection(accuracy.fDeltaIntersection);
+    }
+    // The field manager rejects a minimum above the maximum, so the limit
+    // that makes room for the other is set first.
+    if (accuracy.fEpsilonMax > 0
+        && accuracy.fEpsilonMax < fFieldManager->GetMinimumEpsilonStep()) {
+        fFieldManager->SetMinimumEpsilonStep(accuracy.fEpsilonMin > 0
+                                             ? accuracy.fEpsilonMin
+                                             : accuracy.fEpsilonMax);
+    }
+    if (accuracy.fEpsilonMax > 0) {
+        fFieldManager->SetMaximumEpsilonStep(accuracy.fEpsilonMax);
+    }
+    if (accuracy.fEpsilonMin > 0) {
+        fFieldManager->SetMinimumEpsilonStep(accuracy.fEpsilonMin);
+    }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void EDepSim::EMFieldSetup::SetStepper()
 {
 // Set stepper according to the stepper type
 
-    G4int nvar = 8;
+    G4int nvar = (fFieldType == kElectroMagnetic) ? 8 : 6;
 
+    // The driver is owned (and deleted) by the chord finder.
     if (fStepper) delete fStepper;
+    fStepper = 0;
+    fIntgrDriver = 0;
+
+    if (fStepperType < 0) {
+        if (fFieldType == kUniformMagnetic) {
+            // A helix is the exact solution in a uniform magnetic field.
+            fStepper = new G4ExactHelixStepper(
+                static_cast<G4Mag_EqRhs*>(fEquation));
+            fIntgrDriver = new G4MagInt_Driver(fMinStep, fStepper, nvar);
+            G4cout<<"G4ExactHelixStepper is called"<<G4endl;
+        }
+        else {
+            // The embedded FSAL stepper with the interpolation driver is
+            // the fastest general choice.
+            G4DormandPrince745* stepper
+                = new G4DormandPrince745( fEquation, nvar );
+            fStepper = stepper;
+            fIntgrDriver
+                = new G4InterpolationDriver<G4DormandPrince745>(
+                    fMinStep, stepper, nvar);
+            G4cout<<"G4DormandPrince745 (default) is called"<<G4endl;
+        }
+        return;
+    }
 
     switch ( fStepperType )
     {
@@ -169,7 +239,7 @@ void EDepSim::EMFieldSetup::SetStepper()
         break;
     case 4:
         fStepper = new G4ClassicalRK4( fEquation, nvar );
-        G4cout<<"G4ClassicalRK4 (default) is called"<<G4endl;
+        G4cout<<"G4ClassicalRK4 is called"<<G4endl;
         break;
     case 5:
         fStepper = new G4CashKarpRKF45( fEquation, nvar );
@@ -194,6 +264,10 @@ void EDepSim::EMFieldSetup::SetStepper()
         break;
     default: fStepper = 0;
     }
+
+    if (fStepper) {
+        fIntgrDriver = new G4MagInt_Driver(fMinStep, fStepper, nvar);
+    }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -44,36 +44,91 @@ class G4ChordFinder;
 class G4ElectroMagneticField;
 class G4EquationOfMotion;
 class G4Mag_EqRhs;
-class G4EqMagElectricField;
 class G4MagIntegratorStepper;
-class G4MagInt_Driver;
+class G4VIntegrationDriver;
 
 namespace EDepSim {class EMFieldSetup;}
 
 /// A class for control of the Electric Field of the detector.
 ///
-/// The field for this case is uniform.
-/// It is simply a 'setup' class that creates the field and necessary
-/// other parts
+/// It is simply a 'setup' class that creates the equation of motion, the
+/// stepper and the chord finder for a field.  The cheapest correct
+/// combination is chosen from the type of the field: a field with an
+/// electric component needs the full equation of motion (8 variables), but
+/// a purely magnetic field only needs 6 variables.  A uniform magnetic
+/// field is integrated exactly using a helix, and other fields use the
+/// Dormand-Prince 7(4)5 stepper with the interpolation driver.
 class EDepSim::EMFieldSetup
 {
 public:
+    /// The type of field, which decides the equation of motion and the
+    /// stepper.
+    enum FieldType {
+        /// An electric field (and possibly a magnetic field).
+        kElectroMagnetic,
+        /// A magnetic field without an electric field.
+        kMagnetic,
+        /// A uniform magnetic field without an electric field.
+        kUniformMagnetic
+    };
+
+    /// The accuracy of the field propagation.  Values that are not
+    /// positive leave the Geant4 default.
+    struct Accuracy {
+        Accuracy()
+            : fDeltaChord(-1.0), fDeltaOneStep(-1.0),
+              fDeltaIntersection(-1.0), fEpsilonMin(-1.0),
+              fEpsilonMax(-1.0) {}
+
+        /// Replace the values that are set in another accuracy.
+        void Override(const Accuracy& other) {
+            if (other.fDeltaChord > 0) fDeltaChord = other.fDeltaChord;
+            if (other.fDeltaOneStep > 0) fDeltaOneStep = other.fDeltaOneStep;
+            if (other.fDeltaIntersection > 0) {
+                fDeltaIntersection = other.fDeltaIntersection;
+            }
+            if (other.fEpsilonMin > 0) fEpsilonMin = other.fEpsilonMin;
+            if (other.fEpsilonMax > 0) fEpsilonMax = other.fEpsilonMax;
+        }
+
+        /// The maximum miss distance between the chord and the trajectory.
+        G4double fDeltaChord;
+        /// The position accuracy of a step.
+        G4double fDeltaOneStep;
+        /// The position accuracy of a boundary intersection.
+        G4double fDeltaIntersection;
+        /// The minimum relative integration accuracy.
+        G4double fEpsilonMin;
+        /// The maximum relative integration accuracy.
+        G4double fEpsilonMax;
+    };
+
     /// Create a new field.  The first argument is a general EM field (for
     /// example, G4UniformMagneticField, or G4UniformElectricField.  The
-    /// second argument is the field manager to setup.
-    EMFieldSetup(G4ElectroMagneticField* field, G4FieldManager* m=0);
+    /// second argument is the field manager to setup.  The type is used to
+    /// choose the equation of motion and stepper.  A field that is not
+    /// kElectroMagnetic must still be an electromagnetic field, but the
+    /// electric components are ignored while tracking.
+    EMFieldSetup(G4ElectroMagneticField* field, G4FieldManager* m=0,
+                 FieldType type=kElectroMagnetic);
 
     /// Create a zero field for the field manager.
     EMFieldSetup(G4FieldManager* m=0);
 
     virtual ~EMFieldSetup();
 
+    /// Choose one of the legacy steppers by number (see SetStepper).  A
+    /// negative value (the default) chooses the stepper using the field
+    /// type.
     void SetStepperType(G4int i) { fStepperType = i ; }
 
     void SetStepper();
 
     void SetMinStep(G4double s) { fMinStep = s ; }
 
+    /// Set the accuracy of the field propagation.
+    void SetAccuracy(const Accuracy& accuracy);
+
 protected:
 
     // Find the global Field Manager
@@ -88,12 +143,14 @@ private:
 
     G4ChordFinder*          fChordFinder;
 
-    G4EqMagElectricField*   fEquation;
+    G4EquationOfMotion*     fEquation;
 
     G4ElectroMagneticField* fEMfield;
 
     G4MagIntegratorStepper* fStepper;
-    G4MagInt_Driver*        fIntgrDriver;
+    G4VIntegrationDriver*   fIntgrDriver;
+
+    FieldType               fFieldType;
 
     G4int                   fStepperType;
 
@@ -8,6 +8,7 @@
 #endif
 
 #include "EDepSimSecondaryEnergy.hh"
+#include "EDepSimRegionManager.hh"
 #include "EDepSimLog.hh"
 
 #include <globals.hh>
@@ -21,6 +22,7 @@
 #include <G4Material.hh>
 #include <G4ios.hh>
 #include <G4StepLimiter.hh>
+#include <G4UserSpecialCuts.hh>
 
 EDepSim::ExtraPhysics::ExtraPhysics()
     : G4VPhysicsConstructor("EDepSimExtra"), fIonizationModel(1) { }
@@ -36,6 +38,15 @@ void EDepSim::ExtraPhysics::ConstructParticle() {
 void EDepSim::ExtraPhysics::ConstructProcess() {
     EDepSimLog("EDepSim::ExtraPhysics:: Add Extra Physics Processes");
 
+    // The user limits that are applied by G4UserSpecialCuts.  The process
+    // is called for every step, so it is only added when a region sets one
+    // of the limits.  The minimum range only applies to charged particles.
+    EDepSim::RegionManager* regions = EDepSim::RegionManager::Get();
+    bool neutralCuts = regions->HasLimit("maxTrackLength")
+        || regions->HasLimit("maxTime")
+        || regions->HasLimit("minKineticEnergy");
+    bool chargedCuts = neutralCuts || regions->HasLimit("minRange");
+
     G4ParticleTable::G4PTblDicIterator* theParticleIterator
         = theParticleTable->GetIterator();
 
@@ -60,6 +71,16 @@ void EDepSim::ExtraPhysics::ConstructProcess() {
             pman->AddDiscreteProcess(new G4StepLimiter("Step Limit"));
         }
 
+        // Apply the maximum track length and time, and the minimum kinetic
+        // energy and range set by the user limits for a region.  Optical
+        // photons are not limited.
+        bool specialCuts
+            = (std::abs(charge) > 0.1) ? chargedCuts : neutralCuts;
+        if (specialCuts && !particle->IsShortLived()
+            && particle != G4OpticalPhoton::Definition()) {
+            pman->AddDiscreteProcess(new G4UserSpecialCuts("User Cuts"));
+        }
+
         switch (fIonizationModel) {
         case 0: {
 #ifndef EDEPSIM_SKIP_NESTVersion098
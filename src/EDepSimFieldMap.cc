@@ -0,0 +1,397 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimFieldMap.hh"
+
+#include "EDepSimLog.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // The header of the binary field map format.  The header is followed by
+    // the cells (four doubles per grid point, with Z varying fastest) in the
+    // native byte order.  The header size is a multiple of the cell
+    // alignment so the mapped cells are aligned.
+    struct BinaryHeader {
+        // The file type.  This is "EDSFMAP" with a terminating null.
+        char fMagic[8];
+        // The format version.
+        std::uint32_t fVersion;
+        // A known value used to check the byte order.
+        std::uint32_t fByteOrder;
+        // The offset of the cells from the start of the file.
+        std::uint64_t fDataOffset;
+        // The number of grid points along each axis.
+        std::int32_t fSize[3];
+        // The number of doubles per grid point.
+        std::int32_t fCellValues;
+        // The position of the first grid point (mm).
+        double fOffset[3];
+        // The grid spacing (mm).
+        double fDelta[3];
+        // The unit of the field values (in CLHEP units).
+        double fUnit;
+        // The name of the unit.
+        char fUnitName[32];
+    };
+
+    const char* const kBinaryMagic = "EDSFMAP";
+    const std::uint32_t kBinaryVersion = 1;
+    const std::uint32_t kBinaryByteOrder = 0x01020304;
+    const std::uint64_t kBinaryDataOffset = 256;
+
+    // The fewest grid points along an axis that the interpolation needs.
+    // The stencils give a zero weight to the points outside of the grid, so
+    // a single point along an axis (e.g. a map of a plane) is allowed.
+    const int kMinimumSize = 1;
+    static_assert(sizeof(BinaryHeader) <= kBinaryDataOffset,
+                  "Binary field map header is too large");
+
+    // The cubic convolution kernel.  This must match
+    // EDepSim::Cubic::conv_kernel.
+    double CubicKernel(double s) {
+        double v = 0;
+        double z = std::abs(s);
+        if (0 <= z && z < 1) v = 1 + (0.5) * z * z * (3 * z - 5);
+        else if (1 < z && z < 2) v = 2 - z * (4 + 0.5 * z * (z - 5));
+        return v;
+    }
+
+    // Fill the grid indices and weights for the four grid points used by
+    // the cubic interpolation along one axis.  Grid points outside of the
+    // map get a zero weight (and a valid index).
+    void CubicStencil(double p, int size, int* index, double* weight) {
+        const int base = std::floor(p);
+        for (int n = 0; n < 4; ++n) {
+            const int i = base - 1 + n;
+            if (i < 0 || i >= size) {
+                index[n] = 0;
+                weight[n] = 0.0;
+                continue;
+            }
+            index[n] = i;
+            weight[n] = CubicKernel(p - i);
+        }
+    }
+
+    // Fill the grid indices and weights for the two grid points used by
+    // the linear interpolation along one axis.
+    void LinearStencil(double p, int size, int* index, double* weight) {
+        const int base = std::floor(p);
+        const double t = p - base;
+        for (int n = 0; n < 2; ++n) {
+            const int i = base + n;
+            if (i < 0 || i >= size) {
+                index[n] = 0;
+                weight[n] = 0.0;
+                continue;
+            }
+            index[n] = i;
+            weight[n] = (n == 0) ? 1.0 - t : t;
+        }
+    }
+}
+
+EDepSim::FieldMap::FieldMap()
+    : fOffset({0.0, 0.0, 0.0}), fDelta({1.0, 1.0, 1.0}), fSize({0, 0, 0}),
+      fUnit(1.0), fData(NULL), fMapAddress(NULL), fMapLength(0),
+      fInterpolation(kCubic) {}
+
+EDepSim::FieldMap::~FieldMap() {
+    Clear();
+}
+
+void EDepSim::FieldMap::Clear() {
+    if (fMapAddress) munmap(fMapAddress, fMapLength);
+    fMapAddress = NULL;
+    fMapLength = 0;
+    fCells.clear();
+    fData = NULL;
+    fSize = {0, 0, 0};
+}
+
+bool EDepSim::FieldMap::ReadFile(const std::string& fname, double unit) {
+    Clear();
+    fFileName = fname;
+
+    // Check for the binary format.
+    char magic[8] = {0};
+    std::ifstream fin(fname, std::ios::binary);
+    if (!fin.is_open()) {
+        EDepSimError("Can't read " << fname);
+        return false;
+    }
+    fin.read(magic, sizeof(magic));
+    fin.close();
+    if (std::memcmp(magic, kBinaryMagic, sizeof(magic)) == 0) {
+        return ReadBinary(fname, unit);
+    }
+
+    return ReadText(fname, unit);
+}
+
+bool EDepSim::FieldMap::ReadText(const std::string& fname, double unit) {
+    std::fstream fin(fname, std::fstream::in);
+    if (!fin.is_open()) {
+        EDepSimError("Can't read " << fname);
+        return false;
+    }
+
+    EDepSimLog("Reading " << fname << " ...");
+    fUnit = unit;
+    std::string line;
+    while (std::getline(fin >> std::ws, line)) {
+        if (line.front() == '#') continue;
+        std::istringstream ss(line);
+        ss >> fOffset[0] >> fOffset[1] >> fOffset[2]
+           >> fDelta[0] >> fDelta[1] >> fDelta[2];
+        break;
+    }
+
+    // The Z coordinate varies fastest, then Y and finally X.  Count the grid
+    // points along each axis as the coordinates change, and check that
+    // every row has as many points as the first row, and that every X
+    // slice has as many rows as the first slice.
+    int xCount = 0;
+    int yCount = 0;
+    int zCount = 0;
+    int ySize = 0;
+    int zSize = 0;
+    bool regular = true;
+    double xCurr = 0.0;
+    double yCurr = 0.0;
+    while (true) {
+        bool more = static_cast<bool>(std::getline(fin >> std::ws, line));
+        if (more && line.front() == '#') continue;
+        double x{0}, y{0}, z{0}, fx{0}, fy{0}, fz{0}, f{0};
+        if (more) {
+            std::istringstream ss(line);
+            ss >> x >> y >> z >> fx >> fy >> fz >> f;
+        }
+
+        bool newSlice = !more || fCells.empty()
+            || std::abs(x - xCurr) > 0.0;
+        bool newRow = newSlice || std::abs(y - yCurr) > 0.0;
+        if (newRow && !fCells.empty()) {
+            if (zSize < 1) zSize = zCount;
+            if (zCount != zSize) regular = false;
+        }
+        if (newSlice && !fCells.empty()) {
+            if (ySize < 1) ySize = yCount;
+            if (yCount != ySize) regular = false;
+        }
+        if (!more) break;
+
+        if (newSlice) {
+            xCurr = x;
+            yCurr = y;
+            ++xCount;
+            yCount = 1;
+            zCount = 0;
+        }
+        else if (newRow) {
+            yCurr = y;
+            ++yCount;
+            zCount = 0;
+        }
+        ++zCount;
+
+        Cell cell = {{fx, fy, fz, 0.0}};
+        fCells.push_back(cell);
+    }
+
+    if (!regular || fCells.size() != (std::size_t) xCount*ySize*zSize) {
+        EDepSimError("Field map " << fname << " is not a regular grid:"
+                     << " " << fCells.size() << " points for a"
+                     << " " << xCount << "x" << ySize << "x" << zSize
+                     << " grid");
+        Clear();
+        return false;
+    }
+
+    if (xCount < kMinimumSize || ySize < kMinimumSize
+        || zSize < kMinimumSize
+        || !(fDelta[0] > 0.0) || !(fDelta[1] > 0.0) || !(fDelta[2] > 0.0)) {
+        EDepSimError("Field map " << fname << " has an invalid grid:"
+                     << " " << xCount << "x" << ySize << "x" << zSize
+                     << " points with spacing " << fDelta[0]
+                     << ", " << fDelta[1] << ", " << fDelta[2]);
+        Clear();
+        return false;
+    }
+
+    fSize = {xCount, ySize, zSize};
+    fData = fCells.data();
+    return true;
+}
+
+bool EDepSim::FieldMap::ReadBinary(const std::string& fname, double unit) {
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        EDepSimError("Can't open " << fname);
+        return false;
+    }
+    struct stat info;
+    BinaryHeader header;
+    if (fstat(fd, &info) != 0
+        || (std::size_t) info.st_size < sizeof(BinaryHeader)
+        || read(fd, &header, sizeof(header)) != sizeof(header)) {
+        EDepSimError("Can't read header for " << fname);
+        close(fd);
+        return false;
+    }
+    std::size_t length = info.st_size;
+
+    if (header.fVersion != kBinaryVersion
+        || header.fByteOrder != kBinaryByteOrder
+        || header.fCellValues != 4
+        || header.fDataOffset % alignof(Cell) != 0) {
+        EDepSimError("Unsupported binary field map format in " << fname);
+        close(fd);
+        return false;
+    }
+
+    // The header is checked before the file is mapped since the grid size
+    // is used for all of the cell indices.  The cell count is accumulated
+    // so that it can't overflow.
+    std::size_t points = 1;
+    for (int i = 0; i < 3; ++i) {
+        if (header.fSize[i] < kMinimumSize
+            || !(header.fDelta[i] > 0.0)
+            || !std::isfinite(header.fDelta[i])
+            || !std::isfinite(header.fOffset[i])) {
+            EDepSimError("Binary field map " << fname
+                         << " has an invalid grid along axis " << i);
+            close(fd);
+            return false;
+        }
+        if (points > SIZE_MAX / sizeof(Cell) / header.fSize[i]) {
+            EDepSimError("Binary field map " << fname << " is too large");
+            close(fd);
+            return false;
+        }
+        points *= header.fSize[i];
+    }
+    if (header.fDataOffset > length
+        || points > (length - header.fDataOffset) / sizeof(Cell)) {
+        EDepSimError("Binary field map " << fname << " is truncated");
+        close(fd);
+        return false;
+    }
+
+    if (std::abs(header.fUnit - unit) > 1E-6*std::abs(unit)) {
+        header.fUnitName[sizeof(header.fUnitName)-1] = 0;
+        EDepSimError("Binary field map " << fname
+                     << " has the wrong unit: " << header.fUnitName);
+        close(fd);
+        return false;
+    }
+
+    void* address = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    if (address == MAP_FAILED) {
+        EDepSimError("Can't map " << fname);
+        return false;
+    }
+    fMapAddress = address;
+    fMapLength = length;
+
+    EDepSimLog("Mapped " << fname << " ...");
+    for (int i = 0; i < 3; ++i) {
+        fSize[i] = header.fSize[i];
+        fOffset[i] = header.fOffset[i];
+        fDelta[i] = header.fDelta[i];
+    }
+    fUnit = header.fUnit;
+    fData = reinterpret_cast<const Cell*>(
+        static_cast<const char*>(address) + header.fDataOffset);
+    return true;
+}
+
+bool EDepSim::FieldMap::WriteBinary(const std::string& fname,
+                                    const std::string& unitName) const {
+    if (!fData) {
+        EDepSimError("No field map to write to " << fname);
+        return false;
+    }
+
+    alignas(BinaryHeader) char header[kBinaryDataOffset];
+    std::memset(header, 0, sizeof(header));
+    BinaryHeader* h = reinterpret_cast<BinaryHeader*>(header);
+    std::memcpy(h->fMagic, kBinaryMagic, sizeof(h->fMagic));
+    h->fVersion = kBinaryVersion;
+    h->fByteOrder = kBinaryByteOrder;
+    h->fDataOffset = kBinaryDataOffset;
+    h->fCellValues = 4;
+    for (int i = 0; i < 3; ++i) {
+        h->fSize[i] = fSize[i];
+        h->fOffset[i] = fOffset[i];
+        h->fDelta[i] = fDelta[i];
+    }
+    h->fUnit = fUnit;
+    std::strncpy(h->fUnitName, unitName.c_str(), sizeof(h->fUnitName)-1);
+
+    std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        EDepSimError("Can't write " << fname);
+        return false;
+    }
+    out.write(header, sizeof(header));
+    std::size_t points = (std::size_t) fSize[0]*fSize[1]*fSize[2];
+    out.write(reinterpret_cast<const char*>(fData), points*sizeof(Cell));
+    if (!out) {
+        EDepSimError("Error writing " << fname);
+        return false;
+    }
+    return true;
+}
+
+void EDepSim::FieldMap::GetValue(const double* point, double* value) const {
+    value[0] = value[1] = value[2] = 0.0;
+    if (!fData) return;
+
+    int index[3][4];
+    double weight[3][4];
+    int points = 4;
+    for (int axis = 0; axis < 3; ++axis) {
+        const double p = (point[axis] - fOffset[axis]) / fDelta[axis];
+        if (fInterpolation == kLinear) {
+            LinearStencil(p, fSize[axis], index[axis], weight[axis]);
+            points = 2;
+        }
+        else {
+            CubicStencil(p, fSize[axis], index[axis], weight[axis]);
+        }
+    }
+
+    // Sum the stencil for all of the components at once.  The padding value
+    // is summed too so the inner loop covers a full aligned cell.
+    double sum[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int a = 0; a < points; ++a) {
+        if (weight[0][a] == 0.0) continue;
+        for (int b = 0; b < points; ++b) {
+            const double wxy = weight[0][a] * weight[1][b];
+            if (wxy == 0.0) continue;
+            const Cell* row = &GetCell(index[0][a], index[1][b], 0);
+            for (int c = 0; c < points; ++c) {
+                const double w = wxy * weight[2][c];
+                const double* v = row[index[2][c]].v;
+                for (int d = 0; d < 4; ++d) sum[d] += w * v[d];
+            }
+        }
+    }
+
+    value[0] = fUnit * sum[0];
+    value[1] = fUnit * sum[1];
+    value[2] = fUnit * sum[2];
+}
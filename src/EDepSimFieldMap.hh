@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_FieldMap_hh_seen
+#define EDepSim_FieldMap_hh_seen
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace EDepSim {class FieldMap;}
+/// A vector field sampled on a regular grid.  This is the storage used by
+/// EDepSim::ArbMagField and EDepSim::ArbElecField.  The three components of
+/// the field are interleaved in a single contiguous array, and each grid
+/// point is padded to four aligned values so that the interpolation can
+/// combine all of the components of a grid point in one (vectorizable)
+/// operation.  All three components are interpolated in a single pass over
+/// the interpolation stencil.
+///
+/// The field can be interpolated using a tricubic convolution (the
+/// default, and the same kernel as EDepSim::Cubic), or using a trilinear
+/// interpolation.  For both methods, grid points outside of the map do not
+/// contribute to the field.
+///
+/// The map can be read from the text grid format, or from a binary format
+/// written by WriteBinary() (see the edep-field-map tool).  The binary file
+/// is a fixed size header describing the grid and the field unit, followed
+/// by the cells in the same layout as they are kept in memory.  A binary
+/// file is memory mapped read-only instead of being copied, so jobs on the
+/// same node share one physical copy of the map.
+class EDepSim::FieldMap {
+public:
+    /// The interpolation methods.
+    enum Interpolation {
+        kLinear,
+        kCubic
+    };
+
+    FieldMap();
+    virtual ~FieldMap();
+
+    /// Read a field map file.  The file can either be a text grid file (see
+    /// doc/DETECTOR.md for the format), or a binary file.  The field values
+    /// in a text file are multiplied by unit.  A binary file records its own
+    /// unit, and must match the expected unit.  This returns false if the
+    /// file cannot be read.
+    bool ReadFile(const std::string& fname, double unit);
+
+    /// Write the map to a binary file that can be read by ReadFile().  The
+    /// unit name is saved in the header for documentation.  This returns
+    /// false if the file cannot be written.
+    bool WriteBinary(const std::string& fname,
+                     const std::string& unitName) const;
+
+    /// Interpolate the field at a point, and fill the three components into
+    /// value.  The point is in the global coordinates.
+    void GetValue(const double* point, double* value) const;
+
+    /// Set the interpolation method.
+    void SetInterpolation(Interpolation method) {fInterpolation = method;}
+
+    /// Get the interpolation method.
+    Interpolation GetInterpolation() const {return fInterpolation;}
+
+    /// Get the name of the file used to fill the map.
+    const std::string& GetFileName() const {return fFileName;}
+
+    /// Get the position of the first grid point.
+    const std::array<double,3>& GetOffset() const {return fOffset;}
+
+    /// Get the grid spacing.
+    const std::array<double,3>& GetDelta() const {return fDelta;}
+
+    /// Get the number of grid points along an axis.
+    int GetSize(int axis) const {return fSize[axis];}
+
+    /// Get the unit of the field values.
+    double GetUnit() const {return fUnit;}
+
+    /// Return true if the map is memory mapped from a binary file.
+    bool IsMapped() const {return fMapAddress != NULL;}
+
+private:
+    // The map may own a memory mapping, so it cannot be copied.
+    FieldMap(const FieldMap&);
+    FieldMap& operator=(const FieldMap&);
+
+    /// Read the text grid format.
+    bool ReadText(const std::string& fname, double unit);
+
+    /// Memory map the binary format.
+    bool ReadBinary(const std::string& fname, double unit);
+
+    /// Release the field values (and any memory mapping).
+    void Clear();
+
+    /// The field at one grid point.  The fourth value is padding so each
+    /// grid point is aligned.
+    struct alignas(32) Cell {
+        double v[4];
+    };
+
+    /// Return the cell for a grid point.
+    const Cell& GetCell(int i, int j, int k) const {
+        return fData[((std::size_t) i*fSize[1] + j)*fSize[2] + k];
+    }
+
+    /// The name of the file used to fill the map.
+    std::string fFileName;
+
+    /// The position of the first grid point.
+    std::array<double,3> fOffset;
+
+    /// The spacing of the grid points.
+    std::array<double,3> fDelta;
+
+    /// The number of grid points along each axis.
+    std::array<int,3> fSize;
+
+    /// The unit of the field values.  The interpolated values are scaled
+    /// by the unit.
+    double fUnit;
+
+    /// The field values with Z varying fastest, then Y, and then X.  This
+    /// points either into fCells, or into the memory mapped file.
+    const Cell* fData;
+
+    /// The field values read from a text file.
+    std::vector<Cell> fCells;
+
+    /// The memory mapping of a binary file (NULL if not mapped).
+    void* fMapAddress;
+
+    /// The length of the memory mapping.
+    std::size_t fMapLength;
+
+    /// The interpolation method.
+    Interpolation fInterpolation;
+};
+#endif
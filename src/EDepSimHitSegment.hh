@@ -165,8 +165,10 @@ public:
 
 protected:
     /// Find the primary track ID for the current track.  This is the primary
-    /// that is the ultimate parent of the current track.
-    int FindPrimaryId(G4Track* theTrack);
+    /// that is the ultimate parent of the current track.  This uses the
+    /// trajectories in the current event, so it is virtual to let hits be
+    /// made outside of the event loop (e.g. by edep-microbench).
+    virtual int FindPrimaryId(G4Track* theTrack);
 
     /// Find the maximum separation (the sagitta) between the current hit
     /// segment path points, and the straight line connecting the start and
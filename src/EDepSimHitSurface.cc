@@ -33,12 +33,14 @@ G4Allocator<EDepSim::HitSurface> edepHitSurfaceAllocator;
 EDepSim::HitSurface::HitSurface()
     :  fPrimaryId(-1), fEnergyDeposit(0),
        fPosition(0,0,0,0), fStart(0,0,0,0),
-       fPDGEncoding(0), fCreatorType(-1), fCreatorSubtype(-1) {}
+       fPDGEncoding(0), fCreatorType(-1), fCreatorSubtype(-1),
+       fCount(1) {}
 
 EDepSim::HitSurface::HitSurface(const G4Step* theStep)
     :  fPrimaryId(0), fEnergyDeposit(0),
        fPosition(0,0,0,0), fStart(0,0,0,0),
-       fPDGEncoding(0), fCreatorType(-1), fCreatorSubtype(-1) {
+       fPDGEncoding(0), fCreatorType(-1), fCreatorSubtype(-1),
+       fCount(1) {
     fPrimaryId = theStep->GetTrack()->GetParentID();
     fEnergyDeposit = theStep->GetTotalEnergyDeposit();
     fPosition = G4LorentzVector(theStep->GetPostStepPoint()->GetPosition(),
@@ -54,8 +56,28 @@ EDepSim::HitSurface::HitSurface(const G4Step* theStep)
     }
 }
 
+EDepSim::HitSurface::HitSurface(int primaryId, double energy,
+                                const G4LorentzVector& position,
+                                const G4LorentzVector& start,
+                                int pdgEncoding, int creatorType,
+                                int creatorSubtype)
+    :  fPrimaryId(primaryId), fEnergyDeposit(energy),
+       fPosition(position), fStart(start),
+       fPDGEncoding(pdgEncoding), fCreatorType(creatorType),
+       fCreatorSubtype(creatorSubtype), fCount(1) {}
+
 EDepSim::HitSurface::~HitSurface() { }
 
+void EDepSim::HitSurface::AddPhotons(const EDepSim::HitSurface& other) {
+    if (other.fCount < 1) return;
+    double total = fCount + other.fCount;
+    double w = other.fCount/total;
+    fEnergyDeposit += w*(other.fEnergyDeposit - fEnergyDeposit);
+    fPosition += w*(other.fPosition - fPosition);
+    fStart += w*(other.fStart - fStart);
+    fCount += other.fCount;
+}
+
 void EDepSim::HitSurface::Draw(void) {
 }
 
@@ -32,6 +32,14 @@ public:
     /// Create a new hit surface
     HitSurface();
     explicit HitSurface(const G4Step* theStep);
+
+    /// Create a new hit surface for a photon that was not tracked (e.g. a
+    /// photon simulated using EDepSim::PhotonLibrary).  The primaryId is the
+    /// track that created the photon.
+    HitSurface(int primaryId, double energy,
+               const G4LorentzVector& position,
+               const G4LorentzVector& start,
+               int pdgEncoding, int creatorType, int creatorSubtype);
     virtual ~HitSurface();
 
     typedef G4THitsCollection<EDepSim::HitSurface> HitSurfaceCollection;
@@ -78,6 +86,20 @@ public:
     /// Get the process subtype
     int GetProcessSubtype() const {return fCreatorSubtype;}
 
+    /// Get the number of photons summarized by this hit.  This is one for a
+    /// single photon, the number of photons in a channel and time bin when
+    /// EDepSim::SurfaceSD is accumulating binned hits, and zero for a single
+    /// photon that is a sample of the photons in a binned hit.
+    int GetCount() const {return fCount;}
+
+    /// Set the number of photons summarized by this hit.
+    void SetCount(int count) {fCount = count;}
+
+    /// Add the photons summarized by another hit to this hit.  The
+    /// positions, times and energy become the averages over the photons,
+    /// and the primary id and process of this hit are kept.
+    void AddPhotons(const EDepSim::HitSurface& other);
+
     /// Print the hit information.
     void ls(std::string = "") const;
 
@@ -106,6 +128,9 @@ private:
     /// The creating process subtype
     int fCreatorSubtype;
 
+    /// The number of photons summarized by this hit.
+    int fCount;
+
 };
 
 extern G4Allocator<EDepSim::HitSurface> edepHitSurfaceAllocator;
@@ -408,7 +408,10 @@ public:
 
     /// Set the default debugging level.  The level parameter takes a value
     /// with type EDepSim::LogManager::ErrorPriority.
-    static void SetDebugLevel(ErrorPriority level) {fErrorPriority = level;}
+    static void SetDebugLevel(ErrorPriority level) {
+        fErrorPriority = level;
+        InvalidateTraces();
+    }
 
     /// Set the debugging level for a particular trace.
     static void SetDebugLevel(const char* trace, ErrorPriority level);
@@ -423,7 +426,10 @@ public:
     static void SetLogStream(std::ostream* log);
 
     /// Set the default logging level.
-    static void SetLogLevel(LogPriority level) {fLogPriority = level;}
+    static void SetLogLevel(LogPriority level) {
+        fLogPriority = level;
+        InvalidateTraces();
+    }
 
     /// Set the logging level for a named trace.
     static void SetLogLevel(const char* trace, LogPriority level);
@@ -455,7 +461,46 @@ public:
     /// [Internal method] Make an indentation for a log message.
     static std::string MakeIndent();
 
+    /// [Internal] The cached output level for a named trace at a single
+    /// call site of a named macro.  The level is looked up the first time
+    /// the call site is reached, and is reset when any output level is
+    /// changed.  The handle must be a static aggregate initialized with
+    /// EDEPSIM_TRACE_HANDLE_INIT so it doesn't need a guard.
+    struct TraceHandle {
+        int fLevel;
+        bool fRegistered;
+        TraceHandle* fNext;
+    };
+
+    /// [Internal] The level of a trace handle that hasn't been looked up.
+    /// This is larger than any level so that the macro checks the level.
+    enum {kUnresolvedLevel = 1000};
+
+    /// [Internal method] Get the debugging level for a named trace using
+    /// the level cached in a handle.
+    static int GetDebugLevel(const char* trace, TraceHandle& handle) {
+        if (handle.fLevel != kUnresolvedLevel) return handle.fLevel;
+        return ResolveDebugLevel(trace, handle);
+    }
+
+    /// [Internal method] Get the logging level for a named trace using the
+    /// level cached in a handle.
+    static int GetLogLevel(const char* trace, TraceHandle& handle) {
+        if (handle.fLevel != kUnresolvedLevel) return handle.fLevel;
+        return ResolveLogLevel(trace, handle);
+    }
+
 private:
+    /// Look up a trace level and save it in the handle.
+    static int ResolveDebugLevel(const char* trace, TraceHandle& handle);
+    static int ResolveLogLevel(const char* trace, TraceHandle& handle);
+
+    /// Reset the cached levels in the trace handles.
+    static void InvalidateTraces();
+
+    /// The trace handles that have been resolved.
+    static TraceHandle* fTraceHandles;
+
     static ErrorPriority fErrorPriority;
     static LogPriority fLogPriority;
     static std::ostream* fDebugStream;
@@ -485,6 +530,25 @@ private:
     } while (0)
 #endif
 
+/// INTERNAL: The initial value of a named trace handle.
+#define EDEPSIM_TRACE_HANDLE_INIT                                       \
+    {EDepSim::LogManager::kUnresolvedLevel, false, NULL}
+
+/// INTERNAL: A macro to check the level of a named trace.  The disabled
+/// case is a single comparison with the level cached for the call site.
+#define _EDEPSIM_TRACE_ENABLED(level,getter,trace)                      \
+    (EDepSim::LogManager::level <= _edepsim_trace.fLevel                \
+     && EDepSim::LogManager::level                                      \
+     <= EDepSim::LogManager::getter(trace,_edepsim_trace))
+
+/// The highest error level that is compiled into the executable.  The
+/// messages for higher levels are removed by the compiler, so a release
+/// build can define this as 3 (WarnLevel) to strip the EDepSimDebug() and
+/// EDepSimTrace() messages.  The default (5) keeps every level.
+#ifndef EDEPSIM_MAX_ERROR_LEVEL
+# define EDEPSIM_MAX_ERROR_LEVEL 5
+#endif
+
 /// Set this to false if the error output code should not be included in
 /// the executable.   This can be redefined in user code and depends on the
 /// optimizers to not emit code a constant contitionals (that's the usual
@@ -520,8 +584,9 @@ private:
 # define EDepSimNamedError(trace,outStream)                             \
     do {                                                                \
         if (EDEPSIM_ERROR_OUTPUT) {                                     \
-            if (EDepSim::LogManager::ErrorLevel                         \
-                <= EDepSim::LogManager::GetDebugLevel(trace))           \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(ErrorLevel,GetDebugLevel,trace)) \
                 _EDEPSIM_OUTPUT_ERROR("ERROR[" trace "]: ", outStream); \
         }                                                               \
     } while (0)
@@ -536,13 +601,14 @@ private:
 /// reserved for error conditions where event data is going to be lost, or
 /// where the event might contain incorrect information.  This macro takes one
 /// \ref streamish providing the error message.
-# define EDepSimSevere(outStream)                               \
-    do {                                                        \
-        if (EDEPSIM_ERROR_OUTPUT) {                             \
-            if (EDepSim::LogManager::SevereLevel                \
-                <= EDepSim::LogManager::GetDebugLevel())        \
-                _EDEPSIM_OUTPUT_ERROR("SEVERE: ",outStream);    \
-        }                                                       \
+# define EDepSimSevere(outStream)                                       \
+    do {                                                                \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::SevereLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            if (EDepSim::LogManager::SevereLevel                        \
+                <= EDepSim::LogManager::GetDebugLevel())                \
+                _EDEPSIM_OUTPUT_ERROR("SEVERE: ",outStream);            \
+        }                                                               \
     } while (0)
 #else
 #warning EDepSimSevere has been redefined and unexpected behaviour may result.
@@ -557,9 +623,11 @@ private:
 /// argument is a \ref streamish providing the error message.
 # define EDepSimNamedSevere(trace,outStream)                            \
     do {                                                                \
-        if (EDEPSIM_ERROR_OUTPUT) {                                     \
-            if (EDepSim::LogManager::SevereLevel                        \
-                <= EDepSim::LogManager::GetDebugLevel(trace))           \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::SevereLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(SevereLevel,GetDebugLevel,trace)) \
                 _EDEPSIM_OUTPUT_ERROR("SEVERE[" trace "]: ", outStream); \
         }                                                               \
     } while (0)
@@ -573,13 +641,14 @@ private:
 /// of error output.  This macro should be used when a correctable, but
 /// unexpected, problem is found with an event.  This macro takes one \ref
 /// streamish providing the error message.
-# define EDepSimWarn(outStream)                                 \
-    do {                                                        \
-        if (EDEPSIM_ERROR_OUTPUT) {                             \
-            if (EDepSim::LogManager::WarnLevel                  \
-                <= EDepSim::LogManager::GetDebugLevel())        \
-                _EDEPSIM_OUTPUT_ERROR("WARNING: ",outStream);   \
-        }                                                       \
+# define EDepSimWarn(outStream)                                         \
+    do {                                                                \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::WarnLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            if (EDepSim::LogManager::WarnLevel                          \
+                <= EDepSim::LogManager::GetDebugLevel())                \
+                _EDEPSIM_OUTPUT_ERROR("WARNING: ",outStream);           \
+        }                                                               \
     } while (0)
 #else
 #warning EDepSimWarn has been redefined and unexpected behaviour may result.
@@ -593,9 +662,11 @@ private:
 /// argument is a \ref streamish providing the error message.
 # define EDepSimNamedWarn(trace,outStream)                              \
     do {                                                                \
-        if (EDEPSIM_ERROR_OUTPUT) {                                     \
-            if (EDepSim::LogManager::WarnLevel                          \
-                <= EDepSim::LogManager::GetDebugLevel(trace))           \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::WarnLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(WarnLevel,GetDebugLevel,trace))  \
                 _EDEPSIM_OUTPUT_ERROR("WARNING[" trace "]: ", outStream); \
         }                                                               \
     } while (0)
@@ -611,13 +682,14 @@ private:
 /// macro should be used during debugging to provide traces of the code
 /// execution.  This macro takes one \ref streamish providing the error
 /// message.
-#define EDepSimDebug(outStream)                                 \
-    do {                                                        \
-        if (EDEPSIM_ERROR_OUTPUT) {                             \
-            if (EDepSim::LogManager::DebugLevel                 \
-                <= EDepSim::LogManager::GetDebugLevel())        \
-                _EDEPSIM_OUTPUT_ERROR("DEBUG: ",outStream);     \
-        }                                                       \
+#define EDepSimDebug(outStream)                                         \
+    do {                                                                \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::DebugLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            if (EDepSim::LogManager::DebugLevel                         \
+                <= EDepSim::LogManager::GetDebugLevel())                \
+                _EDEPSIM_OUTPUT_ERROR("DEBUG: ",outStream);             \
+        }                                                               \
     } while (0)
 #else
 #warning EDepSimDebug has been redefined and unexpected behaviour may result.
@@ -633,9 +705,11 @@ private:
 /// the error message.
 #define EDepSimNamedDebug(trace,outStream)                              \
     do {                                                                \
-        if (EDEPSIM_ERROR_OUTPUT) {                                     \
-            if (EDepSim::LogManager::DebugLevel                         \
-                <= EDepSim::LogManager::GetDebugLevel(trace))           \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::DebugLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(DebugLevel,GetDebugLevel,trace)) \
                 _EDEPSIM_OUTPUT_ERROR("DEBUG[" trace "]: ", outStream); \
         }                                                               \
     } while (0)
@@ -650,13 +724,14 @@ private:
 /// used to print short messages that trace the execution of code being
 /// debugged.  This macro takes one \ref streamish providing the error
 /// message.
-# define EDepSimTrace(outStream)                                \
-    do {                                                        \
-        if (EDEPSIM_ERROR_OUTPUT) {                             \
-            if (EDepSim::LogManager::TraceLevel                 \
-                <= EDepSim::LogManager::GetDebugLevel())        \
-                _EDEPSIM_OUTPUT_ERROR("TRACE: ",outStream);      \
-        }                                                       \
+# define EDepSimTrace(outStream)                                        \
+    do {                                                                \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::TraceLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            if (EDepSim::LogManager::TraceLevel                         \
+                <= EDepSim::LogManager::GetDebugLevel())                \
+                _EDEPSIM_OUTPUT_ERROR("TRACE: ",outStream);             \
+        }                                                               \
     } while (0)
 #else
 #warning EDepSimTrace has been redefined and unexpected behaviour may result.
@@ -671,9 +746,11 @@ private:
 /// the error message.
 #define EDepSimNamedTrace(trace,outStream)                              \
     do {                                                                \
-        if (EDEPSIM_ERROR_OUTPUT) {                                     \
-            if (EDepSim::LogManager::TraceLevel                         \
-                <= EDepSim::LogManager::GetDebugLevel(trace))           \
+        if (EDEPSIM_ERROR_OUTPUT                                        \
+            && EDepSim::LogManager::TraceLevel <= EDEPSIM_MAX_ERROR_LEVEL) { \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(TraceLevel,GetDebugLevel,trace)) \
                 _EDEPSIM_OUTPUT_ERROR("TRACE[" trace "]: ", outStream); \
         }                                                               \
     } while (0)
@@ -735,8 +812,9 @@ private:
 #define EDepSimNamedLog(trace,outStream)                                \
     do {                                                                \
         if (EDEPSIM_LOG_OUTPUT) {                                       \
-            if (EDepSim::LogManager::LogLevel                           \
-                <= EDepSim::LogManager::GetLogLevel(trace))             \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(LogLevel,GetLogLevel,trace))     \
                 _EDEPSIM_OUTPUT_LOG("% [" trace "] ",outStream);        \
         }                                                               \
     } while (0)
@@ -770,8 +848,9 @@ private:
 # define EDepSimNamedInfo(trace,outStream)                              \
     do {                                                                \
         if (EDEPSIM_LOG_OUTPUT) {                                       \
-            if (EDepSim::LogManager::InfoLevel                          \
-                <= EDepSim::LogManager::GetLogLevel(trace))             \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(InfoLevel,GetLogLevel,trace))    \
                 _EDEPSIM_OUTPUT_LOG("%% [" trace "] ",outStream);       \
         }                                                               \
     } while (0)
@@ -805,8 +884,9 @@ private:
 # define EDepSimNamedVerbose(trace,outStream)                           \
     do {                                                                \
         if (EDEPSIM_LOG_OUTPUT) {                                       \
-            if (EDepSim::LogManager::VerboseLevel                       \
-                <= EDepSim::LogManager::GetLogLevel(trace))             \
+            static EDepSim::LogManager::TraceHandle _edepsim_trace      \
+                = EDEPSIM_TRACE_HANDLE_INIT;                            \
+            if (_EDEPSIM_TRACE_ENABLED(VerboseLevel,GetLogLevel,trace)) \
                 _EDEPSIM_OUTPUT_LOG("%%% [" trace "] ",outStream);      \
         }                                                               \
     } while (0)
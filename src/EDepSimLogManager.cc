@@ -14,12 +14,14 @@ std::ostream* EDepSim::LogManager::fLogStream = NULL;
 std::map<std::string,EDepSim::LogManager::ErrorPriority> EDepSim::LogManager::fErrorTraces;
 std::map<std::string,EDepSim::LogManager::LogPriority> EDepSim::LogManager::fLogTraces;
 int EDepSim::LogManager::fIndentation = 0;
+EDepSim::LogManager::TraceHandle* EDepSim::LogManager::fTraceHandles = NULL;
 
 EDepSim::LogManager::~LogManager() { }
 
 void EDepSim::LogManager::SetDebugLevel(const char* trace,
                               EDepSim::LogManager::ErrorPriority level) {
     fErrorTraces[trace] = level;
+    InvalidateTraces();
 }
 
 EDepSim::LogManager::ErrorPriority EDepSim::LogManager::GetDebugLevel(const char* trace) {
@@ -75,6 +77,35 @@ std::ostream& EDepSim::LogManager::GetDebugStream() {
 void EDepSim::LogManager::SetLogLevel(const char* trace,
                             EDepSim::LogManager::LogPriority level) {
     fLogTraces[trace] = level;
+    InvalidateTraces();
+}
+
+int EDepSim::LogManager::ResolveDebugLevel(const char* trace,
+                                           TraceHandle& handle) {
+    if (!handle.fRegistered) {
+        handle.fRegistered = true;
+        handle.fNext = fTraceHandles;
+        fTraceHandles = &handle;
+    }
+    handle.fLevel = GetDebugLevel(trace);
+    return handle.fLevel;
+}
+
+int EDepSim::LogManager::ResolveLogLevel(const char* trace,
+                                         TraceHandle& handle) {
+    if (!handle.fRegistered) {
+        handle.fRegistered = true;
+        handle.fNext = fTraceHandles;
+        fTraceHandles = &handle;
+    }
+    handle.fLevel = GetLogLevel(trace);
+    return handle.fLevel;
+}
+
+void EDepSim::LogManager::InvalidateTraces() {
+    for (TraceHandle* handle = fTraceHandles; handle; handle = handle->fNext) {
+        handle->fLevel = kUnresolvedLevel;
+    }
 }
 
 EDepSim::LogManager::LogPriority EDepSim::LogManager::GetLogLevel(const char* trace) {
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimPerformanceMonitor.hh"
+#include "EDepSimPerformanceMonitorMessenger.hh"
+#include "EDepSimLog.hh"
+
+#include <G4Event.hh>
+#include <G4HCofThisEvent.hh>
+#include <G4VHitsCollection.hh>
+#include <G4RunManager.hh>
+#include <G4Run.hh>
+
+#include <sys/resource.h>
+
+EDepSim::PerformanceMonitor* EDepSim::PerformanceMonitor::fThis = NULL;
+
+EDepSim::PerformanceMonitor::PerformanceMonitor()
+    : fEnabled(false), fSlowEventTime(0.0) {
+    BeginOfEvent();
+    fMessenger = new EDepSim::PerformanceMonitorMessenger(this);
+}
+
+EDepSim::PerformanceMonitor::~PerformanceMonitor() {
+    delete fMessenger;
+}
+
+const char* EDepSim::PerformanceMonitor::GetStageName(int stage) {
+    switch (stage) {
+    case kEvent: return "Event";
+    case kGeneration: return "Generation";
+    case kTracking: return "Tracking";
+    case kSummaries: return "Summaries";
+    case kMarkTrajectories: return "MarkTrajectories";
+    case kSummarizeTrajectories: return "SummarizeTrajectories";
+    case kSelectTrajectoryPoints: return "SelectTrajectoryPoints";
+    case kSummarizeSegmentDetectors: return "SummarizeSegmentDetectors";
+    case kFill: return "Fill";
+    default: break;
+    }
+    return "Unknown";
+}
+
+void EDepSim::PerformanceMonitor::BeginOfEvent() {
+    fRecord.RunId = -1;
+    fRecord.EventId = -1;
+    for (int i = 0; i < kStageCount; ++i) {
+        fRecord.WallTime[i] = 0.0;
+        fRecord.CPUTime[i] = 0.0;
+    }
+    fRecord.PeakMemory = 0.0;
+    fRecord.Steps = 0;
+    fRecord.Tracks = 0;
+    fRecord.Hits = 0;
+    if (fEnabled) Start(kEvent);
+}
+
+void EDepSim::PerformanceMonitor::Start(Stage stage) {
+    fWallStart[stage] = std::chrono::steady_clock::now();
+    fCPUStart[stage] = std::clock();
+}
+
+void EDepSim::PerformanceMonitor::Stop(Stage stage) {
+    std::chrono::duration<double> wall
+        = std::chrono::steady_clock::now() - fWallStart[stage];
+    fRecord.WallTime[stage] += wall.count();
+    fRecord.CPUTime[stage]
+        += double(std::clock() - fCPUStart[stage])/CLOCKS_PER_SEC;
+}
+
+void EDepSim::PerformanceMonitor::EndOfEvent(const G4Event* theEvent) {
+    if (!fEnabled) return;
+    Stop(kEvent);
+
+    const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+    if (run) fRecord.RunId = run->GetRunID();
+    fRecord.EventId = theEvent->GetEventID();
+
+    G4HCofThisEvent* HCofEvent = theEvent->GetHCofThisEvent();
+    if (HCofEvent) {
+        for (int i = 0; i < HCofEvent->GetNumberOfCollections(); ++i) {
+            G4VHitsCollection* hits = HCofEvent->GetHC(i);
+            if (hits) fRecord.Hits += hits->GetSize();
+        }
+    }
+
+    // The maximum resident set size is in kilobytes on Linux, and in bytes
+    // on macOS.
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        fRecord.PeakMemory = usage.ru_maxrss/(1024.0*1024.0);
+#else
+        fRecord.PeakMemory = usage.ru_maxrss/1024.0;
+#endif
+    }
+
+    EDepSimNamedInfo("Performance",
+                     "Event " << fRecord.EventId
+                     << " wall " << fRecord.WallTime[kEvent] << " s"
+                     << " cpu " << fRecord.CPUTime[kEvent] << " s"
+                     << " steps " << fRecord.Steps
+                     << " tracks " << fRecord.Tracks
+                     << " hits " << fRecord.Hits
+                     << " memory " << fRecord.PeakMemory << " MB");
+
+    if (fSlowEventTime > 0.0 && fRecord.WallTime[kEvent] > fSlowEventTime) {
+        EDepSimLog("Slow event " << fRecord.EventId
+                   << " in run " << fRecord.RunId
+                   << ": " << fRecord.WallTime[kEvent] << " s"
+                   << " with " << fRecord.Steps << " steps");
+        for (int i = kGeneration; i < kStageCount; ++i) {
+            EDepSimLog("    " << GetStageName(i)
+                       << ": " << fRecord.WallTime[i] << " s");
+        }
+    }
+}
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_PerformanceMonitor_hh_seen
+#define EDepSim_PerformanceMonitor_hh_seen
+
+#include <chrono>
+#include <ctime>
+#include <string>
+
+class G4Event;
+
+namespace EDepSim {class PerformanceMonitorMessenger;}
+
+namespace EDepSim {class PerformanceMonitor;}
+/// Record the time and resources used by each event.  The monitor is
+/// enabled with /edep/perf/enable, and then records the wall and CPU time
+/// spent in each stage of an event (see EDepSim::PerformanceMonitor::Stage),
+/// the peak resident memory of the job, and the number of steps, tracks and
+/// hits in the event.  The records are written by
+/// EDepSim::RootPersistencyManager to the EDepSimPerformance tree in the
+/// output file.  When the monitor is disabled, each instrumented point
+/// costs a single test.
+///
+/// The stage times are inclusive, so the SelectTrajectoryPoints time is
+/// part of the SummarizeTrajectories time, and the stages of
+/// UpdateSummaries are part of the Summaries time.
+class EDepSim::PerformanceMonitor {
+public:
+    /// The stages of an event that are timed.
+    enum Stage {
+        kEvent,                     ///< From generation to the tree fill.
+        kGeneration,                ///< GeneratePrimaries.
+        kTracking,                  ///< From Begin to EndOfEventAction.
+        kSummaries,                 ///< UpdateSummaries.
+        kMarkTrajectories,          ///< MarkTrajectories.
+        kSummarizeTrajectories,     ///< SummarizeTrajectories.
+        kSelectTrajectoryPoints,    ///< SelectTrajectoryPoints.
+        kSummarizeSegmentDetectors, ///< SummarizeSegmentDetectors.
+        kFill,                      ///< The event tree fill.
+        kStageCount
+    };
+
+    /// The performance record for an event.
+    struct EventRecord {
+        int RunId;
+        int EventId;
+        /// The wall time for each stage (seconds).
+        double WallTime[kStageCount];
+        /// The CPU time for each stage (seconds).
+        double CPUTime[kStageCount];
+        /// The peak resident memory of the job at the end of the event (MB).
+        double PeakMemory;
+        /// The number of steps in the event.
+        long Steps;
+        /// The number of tracks in the event.
+        long Tracks;
+        /// The number of hits in the sensitive detectors.
+        long Hits;
+    };
+
+    /// Time a stage from construction to destruction.
+    class Scope {
+    public:
+        explicit Scope(Stage stage)
+            : fStage(stage),
+              fActive(EDepSim::PerformanceMonitor::Get()->IsEnabled()) {
+            if (fActive) EDepSim::PerformanceMonitor::Get()->Start(fStage);
+        }
+        ~Scope() {
+            if (fActive) EDepSim::PerformanceMonitor::Get()->Stop(fStage);
+        }
+    private:
+        Stage fStage;
+        bool fActive;
+    };
+
+    /// Get the monitor.
+    static EDepSim::PerformanceMonitor* Get() {
+        if (!fThis) fThis = new EDepSim::PerformanceMonitor();
+        return fThis;
+    }
+
+    virtual ~PerformanceMonitor();
+
+    /// Enable (or disable) the monitor.
+    void SetEnabled(bool enabled) {fEnabled = enabled;}
+
+    /// Check if the monitor is recording.
+    bool IsEnabled() const {return fEnabled;}
+
+    /// Set the wall time above which an event is reported in the log.  A
+    /// value of zero (the default) doesn't report any events.
+    void SetSlowEventTime(double seconds) {fSlowEventTime = seconds;}
+
+    /// Start a new event.  This is called before the primaries are
+    /// generated.
+    void BeginOfEvent();
+
+    /// Finish the event record.  This is called after the event is saved.
+    void EndOfEvent(const G4Event* theEvent);
+
+    /// Start timing a stage.
+    void Start(Stage stage);
+
+    /// Stop timing a stage, and add the time to the record.
+    void Stop(Stage stage);
+
+    /// Count a step (and a track if this is the first step of the track).
+    void CountStep(bool firstStep) {
+        ++fRecord.Steps;
+        if (firstStep) ++fRecord.Tracks;
+    }
+
+    /// Get the record for the current (or last finished) event.
+    const EventRecord& GetRecord() const {return fRecord;}
+    EventRecord& GetRecord() {return fRecord;}
+
+    /// Get the name of a stage.
+    static const char* GetStageName(int stage);
+
+private:
+    PerformanceMonitor();
+
+    /// The pointer to the monitor.
+    static EDepSim::PerformanceMonitor* fThis;
+
+    /// True if the monitor is recording.
+    bool fEnabled;
+
+    /// The event wall time above which the event is logged.
+    double fSlowEventTime;
+
+    /// The record being filled.
+    EventRecord fRecord;
+
+    /// The start times of the stages being timed.
+    std::chrono::steady_clock::time_point fWallStart[kStageCount];
+    std::clock_t fCPUStart[kStageCount];
+
+    /// The messenger for this monitor.
+    EDepSim::PerformanceMonitorMessenger* fMessenger;
+};
+#endif
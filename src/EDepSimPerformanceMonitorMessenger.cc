@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimPerformanceMonitorMessenger.hh"
+#include "EDepSimPerformanceMonitor.hh"
+#include "EDepSimStepStatistics.hh"
+
+#include <G4UIdirectory.hh>
+#include <G4UIcmdWithABool.hh>
+#include <G4UIcmdWithADoubleAndUnit.hh>
+#include <G4UIcmdWithAnInteger.hh>
+#include <G4UIcmdWithAString.hh>
+
+#include <G4SystemOfUnits.hh>
+
+EDepSim::PerformanceMonitorMessenger::PerformanceMonitorMessenger(
+    EDepSim::PerformanceMonitor* monitor)
+    : fMonitor(monitor) {
+    fDirectory = new G4UIdirectory("/edep/perf/");
+    fDirectory->SetGuidance(
+        "Record the time and resources used by each event.");
+
+    fEnableCMD = new G4UIcmdWithABool("/edep/perf/enable",this);
+    fEnableCMD->SetGuidance(
+        "Record the time spent in each stage of an event, the memory,"
+        " and the number of steps, tracks and hits.  The records are"
+        " saved in the EDepSimPerformance tree of the output file.");
+    fEnableCMD->SetParameterName("enable",true);
+    fEnableCMD->SetDefaultValue(true);
+    fEnableCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fSlowEventCMD = new G4UIcmdWithADoubleAndUnit("/edep/perf/slowEvent",
+                                                  this);
+    fSlowEventCMD->SetGuidance(
+        "Log the stage times of events that take longer than a wall time"
+        " (zero turns this off).");
+    fSlowEventCMD->SetParameterName("time",false);
+    fSlowEventCMD->SetUnitCategory("Time");
+    fSlowEventCMD->SetDefaultUnit("s");
+    fSlowEventCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fStepsCMD = new G4UIcmdWithABool("/edep/perf/steps",this);
+    fStepsCMD->SetGuidance(
+        "Count the steps, CPU time, and length in each logical volume, for"
+        " each particle and for each process.  The ranked tables are"
+        " printed at the end of the run.");
+    fStepsCMD->SetParameterName("enable",true);
+    fStepsCMD->SetDefaultValue(true);
+    fStepsCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fStepSampleCMD = new G4UIcmdWithAnInteger("/edep/perf/stepSample",this);
+    fStepSampleCMD->SetGuidance(
+        "Time one step out of every N steps (zero turns off the timing).");
+    fStepSampleCMD->SetParameterName("period",false);
+    fStepSampleCMD->SetRange("period >= 0");
+    fStepSampleCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fStepRowsCMD = new G4UIcmdWithAnInteger("/edep/perf/stepRows",this);
+    fStepRowsCMD->SetGuidance(
+        "Set the number of rows of each step table that are printed"
+        " (zero prints every row).");
+    fStepRowsCMD->SetParameterName("rows",false);
+    fStepRowsCMD->SetRange("rows >= 0");
+    fStepRowsCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fStepTableCMD = new G4UIcmdWithAString("/edep/perf/stepTable",this);
+    fStepTableCMD->SetGuidance(
+        "Write the full step tables to a text file at the end of each run.");
+    fStepTableCMD->SetParameterName("file",false);
+    fStepTableCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+EDepSim::PerformanceMonitorMessenger::~PerformanceMonitorMessenger() {
+    delete fEnableCMD;
+    delete fSlowEventCMD;
+    delete fStepsCMD;
+    delete fStepSampleCMD;
+    delete fStepRowsCMD;
+    delete fStepTableCMD;
+    delete fDirectory;
+}
+
+void EDepSim::PerformanceMonitorMessenger::SetNewValue(G4UIcommand* command,
+                                                       G4String newValue) {
+    if (command == fEnableCMD) {
+        fMonitor->SetEnabled(fEnableCMD->GetNewBoolValue(newValue));
+    }
+    else if (command == fSlowEventCMD) {
+        fMonitor->SetSlowEventTime(
+            fSlowEventCMD->GetNewDoubleValue(newValue)/s);
+    }
+    else if (command == fStepsCMD) {
+        EDepSim::StepStatistics::Get()->SetEnabled(
+            fStepsCMD->GetNewBoolValue(newValue));
+    }
+    else if (command == fStepSampleCMD) {
+        EDepSim::StepStatistics::Get()->SetSamplePeriod(
+            fStepSampleCMD->GetNewIntValue(newValue));
+    }
+    else if (command == fStepRowsCMD) {
+        EDepSim::StepStatistics::Get()->SetPrintRows(
+            fStepRowsCMD->GetNewIntValue(newValue));
+    }
+    else if (command == fStepTableCMD) {
+        EDepSim::StepStatistics::Get()->SetTableFile(newValue);
+    }
+}
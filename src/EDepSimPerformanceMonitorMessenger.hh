@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_PerformanceMonitorMessenger_hh_seen
+#define EDepSim_PerformanceMonitorMessenger_hh_seen
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithAString;
+
+namespace EDepSim {class PerformanceMonitor;}
+
+namespace EDepSim {class PerformanceMonitorMessenger;}
+/// Control the per event performance monitor, and the step statistics
+/// collected by EDepSim::StepStatistics.
+class EDepSim::PerformanceMonitorMessenger: public G4UImessenger {
+public:
+    PerformanceMonitorMessenger(EDepSim::PerformanceMonitor* monitor);
+    virtual ~PerformanceMonitorMessenger();
+
+    void SetNewValue(G4UIcommand* command, G4String newValue);
+
+private:
+    EDepSim::PerformanceMonitor* fMonitor;
+
+    G4UIdirectory*             fDirectory;
+    G4UIcmdWithABool*          fEnableCMD;
+    G4UIcmdWithADoubleAndUnit* fSlowEventCMD;
+    G4UIcmdWithABool*          fStepsCMD;
+    G4UIcmdWithAnInteger*      fStepSampleCMD;
+    G4UIcmdWithAnInteger*      fStepRowsCMD;
+    G4UIcmdWithAString*        fStepTableCMD;
+};
+#endif
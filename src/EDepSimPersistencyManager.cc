@@ -14,6 +14,8 @@
 #include "EDepSimHitSurface.hh"
 #include "EDepSimException.hh"
 #include "EDepSimUserRunAction.hh"
+#include "EDepSimUserEventInformation.hh"
+#include "EDepSimPerformanceMonitor.hh"
 #include "EDepSimLog.hh"
 
 #include <G4ios.hh>
@@ -77,6 +79,7 @@ G4bool EDepSim::PersistencyManager::Close(void) {
 // This is called by the G4RunManager during AnalyzeEvent.
 G4bool EDepSim::PersistencyManager::Store(const G4Event* anEvent) {
     UpdateSummaries(anEvent);
+    EDepSim::PerformanceMonitor::Get()->EndOfEvent(anEvent);
     return false;
 }
 
@@ -172,30 +175,49 @@ bool EDepSim::PersistencyManager::SaveTrajectoryBoundary(G4VTrajectory* g4Traj,
 }
 
 void EDepSim::PersistencyManager::UpdateSummaries(const G4Event* event) {
+    EDepSim::PerformanceMonitor::Scope timer(
+        EDepSim::PerformanceMonitor::kSummaries);
 
     const G4Run* runInfo = G4RunManager::GetRunManager()->GetCurrentRun();
 
     fEventSummary.RunId = runInfo->GetRunID();
     fEventSummary.EventId = event->GetEventID();
+    fEventSummary.RandomSeed = 0;
+    const EDepSim::UserEventInformation* eventInfo
+        = dynamic_cast<const EDepSim::UserEventInformation*>(
+            event->GetUserInformation());
+    if (eventInfo) fEventSummary.RandomSeed = eventInfo->GetRandomSeed();
     EDepSimLog("Event Summary for run " << fEventSummary.RunId
                << " event " << fEventSummary.EventId);
 
     // Summarize the trajectories first. This goes through the
     // EDepSim::TrajectoryContainer and marks the trajectory objects that
     // should be saved.
-    MarkTrajectories(event);
+    {
+        EDepSim::PerformanceMonitor::Scope stage(
+            EDepSim::PerformanceMonitor::kMarkTrajectories);
+        MarkTrajectories(event);
+    }
 
     SummarizePrimaries(fEventSummary.Primaries,event->GetPrimaryVertex());
     EDepSimLog("   Primaries " << fEventSummary.Primaries.size());
 
-    SummarizeTrajectories(fEventSummary.Trajectories,event);
+    {
+        EDepSim::PerformanceMonitor::Scope stage(
+            EDepSim::PerformanceMonitor::kSummarizeTrajectories);
+        SummarizeTrajectories(fEventSummary.Trajectories,event);
+    }
     EDepSimLog("   Trajectories " << fEventSummary.Trajectories.size());
 
     SummarizePhotonDetectors(fEventSummary.PhotonDetectors, event);
     EDepSimLog("   Photon Detectors "
                << fEventSummary.PhotonDetectors.size());
 
-    SummarizeSegmentDetectors(fEventSummary.SegmentDetectors, event);
+    {
+        EDepSim::PerformanceMonitor::Scope stage(
+            EDepSim::PerformanceMonitor::kSummarizeSegmentDetectors);
+        SummarizeSegmentDetectors(fEventSummary.SegmentDetectors, event);
+    }
     EDepSimLog("   Segment Detectors "
                << fEventSummary.SegmentDetectors.size());
 }
@@ -653,6 +675,7 @@ EDepSim::PersistencyManager::SummarizePhotonHits(TG4PhotonHitContainer& dest,
         hit.PrimaryId = primaryId;
         hit.Process = g4HitSurf->GetProcessSubtype();
         hit.EnergyDeposit = g4HitSurf->GetEnergyDeposit();
+        hit.Count = g4HitSurf->GetCount();
         hit.Start.SetXYZT(g4HitSurf->GetStart().x(),
                           g4HitSurf->GetStart().y(),
                           g4HitSurf->GetStart().z(),
@@ -808,6 +831,8 @@ int EDepSim::PersistencyManager::SplitTrajectory(G4VTrajectory* g4Traj,
 void
 EDepSim::PersistencyManager::SelectTrajectoryPoints(std::vector<int>& selected,
                                                     G4VTrajectory* g4Traj) {
+    EDepSim::PerformanceMonitor::Scope timer(
+        EDepSim::PerformanceMonitor::kSelectTrajectoryPoints);
 
     selected.clear();
 
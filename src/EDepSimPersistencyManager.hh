@@ -247,6 +247,12 @@ protected:
     /// A summary of the primary vertices in the event.
     TG4Event fEventSummary;
 
+    /// Fill a vector with the indices of trajectory points that should be
+    /// copied to the output file.  This is protected so it can be timed
+    /// on its own (see edep-microbench).
+    void SelectTrajectoryPoints(std::vector<int>& selected,
+                                G4VTrajectory* g4Traj);
+
 private:
     // Fill the vertex container.  This allows informational vertices to be
     // filled.
@@ -300,11 +306,6 @@ private:
     /// the trajectory accuracy.
     int SplitTrajectory(G4VTrajectory* traj, int point1, int point2);
 
-    /// Fill a vector with the indices of trajectory points that should be
-    /// copied to the output file.
-    void SelectTrajectoryPoints(std::vector<int>& selected,
-                                G4VTrajectory* g4Traj);
-
     /// Return true if a trajectory point should be saved.  The decision is
     /// based on the stepping status (must be fGeomBoundary), the current and
     /// the previous volume name (one must match a trajectory boundary regexp,
@@ -4,6 +4,7 @@
 #include "EDepSimPersistencyMessenger.hh"
 #include "EDepSimPersistencyManager.hh"
 #include "EDepSimUserTrackingAction.hh"
+#include "EDepSimCheckpointManager.hh"
 #include "EDepSimLog.hh"
 
 #include <G4UIdirectory.hh>
@@ -31,6 +32,20 @@ EDepSim::PersistencyMessenger::PersistencyMessenger(
     fCloseCMD = new G4UIcmdWithoutParameter("/edep/db/close",this);
     fCloseCMD->SetGuidance("Close the output file.");
 
+    fCheckpointCMD = new G4UIcmdWithAnInteger("/edep/db/checkpoint",this);
+    fCheckpointCMD->SetGuidance(
+        "Save a checkpoint after every N events so the job can be restarted"
+        " with /edep/db/restart.  Zero turns off the checkpoints.");
+    fCheckpointCMD->SetParameterName("events",false);
+    fCheckpointCMD->SetRange("events >= 0");
+
+    fRestartCMD = new G4UIcmdWithoutParameter("/edep/db/restart",this);
+    fRestartCMD->SetGuidance(
+        "Restart from the last checkpoint in the output file.  This must be"
+        " used before /edep/db/open, and the job must use the same commands"
+        " as the job that saved the checkpoint.");
+    fRestartCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
     fPersistencySetDIR = new G4UIdirectory("/edep/db/set/");
     fPersistencySetDIR->SetGuidance("Set various parameters");
 
@@ -160,6 +175,8 @@ EDepSim::PersistencyMessenger::PersistencyMessenger(
 EDepSim::PersistencyMessenger::~PersistencyMessenger() {
     delete fOpenCMD;
     delete fCloseCMD;
+    delete fCheckpointCMD;
+    delete fRestartCMD;
     delete fGammaThresholdCMD;
     delete fNeutronThresholdCMD;
     delete fLengthThresholdCMD;
@@ -185,6 +202,13 @@ void EDepSim::PersistencyMessenger::SetNewValue(G4UIcommand* command,
     else if (command == fCloseCMD) {
         fPersistencyManager->Close();
     }
+    else if (command == fCheckpointCMD) {
+        EDepSim::CheckpointManager::Get()->SetPeriod(
+            fCheckpointCMD->GetNewIntValue(newValue));
+    }
+    else if (command == fRestartCMD) {
+        EDepSim::CheckpointManager::Get()->SetRestart(true);
+    }
     else if (command == fGammaThresholdCMD) {
         fPersistencyManager->SetGammaThreshold(
             fGammaThresholdCMD->GetNewDoubleValue(newValue));
@@ -260,6 +284,10 @@ G4String EDepSim::PersistencyMessenger::GetCurrentValue(G4UIcommand * command) {
     if (command==fOpenCMD) {
         currentValue = fPersistencyManager->GetFilename();
     }
+    else if (command==fCheckpointCMD) {
+        currentValue = fCheckpointCMD->ConvertToString(
+            EDepSim::CheckpointManager::Get()->GetPeriod());
+    }
     else if (command==fGammaThresholdCMD) {
         currentValue = fGammaThresholdCMD->ConvertToString(
             fPersistencyManager->GetGammaThreshold());
@@ -31,6 +31,8 @@ private:
     G4UIdirectory*             fPersistencySetDIR;
     G4UIcmdWithAString*        fOpenCMD;
     G4UIcmdWithoutParameter*   fCloseCMD;
+    G4UIcmdWithAnInteger*      fCheckpointCMD;
+    G4UIcmdWithoutParameter*   fRestartCMD;
     G4UIcmdWithADoubleAndUnit* fGammaThresholdCMD;
     G4UIcmdWithADoubleAndUnit* fNeutronThresholdCMD;
     G4UIcmdWithADoubleAndUnit* fLengthThresholdCMD;
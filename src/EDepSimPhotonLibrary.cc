@@ -0,0 +1,314 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimPhotonLibrary.hh"
+
+#include "EDepSimLog.hh"
+
+#include <Randomize.hh>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // The header of the photon library file.  The header is followed by a
+    // DetectorRecord for each photon detector, the visibilities (a float
+    // for each detector and voxel), and the cumulative arrival time
+    // distributions (a float for each detector, voxel and time bin).  The
+    // values are in the native byte order.
+    struct LibraryHeader {
+        // The file type.  This is "EDSPLIB" with a terminating null.
+        char fMagic[8];
+        // The format version.
+        std::uint32_t fVersion;
+        // A known value used to check the byte order.
+        std::uint32_t fByteOrder;
+        // The number of voxels along each axis.
+        std::int32_t fSize[3];
+        // The number of arrival time bins.
+        std::int32_t fTimeBins;
+        // The number of photon detectors.
+        std::int32_t fDetectors;
+        // Padding to align the doubles.
+        std::int32_t fPadding;
+        // The low corner of the library box (mm).
+        double fLow[3];
+        // The size of a voxel (mm).
+        double fDelta[3];
+        // The width of an arrival time bin (ns).
+        double fTimeBinWidth;
+    };
+
+    // The summary of a photon detector in the library file.
+    struct DetectorRecord {
+        // The sensitive detector name.
+        char fName[64];
+        // The average position of the detected photons (mm).
+        double fPosition[3];
+        // The average energy of the detected photons (MeV).
+        double fEnergy;
+    };
+
+    const char* const kLibraryMagic = "EDSPLIB";
+    const std::uint32_t kLibraryVersion = 1;
+    const std::uint32_t kLibraryByteOrder = 0x01020304;
+}
+
+EDepSim::PhotonLibrary::PhotonLibrary()
+    : fLow(0,0,0), fDelta(1,1,1), fTimeBins(1), fTimeBinWidth(1.0) {
+    fSize[0] = fSize[1] = fSize[2] = 0;
+}
+
+EDepSim::PhotonLibrary::~PhotonLibrary() {}
+
+void EDepSim::PhotonLibrary::SetGrid(const G4ThreeVector& low,
+                                     const G4ThreeVector& high,
+                                     int nx, int ny, int nz) {
+    fLow = low;
+    fSize[0] = std::max(nx,1);
+    fSize[1] = std::max(ny,1);
+    fSize[2] = std::max(nz,1);
+    fDelta.set((high.x()-low.x())/fSize[0],
+               (high.y()-low.y())/fSize[1],
+               (high.z()-low.z())/fSize[2]);
+    Resize();
+}
+
+void EDepSim::PhotonLibrary::SetTimeBins(int bins, double width) {
+    fTimeBins = std::max(bins,1);
+    fTimeBinWidth = width;
+    Resize();
+}
+
+void EDepSim::PhotonLibrary::Clear() {
+    fDetectors.clear();
+    Resize();
+}
+
+void EDepSim::PhotonLibrary::Resize() {
+    std::size_t voxels = GetVoxelCount();
+    std::size_t cells = fDetectors.size()*voxels;
+    fEmitted.assign(voxels, 0.0);
+    fDetected.assign(cells*fTimeBins, 0.0);
+    std::vector<float>().swap(fVisibility);
+    std::vector<float>().swap(fTimeCDF);
+    for (std::vector<Detector>::iterator d = fDetectors.begin();
+         d != fDetectors.end(); ++d) {
+        d->fPositionSum.set(0,0,0);
+        d->fEnergySum = 0.0;
+        d->fCount = 0.0;
+    }
+}
+
+int EDepSim::PhotonLibrary::GetVoxel(const G4ThreeVector& pos) const {
+    int index = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        double p = std::floor((pos[axis] - fLow[axis])/fDelta[axis]);
+        if (p < 0 || p >= fSize[axis]) return -1;
+        index = index*fSize[axis] + (int) p;
+    }
+    return index;
+}
+
+int EDepSim::PhotonLibrary::FindDetector(const std::string& name) const {
+    for (std::size_t d = 0; d < fDetectors.size(); ++d) {
+        if (fDetectors[d].fName == name) return d;
+    }
+    return -1;
+}
+
+int EDepSim::PhotonLibrary::AddDetector(const std::string& name) {
+    int detector = FindDetector(name);
+    if (detector >= 0) return detector;
+
+    Detector newDetector;
+    newDetector.fName = name;
+    newDetector.fPosition.set(0,0,0);
+    newDetector.fEnergy = 0.0;
+    newDetector.fPositionSum.set(0,0,0);
+    newDetector.fEnergySum = 0.0;
+    newDetector.fCount = 0.0;
+    fDetectors.push_back(newDetector);
+
+    // The contents are ordered by detector, so the new detector is added to
+    // the end.
+    std::size_t cells = fDetectors.size()*GetVoxelCount();
+    fDetected.resize(cells*fTimeBins, 0.0);
+    return fDetectors.size() - 1;
+}
+
+void EDepSim::PhotonLibrary::AddEmitted(int voxel, double photons) {
+    if (voxel < 0) return;
+    fEmitted[voxel] += photons;
+}
+
+void EDepSim::PhotonLibrary::AddDetected(int voxel, int detector,
+                                         double time,
+                                         const G4ThreeVector& position,
+                                         double energy) {
+    if (voxel < 0 || detector < 0) return;
+    // Clamp before converting so a very late photon can't overflow the bin.
+    double t = std::floor(time/fTimeBinWidth);
+    int bin = std::max(0.0, std::min(t, fTimeBins-1.0));
+    std::size_t cell = (std::size_t) detector*GetVoxelCount() + voxel;
+    fDetected[cell*fTimeBins + bin] += 1.0;
+    Detector& det = fDetectors[detector];
+    det.fPositionSum += position;
+    det.fEnergySum += energy;
+    det.fCount += 1.0;
+}
+
+double EDepSim::PhotonLibrary::SampleTime(int voxel, int detector) const {
+    std::size_t cell = (std::size_t) detector*GetVoxelCount() + voxel;
+    std::vector<float>::const_iterator begin
+        = fTimeCDF.begin() + cell*fTimeBins;
+    std::vector<float>::const_iterator end = begin + fTimeBins;
+    std::vector<float>::const_iterator bin
+        = std::upper_bound(begin, end, (float) G4UniformRand());
+    if (bin == end) --bin;
+    return ((bin - begin) + G4UniformRand())*fTimeBinWidth;
+}
+
+bool EDepSim::PhotonLibrary::Write(const std::string& fname) const {
+    LibraryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.fMagic, kLibraryMagic, sizeof(header.fMagic));
+    header.fVersion = kLibraryVersion;
+    header.fByteOrder = kLibraryByteOrder;
+    for (int i = 0; i < 3; ++i) {
+        header.fSize[i] = fSize[i];
+        header.fLow[i] = fLow[i];
+        header.fDelta[i] = fDelta[i];
+    }
+    header.fTimeBins = fTimeBins;
+    header.fDetectors = fDetectors.size();
+    header.fTimeBinWidth = fTimeBinWidth;
+
+    std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        EDepSimError("Can't write " << fname);
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (std::vector<Detector>::const_iterator d = fDetectors.begin();
+         d != fDetectors.end(); ++d) {
+        DetectorRecord record;
+        std::memset(&record, 0, sizeof(record));
+        std::strncpy(record.fName, d->fName.c_str(), sizeof(record.fName)-1);
+        if (d->fCount > 0) {
+            G4ThreeVector position = d->fPositionSum/d->fCount;
+            for (int i = 0; i < 3; ++i) record.fPosition[i] = position[i];
+            record.fEnergy = d->fEnergySum/d->fCount;
+        }
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    // Turn the photon counts into the visibilities and the cumulative
+    // arrival time distributions.
+    const std::size_t voxels = GetVoxelCount();
+    const std::size_t cells = fDetectors.size()*voxels;
+    std::vector<float> visibility(cells, 0.0);
+    std::vector<float> timeCDF(cells*fTimeBins, 1.0);
+    for (std::size_t cell = 0; cell < cells; ++cell) {
+        const double* counts = &fDetected[cell*fTimeBins];
+        double total = 0.0;
+        for (int bin = 0; bin < fTimeBins; ++bin) total += counts[bin];
+        if (total <= 0.0) continue;
+        double emitted = fEmitted[cell % voxels];
+        if (emitted > 0.0) visibility[cell] = total/emitted;
+        double sum = 0.0;
+        for (int bin = 0; bin < fTimeBins; ++bin) {
+            sum += counts[bin];
+            timeCDF[cell*fTimeBins + bin] = sum/total;
+        }
+    }
+    out.write(reinterpret_cast<const char*>(visibility.data()),
+              visibility.size()*sizeof(float));
+    out.write(reinterpret_cast<const char*>(timeCDF.data()),
+              timeCDF.size()*sizeof(float));
+    if (!out) {
+        EDepSimError("Error writing " << fname);
+        return false;
+    }
+    return true;
+}
+
+bool EDepSim::PhotonLibrary::Read(const std::string& fname) {
+    std::ifstream in(fname, std::ios::binary);
+    if (!in.is_open()) {
+        EDepSimError("Can't read " << fname);
+        return false;
+    }
+
+    LibraryHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in
+        || std::memcmp(header.fMagic, kLibraryMagic, sizeof(header.fMagic))
+        || header.fVersion != kLibraryVersion
+        || header.fByteOrder != kLibraryByteOrder) {
+        EDepSimError("Unsupported photon library format in " << fname);
+        return false;
+    }
+
+    // The voxel count must fit in the int returned by GetVoxelCount().
+    bool valid = header.fTimeBins > 0 && header.fDetectors >= 0;
+    int voxels = 1;
+    for (int i = 0; valid && i < 3; ++i) {
+        valid = header.fSize[i] > 0 && voxels <= INT_MAX/header.fSize[i];
+        if (valid) voxels *= header.fSize[i];
+    }
+    if (!valid) {
+        EDepSimError("Photon library " << fname << " has an invalid size");
+        return false;
+    }
+
+    fDetectors.clear();
+    for (int i = 0; i < 3; ++i) {
+        fSize[i] = header.fSize[i];
+        fLow[i] = header.fLow[i];
+        fDelta[i] = header.fDelta[i];
+    }
+    fTimeBins = header.fTimeBins;
+    fTimeBinWidth = header.fTimeBinWidth;
+
+    for (int d = 0; d < header.fDetectors; ++d) {
+        DetectorRecord record;
+        in.read(reinterpret_cast<char*>(&record), sizeof(record));
+        record.fName[sizeof(record.fName)-1] = 0;
+        Detector detector;
+        detector.fName = record.fName;
+        detector.fPosition.set(record.fPosition[0],
+                               record.fPosition[1],
+                               record.fPosition[2]);
+        detector.fEnergy = record.fEnergy;
+        fDetectors.push_back(detector);
+    }
+
+    // A library that is read is only applied, so the tables used to build
+    // a library aren't needed.
+    const std::size_t cells = fDetectors.size()*GetVoxelCount();
+    std::vector<double>().swap(fEmitted);
+    std::vector<double>().swap(fDetected);
+    fVisibility.assign(cells, 0.0);
+    fTimeCDF.assign(cells*fTimeBins, 1.0);
+
+    in.read(reinterpret_cast<char*>(fVisibility.data()),
+            fVisibility.size()*sizeof(float));
+    in.read(reinterpret_cast<char*>(fTimeCDF.data()),
+            fTimeCDF.size()*sizeof(float));
+    if (!in) {
+        EDepSimError("Photon library " << fname << " is truncated");
+        fDetectors.clear();
+        Resize();
+        return false;
+    }
+
+    EDepSimLog("Read photon library " << fname
+               << " with " << GetVoxelCount() << " voxels"
+               << " and " << GetDetectorCount() << " photon detectors");
+    return true;
+}
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_PhotonLibrary_hh_seen
+#define EDepSim_PhotonLibrary_hh_seen
+
+#include <G4ThreeVector.hh>
+
+#include <string>
+#include <vector>
+
+namespace EDepSim {class PhotonLibrary;}
+/// A voxelized table of the response of the photon detectors to the optical
+/// photons produced in the detector.  The volume covered by the library is a
+/// box (in global coordinates) that is divided into a regular grid of voxels.
+/// For each voxel and each photon detector the library holds the visibility
+/// (the probability that a photon emitted isotropically from the voxel is
+/// detected), and the distribution of the photon arrival time relative to
+/// the emission time.  A photon detector is an EDepSim::SurfaceSD and is
+/// identified by the sensitive detector name.  The library also holds the
+/// average position where the photons were detected, and the average energy
+/// of the detected photons for each photon detector.
+///
+/// The library is filled by a simulation that generates optical photons
+/// inside the library volume (see EDepSim::PhotonLibraryManager).  The
+/// number of photons generated in each voxel is added using AddEmitted(),
+/// and each detected photon is added with AddDetected().  The visibilities
+/// and time distributions are calculated when the library is written.
+class EDepSim::PhotonLibrary {
+public:
+    PhotonLibrary();
+    virtual ~PhotonLibrary();
+
+    /// Set the box covered by the library, and the number of voxels along
+    /// each axis.  This clears the library contents.
+    void SetGrid(const G4ThreeVector& low, const G4ThreeVector& high,
+                 int nx, int ny, int nz);
+
+    /// Set the number of arrival time bins, and the width of each bin.
+    /// Photons arriving after the last bin are counted in the last bin.
+    /// This clears the library contents.
+    void SetTimeBins(int bins, double width);
+
+    /// Remove the photon detectors, and clear the library contents.
+    void Clear();
+
+    /// Read a library written by Write().  This returns false if the
+    /// library cannot be read.
+    bool Read(const std::string& fname);
+
+    /// Write the library.  The visibilities and arrival time distributions
+    /// are calculated from the photons that have been added.  This returns
+    /// false if the file cannot be written.
+    bool Write(const std::string& fname) const;
+
+    /// Return the voxel containing a position, or -1 if the position is
+    /// outside of the library.
+    int GetVoxel(const G4ThreeVector& pos) const;
+
+    /// Return the number of voxels.
+    int GetVoxelCount() const {return fSize[0]*fSize[1]*fSize[2];}
+
+    /// Return the number of photon detectors.
+    int GetDetectorCount() const {return fDetectors.size();}
+
+    /// Return the (sensitive detector) name of a photon detector.
+    const std::string& GetDetectorName(int detector) const {
+        return fDetectors[detector].fName;
+    }
+
+    /// Return the index of a photon detector, or -1 if it is not in the
+    /// library.
+    int FindDetector(const std::string& name) const;
+
+    /// Return the index of a photon detector, and add it to the library if
+    /// it does not exist.
+    int AddDetector(const std::string& name);
+
+    /// Add photons emitted in a voxel while the library is being filled.
+    void AddEmitted(int voxel, double photons);
+
+    /// Add a photon emitted in a voxel that was detected.  The time is the
+    /// time between emission and detection, the position is where the
+    /// photon was detected, and energy is the photon energy.
+    void AddDetected(int voxel, int detector, double time,
+                     const G4ThreeVector& position, double energy);
+
+    /// Return the probability that a photon emitted in a voxel is seen by a
+    /// photon detector.
+    double GetVisibility(int voxel, int detector) const {
+        return fVisibility[(std::size_t) detector*GetVoxelCount() + voxel];
+    }
+
+    /// Draw a photon arrival time (relative to the emission time) for a
+    /// voxel and photon detector.
+    double SampleTime(int voxel, int detector) const;
+
+    /// Return the average position of the photons seen by a detector.
+    const G4ThreeVector& GetDetectorPosition(int detector) const {
+        return fDetectors[detector].fPosition;
+    }
+
+    /// Return the average energy of the photons seen by a detector.
+    double GetDetectorEnergy(int detector) const {
+        return fDetectors[detector].fEnergy;
+    }
+
+private:
+    /// The summary of a photon detector.
+    struct Detector {
+        /// The sensitive detector name.
+        std::string fName;
+        /// The average detected position.
+        G4ThreeVector fPosition;
+        /// The average photon energy.
+        double fEnergy;
+        /// The sums used to fill the averages.
+        G4ThreeVector fPositionSum;
+        double fEnergySum;
+        double fCount;
+    };
+
+    /// Allocate the tables that are filled while the library is built for
+    /// the current grid, time bins and photon detectors.  The tables that
+    /// are read by Read() are released.
+    void Resize();
+
+    /// The low corner of the library box.
+    G4ThreeVector fLow;
+
+    /// The size of a voxel.
+    G4ThreeVector fDelta;
+
+    /// The number of voxels along each axis.
+    int fSize[3];
+
+    /// The number of arrival time bins.
+    int fTimeBins;
+
+    /// The width of an arrival time bin.
+    double fTimeBinWidth;
+
+    /// The photon detectors.
+    std::vector<Detector> fDetectors;
+
+    /// The number of photons emitted in each voxel (while filling).
+    std::vector<double> fEmitted;
+
+    /// The number of detected photons for each detector, voxel and time
+    /// bin (while filling).  This is a double so it keeps counting past
+    /// the 2^24 photons where a float stops changing.
+    std::vector<double> fDetected;
+
+    /// The visibility for each detector and voxel (after reading).
+    std::vector<float> fVisibility;
+
+    /// The cumulative arrival time distribution for each detector, voxel
+    /// and time bin (after reading).
+    std::vector<float> fTimeCDF;
+};
+#endif
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimPhotonLibraryManager.hh"
+#include "EDepSimPhotonLibraryMessenger.hh"
+#include "EDepSimSurfaceSD.hh"
+#include "EDepSimHitSurface.hh"
+#include "EDepSimException.hh"
+#include "EDepSimLog.hh"
+
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4Track.hh>
+#include <G4Event.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4SDManager.hh>
+#include <G4Material.hh>
+#include <G4MaterialPropertiesTable.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4OpProcessSubType.hh>
+#include <G4ProcessType.hh>
+#include <G4Poisson.hh>
+#include <Randomize.hh>
+
+#include <G4SystemOfUnits.hh>
+
+#include <cmath>
+#include <sstream>
+
+EDepSim::PhotonLibraryManager* EDepSim::PhotonLibraryManager::fThis = NULL;
+
+EDepSim::PhotonLibraryManager* EDepSim::PhotonLibraryManager::Get() {
+    if (!fThis) fThis = new EDepSim::PhotonLibraryManager();
+    return fThis;
+}
+
+EDepSim::PhotonLibraryManager::PhotonLibraryManager()
+    : fMode(kOff), fDetectorsFound(false) {
+    fLibrary.SetGrid(G4ThreeVector(-1*m,-1*m,-1*m),
+                     G4ThreeVector(1*m,1*m,1*m), 20, 20, 20);
+    fLibrary.SetTimeBins(100, 1*ns);
+    fMessenger = new EDepSim::PhotonLibraryMessenger(this);
+}
+
+EDepSim::PhotonLibraryManager::~PhotonLibraryManager() {
+    delete fMessenger;
+}
+
+void EDepSim::PhotonLibraryManager::SetGrid(const G4ThreeVector& low,
+                                            const G4ThreeVector& high,
+                                            int nx, int ny, int nz) {
+    fLibrary.SetGrid(low, high, nx, ny, nz);
+}
+
+void EDepSim::PhotonLibraryManager::SetTimeBins(int bins, double width) {
+    fLibrary.SetTimeBins(bins, width);
+}
+
+void EDepSim::PhotonLibraryManager::Build(const std::string& fname) {
+    fLibrary.Clear();
+    fFileName = fname;
+    fMode = kBuild;
+    EDepSimLog("Build photon library " << fFileName
+               << " with " << fLibrary.GetVoxelCount() << " voxels");
+}
+
+void EDepSim::PhotonLibraryManager::Apply(const std::string& fname) {
+    if (!fLibrary.Read(fname)) {
+        EDepSimThrow("Photon library cannot be read");
+    }
+    fFileName = fname;
+    fMode = kApply;
+    fDetectors.clear();
+    fDetectorsFound = false;
+}
+
+const EDepSim::PhotonLibraryManager::Scintillation&
+EDepSim::PhotonLibraryManager::GetScintillation(const G4Material* material) {
+    std::size_t index = material->GetIndex();
+    if (index >= fScintillation.size()) fScintillation.resize(index+1);
+    Scintillation& info = fScintillation[index];
+    if (info.fFilled) return info;
+    info.fFilled = true;
+
+    G4MaterialPropertiesTable* mpt = material->GetMaterialPropertiesTable();
+    if (!mpt) return info;
+    if (!mpt->ConstPropertyExists("SCINTILLATIONYIELD")) return info;
+    info.fYield = mpt->GetConstProperty("SCINTILLATIONYIELD");
+
+    // Find the scintillation components.  The yields of the components are
+    // relative, so they are normalized here.
+    double total = 0.0;
+    for (int i = 1; i <= 3; ++i) {
+        std::ostringstream timeName;
+        timeName << "SCINTILLATIONTIMECONSTANT" << i;
+        if (!mpt->ConstPropertyExists(timeName.str())) continue;
+        std::ostringstream yieldName;
+        yieldName << "SCINTILLATIONYIELD" << i;
+        double yield = 1.0;
+        if (mpt->ConstPropertyExists(yieldName.str())) {
+            yield = mpt->GetConstProperty(yieldName.str());
+        }
+        total += yield;
+        info.fTimeConstant.push_back(mpt->GetConstProperty(timeName.str()));
+        info.fFraction.push_back(total);
+    }
+    for (std::size_t i = 0; i < info.fFraction.size(); ++i) {
+        info.fFraction[i] /= total;
+    }
+
+    EDepSimLog("Photon library scintillation for " << material->GetName()
+               << ": " << info.fYield*MeV << " per MeV"
+               << " with " << info.fTimeConstant.size() << " components");
+    return info;
+}
+
+void EDepSim::PhotonLibraryManager::FindDetectors() {
+    fDetectorsFound = true;
+    fDetectors.clear();
+    G4SDManager* sdM = G4SDManager::GetSDMpointer();
+    for (int d = 0; d < fLibrary.GetDetectorCount(); ++d) {
+        const std::string& name = fLibrary.GetDetectorName(d);
+        EDepSim::SurfaceSD* sd = dynamic_cast<EDepSim::SurfaceSD*>(
+            sdM->FindSensitiveDetector(name, false));
+        if (!sd) {
+            EDepSimError("Photon library detector " << name
+                         << " is not a surface detector in the geometry");
+        }
+        fDetectors.push_back(sd);
+    }
+}
+
+void EDepSim::PhotonLibraryManager::ProcessStep(const G4Step* theStep) {
+    // The energy that goes into scintillation.
+    double energy = theStep->GetNonIonizingEnergyDeposit();
+    if (energy <= 0.0) return;
+
+    const G4StepPoint* thePreStep = theStep->GetPreStepPoint();
+    const G4StepPoint* thePostStep = theStep->GetPostStepPoint();
+    const Scintillation& info = GetScintillation(thePreStep->GetMaterial());
+    if (info.fYield <= 0.0) return;
+
+    const G4ThreeVector& prePos = thePreStep->GetPosition();
+    const G4ThreeVector& postPos = thePostStep->GetPosition();
+    int voxel = fLibrary.GetVoxel(0.5*(prePos+postPos));
+    if (voxel < 0) return;
+
+    if (!fDetectorsFound) FindDetectors();
+
+    const double photons = info.fYield*energy;
+    const double preTime = thePreStep->GetGlobalTime();
+    const double postTime = thePostStep->GetGlobalTime();
+    const int trackId = theStep->GetTrack()->GetTrackID();
+    const int pdg = G4OpticalPhoton::Definition()->GetPDGEncoding();
+
+    for (std::size_t d = 0; d < fDetectors.size(); ++d) {
+        if (!fDetectors[d]) continue;
+        double mean = photons*fLibrary.GetVisibility(voxel,d);
+        if (mean <= 0.0) continue;
+        long detected = G4Poisson(mean);
+        for (long p = 0; p < detected; ++p) {
+            // Emit the photon from a point along the step, and delay it by
+            // the scintillation decay time.
+            double f = G4UniformRand();
+            G4ThreeVector start = prePos + f*(postPos-prePos);
+            double startTime = preTime + f*(postTime-preTime);
+            if (!info.fFraction.empty()) {
+                double r = G4UniformRand();
+                std::size_t c = 0;
+                while (c+1 < info.fFraction.size()
+                       && r > info.fFraction[c]) ++c;
+                startTime -= info.fTimeConstant[c]*std::log(G4UniformRand());
+            }
+            double stopTime = startTime + fLibrary.SampleTime(voxel,d);
+            EDepSim::HitSurface* hit = new EDepSim::HitSurface(
+                trackId, fLibrary.GetDetectorEnergy(d),
+                G4LorentzVector(fLibrary.GetDetectorPosition(d), stopTime),
+                G4LorentzVector(start, startTime),
+                pdg, fOptical, fScintillation);
+            fDetectors[d]->AddHit(hit);
+        }
+    }
+}
+
+void EDepSim::PhotonLibraryManager::EndOfEvent(const G4Event* theEvent) {
+    if (fMode != kBuild) return;
+
+    // Count the primary photons emitted in each voxel.
+    for (G4PrimaryVertex* vtx = theEvent->GetPrimaryVertex();
+         vtx;
+         vtx = vtx->GetNext()) {
+        int voxel = fLibrary.GetVoxel(vtx->GetPosition());
+        if (voxel < 0) continue;
+        int photons = 0;
+        for (int p=0; p<vtx->GetNumberOfParticle(); ++p) {
+            if (vtx->GetPrimary(p)->GetG4code()
+                == G4OpticalPhoton::Definition()) ++photons;
+        }
+        fLibrary.AddEmitted(voxel, photons);
+    }
+}
+
+void EDepSim::PhotonLibraryManager::AddDetected(const std::string& detector,
+                                                const G4Step* theStep) {
+    if (fMode != kBuild) return;
+
+    // Only use the photons that were generated as primaries.
+    const G4Track* theTrack = theStep->GetTrack();
+    if (theTrack->GetParentID() != 0) return;
+
+    // The photon is counted in the voxel where it was emitted, and the
+    // arrival time is measured from when it was emitted.
+    int voxel = fLibrary.GetVoxel(theTrack->GetVertexPosition());
+    if (voxel < 0) return;
+    const G4StepPoint* thePostStep = theStep->GetPostStepPoint();
+    double emitted = theTrack->GetGlobalTime() - theTrack->GetLocalTime();
+    fLibrary.AddDetected(voxel, fLibrary.AddDetector(detector),
+                         thePostStep->GetGlobalTime() - emitted,
+                         thePostStep->GetPosition(),
+                         theStep->GetTotalEnergyDeposit());
+}
+
+void EDepSim::PhotonLibraryManager::EndOfRun() {
+    if (fMode != kBuild) return;
+    if (!fLibrary.Write(fFileName)) {
+        EDepSimError("Photon library was not written");
+        return;
+    }
+    EDepSimLog("Wrote photon library " << fFileName
+               << " with " << fLibrary.GetDetectorCount()
+               << " photon detectors");
+}
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_PhotonLibraryManager_hh_seen
+#define EDepSim_PhotonLibraryManager_hh_seen
+
+#include "EDepSimPhotonLibrary.hh"
+
+#include <string>
+#include <vector>
+
+class G4Step;
+class G4Event;
+class G4Material;
+
+namespace EDepSim {class SurfaceSD;}
+namespace EDepSim {class PhotonLibraryMessenger;}
+
+namespace EDepSim {class PhotonLibraryManager;}
+/// Build, or apply, an EDepSim::PhotonLibrary so that the optical photons
+/// do not need to be tracked.
+///
+/// When the library is being built, the job generates optical photons
+/// inside the library volume (e.g. using GPS), and the photons are tracked
+/// normally to the EDepSim::SurfaceSD detectors.  Each primary photon that
+/// is detected is added to the library by the surface detector, using the
+/// voxel where the photon was emitted and the time since it was emitted.
+/// At the end of each event the primary photons are counted in the voxel
+/// where they were emitted.  The library is written at the end of each
+/// run.
+///
+/// When the library is being applied, the optical photons are not tracked.
+/// Instead, the mean number of photons produced by each step is calculated
+/// from the secondary energy deposit of the step (the energy deposit that
+/// goes into scintillation, see EDepSim::SecondaryEnergy) and the
+/// SCINTILLATIONYIELD material property.  The number of detected photons
+/// is drawn for each photon detector using the library visibility, and the
+/// photon hits are added to the EDepSim::SurfaceSD with the same name, so
+/// they are saved as TG4PhotonHit objects.
+class EDepSim::PhotonLibraryManager {
+public:
+    /// Get the manager.
+    static EDepSim::PhotonLibraryManager* Get();
+
+    virtual ~PhotonLibraryManager();
+
+    /// Set the box covered by the library being built, and the number of
+    /// voxels along each axis.
+    void SetGrid(const G4ThreeVector& low, const G4ThreeVector& high,
+                 int nx, int ny, int nz);
+
+    /// Set the arrival time bins for the library being built.
+    void SetTimeBins(int bins, double width);
+
+    /// Start building a library that will be written to fname at the end
+    /// of the run.
+    void Build(const std::string& fname);
+
+    /// Read a library and use it instead of tracking the optical photons.
+    void Apply(const std::string& fname);
+
+    /// Return true if a library is being built.
+    bool IsBuilding() const {return fMode == kBuild;}
+
+    /// Return true if optical photons are simulated using the library.
+    bool IsApplying() const {return fMode == kApply;}
+
+    /// Make the photon hits for a step when a library is being applied.
+    void ProcessStep(const G4Step* theStep);
+
+    /// Add a photon seen by a surface detector when a library is being
+    /// built.  Only the primary photons are added.
+    void AddDetected(const std::string& detector, const G4Step* theStep);
+
+    /// Count the photons emitted in an event when a library is being built.
+    void EndOfEvent(const G4Event* theEvent);
+
+    /// Write the library at the end of a run when it is being built.
+    void EndOfRun();
+
+private:
+    PhotonLibraryManager();
+
+    /// The scintillation properties of a material.
+    struct Scintillation {
+        Scintillation() : fFilled(false), fYield(0.0) {}
+        /// True if the properties have been found.
+        bool fFilled;
+        /// The number of photons per unit energy.
+        double fYield;
+        /// The time constants of the scintillation components.
+        std::vector<double> fTimeConstant;
+        /// The cumulative fraction of photons for each component.
+        std::vector<double> fFraction;
+    };
+
+    /// Get the scintillation properties for a material.
+    const Scintillation& GetScintillation(const G4Material* material);
+
+    /// Find the surface detectors for the photon detectors in the library.
+    void FindDetectors();
+
+    /// The operating modes.
+    enum Mode {kOff, kBuild, kApply};
+
+    /// The pointer to the manager.
+    static EDepSim::PhotonLibraryManager* fThis;
+
+    /// The photon library.
+    EDepSim::PhotonLibrary fLibrary;
+
+    /// The current mode.
+    Mode fMode;
+
+    /// The file that is being built.
+    std::string fFileName;
+
+    /// The surface detectors for each photon detector in the library
+    /// (NULL if the detector doesn't exist).
+    std::vector<EDepSim::SurfaceSD*> fDetectors;
+
+    /// True if fDetectors has been filled.
+    bool fDetectorsFound;
+
+    /// The scintillation properties indexed by G4Material::GetIndex().
+    std::vector<Scintillation> fScintillation;
+
+    /// The messenger for this manager.
+    EDepSim::PhotonLibraryMessenger* fMessenger;
+};
+#endif
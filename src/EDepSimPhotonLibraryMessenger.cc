@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimPhotonLibraryMessenger.hh"
+#include "EDepSimPhotonLibraryManager.hh"
+#include "EDepSimLog.hh"
+
+#include <G4UIdirectory.hh>
+#include <G4UIcommand.hh>
+#include <G4UIparameter.hh>
+#include <G4UIcmdWithAString.hh>
+#include <G4UnitsTable.hh>
+
+#include <G4SystemOfUnits.hh>
+
+#include <sstream>
+
+EDepSim::PhotonLibraryMessenger::PhotonLibraryMessenger(
+    EDepSim::PhotonLibraryManager* manager)
+    : fManager(manager) {
+    // These must match the defaults set by the manager.
+    for (int i = 0; i < 3; ++i) {
+        fLow[i] = -1*m;
+        fHigh[i] = 1*m;
+        fVoxels[i] = 20;
+    }
+
+    fDirectory = new G4UIdirectory("/edep/photonLibrary/");
+    fDirectory->SetGuidance(
+        "Build or apply a voxelized library of the photon detector"
+        " response so optical photons do not need to be tracked.");
+
+    fBoxCMD = new G4UIcommand("/edep/photonLibrary/box",this);
+    fBoxCMD->SetGuidance(
+        "Set the corners of the box covered by the library (global"
+        " coordinates).  This must be used before the build command.");
+    fBoxCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+    const char* corners[] = {"xLow", "yLow", "zLow",
+                             "xHigh", "yHigh", "zHigh"};
+    for (int i = 0; i < 6; ++i) {
+        G4UIparameter* param = new G4UIparameter(corners[i],'d',false);
+        fBoxCMD->SetParameter(param);
+    }
+    G4UIparameter* param = new G4UIparameter("unit",'s',true);
+    param->SetDefaultValue("cm");
+    fBoxCMD->SetParameter(param);
+
+    fVoxelsCMD = new G4UIcommand("/edep/photonLibrary/voxels",this);
+    fVoxelsCMD->SetGuidance(
+        "Set the number of voxels along each axis of the library box."
+        "  This must be used before the build command.");
+    fVoxelsCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+    const char* axes[] = {"nx", "ny", "nz"};
+    for (int i = 0; i < 3; ++i) {
+        param = new G4UIparameter(axes[i],'i',false);
+        param->SetParameterRange(std::string(axes[i]) + ">0");
+        fVoxelsCMD->SetParameter(param);
+    }
+
+    fTimeBinsCMD = new G4UIcommand("/edep/photonLibrary/timeBins",this);
+    fTimeBinsCMD->SetGuidance(
+        "Set the number and width of the photon arrival time bins."
+        "  This must be used before the build command.");
+    fTimeBinsCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+    param = new G4UIparameter("bins",'i',false);
+    param->SetParameterRange("bins>0");
+    fTimeBinsCMD->SetParameter(param);
+    param = new G4UIparameter("width",'d',false);
+    param->SetParameterRange("width>0");
+    fTimeBinsCMD->SetParameter(param);
+    param = new G4UIparameter("unit",'s',true);
+    param->SetDefaultValue("ns");
+    fTimeBinsCMD->SetParameter(param);
+
+    fBuildCMD = new G4UIcmdWithAString("/edep/photonLibrary/build",this);
+    fBuildCMD->SetGuidance(
+        "Build a photon library from the primary optical photons, and"
+        " write it to a file at the end of the run.");
+    fBuildCMD->SetParameterName("filename",false);
+    fBuildCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fApplyCMD = new G4UIcmdWithAString("/edep/photonLibrary/apply",this);
+    fApplyCMD->SetGuidance(
+        "Read a photon library, and use it to make the photon hits instead"
+        " of tracking the optical photons.");
+    fApplyCMD->SetParameterName("filename",false);
+    fApplyCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+EDepSim::PhotonLibraryMessenger::~PhotonLibraryMessenger() {
+    delete fBoxCMD;
+    delete fVoxelsCMD;
+    delete fTimeBinsCMD;
+    delete fBuildCMD;
+    delete fApplyCMD;
+    delete fDirectory;
+}
+
+void EDepSim::PhotonLibraryMessenger::SetNewValue(G4UIcommand* command,
+                                                  G4String newValue) {
+    if (command == fBoxCMD) {
+        std::string unitName;
+        std::istringstream input((const char*)newValue);
+        input >> fLow[0] >> fLow[1] >> fLow[2]
+              >> fHigh[0] >> fHigh[1] >> fHigh[2] >> unitName;
+        double unit = G4UnitDefinition::GetValueOf(unitName);
+        for (int i = 0; i < 3; ++i) {
+            fLow[i] *= unit;
+            fHigh[i] *= unit;
+        }
+        fManager->SetGrid(G4ThreeVector(fLow[0],fLow[1],fLow[2]),
+                          G4ThreeVector(fHigh[0],fHigh[1],fHigh[2]),
+                          fVoxels[0], fVoxels[1], fVoxels[2]);
+    }
+    else if (command == fVoxelsCMD) {
+        std::istringstream input((const char*)newValue);
+        input >> fVoxels[0] >> fVoxels[1] >> fVoxels[2];
+        fManager->SetGrid(G4ThreeVector(fLow[0],fLow[1],fLow[2]),
+                          G4ThreeVector(fHigh[0],fHigh[1],fHigh[2]),
+                          fVoxels[0], fVoxels[1], fVoxels[2]);
+    }
+    else if (command == fTimeBinsCMD) {
+        int bins;
+        double width;
+        std::string unitName;
+        std::istringstream input((const char*)newValue);
+        input >> bins >> width >> unitName;
+        fManager->SetTimeBins(bins,
+                              width*G4UnitDefinition::GetValueOf(unitName));
+    }
+    else if (command == fBuildCMD) {
+        fManager->Build(newValue);
+    }
+    else if (command == fApplyCMD) {
+        fManager->Apply(newValue);
+    }
+}
@@ -0,0 +1,39 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_PhotonLibraryMessenger_hh_seen
+#define EDepSim_PhotonLibraryMessenger_hh_seen
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+
+namespace EDepSim {class PhotonLibraryManager;}
+
+namespace EDepSim {class PhotonLibraryMessenger;}
+/// Control the building and use of the photon library.
+class EDepSim::PhotonLibraryMessenger: public G4UImessenger {
+public:
+    PhotonLibraryMessenger(EDepSim::PhotonLibraryManager* manager);
+    virtual ~PhotonLibraryMessenger();
+
+    void SetNewValue(G4UIcommand* command, G4String newValue);
+
+private:
+    EDepSim::PhotonLibraryManager* fManager;
+
+    G4UIdirectory*       fDirectory;
+    G4UIcommand*         fBoxCMD;
+    G4UIcommand*         fVoxelsCMD;
+    G4UIcommand*         fTimeBinsCMD;
+    G4UIcmdWithAString*  fBuildCMD;
+    G4UIcmdWithAString*  fApplyCMD;
+
+    /// The library box and voxels are set by separate commands, so save
+    /// them here.
+    double fLow[3];
+    double fHigh[3];
+    int fVoxels[3];
+};
+#endif
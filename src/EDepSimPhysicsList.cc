@@ -3,6 +3,7 @@
 #include "EDepSimException.hh"
 #include "EDepSimExtraPhysics.hh"
 #include "EDepSimDokeBirksSaturation.hh"
+#include "EDepSimRegionManager.hh"
 #include "EDepSimGetExternalActionConstructor.hh"
 
 #include <EDepSimLog.hh>
@@ -23,11 +24,51 @@
 
 #include <G4ProcessTable.hh>
 
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4ProductionCuts.hh>
+#include <G4ProductionCutsTable.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4Material.hh>
+#include <G4Element.hh>
+#include <G4EmParameters.hh>
+#include <G4Version.hh>
+
 #include <G4UnitsTable.hh>
 #include <G4SystemOfUnits.hh>
 
+#include <TMD5.h>
+#include <TSystem.h>
+
+#include <cstdio>
+#include <sstream>
 #include <unistd.h>
 
+namespace {
+    // Add a string to the MD5 hash.
+    void HashString(TMD5& md5, const std::string& value) {
+        md5.Update(reinterpret_cast<const UChar_t*>(value.data()),
+                   value.size());
+    }
+
+    // Remove a directory of stored physics tables.  The tables are stored
+    // as plain files, so there are no sub-directories.
+    void RemoveTableDirectory(const std::string& directory) {
+        void* dir = gSystem->OpenDirectory(directory.c_str());
+        if (dir) {
+            const char* entry;
+            while ((entry = gSystem->GetDirEntry(dir))) {
+                std::string name(entry);
+                if (name == "." || name == "..") continue;
+                std::remove((directory + "/" + name).c_str());
+            }
+            gSystem->FreeDirectory(dir);
+        }
+        gSystem->Unlink(directory.c_str());
+    }
+}
+
 EDepSim::PhysicsList::PhysicsList(G4String physName)
     : G4VModularPhysicsList() {
     G4LossTableManager::Instance();
@@ -103,7 +144,8 @@ EDepSim::PhysicsList::PhysicsList(G4String physName)
 
     // Setup the parameters (override if necesssary)
     G4EmParameters* emParams = G4EmParameters::Instance();
-    emParams->SetEmSaturation(new EDepSim::DokeBirksSaturation(0));
+    fSaturation = new EDepSim::DokeBirksSaturation(0);
+    emParams->SetEmSaturation(fSaturation);
 
     // Force any necessary optical parameters.
     G4OpticalParameters* opParams = G4OpticalParameters::Instance();
@@ -130,9 +172,149 @@ void EDepSim::PhysicsList::SetCuts() {
     SetCutValue(fCutForElectron, "e-");
     SetCutValue(fCutForPositron, "e+");
 
+    // Set the cuts for the regions.  The cuts that are not set for a region
+    // are copied from the global cuts.
+    EDepSim::RegionManager::Get()->SetProductionCuts();
+
+    // Retrieve the physics tables from the cache, or remember where they
+    // should be stored after they are built.
+    fTableCacheName.clear();
+    if (!fTableCacheDirectory.empty()) {
+        std::string cacheName = TableCacheName();
+        // AccessPathName returns true when the file does NOT exist.
+        if (!gSystem->AccessPathName(cacheName.c_str())) {
+            EDepSimLog("Physics tables retrieved from cache: " << cacheName);
+            SetPhysicsTableRetrieved(cacheName);
+        }
+        else {
+            EDepSimLog("Physics table cache miss: " << cacheName);
+            fTableCacheName = cacheName;
+        }
+    }
+
     if (verboseLevel>0) DumpCutValuesTable();
 }
 
+std::string EDepSim::PhysicsList::TableCacheName() {
+    TMD5 md5;
+    std::ostringstream desc;
+    desc.precision(17);
+
+    // The version changes the format of the tables.
+    desc << "EDepSimPhysicsCache 1 G4 " << G4VERSION_NUMBER << std::endl;
+
+    // The physics constructors and the EM options.
+    for (G4int i = 0; ; ++i) {
+        const G4VPhysicsConstructor* elem = GetPhysics(i);
+        if (elem == NULL) break;
+        desc << "PHYS " << elem->GetPhysicsName() << std::endl;
+    }
+    G4EmParameters::Instance()->StreamInfo(desc);
+    G4ProductionCutsTable* cutsTable
+        = G4ProductionCutsTable::GetProductionCutsTable();
+    desc << "ENERGY " << cutsTable->GetLowEdgeEnergy()
+         << " " << cutsTable->GetHighEdgeEnergy() << std::endl;
+    HashString(md5, desc.str());
+
+    // The production cuts for each region.
+    G4RegionStore* regions = G4RegionStore::GetInstance();
+    for (std::size_t i = 0; i < regions->size(); ++i) {
+        const G4Region* region = (*regions)[i];
+        std::ostringstream cuts;
+        cuts.precision(17);
+        cuts << "REGION " << region->GetName();
+        const G4ProductionCuts* production = region->GetProductionCuts();
+        if (production) {
+            cuts << " " << production->GetProductionCut("gamma")
+                 << " " << production->GetProductionCut("e-")
+                 << " " << production->GetProductionCut("e+")
+                 << " " << production->GetProductionCut("proton");
+        }
+        cuts << std::endl;
+        HashString(md5, cuts.str());
+    }
+
+    // The materials of the logical volumes, and the volumes at the root of
+    // each region, decide the material and cuts couples.
+    G4LogicalVolumeStore* volumes = G4LogicalVolumeStore::GetInstance();
+    for (std::size_t i = 0; i < volumes->size(); ++i) {
+        const G4LogicalVolume* volume = (*volumes)[i];
+        std::ostringstream lv;
+        const G4Material* material = volume->GetMaterial();
+        lv << "LV " << volume->GetName()
+           << " " << (material ? material->GetName() : "none");
+        if (volume->IsRootRegion() && volume->GetRegion()) {
+            lv << " " << volume->GetRegion()->GetName();
+        }
+        lv << std::endl;
+        HashString(md5, lv.str());
+    }
+
+    // The material definitions.
+    const G4MaterialTable* materials = G4Material::GetMaterialTable();
+    for (std::size_t i = 0; i < materials->size(); ++i) {
+        const G4Material* material = (*materials)[i];
+        std::ostringstream mat;
+        mat.precision(17);
+        mat << "MAT " << material->GetName()
+            << " " << material->GetDensity()
+            << " " << material->GetState()
+            << " " << material->GetTemperature()
+            << " " << material->GetPressure()
+            << " " << material->GetIonisation()->GetMeanExcitationEnergy()
+            << std::endl;
+        const G4double* fractions = material->GetFractionVector();
+        for (std::size_t j = 0; j < material->GetNumberOfElements(); ++j) {
+            const G4Element* element = material->GetElement(j);
+            mat << "   " << element->GetName()
+                << " " << element->GetZ()
+                << " " << element->GetA()
+                << " " << fractions[j] << std::endl;
+        }
+        HashString(md5, mat.str());
+    }
+
+    md5.Final();
+    return fTableCacheDirectory + "/edepsim-physics-" + md5.AsString();
+}
+
+void EDepSim::PhysicsList::StoreTableCache() {
+    // Only the tables for the first run are retrieved from the cache, and
+    // the later runs build the tables normally.
+    if (IsPhysicsTableRetrieved()) ResetPhysicsTableRetrieved();
+
+    if (fTableCacheName.empty()) return;
+    std::string cacheName = fTableCacheName;
+    fTableCacheName.clear();
+
+    // The cuts can be changed after the physics is initialized.
+    if (TableCacheName() != cacheName) {
+        EDepSimLog("Physics changed after initialization."
+                   << " The physics tables are not cached.");
+        return;
+    }
+
+    // Write into a temporary directory and then move it into place so that
+    // jobs sharing a cache directory never see partially written tables.
+    gSystem->mkdir(fTableCacheDirectory.c_str(), true);
+    std::ostringstream tmpName;
+    tmpName << cacheName << ".tmp" << gSystem->GetPid();
+    gSystem->mkdir(tmpName.str().c_str(), true);
+    if (!StorePhysicsTable(tmpName.str())) {
+        EDepSimError("Cannot store the physics tables: " << tmpName.str());
+        RemoveTableDirectory(tmpName.str());
+        return;
+    }
+
+    // The move fails if another job has already stored the same tables.
+    if (std::rename(tmpName.str().c_str(), cacheName.c_str()) != 0) {
+        EDepSimLog("Physics tables already cached: " << cacheName);
+        RemoveTableDirectory(tmpName.str());
+        return;
+    }
+    EDepSimLog("Physics tables saved to cache: " << cacheName);
+}
+
 void EDepSim::PhysicsList::SetCutForGamma(G4double cut) {
     fCutForGamma = cut;
     SetParticleCuts(fCutForGamma, G4Gamma::Gamma());
@@ -152,6 +334,10 @@ void EDepSim::PhysicsList::SetIonizationModel(bool b) {
     fExtra->SetIonizationModel(b);
 }
 
+void EDepSim::PhysicsList::SetLETTolerance(double tolerance) {
+    fSaturation->SetLETTolerance(tolerance);
+}
+
 G4VModularPhysicsList*
 EDepSim::PhysicsList::ExternalPhysicsList(std::string externName) {
     // Strip the EXTERN:
@@ -4,9 +4,12 @@
 #include "globals.hh"
 #include "G4VModularPhysicsList.hh"
 
+#include <string>
+
 class G4VPhysicsConstructor;
 namespace EDepSim {class PhysicsListMessenger;}
 namespace EDepSim {class ExtraPhysics;}
+namespace EDepSim {class DokeBirksSaturation;}
 
 namespace EDepSim {class PhysicsList;}
 /// Use the G4PhysListFactory to select a physics list for this run.  The
@@ -45,6 +48,25 @@ public:
     /// nest).
     void SetIonizationModel(bool);
 
+    /// Set the maximum relative error of the tabulated electron LET used
+    /// for the LAr recombination (zero to calculate the LET for each step).
+    void SetLETTolerance(double);
+
+    /// Set the directory used to cache the physics tables.  The tables for
+    /// the first run are retrieved from the cache when they exist, and
+    /// stored when they don't.  The cached tables are named using a hash of
+    /// the physics constructors, the production cuts and the materials, so
+    /// they are only used when all of those are unchanged.  An empty
+    /// directory turns off the cache.
+    void SetTableCache(const std::string& directory) {
+        fTableCacheDirectory = directory;
+    }
+
+    /// Store the physics tables in the cache if they were built for this
+    /// job.  This is called by EDepSim::UserRunAction at the beginning of
+    /// each run, after GEANT4 has built the tables.
+    void StoreTableCache();
+
 private:
 
     /// Load a modular physics list from an external library.  The externName
@@ -56,6 +78,10 @@ private:
     /// "EXTERN:library-name:symbol-name"
     G4VPhysicsConstructor* ExternalExtraPhysics(std::string externName);
 
+    /// Get the name of the physics table cache for the current physics,
+    /// production cuts and materials.
+    std::string TableCacheName();
+
     /// The gamma-ray range cut.
     G4double fCutForGamma;
 
@@ -68,6 +94,16 @@ private:
     /// The extra physics list
     EDepSim::ExtraPhysics* fExtra;
 
+    /// The saturation model used for LAr.  This is owned by G4EmParameters.
+    EDepSim::DokeBirksSaturation* fSaturation;
+
+    /// The directory of cached physics tables (empty if not used).
+    std::string fTableCacheDirectory;
+
+    /// The physics table cache that will be stored after the tables are
+    /// built (empty if the tables have been stored or retrieved).
+    std::string fTableCacheName;
+
     /// The messenger to control this class.
     EDepSim::PhysicsListMessenger* fMessenger;
 
@@ -8,6 +8,7 @@
 #include <G4UIcmdWithAString.hh>
 #include <G4UIcmdWithoutParameter.hh>
 #include <G4UIcmdWithADoubleAndUnit.hh>
+#include <G4UIcmdWithADouble.hh>
 #include <G4UIcmdWithABool.hh>
 
 #include "G4ParticleTable.hh"
@@ -57,6 +58,25 @@ EDepSim::PhysicsListMessenger::PhysicsListMessenger(EDepSim::PhysicsList* pPhys)
     fIonizationModelCMD->SetGuidance("Set ionization model in the LAr");
     fIonizationModelCMD->SetParameterName("fraction",false);
     fIonizationModelCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fLETToleranceCMD = new G4UIcmdWithADouble("/edep/phys/letTolerance",
+                                              this);
+    fLETToleranceCMD->SetGuidance(
+        "Set the maximum relative error of the tabulated electron LET");
+    fLETToleranceCMD->SetGuidance(
+        "  used for LAr recombination.  Zero calculates the LET directly.");
+    fLETToleranceCMD->SetParameterName("tolerance",false);
+    fLETToleranceCMD->SetRange("tolerance>=0.0");
+    fLETToleranceCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fTableCacheCMD = new G4UIcmdWithAString("/edep/phys/tableCache",this);
+    fTableCacheCMD->SetGuidance(
+        "Cache the physics tables in a directory (set before update).");
+    fTableCacheCMD->SetGuidance(
+        "  The tables are only reused for the same physics, cuts and"
+        " materials.");
+    fTableCacheCMD->SetParameterName("directory",false);
+    fTableCacheCMD->AvailableForStates(G4State_PreInit);
 }
 
 EDepSim::PhysicsListMessenger::~PhysicsListMessenger() {
@@ -65,6 +85,8 @@ EDepSim::PhysicsListMessenger::~PhysicsListMessenger() {
     delete fPosCutCMD;
     delete fAllCutCMD;
     delete fIonizationModelCMD;
+    delete fLETToleranceCMD;
+    delete fTableCacheCMD;
 }
 
 void EDepSim::PhysicsListMessenger::SetNewValue(G4UIcommand* command,
@@ -91,4 +113,11 @@ void EDepSim::PhysicsListMessenger::SetNewValue(G4UIcommand* command,
         G4double cut = fIonizationModelCMD->GetNewBoolValue(newValue);
         fPhysicsList->SetIonizationModel(cut);
     }
+    else if (command == fLETToleranceCMD) {
+        fPhysicsList->SetLETTolerance(fLETToleranceCMD
+                                      ->GetNewDoubleValue(newValue));
+    }
+    else if (command == fTableCacheCMD) {
+        fPhysicsList->SetTableCache(newValue);
+    }
 }
@@ -8,6 +8,7 @@ namespace EDepSim {class PhysicsList;}
 
 class G4UIdirectory;
 class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithADouble;
 class G4UIcmdWithABool;
 class G4UIcmdWithAString;
 class G4UIcmdWithoutParameter;
@@ -35,6 +36,8 @@ private:
     G4UIcmdWithADoubleAndUnit* fPosCutCMD;
     G4UIcmdWithADoubleAndUnit* fAllCutCMD;
     G4UIcmdWithABool*          fIonizationModelCMD;
+    G4UIcmdWithADouble*        fLETToleranceCMD;
+    G4UIcmdWithAString*        fTableCacheCMD;
 
 };
 #endif
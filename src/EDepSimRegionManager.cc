@@ -0,0 +1,260 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimRegionManager.hh"
+#include "EDepSimLog.hh"
+
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4ProductionCuts.hh>
+#include <G4UserLimits.hh>
+#include <G4UnitsTable.hh>
+
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <set>
+
+EDepSim::RegionManager* EDepSim::RegionManager::fThis = NULL;
+
+void EDepSim::RegionManager::AddVolume(const std::string& region,
+                                       const std::string& volume,
+                                       bool fromGDML) {
+    Definition& def
+        = fromGDML ? fGDMLDefinitions[region] : fDefinitions[region];
+    if (std::find(def.fVolumes.begin(), def.fVolumes.end(), volume)
+        != def.fVolumes.end()) return;
+    def.fVolumes.push_back(volume);
+}
+
+void EDepSim::RegionManager::SetCut(const std::string& region,
+                                    const std::string& particle,
+                                    double cut, bool fromGDML) {
+    if (particle == "em") {
+        SetCut(region, "gamma", cut, fromGDML);
+        SetCut(region, "e-", cut, fromGDML);
+        SetCut(region, "e+", cut, fromGDML);
+        return;
+    }
+    if (particle != "gamma" && particle != "e-"
+        && particle != "e+" && particle != "proton") {
+        EDepSimError("Invalid production cut particle " << particle
+                     << " for region " << region);
+        return;
+    }
+    Definition& def
+        = fromGDML ? fGDMLDefinitions[region] : fDefinitions[region];
+    def.fCuts[particle] = cut;
+}
+
+void EDepSim::RegionManager::SetLimit(const std::string& region,
+                                      const std::string& limit,
+                                      double value, bool fromGDML) {
+    if (limit != "maxStep" && limit != "maxTrackLength"
+        && limit != "maxTime" && limit != "minKineticEnergy"
+        && limit != "minRange") {
+        EDepSimError("Invalid user limit " << limit
+                     << " for region " << region);
+        return;
+    }
+    Definition& def
+        = fromGDML ? fGDMLDefinitions[region] : fDefinitions[region];
+    def.fLimits[limit] = value;
+}
+
+void EDepSim::RegionManager::ClearGDML() {
+    fGDMLDefinitions.clear();
+}
+
+EDepSim::RegionManager::Definition
+EDepSim::RegionManager::GetDefinition(const std::string& region) const {
+    Definition def;
+    std::map<std::string, Definition>::const_iterator gdml
+        = fGDMLDefinitions.find(region);
+    if (gdml != fGDMLDefinitions.end()) def = gdml->second;
+    std::map<std::string, Definition>::const_iterator macro
+        = fDefinitions.find(region);
+    if (macro == fDefinitions.end()) return def;
+    for (std::vector<std::string>::const_iterator v
+             = macro->second.fVolumes.begin();
+         v != macro->second.fVolumes.end(); ++v) {
+        if (std::find(def.fVolumes.begin(), def.fVolumes.end(), *v)
+            == def.fVolumes.end()) def.fVolumes.push_back(*v);
+    }
+    for (std::map<std::string, double>::const_iterator c
+             = macro->second.fCuts.begin();
+         c != macro->second.fCuts.end(); ++c) {
+        def.fCuts[c->first] = c->second;
+    }
+    for (std::map<std::string, double>::const_iterator l
+             = macro->second.fLimits.begin();
+         l != macro->second.fLimits.end(); ++l) {
+        def.fLimits[l->first] = l->second;
+    }
+    return def;
+}
+
+std::set<std::string> EDepSim::RegionManager::GetRegionNames() const {
+    std::set<std::string> names;
+    for (std::map<std::string, Definition>::const_iterator d
+             = fGDMLDefinitions.begin(); d != fGDMLDefinitions.end(); ++d) {
+        names.insert(d->first);
+    }
+    for (std::map<std::string, Definition>::const_iterator d
+             = fDefinitions.begin(); d != fDefinitions.end(); ++d) {
+        names.insert(d->first);
+    }
+    return names;
+}
+
+void EDepSim::RegionManager::CreateRegions() {
+    std::set<std::string> names = GetRegionNames();
+
+    // Attach the root volumes for all of the regions before the limits are
+    // applied so that the limits stop at the boundary of the next region.
+    G4LogicalVolumeStore* volumes = G4LogicalVolumeStore::GetInstance();
+    for (std::set<std::string>::const_iterator n = names.begin();
+         n != names.end(); ++n) {
+        Definition def = GetDefinition(*n);
+        G4Region* region
+            = G4RegionStore::GetInstance()->FindOrCreateRegion(*n);
+        for (std::vector<std::string>::const_iterator v
+                 = def.fVolumes.begin(); v != def.fVolumes.end(); ++v) {
+            G4LogicalVolume* volume = volumes->GetVolume(*v, false);
+            if (!volume) {
+                EDepSimError("Region " << *n << " volume " << *v
+                             << " does not exist");
+                continue;
+            }
+            if (volume->IsRootRegion() && volume->GetRegion()
+                && volume->GetRegion() != region) {
+                EDepSimError("Volume " << *v << " is already the root of "
+                             << volume->GetRegion()->GetName()
+                             << " and can't be added to " << *n);
+                continue;
+            }
+            region->AddRootLogicalVolume(volume);
+            EDepSimLog("Add volume " << *v << " to region " << *n);
+        }
+    }
+
+    for (std::set<std::string>::const_iterator n = names.begin();
+         n != names.end(); ++n) {
+        Definition def = GetDefinition(*n);
+        if (def.fLimits.empty()) continue;
+        G4UserLimits* limits = new G4UserLimits();
+        std::map<std::string, double>::const_iterator l;
+        l = def.fLimits.find("maxStep");
+        if (l != def.fLimits.end()) limits->SetMaxAllowedStep(l->second);
+        l = def.fLimits.find("maxTrackLength");
+        if (l != def.fLimits.end()) limits->SetUserMaxTrackLength(l->second);
+        l = def.fLimits.find("maxTime");
+        if (l != def.fLimits.end()) limits->SetUserMaxTime(l->second);
+        l = def.fLimits.find("minKineticEnergy");
+        if (l != def.fLimits.end()) limits->SetUserMinEkine(l->second);
+        l = def.fLimits.find("minRange");
+        if (l != def.fLimits.end()) limits->SetUserMinRange(l->second);
+
+        G4Region* region = G4RegionStore::GetInstance()->GetRegion(*n, false);
+        region->SetUserLimits(limits);
+        for (std::vector<std::string>::const_iterator v
+                 = def.fVolumes.begin(); v != def.fVolumes.end(); ++v) {
+            G4LogicalVolume* volume = volumes->GetVolume(*v, false);
+            if (!volume || volume->GetRegion() != region) continue;
+            ApplyLimits(volume, limits, region);
+        }
+    }
+}
+
+void EDepSim::RegionManager::ApplyLimits(G4LogicalVolume* volume,
+                                         G4UserLimits* limits,
+                                         const G4Region* region) {
+    // The volume has already been visited.
+    if (volume->GetUserLimits() == limits) return;
+    if (!volume->GetUserLimits()) volume->SetUserLimits(limits);
+    for (std::size_t i = 0; i < (std::size_t) volume->GetNoDaughters(); ++i) {
+        G4LogicalVolume* daughter
+            = volume->GetDaughter(i)->GetLogicalVolume();
+        if (daughter->IsRootRegion() && daughter->GetRegion() != region) {
+            continue;
+        }
+        ApplyLimits(daughter, limits, region);
+    }
+}
+
+void EDepSim::RegionManager::SetProductionCuts() {
+    // The cuts that aren't set for a region are copied from the default
+    // region.  This is called after the physics list has set them.
+    G4RegionStore* store = G4RegionStore::GetInstance();
+    const G4Region* world
+        = store->GetRegion("DefaultRegionForTheWorld", false);
+    const G4ProductionCuts* defaults
+        = world ? world->GetProductionCuts() : NULL;
+
+    std::set<std::string> names = GetRegionNames();
+    for (std::set<std::string>::const_iterator n = names.begin();
+         n != names.end(); ++n) {
+        Definition def = GetDefinition(*n);
+        if (def.fCuts.empty()) continue;
+        G4Region* region = store->GetRegion(*n, false);
+        if (!region) {
+            EDepSimError("Production cuts for undefined region " << *n);
+            continue;
+        }
+        G4ProductionCuts* cuts = defaults
+            ? new G4ProductionCuts(*defaults) : new G4ProductionCuts();
+        for (std::map<std::string, double>::const_iterator c
+                 = def.fCuts.begin(); c != def.fCuts.end(); ++c) {
+            cuts->SetProductionCut(c->second, c->first);
+        }
+        region->SetProductionCuts(cuts);
+        EDepSimLog("Region " << *n << " production cuts:"
+                   << " gamma " << G4BestUnit(cuts->GetProductionCut("gamma"),
+                                              "Length")
+                   << " e- " << G4BestUnit(cuts->GetProductionCut("e-"),
+                                           "Length")
+                   << " e+ " << G4BestUnit(cuts->GetProductionCut("e+"),
+                                           "Length")
+                   << " proton " << G4BestUnit(
+                       cuts->GetProductionCut("proton"), "Length"));
+    }
+}
+
+bool EDepSim::RegionManager::HasLimit(const std::string& limit) const {
+    std::set<std::string> names = GetRegionNames();
+    for (std::set<std::string>::const_iterator n = names.begin();
+         n != names.end(); ++n) {
+        Definition def = GetDefinition(*n);
+        if (def.fLimits.find(limit) != def.fLimits.end()) return true;
+    }
+    return false;
+}
+
+void EDepSim::RegionManager::ListRegions() const {
+    std::set<std::string> names = GetRegionNames();
+    EDepSimLog("Region definitions:");
+    for (std::set<std::string>::const_iterator n = names.begin();
+         n != names.end(); ++n) {
+        Definition def = GetDefinition(*n);
+        EDepSimLog("   Region " << *n);
+        for (std::vector<std::string>::const_iterator v
+                 = def.fVolumes.begin(); v != def.fVolumes.end(); ++v) {
+            EDepSimLog("      volume " << *v);
+        }
+        for (std::map<std::string, double>::const_iterator c
+                 = def.fCuts.begin(); c != def.fCuts.end(); ++c) {
+            EDepSimLog("      " << c->first << " cut "
+                       << G4BestUnit(c->second, "Length"));
+        }
+        for (std::map<std::string, double>::const_iterator l
+                 = def.fLimits.begin(); l != def.fLimits.end(); ++l) {
+            const char* category = "Length";
+            if (l->first == "maxTime") category = "Time";
+            if (l->first == "minKineticEnergy") category = "Energy";
+            EDepSimLog("      " << l->first << " "
+                       << G4BestUnit(l->second, category));
+        }
+    }
+}
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_RegionManager_hh_seen
+#define EDepSim_RegionManager_hh_seen
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class G4LogicalVolume;
+class G4UserLimits;
+class G4Region;
+
+namespace EDepSim {class RegionManager;}
+/// Define the regions of the geometry, and the production cuts and user
+/// limits for each region.  A region is attached to one or more logical
+/// volumes (and the volumes inside of them), so the cuts can be fine in the
+/// active volumes while the passive material (the rock, cryostat, and hall)
+/// uses coarse cuts.  The regions are defined using the /edep/region/
+/// commands, or with GDML auxiliary types on a logical volume:
+///
+/// * Region -- The region for the volume and its daughters.
+/// * RegionCut -- The gamma, electron and positron production cut.
+/// * RegionGammaCut, RegionElectronCut, RegionPositronCut,
+///   RegionProtonCut -- The production cut for one particle.
+/// * RegionMaxStep, RegionMaxTrackLength, RegionMaxTime,
+///   RegionMinKineticEnergy, RegionMinRange -- The user limits.
+///
+/// A value set by a macro command overrides a GDML value.  The production
+/// cuts that are not set for a region are the global cuts from
+/// /edep/phys/gammaCut (etc) when the physics is initialized.  The user
+/// limits are applied to every logical volume in the region that doesn't
+/// already have limits (e.g. from the StepLimit GDML auxiliary type).
+/// Tracks in a region are killed when they reach the maximum track length
+/// or time, or drop below the minimum kinetic energy or range (optical
+/// photons are never killed, and the minimum range only applies to charged
+/// particles).  Stacking
+/// rules can also be limited to a region (see /edep/stack/addRule).
+class EDepSim::RegionManager {
+public:
+    /// Get the manager.
+    static EDepSim::RegionManager* Get() {
+        if (!fThis) fThis = new EDepSim::RegionManager();
+        return fThis;
+    }
+
+    virtual ~RegionManager() {}
+
+    /// Add a logical volume (and its daughters) to a region.  The region is
+    /// created if it doesn't exist.
+    void AddVolume(const std::string& region, const std::string& volume,
+                   bool fromGDML = false);
+
+    /// Set the production cut for a particle in a region.  The particle is
+    /// "gamma", "e-", "e+", "proton", or "em" for the first three.
+    void SetCut(const std::string& region, const std::string& particle,
+                double cut, bool fromGDML = false);
+
+    /// Set a user limit for a region.  The limit is one of "maxStep",
+    /// "maxTrackLength", "maxTime", "minKineticEnergy", or "minRange".
+    void SetLimit(const std::string& region, const std::string& limit,
+                  double value, bool fromGDML = false);
+
+    /// Remove the definitions that came from a GDML file.  This is called
+    /// before a GDML geometry is read.
+    void ClearGDML();
+
+    /// Create the regions, and attach the logical volumes and user limits.
+    /// This is called after the geometry is constructed.
+    void CreateRegions();
+
+    /// Set the production cuts for the regions.  This is called by
+    /// EDepSim::PhysicsList::SetCuts after the global cuts are set.
+    void SetProductionCuts();
+
+    /// Print the region definitions.
+    void ListRegions() const;
+
+    /// Check if a user limit is set for any region.  The limit is one of
+    /// the names used by SetLimit().  This is used by the physics list to
+    /// only add the processes that apply the limits when they are needed.
+    bool HasLimit(const std::string& limit) const;
+
+private:
+    RegionManager() {}
+
+    /// The volumes, production cuts and user limits for a region.
+    struct Definition {
+        std::vector<std::string> fVolumes;
+        std::map<std::string, double> fCuts;
+        std::map<std::string, double> fLimits;
+    };
+
+    /// Get the definition of a region with the macro values applied on top
+    /// of the GDML values.
+    Definition GetDefinition(const std::string& region) const;
+
+    /// Get the names of the regions defined by macros or GDML.
+    std::set<std::string> GetRegionNames() const;
+
+    /// Set the user limits for a volume and its daughters.  The daughters
+    /// that are the root of another region, or have their own limits, are
+    /// not changed.
+    void ApplyLimits(G4LogicalVolume* volume, G4UserLimits* limits,
+                     const G4Region* region);
+
+    /// The pointer to the manager.
+    static EDepSim::RegionManager* fThis;
+
+    /// The regions defined by the macro commands.
+    std::map<std::string, Definition> fDefinitions;
+
+    /// The regions defined by the GDML auxiliary types.
+    std::map<std::string, Definition> fGDMLDefinitions;
+};
+#endif
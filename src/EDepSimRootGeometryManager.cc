@@ -1,6 +1,8 @@
 ////////////////////////////////////////////////////////////
 //
 #include "EDepSimRootGeometryManager.hh"
+#include "EDepSimRootOverlapChecker.hh"
+#include "EDepSimVRootSolidConverter.hh"
 #include "EDepSimException.hh"
 
 #include "EDepSimLog.hh"
@@ -11,54 +13,29 @@
 #include <TGeoVolume.h>
 #include <TGeoMedium.h>
 #include <TGeoElement.h>
-#include <TGeoTube.h>
-#include <TGeoTrd2.h>
-#include <TGeoSphere.h>
-#include <TGeoPgon.h>
-#include <TGeoArb8.h>
-#include <TGeoBoolNode.h>
-#include <TGeoCompositeShape.h>
 #include <TGeoMatrix.h>
 #include <TGeoOverlap.h>
-#include <TGeoXtru.h>
-#include <TGeoPcon.h>
-#include <TGeoEltu.h>
-#include <TGeoParaboloid.h>
-#include <TGeoHype.h>
-#include <TGeoCone.h>
-#include <TGeoPara.h>
-#include <TGeoTorus.h>
 #include <TColor.h>
+#include <TFile.h>
+#include <TSystem.h>
+#include <TMD5.h>
+#include <TParameter.h>
+#include <TObjArray.h>
+#include <TObjString.h>
 
 #include <globals.hh>
 
 #include <G4LogicalVolume.hh>
 #include <G4VPhysicalVolume.hh>
+#include <G4VPVParameterisation.hh>
 #include <G4Material.hh>
 #include <G4Element.hh>
 #include <G4Isotope.hh>
 #include <G4UnitsTable.hh>
+#include <G4Version.hh>
 
 #include <G4VisAttributes.hh>
 #include <G4VSolid.hh>
-#include <G4Box.hh>
-#include <G4Trd.hh>
-#include <G4Tubs.hh>
-#include <G4Sphere.hh>
-#include <G4Polyhedra.hh>
-#include <G4Polycone.hh>
-#include <G4Trap.hh>
-#include <G4SubtractionSolid.hh>
-#include <G4UnionSolid.hh>
-#include <G4IntersectionSolid.hh>
-#include <G4ExtrudedSolid.hh>
-#include <G4EllipticalTube.hh>
-#include <G4Torus.hh>
-#include <G4Para.hh>
-#include <G4Cons.hh>
-#include <G4Hype.hh>
-#include <G4Paraboloid.hh>
-#include <G4GenericTrap.hh>
 
 #include <G4SystemOfUnits.hh>
 #include <G4PhysicalConstants.hh>
@@ -66,11 +43,16 @@
 #include <memory>
 #include <cmath>
 #include <cstdlib>
+#include <cstdio>
+#include <sstream>
 #include <set>
+#include <typeinfo>
 
 EDepSim::RootGeometryManager* EDepSim::RootGeometryManager::fThis = NULL;
 
-EDepSim::RootGeometryManager::RootGeometryManager() {
+EDepSim::RootGeometryManager::RootGeometryManager()
+    : fValidateThreads(0), fParameterisedCopy(NULL) {
+    AddDefaultSolidConverters();
 }
 
 EDepSim::RootGeometryManager* EDepSim::RootGeometryManager::Get() {
@@ -78,7 +60,12 @@ EDepSim::RootGeometryManager* EDepSim::RootGeometryManager::Get() {
     return fThis;
 }
 
-EDepSim::RootGeometryManager::~RootGeometryManager() {}
+EDepSim::RootGeometryManager::~RootGeometryManager() {
+    for (std::map<std::string, EDepSim::VRootSolidConverter*>::iterator
+             c = fSolidConverters.begin(); c != fSolidConverters.end(); ++c) {
+        delete c->second;
+    }
+}
 
 void EDepSim::RootGeometryManager::Export(const char *file) {
     EDepSimLog("   *** Export to " << file);
@@ -92,6 +79,11 @@ int EDepSim::RootGeometryManager::GetNodeId(const G4ThreeVector& pos) {
 }
 
 namespace {
+    // The version of the geometry cache.  This must be increased when the
+    // conversion to ROOT (including the built in solid converters), or the
+    // format of the cache file changes.
+    const int kGeometryCacheVersion = 2;
+
     int CountVolumes(G4LogicalVolume* volume) {
         int count = 1;
         for (std::size_t i=0; i < (std::size_t)volume->GetNoDaughters(); ++i) {
@@ -129,6 +121,13 @@ void EDepSim::RootGeometryManager::Update(const G4VPhysicalVolume* aWorld,
             delete *i;
         }
     }
+    // Check if the converted geometry has already been cached.
+    std::string cacheFile;
+    if (!fCacheDirectory.empty()) {
+        cacheFile = CacheFileName(aWorld);
+        if (ReadCache(cacheFile, validateGeometry)) return;
+    }
+
     // Create the new geometry.
     gGeoManager = new TGeoManager("EDepSimGeometry",
                                   "Simulated Detector Geometry");
@@ -147,8 +146,10 @@ void EDepSim::RootGeometryManager::Update(const G4VPhysicalVolume* aWorld,
 
     // Create the ROOT geometry definitions.
     fPrintedMass.clear();
+    fMassSummary.clear();
     fNameStack.clear();
     fKnownVolumes.clear();
+    fParameterisedCopy = NULL;
     EDepSimInfo("Start defining envelope");
     CreateEnvelope(aWorld,gGeoManager,NULL);
     EDepSimInfo("Geometry is Filled");
@@ -157,7 +158,11 @@ void EDepSim::RootGeometryManager::Update(const G4VPhysicalVolume* aWorld,
 
     EDepSimLog("Geometry initialized and closed");
 
-    if (validateGeometry) return Validate();
+    // Validation throws if there are overlaps, so a geometry that fails
+    // validation is never saved to the cache.
+    if (validateGeometry) Validate();
+
+    if (!cacheFile.empty()) WriteCache(cacheFile, validateGeometry);
 }
 
 void EDepSim::RootGeometryManager::Update(std::string gdmlFile,
@@ -201,6 +206,23 @@ void EDepSim::RootGeometryManager::Update(std::string gdmlFile,
 void EDepSim::RootGeometryManager::Validate() {
 
     int count = 0;
+    if (fValidateThreads > 1) {
+        // Check for overlaps at 0.1 mm size using the mesh vertices, and
+        // then by sampling points in each volume.
+        EDepSim::RootOverlapChecker checker(gGeoManager, fValidateThreads);
+        checker.SetTolerance(0.1*CLHEP::mm);
+        checker.SetSamplePoints(100000);
+        count = checker.Check();
+        if (count > 0) {
+            EDepSimThrow(
+                "The geometry has overlaps and will produce incorrect"
+                " results.  To use the geometry, specify the '-C' option"
+                " on the command line.");
+        }
+        EDepSimLog("Geometry validated");
+        return;
+    }
+
     // Check for overlaps at volume corners.  Look for overlaps at 0.1 mm size.
     gGeoManager->CheckOverlaps(0.1*CLHEP::mm);
     {
@@ -233,321 +255,253 @@ void EDepSim::RootGeometryManager::Validate() {
     EDepSimLog("Geometry validated");
 }
 
-TGeoShape* EDepSim::RootGeometryManager::CreateShape(
-    const std::string& theName,
-    const G4VSolid* theSolid,
-    TGeoMatrix **returnMatrix) {
-    const G4String geometryType = theSolid->GetEntityType();
-    TGeoShape* theShape = NULL;
-    if (geometryType == "G4Box") {
-        // Create a box
-        const G4Box* box = dynamic_cast<const G4Box*>(theSolid);
-        theShape = new TGeoBBox(box->GetXHalfLength()/CLHEP::mm,
-                                box->GetYHalfLength()/CLHEP::mm,
-                                box->GetZHalfLength()/CLHEP::mm);
-    }
-    else if (geometryType == "G4Tubs") {
-        const G4Tubs* tube = dynamic_cast<const G4Tubs*>(theSolid);
-        // Root takes the angles in degrees so there is no extra
-        // conversion.
-        double zhalf = tube->GetZHalfLength()/CLHEP::mm;
-        double rmin = tube->GetInnerRadius()/CLHEP::mm;
-        double rmax = tube->GetOuterRadius()/CLHEP::mm;
-        double minPhiDeg = tube->GetStartPhiAngle()/CLHEP::degree;
-        double maxPhiDeg = minPhiDeg + tube->GetDeltaPhiAngle()/CLHEP::degree;
-        theShape = new TGeoTubeSeg(rmin, rmax,
-                                   zhalf,
-                                   minPhiDeg, maxPhiDeg);
-    }
-    else if (geometryType == "G4Sphere") {
-        const G4Sphere* sphere = dynamic_cast<const G4Sphere*>(theSolid);
-        // Root takes the angles in degrees so there is no extra
-        // conversion.
-        double minPhiDeg = sphere->GetStartPhiAngle()/CLHEP::degree;
-        double maxPhiDeg = minPhiDeg + sphere->GetDeltaPhiAngle()/CLHEP::degree;
-        double minThetaDeg = sphere->GetStartThetaAngle()/CLHEP::degree;
-        double maxThetaDeg = minThetaDeg
-            + sphere->GetDeltaThetaAngle()/CLHEP::degree;
-        theShape = new TGeoSphere(sphere->GetInnerRadius()/CLHEP::mm,
-                                  sphere->GetOuterRadius()/CLHEP::mm,
-                                  minThetaDeg, maxThetaDeg,
-                                  minPhiDeg, maxPhiDeg);
-    }
-    else if (geometryType == "G4Hype") {
-        const G4Hype* Hype = dynamic_cast<const G4Hype*>(theSolid);
-        double rin = Hype->GetInnerRadius()/CLHEP::mm;
-        double stin = Hype->GetInnerStereo()/CLHEP::degree;
-        double rout = Hype->GetOuterRadius()/CLHEP::mm;
-        double stout = Hype->GetOuterStereo()/CLHEP::degree;
-        double dz = Hype->GetZHalfLength()/CLHEP::mm;
-        theShape = new TGeoHype(rin,stin,rout,stout,dz);
+namespace {
+    void HashString(TMD5& md5, const std::string& value) {
+        md5.Update(reinterpret_cast<const UChar_t*>(value.data()),
+                   value.size());
     }
-    else if (geometryType == "G4Paraboloid") {
-        const G4Paraboloid *Paraboloid = dynamic_cast<const G4Paraboloid *>(theSolid);
 
-        double rlo=Paraboloid->GetRadiusMinusZ()/CLHEP::mm;
-        double rhi=Paraboloid->GetRadiusPlusZ()/CLHEP::mm;
-        double dz=Paraboloid->GetZHalfLength()/CLHEP::mm;
-
-        theShape = new TGeoParaboloid(rlo,rhi,dz);
-    }
-    else if (geometryType == "G4Cons") {
-        const G4Cons* Cons = dynamic_cast<const G4Cons*>(theSolid);
-        double rmin1 = Cons->GetInnerRadiusMinusZ()/ CLHEP::mm;
-        double rmax1 = Cons->GetOuterRadiusMinusZ() / CLHEP::mm;
-        double rmin2 = Cons->GetInnerRadiusPlusZ()/CLHEP::mm;
-        double rmax2 = Cons->GetOuterRadiusPlusZ ()/CLHEP::mm;
-        double dz = Cons->GetZHalfLength()/ CLHEP::mm;
-        double phi1 = Cons->GetStartPhiAngle()/ CLHEP::degree;
-        double phi2 = Cons->GetDeltaPhiAngle()/ CLHEP::degree;
-        theShape = new TGeoConeSeg(dz, rmin1, rmax1, rmin2, rmax2, phi1, phi2);
-    }
-    else if (geometryType == "G4Torus") {
-      const G4Torus* torus = dynamic_cast<const G4Torus*>(theSolid);
-      // Root takes the angles in degrees so there is no extra
-      // conversion.
-      double minR = torus->GetRmin()/CLHEP::mm;
-      double maxR = torus->GetRmax()/CLHEP::mm;
-      double axialR = torus->GetRtor()/CLHEP::mm;
-      double phi1 = torus->GetSPhi()/CLHEP::degree;
-      double dphi = torus->GetDPhi()/CLHEP::degree;
-      theShape = new TGeoTorus(axialR, minR, maxR, phi1, dphi);
-    }
-    else if (geometryType == "G4Para") {
-        const G4Para* para = dynamic_cast<const G4Para*>(theSolid);
-        double dX = para->GetXHalfLength() / CLHEP::mm;
-        double dY = para->GetYHalfLength() / CLHEP::mm;
-        double dZ = para->GetZHalfLength() / CLHEP::mm;
-        double alpha =std::atan(para->GetTanAlpha())/CLHEP::degree;
-        G4ThreeVector SymAxis =para->GetSymAxis();
-        double theta = std::acos(SymAxis.z())/CLHEP::degree;
-        double phi = std::acos(SymAxis.x()/std::sin(theta))/CLHEP::degree;
-        theShape = new TGeoPara(dX, dY, dZ, alpha, theta, phi);
-    }
-    else if (geometryType == "G4Polyhedra") {
-        const G4Polyhedra* polyhedra
-            = dynamic_cast<const G4Polyhedra*>(theSolid);
-        double phi = polyhedra->GetStartPhi();
-        double dPhi = polyhedra->GetEndPhi() - phi;
-        if (dPhi>2*M_PI) dPhi -= 2*M_PI;
-        if (dPhi<0) dPhi += 2*M_PI;
-        int sides = polyhedra->GetNumSide();
-        int numZ = polyhedra->GetNumRZCorner()/2;
-        // Factor to take into account that ROOT uses the circle that can be
-        // inscribed inside the polygon, and G4 uses the corner
-        double g4Factor = std::cos(0.5*dPhi/sides);
-        TGeoPgon* pgon = new TGeoPgon(phi/CLHEP::degree,
-                                      dPhi/CLHEP::degree, sides, numZ);
-        for (int i = 0; i< numZ; ++i) {
-            double rMin = g4Factor*polyhedra->GetCorner(numZ-i-1).r;
-            double rMax = g4Factor*polyhedra->GetCorner(numZ+i).r;
-            if (rMax < rMin) std::swap(rMin,rMax);
-            pgon->DefineSection(i,
-                                polyhedra->GetCorner(numZ-i-1).z/CLHEP::mm,
-                                rMin/CLHEP::mm,
-                                rMax/CLHEP::mm);
+    // Add a description of a logical volume and all of its daughters to the
+    // hash.  Each logical volume (and material) is only described once, and
+    // is then referred to by the order in which it was first seen, so the
+    // cost scales with the number of placements, not the size of the
+    // expanded geometry tree.
+    void HashLogicalVolume(TMD5& md5,
+                           std::map<const G4LogicalVolume*,int>& volumes,
+                           std::set<const G4Material*>& materials,
+                           const G4LogicalVolume* theLog) {
+        if (volumes.find(theLog) != volumes.end()) return;
+        int index = volumes.size();
+        volumes[theLog] = index;
+
+        std::ostringstream desc;
+        desc.precision(17);
+        desc << "LV " << index << " " << theLog->GetName()
+             << " " << theLog->GetMaterial()->GetName() << std::endl;
+        if (materials.insert(theLog->GetMaterial()).second) {
+            desc << theLog->GetMaterial() << std::endl;
         }
-        theShape = pgon;
-    }
-    else if (geometryType == "G4Polycone") {
-        const G4Polycone* polycone
-            = dynamic_cast<const G4Polycone*>(theSolid);
-        double phi = polycone->GetStartPhi();
-        double dPhi = polycone->GetEndPhi() - phi;
-        if (dPhi>2*M_PI) dPhi -= 2*M_PI;
-        if (dPhi<0) dPhi += 2*M_PI;
-#ifdef G4GEOM_USE_USOLIDS
-#warning GEANT HAS BEEN COMPILED WITH BROKEN USOLIDS.
-        int numZ = polycone->GetNumRZCorner()/2;
-        TGeoPcon* pcon = new TGeoPcon(phi/CLHEP::degree,
-                                      dPhi/CLHEP::degree, numZ);
-        // This depends on the (mostly) undocumented order of the corners in
-        // the G4Polycone internals.  It's a little unstable...
-        for (int i = 0; i< numZ; ++i) {
-            pcon->DefineSection(i,
-                                polycone->GetCorner(numZ-i-1).z/CLHEP::mm,
-                                polycone->GetCorner(numZ-i-1).r/CLHEP::mm,
-                                polycone->GetCorner(numZ+i).r/CLHEP::mm);
-        }
-#else
-        const G4PolyconeHistorical* param = polycone->GetOriginalParameters();
-        int numZ = param->Num_z_planes;
-        TGeoPcon* pcon = new TGeoPcon(phi/CLHEP::degree,
-                                      dPhi/CLHEP::degree,
-                                      numZ);
-        // This depends on the older interface.  It's not marked as
-        // deprecated, but the documentation discourages it's use.
-        for (int i = 0; i< numZ; ++i) {
-            pcon->DefineSection(i,
-                                param->Z_values[i]/CLHEP::mm,
-                                param->Rmin[i]/CLHEP::mm,
-                                param->Rmax[i]/CLHEP::mm);
+        theLog->GetSolid()->StreamInfo(desc);
+        const G4VisAttributes* visAttributes = theLog->GetVisAttributes();
+        if (visAttributes) {
+            desc << "VIS " << visAttributes->GetColor()
+                 << " " << visAttributes->IsVisible() << std::endl;
         }
-#endif
-        theShape = pcon;
-    }
-    else if (geometryType == "G4Trap") {
-        const G4Trap* trap
-            = dynamic_cast<const G4Trap*>(theSolid);
-        double dz = trap->GetZHalfLength()/CLHEP::mm;
-        double theta = 0;
-        double phi = 0;
-        double h1 = trap->GetYHalfLength1()/CLHEP::mm;
-        double bl1 = trap->GetXHalfLength1()/CLHEP::mm;
-        double tl1 = trap->GetXHalfLength2()/CLHEP::mm;
-        double alpha1 = std::atan(trap->GetTanAlpha1())/CLHEP::degree;
-        double h2 = trap->GetYHalfLength2()/CLHEP::mm;
-        double bl2 = trap->GetXHalfLength3()/CLHEP::mm;
-        double tl2 = trap->GetXHalfLength4()/CLHEP::mm;
-        double alpha2 = std::atan(trap->GetTanAlpha2())/CLHEP::degree;
-        theShape = new TGeoTrap(dz, theta, phi,
-                                h1, bl1, tl1, alpha1,
-                                h2, bl2, tl2, alpha2);
-    }
-    else if (geometryType == "G4Trd") {
-        const G4Trd* trd
-            = dynamic_cast<const G4Trd*>(theSolid);
-        double dz = trd->GetZHalfLength()/CLHEP::mm;
-        double dx1 = trd->GetXHalfLength1()/CLHEP::mm;
-        double dx2 = trd->GetXHalfLength2()/CLHEP::mm;
-        double dy1 = trd->GetYHalfLength1()/CLHEP::mm;
-        double dy2 = trd->GetYHalfLength2()/CLHEP::mm;
-        theShape = new TGeoTrd2(dx1,dx2,dy1,dy2,dz);
-    }
-    else if (geometryType == "G4GenericTrap") {
-        const G4GenericTrap* trap
-            = dynamic_cast<const G4GenericTrap*>(theSolid);
-        double dz = trap->GetZHalfLength()/CLHEP::mm;
-        double vertices[2*8] = { }; // initialized to zeroes
-        for (int i = 0; i < trap->GetNofVertices(); ++i) {
-            const G4TwoVector& v = trap->GetVertex(i);
-            vertices[2*i] = v.x()/CLHEP::mm;
-            vertices[2*i + 1] = v.y()/CLHEP::mm;
+        HashString(md5, desc.str());
+
+        for (std::size_t i = 0;
+             i < (std::size_t) theLog->GetNoDaughters(); ++i) {
+            const G4VPhysicalVolume* daughter = theLog->GetDaughter(i);
+            const G4LogicalVolume* daughterLog = daughter->GetLogicalVolume();
+            HashLogicalVolume(md5, volumes, materials, daughterLog);
+            std::ostringstream place;
+            place.precision(17);
+            place << "PV " << daughter->GetName()
+                  << " " << daughter->GetCopyNo()
+                  << " " << volumes[daughterLog]
+                  << " " << daughter->GetObjectTranslation()
+                  << " " << *daughter->GetObjectRotation();
+            if (daughter->IsReplicated()) {
+                EAxis a; G4int nRep; G4double w; G4double o; G4bool c;
+                daughter->GetReplicationData(a,nRep,w,o,c);
+                place << " REP " << a << " " << nRep << " " << w
+                      << " " << o << " " << c;
+                // The parameterisation can change the solid and the position
+                // of every copy, so describe each one.
+                G4VPVParameterisation* param = daughter->GetParameterisation();
+                G4VPhysicalVolume* thePV
+                    = const_cast<G4VPhysicalVolume*>(daughter);
+                for (int i = 0; param && i < nRep; ++i) {
+                    G4VSolid* solid = param->ComputeSolid(i, thePV);
+                    solid->ComputeDimensions(param, i, thePV);
+                    param->ComputeTransformation(i, thePV);
+                    place << std::endl << "COPY " << i
+                          << " " << thePV->GetObjectTranslation()
+                          << " " << *thePV->GetObjectRotation()
+                          << std::endl;
+                    solid->StreamInfo(place);
+                }
+            }
+            place << std::endl;
+            HashString(md5, place.str());
         }
-        theShape = new TGeoArb8(dz, vertices);
-    }
-    else if (geometryType == "G4SubtractionSolid") {
-        const G4SubtractionSolid* sub
-            = dynamic_cast<const G4SubtractionSolid*>(theSolid);
-        const G4VSolid* solidA = sub->GetConstituentSolid(0);
-        const G4VSolid* solidB = sub->GetConstituentSolid(1);
-        // solidA - solidB
-        TGeoMatrix* matrixA = NULL;
-        TGeoShape* shapeA = CreateShape(theName, solidA, &matrixA);
-        TGeoMatrix* matrixB = NULL;
-        TGeoShape* shapeB = CreateShape(theName, solidB, &matrixB);
-        TGeoSubtraction* subtractNode = new TGeoSubtraction(shapeA,shapeB,
-                                                            matrixA, matrixB);
-        theShape = new TGeoCompositeShape("name",subtractNode);
     }
-    else if (geometryType == "G4DisplacedSolid") {
-        const G4DisplacedSolid* disp
-            = dynamic_cast<const G4DisplacedSolid*>(theSolid);
-        const G4VSolid* movedSolid = disp->GetConstituentMovedSolid();
-        G4RotationMatrix rotation = disp->GetObjectRotation();
-        G4ThreeVector displacement = disp->GetObjectTranslation();
-        theShape = CreateShape(theName, movedSolid);
-        if (returnMatrix) {
-            TGeoRotation* rotate
-                = new TGeoRotation("rot",
-                                   TMath::RadToDeg()*rotation.thetaX(),
-                                   TMath::RadToDeg()*rotation.phiX(),
-                                   TMath::RadToDeg()*rotation.thetaY(),
-                                   TMath::RadToDeg()*rotation.phiY(),
-                                   TMath::RadToDeg()*rotation.thetaZ(),
-                                   TMath::RadToDeg()*rotation.phiZ());
-            *returnMatrix = new TGeoCombiTrans(displacement.x()/CLHEP::mm,
-                                               displacement.y()/CLHEP::mm,
-                                               displacement.z()/CLHEP::mm,
-                                               rotate);
+}
+
+std::string EDepSim::RootGeometryManager::CacheFileName(
+    const G4VPhysicalVolume* aWorld) {
+    TMD5 md5;
+
+    // Include the versions since they can change the conversion, or the
+    // format of the cached file.
+    std::ostringstream header;
+    header << "EDepSimGeometryCache " << kGeometryCacheVersion
+           << " ROOT " << gROOT->GetVersionInt()
+           << " G4 " << G4VERSION_NUMBER << std::endl;
+
+    // Include the solid converters since they change the conversion.  An
+    // external converter is described by where it was loaded from, and a
+    // checksum of the library (when the library file can be read).
+    for (std::map<std::string, EDepSim::VRootSolidConverter*>::iterator
+             c = fSolidConverters.begin();
+         c != fSolidConverters.end();
+         ++c) {
+        EDepSim::VRootSolidConverter* converter = c->second;
+        header << "CONVERTER " << c->first
+               << " " << typeid(*converter).name();
+        if (!converter->GetLibrary().empty()) {
+            header << " " << converter->GetLibrary()
+                   << " " << converter->GetSymbol()
+                   << " " << converter->GetOption();
+            // AccessPathName returns true when the file does NOT exist.
+            const char* library = converter->GetLibrary().c_str();
+            if (!gSystem->AccessPathName(library)) {
+                std::unique_ptr<TMD5> checksum(TMD5::FileChecksum(library));
+                if (checksum) header << " " << checksum->AsString();
+            }
         }
+        header << std::endl;
     }
-    else if (geometryType == "G4UnionSolid") {
-        const G4UnionSolid* sub
-            = dynamic_cast<const G4UnionSolid*>(theSolid);
-        const G4VSolid* solidA = sub->GetConstituentSolid(0);
-        const G4VSolid* solidB = sub->GetConstituentSolid(1);
-        // solidA - solidB
-        TGeoMatrix* matrixA = NULL;
-        TGeoShape* shapeA = CreateShape(theName, solidA, &matrixA);
-        TGeoMatrix* matrixB = NULL;
-        TGeoShape* shapeB = CreateShape(theName, solidB, &matrixB);
-        TGeoUnion* unionNode = new TGeoUnion(shapeA,  shapeB,
-                                             matrixA, matrixB);
-        theShape = new TGeoCompositeShape("name",unionNode);
+    for (std::vector<G4String>::iterator n = fPrintMass.begin();
+         n != fPrintMass.end();
+         ++n) {
+        header << "MASS " << *n << std::endl;
     }
-    else if (geometryType == "G4IntersectionSolid") {
-        const G4IntersectionSolid* sub
-	  = dynamic_cast<const G4IntersectionSolid*>(theSolid);
-        const G4VSolid* solidA = sub->GetConstituentSolid(0);
-        const G4VSolid* solidB = sub->GetConstituentSolid(1);
-        // solidA - solidB
-        TGeoMatrix* matrixA = NULL;
-        TGeoShape* shapeA = CreateShape(theName, solidA, &matrixA);
-        TGeoMatrix* matrixB = NULL;
-        TGeoShape* shapeB = CreateShape(theName, solidB, &matrixB);
-        TGeoIntersection* intersectionNode
-            = new TGeoIntersection(shapeA,  shapeB,
-                                   matrixA, matrixB);
-        theShape = new TGeoCompositeShape("name",intersectionNode);
+    HashString(md5, header.str());
+
+    std::map<const G4LogicalVolume*,int> volumes;
+    std::set<const G4Material*> materials;
+    HashLogicalVolume(md5, volumes, materials, aWorld->GetLogicalVolume());
+    HashString(md5, aWorld->GetName());
+
+    md5.Final();
+    return fCacheDirectory + "/edepsim-geometry-" + md5.AsString() + ".root";
+}
+
+bool EDepSim::RootGeometryManager::ReadCache(const std::string& cacheFile,
+                                             bool validateGeometry) {
+    // AccessPathName returns true when the file does NOT exist.
+    if (gSystem->AccessPathName(cacheFile.c_str())) {
+        EDepSimLog("Geometry cache miss: " << cacheFile);
+        return false;
     }
-    else if (geometryType == "G4ExtrudedSolid"){
-        //This following only works when using the 'standard'
-        //G4ExtrudedSolid Constructor.
-
-        const G4ExtrudedSolid* extr
-            = dynamic_cast<const G4ExtrudedSolid*>(theSolid);
-
-        //number of z planes
-        const G4int nZ = extr->GetNofZSections();
-        //number of vertices in the polygon
-        const G4int nV = extr->GetNofVertices();
-
-        //define and pointers
-        const int maxVertices = 1000;
-        double vertices_x[maxVertices];
-        double vertices_y[maxVertices];
-        if (maxVertices < nV) {
-            EDepSimThrow("Polygon with more than maxVertices");
+
+    bool validated = false;
+    std::vector<std::string> massSummary;
+    {
+        TDirectory::TContext context;
+        std::unique_ptr<TFile> input(TFile::Open(cacheFile.c_str(),"READ"));
+        if (!input || input->IsZombie()) {
+            EDepSimError("Cannot read geometry cache: " << cacheFile);
+            return false;
+        }
+        TParameter<int>* valid = dynamic_cast<TParameter<int>*>(
+            input->Get("EDepSimGeometryValidated"));
+        if (valid) validated = (valid->GetVal() != 0);
+        TObjArray* masses
+            = dynamic_cast<TObjArray*>(input->Get("EDepSimGeometryMasses"));
+        if (masses) {
+            masses->SetOwner(true);
+            TIter next(masses);
+            TObjString* line;
+            while ((line=(TObjString*)next())) {
+                massSummary.push_back(line->GetString().Data());
+            }
+            delete masses;
         }
+        delete valid;
+        input->Close();
+    }
 
+    if (!TGeoManager::Import(cacheFile.c_str(), "EDepSimGeometry")) {
+        EDepSimError("Geometry cache is not valid: " << cacheFile);
+        return false;
+    }
+    gGeoManager->SetVisLevel(20);
 
-        //define an intermediate extrusion constructor with nZ z planes.
-        TGeoXtru *xtru = new TGeoXtru(nZ);
+    EDepSimLog("Geometry read from cache: " << cacheFile);
+    fMassSummary = massSummary;
+    for (std::vector<std::string>::iterator m = fMassSummary.begin();
+         m != fMassSummary.end();
+         ++m) {
+        EDepSimLog(*m);
+    }
 
-        //Get the polygons points.
-        std::vector<G4TwoVector> polyPoints = extr->GetPolygon();
+    if (validateGeometry && !validated) {
+        Validate();
+        WriteCache(cacheFile, true);
+    }
+    else if (validateGeometry) {
+        EDepSimLog("Geometry validated (cached)");
+    }
 
-        //fill the vertices arrays
-        for(int i = 0 ; i < nV ; i++){
-            vertices_x[i]= polyPoints[i].x();
-            vertices_y[i]= polyPoints[i].y();
-        }
+    return true;
+}
 
-        //Define the polygon
-        xtru->DefinePolygon(nV, vertices_x, vertices_y);
+void EDepSim::RootGeometryManager::WriteCache(const std::string& cacheFile,
+                                              bool validated) {
+    if (!gGeoManager) return;
+    gSystem->mkdir(fCacheDirectory.c_str(), true);
+
+    // Write into a temporary file and then move it into place so that jobs
+    // sharing a cache directory never see a partially written file.
+    std::ostringstream tmpName;
+    tmpName << cacheFile << ".tmp" << gSystem->GetPid();
+
+    TDirectory::TContext context;
+    std::unique_ptr<TFile> output(
+        TFile::Open(tmpName.str().c_str(),"RECREATE"));
+    if (!output || output->IsZombie()) {
+        EDepSimError("Cannot write geometry cache: " << tmpName.str());
+        return;
+    }
+    gGeoManager->Write("EDepSimGeometry");
+    TParameter<int> valid("EDepSimGeometryValidated", validated ? 1 : 0);
+    valid.Write();
+    TObjArray masses;
+    masses.SetOwner(true);
+    for (std::vector<std::string>::iterator m = fMassSummary.begin();
+         m != fMassSummary.end();
+         ++m) {
+        masses.Add(new TObjString(m->c_str()));
+    }
+    masses.Write("EDepSimGeometryMasses", TObject::kSingleKey);
+    output->Close();
 
-        double z_pos, x_off, y_off, scale;
+    if (std::rename(tmpName.str().c_str(), cacheFile.c_str()) != 0) {
+        EDepSimError("Cannot move geometry cache into place: " << cacheFile);
+        std::remove(tmpName.str().c_str());
+        return;
+    }
+    EDepSimLog("Geometry saved to cache: " << cacheFile);
+}
 
-        //fill the parameters to define the Root extruded solid
-        for(int i = 0 ; i < nZ ; i++){
-            z_pos = extr->GetZSection(i).fZ;
-            x_off = extr->GetZSection(i).fOffset.x() ;
-            y_off = extr->GetZSection(i).fOffset.y();
-            scale = extr->GetZSection(i).fScale;
-            xtru->DefineSection(i, z_pos, x_off, y_off, scale);
-        }
-        //now assign 'theShape' to this complete extruded object.
-        theShape = xtru;
+void EDepSim::RootGeometryManager::AddSolidConverter(
+    EDepSim::VRootSolidConverter* converter) {
+    if (!converter) return;
+    std::map<std::string, EDepSim::VRootSolidConverter*>::iterator
+        old = fSolidConverters.find(converter->GetEntityType());
+    if (old != fSolidConverters.end()) {
+        if (old->second == converter) return;
+        EDepSimLog("Replace solid converter for " << old->first);
+        delete old->second;
     }
-    else if (geometryType == "G4EllipticalTube") {
-        const G4EllipticalTube* ellipticalTube
-            = dynamic_cast<const G4EllipticalTube*>(theSolid);
-        theShape = new TGeoEltu(ellipticalTube->GetDx()/CLHEP::mm,
-                                ellipticalTube->GetDy()/CLHEP::mm,
-                                ellipticalTube->GetDz()/CLHEP::mm);
+    fSolidConverters[converter->GetEntityType()] = converter;
+}
+
+TGeoShape* EDepSim::RootGeometryManager::CreateShape(
+    const std::string& theName,
+    const G4VSolid* theSolid,
+    TGeoMatrix **returnMatrix) {
+    const std::string geometryType = theSolid->GetEntityType();
+    std::map<std::string, EDepSim::VRootSolidConverter*>::iterator
+        converter = fSolidConverters.find(geometryType);
+    TGeoShape* theShape = NULL;
+    if (converter != fSolidConverters.end()) {
+        theShape = converter->second->CreateShape(*this, theName,
+                                                  theSolid, returnMatrix);
     }
-    else {
+    if (!theShape) {
         EDepSimThrow(theName + " :: " + geometryType
                      + " --> shape not implemented");
     }
@@ -713,15 +667,26 @@ bool EDepSim::RootGeometryManager::CreateEnvelope(
 
     if (IgnoreVolume(theG4PhysVol)) return true;
 
+    // A parameterised volume can change the solid and position of each copy,
+    // so every copy is exported as a separate volume.
+    if (theG4PhysVol->GetParameterisation()
+        && theG4PhysVol != fParameterisedCopy) {
+        return CreateParameterisedEnvelope(theG4PhysVol,
+                                           theEnvelope, theMother);
+    }
+
     // The new volume that will be added to the mother volume.  This is
     // created in this function.
     TGeoVolume* theVolume = NULL;
     G4LogicalVolume* theLog = theG4PhysVol->GetLogicalVolume();
 
     if (PrintMass(theG4PhysVol)) {
-        EDepSimLog("%%% Mass: "
-                   << G4BestUnit(theLog->GetMass(true),"Mass")
-                   << " Volume: " << theG4PhysVol->GetName());
+        std::ostringstream massLine;
+        massLine << "%%% Mass: "
+                 << G4BestUnit(theLog->GetMass(true),"Mass")
+                 << " Volume: " << theG4PhysVol->GetName();
+        fMassSummary.push_back(massLine.str());
+        EDepSimLog(massLine.str());
     }
 
     // Get the name of the expected name of the volume.
@@ -858,7 +823,8 @@ bool EDepSim::RootGeometryManager::CreateEnvelope(
                              TMath::RadToDeg()*rot->phiY(),
                              TMath::RadToDeg()*rot->thetaZ(),
                              TMath::RadToDeg()*rot->phiZ());
-        if (theG4PhysVol->IsReplicated()) {
+        if (theG4PhysVol->IsReplicated()
+            && !theG4PhysVol->GetParameterisation()) {
             EAxis a; G4int nRep; G4double w; G4double o; G4bool c;
             G4ThreeVector axis;
             theG4PhysVol->GetReplicationData(a,nRep,w,o,c);
@@ -897,6 +863,53 @@ bool EDepSim::RootGeometryManager::CreateEnvelope(
     return false;
 }
 
+// Save each copy of a parameterised volume.  The parameterisation sets the
+// solid, and the position of the physical volume for a copy, and then the
+// copy is saved by CreateEnvelope as if it were a normal placement.  The
+// material of the copies is not changed.
+bool EDepSim::RootGeometryManager::CreateParameterisedEnvelope(
+    const G4VPhysicalVolume* theG4PhysVol,
+    TGeoManager* theEnvelope,
+    TGeoVolume* theMother) {
+    G4VPhysicalVolume* thePV = const_cast<G4VPhysicalVolume*>(theG4PhysVol);
+    G4VPVParameterisation* param = thePV->GetParameterisation();
+    G4LogicalVolume* theLog = thePV->GetLogicalVolume();
+
+    EAxis a; G4int nRep; G4double w; G4double o; G4bool c;
+    thePV->GetReplicationData(a,nRep,w,o,c);
+
+    // The copies have different shapes, so a new volume is needed for each
+    // one.
+    const G4VPhysicalVolume* savedCopy = fParameterisedCopy;
+    bool savedCreateAll = fCreateAllVolumes;
+    fParameterisedCopy = thePV;
+    fCreateAllVolumes = true;
+
+    // The logical volume is still used by GEANT4, so the solid and the
+    // placement are put back after the copies are saved.
+    G4VSolid* savedSolid = theLog->GetSolid();
+    G4RotationMatrix* savedRotation = thePV->GetRotation();
+    G4ThreeVector savedTranslation = thePV->GetTranslation();
+
+    bool ignored = false;
+    for (int i=0; i<nRep; ++i) {
+        G4VSolid* solid = param->ComputeSolid(i, thePV);
+        solid->ComputeDimensions(param, i, thePV);
+        param->ComputeTransformation(i, thePV);
+        theLog->SetSolid(solid);
+        if (CreateEnvelope(thePV, theEnvelope, theMother)) ignored = true;
+    }
+
+    theLog->SetSolid(savedSolid);
+    thePV->SetRotation(savedRotation);
+    thePV->SetTranslation(savedTranslation);
+    fParameterisedCopy = savedCopy;
+    fCreateAllVolumes = savedCreateAll;
+    fKnownVolumes.erase(theLog);
+
+    return ignored;
+}
+
 void EDepSim::RootGeometryManager::SetDrawAtt(G4Material* material,
                                               int color, double opacity) {
     G4String materialName = material->GetName();
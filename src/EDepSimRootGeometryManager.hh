@@ -26,6 +26,9 @@ class TGeoNode;
 
 class G4Material;
 class G4VPhysicalVolume;
+class G4VSolid;
+
+namespace EDepSim {class VRootSolidConverter;}
 
 namespace EDepSim {class RootGeometryManager;}
 /// Provide a root output for the geant 4 events.
@@ -70,6 +73,42 @@ public:
         fPrintMass.push_back(name);
     }
 
+    /// Set the directory used to cache the converted ROOT geometry.  When
+    /// this is set, Update() looks for a file keyed by a hash of the G4
+    /// geometry description and loads it instead of converting the geometry.
+    /// The converted geometry (along with the printed masses and the
+    /// validation result) is saved after a cache miss.  An empty directory
+    /// name disables the cache.
+    void SetCacheDirectory(std::string dir) {fCacheDirectory = dir;}
+
+    /// Get the geometry cache directory.
+    std::string GetCacheDirectory() const {return fCacheDirectory;}
+
+    /// Set the number of threads used to validate the geometry.  If this is
+    /// more than one, the volume tree is partitioned between the threads
+    /// (see EDepSim::RootOverlapChecker).  Otherwise, the geometry is
+    /// validated using TGeoManager::CheckOverlaps.
+    void SetValidateThreads(int threads) {fValidateThreads = threads;}
+
+    /// Get the number of threads used to validate the geometry.
+    int GetValidateThreads() const {return fValidateThreads;}
+
+    /// Add a converter from a G4 solid to a ROOT shape.  The converter is
+    /// used for solids with an entity type matching
+    /// EDepSim::VRootSolidConverter::GetEntityType(), and replaces any
+    /// existing converter for that type.  The geometry manager takes
+    /// ownership of the converter.
+    void AddSolidConverter(EDepSim::VRootSolidConverter* converter);
+
+    /// Create a new ROOT shape object based on the G4 solid using the
+    /// registered converter for the solid type.  This is called recursively
+    /// by the converters for solids built from other solids (e.g. the G4
+    /// boolean solids).  An exception is thrown if there isn't a converter
+    /// for the solid.
+    TGeoShape* CreateShape(const std::string& theName,
+                           const G4VSolid* theSolid,
+                           TGeoMatrix **mat = NULL);
+
 protected:
     /// use Get() instead
     RootGeometryManager();
@@ -106,6 +145,22 @@ private:
     /// A map of which masses have been printed.
     std::set<G4String> fPrintedMass;
 
+    /// The mass summary lines printed while converting the geometry.  These
+    /// are saved with a cached geometry so they are repeated when the cache
+    /// is used.
+    std::vector<std::string> fMassSummary;
+
+    /// The directory where converted geometries are cached.  The cache is
+    /// not used if this is empty.
+    std::string fCacheDirectory;
+
+    /// The number of threads used to validate the geometry.
+    int fValidateThreads;
+
+    /// The converters from G4 solids to ROOT shapes keyed by the G4 entity
+    /// type.
+    std::map<std::string, EDepSim::VRootSolidConverter*> fSolidConverters;
+
     /// A stack of volume names that have been seen.  These are the "short"
     /// volume names of all of the parents to the current volue.
     std::vector<G4String> fNameStack;
@@ -125,11 +180,29 @@ private:
     /// the geant geometry and counting the number of unique volumes.
     bool fCreateAllVolumes;
 
-    /// Create a new ROOT shape object based on the G4 solid.  This might be
-    /// called recursively if a G4 boolean solid is found.
-    TGeoShape* CreateShape(const std::string& theName,
-                           const G4VSolid* theSolid,
-                           TGeoMatrix **mat = NULL);
+    /// The parameterised volume that has a copy being saved by
+    /// CreateEnvelope.  The parameterisation has already set the solid and
+    /// position for the copy.
+    const G4VPhysicalVolume* fParameterisedCopy;
+
+    /// Return the name of the cache file for a G4 geometry.  The name is
+    /// built from an MD5 hash of the geometry description (solids,
+    /// placements, materials and visual attributes) and the list of volumes
+    /// with printed masses.
+    std::string CacheFileName(const G4VPhysicalVolume* aWorld);
+
+    /// Load the ROOT geometry from a cache file.  This returns true if
+    /// gGeoManager has been set from the cache.  If validation is requested
+    /// but the cached geometry has not been validated, the validation is run
+    /// and the cache is updated.
+    bool ReadCache(const std::string& cacheFile, bool validate);
+
+    /// Save the current ROOT geometry to a cache file.
+    void WriteCache(const std::string& cacheFile, bool validated);
+
+    /// Register the converters for the G4 solids that are handled natively.
+    /// This is defined in EDepSimRootSolidConverters.cc.
+    void AddDefaultSolidConverters();
 
     /// Create a new ROOT volume object.
     TGeoVolume* CreateVolume(const G4VSolid* theSolid,
@@ -148,6 +221,14 @@ private:
                         TGeoManager* theEnvelope,
                         TGeoVolume* theMother);
 
+    /// Save the copies of a parameterised volume.  Each copy is saved as a
+    /// separate ROOT volume (with its own daughters) since the solid can be
+    /// different for every copy.  This returns true if a daughter volume was
+    /// ignored.
+    bool CreateParameterisedEnvelope(const G4VPhysicalVolume* theVol,
+                                     TGeoManager* theEnvelope,
+                                     TGeoVolume* theMother);
+
     // Method counts how many nodes there are in mother volume with the
     // same name as daughter node.
     int HowManySimilarNodesInVolume(TGeoVolume* theMother,
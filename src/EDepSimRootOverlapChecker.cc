@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimRootOverlapChecker.hh"
+
+#include "EDepSimLog.hh"
+
+#include <TGeoManager.h>
+#include <TGeoVolume.h>
+#include <TGeoNode.h>
+#include <TGeoBBox.h>
+#include <TGeoMatrix.h>
+#include <TObjArray.h>
+#include <TRandom3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace {
+    // A uniform grid of cells covering the daughters of a mother volume.
+    // Each cell holds the indices of the daughters whose bounding boxes
+    // touch the cell.  This is used to find the daughters that might
+    // contain a point without checking every daughter.
+    class DaughterGrid {
+    public:
+        DaughterGrid(const std::vector<double>& lo,
+                     const std::vector<double>& hi) {
+            int nBoxes = lo.size()/3;
+            for (int j=0; j<3; ++j) {
+                fLow[j] = lo[j];
+                fHigh[j] = hi[j];
+            }
+            for (int i=0; i<nBoxes; ++i) {
+                for (int j=0; j<3; ++j) {
+                    fLow[j] = std::min(fLow[j], lo[3*i+j]);
+                    fHigh[j] = std::max(fHigh[j], hi[3*i+j]);
+                }
+            }
+            // Aim for about one daughter per cell.
+            int cells = std::max(1, (int) std::cbrt((double) nBoxes));
+            cells = std::min(cells, 100);
+            for (int j=0; j<3; ++j) {
+                fCells[j] = cells;
+                double width = fHigh[j] - fLow[j];
+                fInverse[j] = (width > 0.0) ? cells/width : 0.0;
+            }
+            fContents.resize(fCells[0]*fCells[1]*fCells[2]);
+            for (int i=0; i<nBoxes; ++i) {
+                int low[3];
+                int high[3];
+                for (int j=0; j<3; ++j) {
+                    low[j] = Bin(j,lo[3*i+j]);
+                    high[j] = Bin(j,hi[3*i+j]);
+                }
+                for (int x=low[0]; x<=high[0]; ++x) {
+                    for (int y=low[1]; y<=high[1]; ++y) {
+                        for (int z=low[2]; z<=high[2]; ++z) {
+                            fContents[Index(x,y,z)].push_back(i);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Return the daughters that might contain the point.  This returns
+        // NULL if the point is outside of the grid.
+        const std::vector<int>* Find(const double* point) const {
+            for (int j=0; j<3; ++j) {
+                if (point[j] < fLow[j] || fHigh[j] < point[j]) return NULL;
+            }
+            return &fContents[Index(Bin(0,point[0]),
+                                    Bin(1,point[1]),
+                                    Bin(2,point[2]))];
+        }
+
+    private:
+        int Bin(int axis, double value) const {
+            int bin = (value - fLow[axis])*fInverse[axis];
+            if (bin < 0) return 0;
+            if (bin >= fCells[axis]) return fCells[axis]-1;
+            return bin;
+        }
+
+        int Index(int x, int y, int z) const {
+            return (x*fCells[1] + y)*fCells[2] + z;
+        }
+
+        double fLow[3];
+        double fHigh[3];
+        double fInverse[3];
+        int fCells[3];
+        std::vector< std::vector<int> > fContents;
+    };
+
+    // Find the bounding box of a node in the mother coordinates.
+    void NodeBounds(const TGeoNode* node, double* lo, double* hi) {
+        const TGeoBBox* box
+            = dynamic_cast<const TGeoBBox*>(node->GetVolume()->GetShape());
+        const TGeoMatrix* matrix = node->GetMatrix();
+        const double* origin = box->GetOrigin();
+        const double half[3] = {box->GetDX(), box->GetDY(), box->GetDZ()};
+        for (int j=0; j<3; ++j) {
+            lo[j] = 1E+300;
+            hi[j] = -1E+300;
+        }
+        for (int corner=0; corner<8; ++corner) {
+            double local[3];
+            double master[3];
+            for (int j=0; j<3; ++j) {
+                double sign = (corner & (1<<j)) ? 1.0 : -1.0;
+                local[j] = origin[j] + sign*half[j];
+            }
+            matrix->LocalToMaster(local,master);
+            for (int j=0; j<3; ++j) {
+                lo[j] = std::min(lo[j],master[j]);
+                hi[j] = std::max(hi[j],master[j]);
+            }
+        }
+    }
+
+    // Keep the largest distance found for each pair of daughters.  The
+    // second index is negative for an extrusion from the mother.
+    typedef std::map<std::pair<int,int>, double> OverlapMap;
+
+    void RecordOverlap(OverlapMap& overlaps, int first, int second,
+                       double distance) {
+        if (second >= 0 && second < first) std::swap(first,second);
+        std::pair<int,int> key(first,second);
+        OverlapMap::iterator o = overlaps.find(key);
+        if (o == overlaps.end()) overlaps[key] = distance;
+        else o->second = std::max(o->second, distance);
+    }
+}
+
+EDepSim::RootOverlapChecker::RootOverlapChecker(TGeoManager* geom,
+                                                int threads)
+    : fGeoManager(geom), fThreads(threads),
+      fTolerance(0.1), fSamplePoints(100000) {
+    if (fThreads < 1) fThreads = 1;
+}
+
+EDepSim::RootOverlapChecker::~RootOverlapChecker() {}
+
+int EDepSim::RootOverlapChecker::Check() {
+    // Find the volumes that have daughters to check.
+    std::vector<const TGeoVolume*> mothers;
+    TIter next(fGeoManager->GetListOfVolumes());
+    TGeoVolume* volume;
+    while ((volume=(TGeoVolume*)next())) {
+        if (volume->GetNdaughters() < 1) continue;
+        mothers.push_back(volume);
+    }
+
+    EDepSimLog("Check " << mothers.size() << " volumes for overlaps using "
+               << fThreads << " threads");
+
+    // Make sure that shapes have scratch space for each thread.  The
+    // previous setting is put back after the check.
+    int previousThreads = fGeoManager->GetMaxThreads();
+    fGeoManager->SetMaxThreads(fThreads);
+
+    std::vector< std::vector<Overlap> > found(mothers.size());
+    std::atomic<std::size_t> nextMother(0);
+    std::vector<std::thread> workers;
+    for (int i=0; i<fThreads; ++i) {
+        workers.push_back(std::thread([&]() {
+                    TGeoManager::ThreadId();
+                    for (;;) {
+                        std::size_t m = nextMother++;
+                        if (m >= mothers.size()) break;
+                        CheckVolume(mothers[m], m, found[m]);
+                    }
+                }));
+    }
+    for (std::size_t i=0; i<workers.size(); ++i) workers[i].join();
+
+    // Forget the worker thread ids so the geometry is used the same way as
+    // before the check.
+    fGeoManager->ClearThreadsMap();
+    fGeoManager->SetMaxThreads(previousThreads);
+
+    // Gather the reports in the geometry order.
+    int count = 0;
+    for (std::size_t m=0; m<found.size(); ++m) {
+        for (std::vector<Overlap>::iterator o = found[m].begin();
+             o != found[m].end(); ++o) {
+            ++count;
+            if (o->fSecond.empty()) {
+                EDepSimLog("Extrusion in " << o->fMother
+                           << ": " << o->fFirst
+                           << " extrudes by " << o->fDistance);
+            }
+            else {
+                EDepSimLog("Overlap in " << o->fMother
+                           << ": " << o->fFirst
+                           << " and " << o->fSecond
+                           << " overlap by " << o->fDistance);
+            }
+        }
+    }
+    EDepSimLog("Overlap check found " << count << " overlaps");
+
+    return count;
+}
+
+void EDepSim::RootOverlapChecker::CheckVolume(
+    const TGeoVolume* mother, int index,
+    std::vector<Overlap>& found) const {
+    const TGeoShape* motherShape = mother->GetShape();
+    int nDaughters = mother->GetNdaughters();
+
+    // Get the daughter bounding boxes in the mother coordinates.  Assemblies
+    // (and MANY nodes) are allowed to overlap and are not checked.
+    std::vector<const TGeoNode*> nodes(nDaughters);
+    std::vector<bool> checked(nDaughters);
+    std::vector<double> lo(3*nDaughters);
+    std::vector<double> hi(3*nDaughters);
+    for (int i=0; i<nDaughters; ++i) {
+        nodes[i] = mother->GetNode(i);
+        checked[i] = !nodes[i]->IsOverlapping()
+            && !nodes[i]->GetVolume()->IsAssembly();
+        NodeBounds(nodes[i], &lo[3*i], &hi[3*i]);
+    }
+    DaughterGrid grid(lo,hi);
+
+    OverlapMap overlaps;
+
+    // Check the mesh vertices of each daughter against the mother and the
+    // neighboring daughters.
+    for (int i=0; i<nDaughters; ++i) {
+        if (!checked[i]) continue;
+        const TGeoShape* shape = nodes[i]->GetVolume()->GetShape();
+        const TGeoMatrix* matrix = nodes[i]->GetMatrix();
+        std::vector<double> points(3*shape->GetNmeshVertices());
+        if (points.empty()) continue;
+        shape->SetPoints(&points[0]);
+        for (std::size_t p=0; p<points.size(); p+=3) {
+            const double* local = &points[p];
+            // Composite shapes have mesh vertices that are not part of the
+            // final shape.
+            if (!shape->Contains(local)) continue;
+            double master[3];
+            matrix->LocalToMaster(local,master);
+            if (!mother->IsAssembly() && !motherShape->Contains(master)) {
+                double distance = motherShape->Safety(master,kFALSE);
+                if (distance > fTolerance) {
+                    RecordOverlap(overlaps, i, -1, distance);
+                }
+            }
+            const std::vector<int>* candidates = grid.Find(master);
+            if (!candidates) continue;
+            for (std::vector<int>::const_iterator j = candidates->begin();
+                 j != candidates->end(); ++j) {
+                if (*j == i || !checked[*j]) continue;
+                const TGeoShape* other = nodes[*j]->GetVolume()->GetShape();
+                double otherLocal[3];
+                nodes[*j]->GetMatrix()->MasterToLocal(master,otherLocal);
+                if (!other->Contains(otherLocal)) continue;
+                double distance = other->Safety(otherLocal,kTRUE);
+                if (distance > fTolerance) {
+                    RecordOverlap(overlaps, i, *j, distance);
+                }
+            }
+        }
+    }
+
+    // Sample random points in the mother and look for points inside of more
+    // than one daughter.
+    const TGeoBBox* motherBox = dynamic_cast<const TGeoBBox*>(motherShape);
+    if (fSamplePoints > 0 && motherBox && !mother->IsAssembly()) {
+        TRandom3 random(index+1);
+        const double* origin = motherBox->GetOrigin();
+        const double half[3] = {motherBox->GetDX(),
+                                motherBox->GetDY(),
+                                motherBox->GetDZ()};
+        std::vector<int> inside;
+        std::vector<double> depth;
+        for (int s=0; s<fSamplePoints; ++s) {
+            double master[3];
+            for (int j=0; j<3; ++j) {
+                master[j] = origin[j] + half[j]*(2.0*random.Rndm()-1.0);
+            }
+            if (!motherShape->Contains(master)) continue;
+            const std::vector<int>* candidates = grid.Find(master);
+            if (!candidates) continue;
+            inside.clear();
+            depth.clear();
+            for (std::vector<int>::const_iterator j = candidates->begin();
+                 j != candidates->end(); ++j) {
+                if (!checked[*j]) continue;
+                const TGeoShape* shape = nodes[*j]->GetVolume()->GetShape();
+                double local[3];
+                nodes[*j]->GetMatrix()->MasterToLocal(master,local);
+                if (!shape->Contains(local)) continue;
+                inside.push_back(*j);
+                depth.push_back(shape->Safety(local,kTRUE));
+            }
+            for (std::size_t a=0; a<inside.size(); ++a) {
+                for (std::size_t b=a+1; b<inside.size(); ++b) {
+                    double distance = std::min(depth[a],depth[b]);
+                    if (distance > fTolerance) {
+                        RecordOverlap(overlaps, inside[a], inside[b],
+                                      distance);
+                    }
+                }
+            }
+        }
+    }
+
+    for (OverlapMap::iterator o = overlaps.begin();
+         o != overlaps.end(); ++o) {
+        Overlap overlap;
+        overlap.fMother = mother->GetName();
+        overlap.fFirst = nodes[o->first.first]->GetName();
+        if (o->first.second >= 0) {
+            overlap.fSecond = nodes[o->first.second]->GetName();
+        }
+        overlap.fDistance = o->second;
+        found.push_back(overlap);
+    }
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_RootOverlapChecker_hh_seen
+#define EDepSim_RootOverlapChecker_hh_seen
+
+#include <string>
+#include <vector>
+
+class TGeoManager;
+class TGeoVolume;
+
+namespace EDepSim {class RootOverlapChecker;}
+/// Check a closed ROOT geometry for overlaps and extrusions using several
+/// threads.  The volume tree is partitioned by mother volume: each thread
+/// takes the next unchecked mother volume and checks its daughters against
+/// each other, and against the mother.  Each mother is checked in two ways.
+/// The mesh vertices of every daughter are tested against the mother and
+/// the neighboring daughters (like TGeoManager::CheckOverlaps), and then
+/// points are randomly sampled inside the mother (like the "s" option of
+/// TGeoManager::CheckOverlaps).  The sampling uses a random generator seeded
+/// from the index of the mother volume, so the result does not depend on the
+/// number of threads.  The overlaps are reported in the order of the volumes
+/// in the geometry so the summary is reproducible.
+///
+/// Only const shape methods are used while checking, and the geometry is put
+/// into multi-thread mode (TGeoManager::SetMaxThreads) so that shapes with
+/// per-thread scratch data can be used from the worker threads.
+class EDepSim::RootOverlapChecker {
+public:
+    /// Create a checker for a closed geometry using the number of threads.
+    RootOverlapChecker(TGeoManager* geom, int threads);
+    virtual ~RootOverlapChecker();
+
+    /// Set the distance that an overlap must exceed to be reported.  This is
+    /// in the ROOT geometry length units.
+    void SetTolerance(double tolerance) {fTolerance = tolerance;}
+
+    /// Set the number of points sampled inside of each mother volume.  If
+    /// this is zero, then only the mesh vertices are checked.
+    void SetSamplePoints(int points) {fSamplePoints = points;}
+
+    /// Check the geometry, print a summary of the overlaps, and return the
+    /// number of overlaps that were found.
+    int Check();
+
+    /// A description of an overlap found in a mother volume.
+    struct Overlap {
+        /// The name of the mother volume.
+        std::string fMother;
+        /// The name of the first daughter node.
+        std::string fFirst;
+        /// The name of the second daughter node.  This is empty for an
+        /// extrusion of the first daughter from the mother.
+        std::string fSecond;
+        /// The largest distance of the overlap.
+        double fDistance;
+    };
+
+private:
+    /// Check the daughters of one mother volume.  The index is used to seed
+    /// the random sampling.
+    void CheckVolume(const TGeoVolume* mother, int index,
+                     std::vector<Overlap>& found) const;
+
+    /// The geometry being checked.
+    TGeoManager* fGeoManager;
+
+    /// The number of worker threads.
+    int fThreads;
+
+    /// The minimum distance for an overlap to be reported.
+    double fTolerance;
+
+    /// The number of points to sample in each mother volume.
+    int fSamplePoints;
+};
+#endif
@@ -2,9 +2,12 @@
 //
 
 #include "EDepSimLog.hh"
+#include "EDepSimException.hh"
 
 #include "EDepSimRootPersistencyManager.hh"
 #include "EDepSimRootGeometryManager.hh"
+#include "EDepSimPerformanceMonitor.hh"
+#include "EDepSimCheckpointManager.hh"
 
 #include <globals.hh>
 
@@ -14,11 +17,40 @@
 #include <TROOT.h>
 #include <TFile.h>
 #include <TTree.h>
+#include <TDirectory.h>
 #include <TGeoManager.h>
+#include <TSystem.h>
+
+namespace {
+    /// Connect a variable to a branch.  The branch is created unless the
+    /// tree was read from the output file after a restart.
+    void ConnectBranch(TTree* tree, bool existing, const std::string& name,
+                       void* address, const std::string& leaves) {
+        if (existing) tree->SetBranchAddress(name.c_str(), address);
+        else tree->Branch(name.c_str(), address, leaves.c_str());
+    }
 
+    /// Stop ROOT from saving newer tree headers between checkpoints.  An
+    /// AutoSave after a checkpoint would record more entries than the
+    /// checkpoint, and the restart could not use the file.
+    void DisableAutoSave(TDirectory* directory) {
+        TIter next(directory->GetList());
+        TObject* object;
+        while ((object = next())) {
+            TTree* tree = dynamic_cast<TTree*>(object);
+            if (tree) {
+                tree->SetAutoSave(0);
+                continue;
+            }
+            TDirectory* subdirectory = dynamic_cast<TDirectory*>(object);
+            if (subdirectory) DisableAutoSave(subdirectory);
+        }
+    }
+}
 
 EDepSim::RootPersistencyManager::RootPersistencyManager() 
-    : EDepSim::PersistencyManager(), fOutput(NULL), fEventTree(NULL) {}
+    : EDepSim::PersistencyManager(), fOutput(NULL), fEventTree(NULL),
+      fPerfTree(NULL) {}
 
 EDepSim::RootPersistencyManager::~RootPersistencyManager() {
     if (fOutput) delete fOutput;
@@ -43,17 +75,53 @@ bool EDepSim::RootPersistencyManager::Open(G4String filename) {
 
     EDepSimLog("EDepSim::RootPersistencyManager::Open " << GetFilename());
 
+    static TG4Event *pEvent = &fEventSummary;
+    fEventsNotSaved = 0;
+
+    EDepSim::CheckpointManager* checkpoint = EDepSim::CheckpointManager::Get();
+    checkpoint->SetOutputFilename(GetFilename());
+    if (checkpoint->GetRestart() && OpenForRestart(&pEvent)) return true;
+
     fOutput = TFile::Open(GetFilename(), "RECREATE", "EDepSim Root Output");
     fOutput->cd();
     
     fEventTree = new TTree("EDepSimEvents",
                            "Energy Deposition for Simulated Events");
 
-    static TG4Event *pEvent = &fEventSummary;
     fEventTree->Branch("Event","TG4Event",&pEvent);
        
-    fEventsNotSaved = 0;
+    return true;
+}
 
+bool EDepSim::RootPersistencyManager::OpenForRestart(TG4Event** event) {
+    // Without an output file, the job stopped before anything was saved.
+    if (gSystem->AccessPathName(GetFilename().c_str())) {
+        EDepSimLog("No output file to restart: " << GetFilename()
+                   << " -- Start from the beginning");
+        return false;
+    }
+
+    // The output file is never recreated since that would remove the events
+    // the restart is supposed to keep.
+    fOutput = TFile::Open(GetFilename(), "UPDATE", "EDepSim Root Output");
+    if (!fOutput || !fOutput->IsOpen()) {
+        EDepSimThrow("Cannot open " << GetFilename() << " to restart");
+    }
+    fOutput->cd();
+    fEventTree = dynamic_cast<TTree*>(fOutput->Get("EDepSimEvents"));
+    if (!fEventTree) {
+        EDepSimThrow("No events to restart in " << GetFilename());
+    }
+    if (!EDepSim::CheckpointManager::Get()
+        ->ReadCheckpoint(fEventTree->GetEntries())) {
+        EDepSimThrow("No checkpoint for the " << fEventTree->GetEntries()
+                     << " events in " << GetFilename()
+                     << " (remove the file to start from the beginning)");
+    }
+    fEventTree->SetBranchAddress("Event",event);
+    DisableAutoSave(fOutput);
+    EDepSimLog("Continue " << GetFilename() << " after "
+               << fEventTree->GetEntries() << " events");
     return true;
 }
 
@@ -70,6 +138,10 @@ bool EDepSim::RootPersistencyManager::Close() {
     fOutput->Close();
 
     fEventTree = NULL;
+    fPerfTree = NULL;
+
+    // The output is complete, so the checkpoint isn't needed.
+    EDepSim::CheckpointManager::Get()->Finish();
 
     return true;
 }
@@ -85,11 +157,61 @@ bool EDepSim::RootPersistencyManager::Store(const G4Event* anEvent) {
     
     fOutput->cd();
 
-    fEventTree->Fill();
+    EDepSim::PerformanceMonitor* monitor = EDepSim::PerformanceMonitor::Get();
+    {
+        EDepSim::PerformanceMonitor::Scope timer(
+            EDepSim::PerformanceMonitor::kFill);
+        fEventTree->Fill();
+    }
+
+    if (monitor->IsEnabled()) {
+        monitor->EndOfEvent(anEvent);
+        if (!fPerfTree) MakePerformanceTree();
+        fPerfTree->Fill();
+    }
+
+    // Flush the output before the checkpoint is moved into place so the
+    // checkpoint never refers to events that aren't in the file.
+    EDepSim::CheckpointManager* checkpoint = EDepSim::CheckpointManager::Get();
+    if (checkpoint->IsCheckpointEvent(fEventTree->GetEntries())) {
+        DisableAutoSave(fOutput);
+        checkpoint->WriteCheckpoint(anEvent, fEventTree->GetEntries());
+        fOutput->Write(0, TObject::kOverwrite);
+        fOutput->Flush();
+        checkpoint->CommitCheckpoint();
+    }
 
     return true;
 }
 
+void EDepSim::RootPersistencyManager::MakePerformanceTree() {
+    fOutput->cd();
+    fPerfTree = dynamic_cast<TTree*>(fOutput->Get("EDepSimPerformance"));
+    bool existing = (fPerfTree != NULL);
+    if (!fPerfTree) {
+        fPerfTree = new TTree("EDepSimPerformance",
+                              "Time and Resources Used by Each Event");
+    }
+
+    // The branches point directly into the record kept by the monitor.
+    EDepSim::PerformanceMonitor::EventRecord& record
+        = EDepSim::PerformanceMonitor::Get()->GetRecord();
+    ConnectBranch(fPerfTree,existing,"RunId",&record.RunId,"RunId/I");
+    ConnectBranch(fPerfTree,existing,"EventId",&record.EventId,"EventId/I");
+    for (int i = 0; i < EDepSim::PerformanceMonitor::kStageCount; ++i) {
+        std::string stage = EDepSim::PerformanceMonitor::GetStageName(i);
+        ConnectBranch(fPerfTree,existing,stage+"Wall",&record.WallTime[i],
+                      stage+"Wall/D");
+        ConnectBranch(fPerfTree,existing,stage+"CPU",&record.CPUTime[i],
+                      stage+"CPU/D");
+    }
+    ConnectBranch(fPerfTree,existing,"PeakMemory",&record.PeakMemory,
+                  "PeakMemory/D");
+    ConnectBranch(fPerfTree,existing,"Steps",&record.Steps,"Steps/L");
+    ConnectBranch(fPerfTree,existing,"Tracks",&record.Tracks,"Tracks/L");
+    ConnectBranch(fPerfTree,existing,"Hits",&record.Hits,"Hits/L");
+}
+
 bool EDepSim::RootPersistencyManager::Store(const G4Run*) {
     return false;
 }
@@ -106,6 +228,8 @@ bool EDepSim::RootPersistencyManager::Store(const G4VPhysicalVolume*) {
         return false; 
     }
     fOutput->cd();
+    // The geometry was saved before a restart.
+    if (fOutput->GetKey(gGeoManager->GetName())) return true;
     gGeoManager->Write();
     return true;
 }
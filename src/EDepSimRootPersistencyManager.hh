@@ -52,6 +52,15 @@ private:
     /// Make the MC Header and add it to truth.
     void MakeMCHeader(const G4Event* src);
 
+    /// Create the tree for the performance records.  The tree in the
+    /// output file is used when a job is restarted.
+    void MakePerformanceTree();
+
+    /// Open the output file for update when a job is restarted from a
+    /// checkpoint.  This returns false if there isn't an output file with a
+    /// matching checkpoint, in which case the output file is recreated.
+    bool OpenForRestart(TG4Event** event);
+
 private:
     /// The ROOT output file that events are saved into.
     TFile *fOutput;
@@ -59,6 +68,10 @@ private:
     /// The event tree that contains the output events.
     TTree *fEventTree;
 
+    /// The tree of per event performance records.  This is only created
+    /// when the EDepSim::PerformanceMonitor is enabled.
+    TTree *fPerfTree;
+
     /// The number of events saved to the output file since the last write.
     int fEventsNotSaved;
 
@@ -0,0 +1,750 @@
+////////////////////////////////////////////////////////////
+//
+// The converters used by EDepSim::RootGeometryManager to translate the G4
+// solids into ROOT shapes.  Each G4 solid type has a conversion function
+// which is registered with the geometry manager (keyed by the value of
+// G4VSolid::GetEntityType()) in
+// EDepSim::RootGeometryManager::AddDefaultSolidConverters().
+
+#include "EDepSimRootGeometryManager.hh"
+#include "EDepSimVRootSolidConverter.hh"
+#include "EDepSimException.hh"
+
+#include "EDepSimLog.hh"
+
+#include <RVersion.h>
+#include <TMath.h>
+#include <TGeoBBox.h>
+#include <TGeoTube.h>
+#include <TGeoTrd2.h>
+#include <TGeoSphere.h>
+#include <TGeoPgon.h>
+#include <TGeoArb8.h>
+#include <TGeoBoolNode.h>
+#include <TGeoCompositeShape.h>
+#include <TGeoScaledShape.h>
+#include <TGeoMatrix.h>
+#include <TGeoXtru.h>
+#include <TGeoPcon.h>
+#include <TGeoEltu.h>
+#include <TGeoParaboloid.h>
+#include <TGeoHype.h>
+#include <TGeoCone.h>
+#include <TGeoPara.h>
+#include <TGeoTorus.h>
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,26,0)
+#include <TGeoTessellated.h>
+#endif
+
+#include <G4VSolid.hh>
+#include <G4Box.hh>
+#include <G4Trd.hh>
+#include <G4Tubs.hh>
+#include <G4CutTubs.hh>
+#include <G4Sphere.hh>
+#include <G4Orb.hh>
+#include <G4Ellipsoid.hh>
+#include <G4Polyhedra.hh>
+#include <G4Polycone.hh>
+#include <G4Trap.hh>
+#include <G4SubtractionSolid.hh>
+#include <G4UnionSolid.hh>
+#include <G4IntersectionSolid.hh>
+#include <G4DisplacedSolid.hh>
+#include <G4ScaledSolid.hh>
+#include <G4MultiUnion.hh>
+#include <G4ExtrudedSolid.hh>
+#include <G4TessellatedSolid.hh>
+#include <G4VFacet.hh>
+#include <G4Tet.hh>
+#include <G4EllipticalTube.hh>
+#include <G4Torus.hh>
+#include <G4Para.hh>
+#include <G4Cons.hh>
+#include <G4Hype.hh>
+#include <G4Paraboloid.hh>
+#include <G4GenericTrap.hh>
+
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    // Make a ROOT rotation from a G4 rotation matrix.
+    TGeoRotation* MakeRotation(const G4RotationMatrix& rotation) {
+        return new TGeoRotation("rot",
+                                TMath::RadToDeg()*rotation.thetaX(),
+                                TMath::RadToDeg()*rotation.phiX(),
+                                TMath::RadToDeg()*rotation.thetaY(),
+                                TMath::RadToDeg()*rotation.phiY(),
+                                TMath::RadToDeg()*rotation.thetaZ(),
+                                TMath::RadToDeg()*rotation.phiZ());
+    }
+
+    // Convert a G4Box.
+    TGeoShape* CreateBox(EDepSim::RootGeometryManager& manager,
+                         const std::string& theName,
+                         const G4VSolid* theSolid,
+                         TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        // Create a box
+        const G4Box* box = dynamic_cast<const G4Box*>(theSolid);
+        theShape = new TGeoBBox(box->GetXHalfLength()/CLHEP::mm,
+                                box->GetYHalfLength()/CLHEP::mm,
+                                box->GetZHalfLength()/CLHEP::mm);
+        return theShape;
+    }
+
+    // Convert a G4Tubs.
+    TGeoShape* CreateTubs(EDepSim::RootGeometryManager& manager,
+                          const std::string& theName,
+                          const G4VSolid* theSolid,
+                          TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Tubs* tube = dynamic_cast<const G4Tubs*>(theSolid);
+        // Root takes the angles in degrees so there is no extra
+        // conversion.
+        double zhalf = tube->GetZHalfLength()/CLHEP::mm;
+        double rmin = tube->GetInnerRadius()/CLHEP::mm;
+        double rmax = tube->GetOuterRadius()/CLHEP::mm;
+        double minPhiDeg = tube->GetStartPhiAngle()/CLHEP::degree;
+        double maxPhiDeg = minPhiDeg + tube->GetDeltaPhiAngle()/CLHEP::degree;
+        theShape = new TGeoTubeSeg(rmin, rmax,
+                                   zhalf,
+                                   minPhiDeg, maxPhiDeg);
+        return theShape;
+    }
+
+    // Convert a G4Sphere.
+    TGeoShape* CreateSphere(EDepSim::RootGeometryManager& manager,
+                            const std::string& theName,
+                            const G4VSolid* theSolid,
+                            TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Sphere* sphere = dynamic_cast<const G4Sphere*>(theSolid);
+        // Root takes the angles in degrees so there is no extra
+        // conversion.
+        double minPhiDeg = sphere->GetStartPhiAngle()/CLHEP::degree;
+        double maxPhiDeg = minPhiDeg + sphere->GetDeltaPhiAngle()/CLHEP::degree;
+        double minThetaDeg = sphere->GetStartThetaAngle()/CLHEP::degree;
+        double maxThetaDeg = minThetaDeg
+            + sphere->GetDeltaThetaAngle()/CLHEP::degree;
+        theShape = new TGeoSphere(sphere->GetInnerRadius()/CLHEP::mm,
+                                  sphere->GetOuterRadius()/CLHEP::mm,
+                                  minThetaDeg, maxThetaDeg,
+                                  minPhiDeg, maxPhiDeg);
+        return theShape;
+    }
+
+    // Convert a G4Hype.
+    TGeoShape* CreateHype(EDepSim::RootGeometryManager& manager,
+                          const std::string& theName,
+                          const G4VSolid* theSolid,
+                          TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Hype* Hype = dynamic_cast<const G4Hype*>(theSolid);
+        double rin = Hype->GetInnerRadius()/CLHEP::mm;
+        double stin = Hype->GetInnerStereo()/CLHEP::degree;
+        double rout = Hype->GetOuterRadius()/CLHEP::mm;
+        double stout = Hype->GetOuterStereo()/CLHEP::degree;
+        double dz = Hype->GetZHalfLength()/CLHEP::mm;
+        theShape = new TGeoHype(rin,stin,rout,stout,dz);
+        return theShape;
+    }
+
+    // Convert a G4Paraboloid.
+    TGeoShape* CreateParaboloid(EDepSim::RootGeometryManager& manager,
+                                const std::string& theName,
+                                const G4VSolid* theSolid,
+                                TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Paraboloid *Paraboloid = dynamic_cast<const G4Paraboloid *>(theSolid);
+
+        double rlo=Paraboloid->GetRadiusMinusZ()/CLHEP::mm;
+        double rhi=Paraboloid->GetRadiusPlusZ()/CLHEP::mm;
+        double dz=Paraboloid->GetZHalfLength()/CLHEP::mm;
+
+        theShape = new TGeoParaboloid(rlo,rhi,dz);
+        return theShape;
+    }
+
+    // Convert a G4Cons.
+    TGeoShape* CreateCons(EDepSim::RootGeometryManager& manager,
+                          const std::string& theName,
+                          const G4VSolid* theSolid,
+                          TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Cons* Cons = dynamic_cast<const G4Cons*>(theSolid);
+        double rmin1 = Cons->GetInnerRadiusMinusZ()/ CLHEP::mm;
+        double rmax1 = Cons->GetOuterRadiusMinusZ() / CLHEP::mm;
+        double rmin2 = Cons->GetInnerRadiusPlusZ()/CLHEP::mm;
+        double rmax2 = Cons->GetOuterRadiusPlusZ ()/CLHEP::mm;
+        double dz = Cons->GetZHalfLength()/ CLHEP::mm;
+        double phi1 = Cons->GetStartPhiAngle()/ CLHEP::degree;
+        double phi2 = Cons->GetDeltaPhiAngle()/ CLHEP::degree;
+        theShape = new TGeoConeSeg(dz, rmin1, rmax1, rmin2, rmax2, phi1, phi2);
+        return theShape;
+    }
+
+    // Convert a G4Torus.
+    TGeoShape* CreateTorus(EDepSim::RootGeometryManager& manager,
+                           const std::string& theName,
+                           const G4VSolid* theSolid,
+                           TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+      const G4Torus* torus = dynamic_cast<const G4Torus*>(theSolid);
+      // Root takes the angles in degrees so there is no extra
+      // conversion.
+      double minR = torus->GetRmin()/CLHEP::mm;
+      double maxR = torus->GetRmax()/CLHEP::mm;
+      double axialR = torus->GetRtor()/CLHEP::mm;
+      double phi1 = torus->GetSPhi()/CLHEP::degree;
+      double dphi = torus->GetDPhi()/CLHEP::degree;
+      theShape = new TGeoTorus(axialR, minR, maxR, phi1, dphi);
+        return theShape;
+    }
+
+    // Convert a G4Para.
+    TGeoShape* CreatePara(EDepSim::RootGeometryManager& manager,
+                          const std::string& theName,
+                          const G4VSolid* theSolid,
+                          TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Para* para = dynamic_cast<const G4Para*>(theSolid);
+        double dX = para->GetXHalfLength() / CLHEP::mm;
+        double dY = para->GetYHalfLength() / CLHEP::mm;
+        double dZ = para->GetZHalfLength() / CLHEP::mm;
+        double alpha =std::atan(para->GetTanAlpha())/CLHEP::degree;
+        G4ThreeVector SymAxis =para->GetSymAxis();
+        double theta = std::acos(SymAxis.z())/CLHEP::degree;
+        double phi = std::acos(SymAxis.x()/std::sin(theta))/CLHEP::degree;
+        theShape = new TGeoPara(dX, dY, dZ, alpha, theta, phi);
+        return theShape;
+    }
+
+    // Convert a G4Polyhedra.
+    TGeoShape* CreatePolyhedra(EDepSim::RootGeometryManager& manager,
+                               const std::string& theName,
+                               const G4VSolid* theSolid,
+                               TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Polyhedra* polyhedra
+            = dynamic_cast<const G4Polyhedra*>(theSolid);
+        double phi = polyhedra->GetStartPhi();
+        double dPhi = polyhedra->GetEndPhi() - phi;
+        if (dPhi>2*M_PI) dPhi -= 2*M_PI;
+        if (dPhi<0) dPhi += 2*M_PI;
+        int sides = polyhedra->GetNumSide();
+        int numZ = polyhedra->GetNumRZCorner()/2;
+        // Factor to take into account that ROOT uses the circle that can be
+        // inscribed inside the polygon, and G4 uses the corner
+        double g4Factor = std::cos(0.5*dPhi/sides);
+        TGeoPgon* pgon = new TGeoPgon(phi/CLHEP::degree,
+                                      dPhi/CLHEP::degree, sides, numZ);
+        for (int i = 0; i< numZ; ++i) {
+            double rMin = g4Factor*polyhedra->GetCorner(numZ-i-1).r;
+            double rMax = g4Factor*polyhedra->GetCorner(numZ+i).r;
+            if (rMax < rMin) std::swap(rMin,rMax);
+            pgon->DefineSection(i,
+                                polyhedra->GetCorner(numZ-i-1).z/CLHEP::mm,
+                                rMin/CLHEP::mm,
+                                rMax/CLHEP::mm);
+        }
+        theShape = pgon;
+        return theShape;
+    }
+
+    // Convert a G4Polycone.
+    TGeoShape* CreatePolycone(EDepSim::RootGeometryManager& manager,
+                              const std::string& theName,
+                              const G4VSolid* theSolid,
+                              TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Polycone* polycone
+            = dynamic_cast<const G4Polycone*>(theSolid);
+        double phi = polycone->GetStartPhi();
+        double dPhi = polycone->GetEndPhi() - phi;
+        if (dPhi>2*M_PI) dPhi -= 2*M_PI;
+        if (dPhi<0) dPhi += 2*M_PI;
+#ifdef G4GEOM_USE_USOLIDS
+#warning GEANT HAS BEEN COMPILED WITH BROKEN USOLIDS.
+        int numZ = polycone->GetNumRZCorner()/2;
+        TGeoPcon* pcon = new TGeoPcon(phi/CLHEP::degree,
+                                      dPhi/CLHEP::degree, numZ);
+        // This depends on the (mostly) undocumented order of the corners in
+        // the G4Polycone internals.  It's a little unstable...
+        for (int i = 0; i< numZ; ++i) {
+            pcon->DefineSection(i,
+                                polycone->GetCorner(numZ-i-1).z/CLHEP::mm,
+                                polycone->GetCorner(numZ-i-1).r/CLHEP::mm,
+                                polycone->GetCorner(numZ+i).r/CLHEP::mm);
+        }
+#else
+        const G4PolyconeHistorical* param = polycone->GetOriginalParameters();
+        int numZ = param->Num_z_planes;
+        TGeoPcon* pcon = new TGeoPcon(phi/CLHEP::degree,
+                                      dPhi/CLHEP::degree,
+                                      numZ);
+        // This depends on the older interface.  It's not marked as
+        // deprecated, but the documentation discourages it's use.
+        for (int i = 0; i< numZ; ++i) {
+            pcon->DefineSection(i,
+                                param->Z_values[i]/CLHEP::mm,
+                                param->Rmin[i]/CLHEP::mm,
+                                param->Rmax[i]/CLHEP::mm);
+        }
+#endif
+        theShape = pcon;
+        return theShape;
+    }
+
+    // Convert a G4Trap.
+    TGeoShape* CreateTrap(EDepSim::RootGeometryManager& manager,
+                          const std::string& theName,
+                          const G4VSolid* theSolid,
+                          TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Trap* trap
+            = dynamic_cast<const G4Trap*>(theSolid);
+        double dz = trap->GetZHalfLength()/CLHEP::mm;
+        double theta = 0;
+        double phi = 0;
+        double h1 = trap->GetYHalfLength1()/CLHEP::mm;
+        double bl1 = trap->GetXHalfLength1()/CLHEP::mm;
+        double tl1 = trap->GetXHalfLength2()/CLHEP::mm;
+        double alpha1 = std::atan(trap->GetTanAlpha1())/CLHEP::degree;
+        double h2 = trap->GetYHalfLength2()/CLHEP::mm;
+        double bl2 = trap->GetXHalfLength3()/CLHEP::mm;
+        double tl2 = trap->GetXHalfLength4()/CLHEP::mm;
+        double alpha2 = std::atan(trap->GetTanAlpha2())/CLHEP::degree;
+        theShape = new TGeoTrap(dz, theta, phi,
+                                h1, bl1, tl1, alpha1,
+                                h2, bl2, tl2, alpha2);
+        return theShape;
+    }
+
+    // Convert a G4Trd.
+    TGeoShape* CreateTrd(EDepSim::RootGeometryManager& manager,
+                         const std::string& theName,
+                         const G4VSolid* theSolid,
+                         TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4Trd* trd
+            = dynamic_cast<const G4Trd*>(theSolid);
+        double dz = trd->GetZHalfLength()/CLHEP::mm;
+        double dx1 = trd->GetXHalfLength1()/CLHEP::mm;
+        double dx2 = trd->GetXHalfLength2()/CLHEP::mm;
+        double dy1 = trd->GetYHalfLength1()/CLHEP::mm;
+        double dy2 = trd->GetYHalfLength2()/CLHEP::mm;
+        theShape = new TGeoTrd2(dx1,dx2,dy1,dy2,dz);
+        return theShape;
+    }
+
+    // Convert a G4GenericTrap.
+    TGeoShape* CreateGenericTrap(EDepSim::RootGeometryManager& manager,
+                                 const std::string& theName,
+                                 const G4VSolid* theSolid,
+                                 TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4GenericTrap* trap
+            = dynamic_cast<const G4GenericTrap*>(theSolid);
+        double dz = trap->GetZHalfLength()/CLHEP::mm;
+        double vertices[2*8] = { }; // initialized to zeroes
+        for (int i = 0; i < trap->GetNofVertices(); ++i) {
+            const G4TwoVector& v = trap->GetVertex(i);
+            vertices[2*i] = v.x()/CLHEP::mm;
+            vertices[2*i + 1] = v.y()/CLHEP::mm;
+        }
+        theShape = new TGeoArb8(dz, vertices);
+        return theShape;
+    }
+
+    // Convert a G4SubtractionSolid.
+    TGeoShape* CreateSubtractionSolid(EDepSim::RootGeometryManager& manager,
+                                      const std::string& theName,
+                                      const G4VSolid* theSolid,
+                                      TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4SubtractionSolid* sub
+            = dynamic_cast<const G4SubtractionSolid*>(theSolid);
+        const G4VSolid* solidA = sub->GetConstituentSolid(0);
+        const G4VSolid* solidB = sub->GetConstituentSolid(1);
+        // solidA - solidB
+        TGeoMatrix* matrixA = NULL;
+        TGeoShape* shapeA = manager.CreateShape(theName, solidA, &matrixA);
+        TGeoMatrix* matrixB = NULL;
+        TGeoShape* shapeB = manager.CreateShape(theName, solidB, &matrixB);
+        TGeoSubtraction* subtractNode = new TGeoSubtraction(shapeA,shapeB,
+                                                            matrixA, matrixB);
+        theShape = new TGeoCompositeShape("name",subtractNode);
+        return theShape;
+    }
+
+    // Convert a G4DisplacedSolid.
+    TGeoShape* CreateDisplacedSolid(EDepSim::RootGeometryManager& manager,
+                                    const std::string& theName,
+                                    const G4VSolid* theSolid,
+                                    TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4DisplacedSolid* disp
+            = dynamic_cast<const G4DisplacedSolid*>(theSolid);
+        const G4VSolid* movedSolid = disp->GetConstituentMovedSolid();
+        G4RotationMatrix rotation = disp->GetObjectRotation();
+        G4ThreeVector displacement = disp->GetObjectTranslation();
+        theShape = manager.CreateShape(theName, movedSolid);
+        if (returnMatrix) {
+            *returnMatrix = new TGeoCombiTrans(displacement.x()/CLHEP::mm,
+                                               displacement.y()/CLHEP::mm,
+                                               displacement.z()/CLHEP::mm,
+                                               MakeRotation(rotation));
+        }
+        return theShape;
+    }
+
+    // Convert a G4UnionSolid.
+    TGeoShape* CreateUnionSolid(EDepSim::RootGeometryManager& manager,
+                                const std::string& theName,
+                                const G4VSolid* theSolid,
+                                TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4UnionSolid* sub
+            = dynamic_cast<const G4UnionSolid*>(theSolid);
+        const G4VSolid* solidA = sub->GetConstituentSolid(0);
+        const G4VSolid* solidB = sub->GetConstituentSolid(1);
+        // solidA - solidB
+        TGeoMatrix* matrixA = NULL;
+        TGeoShape* shapeA = manager.CreateShape(theName, solidA, &matrixA);
+        TGeoMatrix* matrixB = NULL;
+        TGeoShape* shapeB = manager.CreateShape(theName, solidB, &matrixB);
+        TGeoUnion* unionNode = new TGeoUnion(shapeA,  shapeB,
+                                             matrixA, matrixB);
+        theShape = new TGeoCompositeShape("name",unionNode);
+        return theShape;
+    }
+
+    // Convert a G4IntersectionSolid.
+    TGeoShape* CreateIntersectionSolid(EDepSim::RootGeometryManager& manager,
+                                       const std::string& theName,
+                                       const G4VSolid* theSolid,
+                                       TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4IntersectionSolid* sub
+	  = dynamic_cast<const G4IntersectionSolid*>(theSolid);
+        const G4VSolid* solidA = sub->GetConstituentSolid(0);
+        const G4VSolid* solidB = sub->GetConstituentSolid(1);
+        // solidA - solidB
+        TGeoMatrix* matrixA = NULL;
+        TGeoShape* shapeA = manager.CreateShape(theName, solidA, &matrixA);
+        TGeoMatrix* matrixB = NULL;
+        TGeoShape* shapeB = manager.CreateShape(theName, solidB, &matrixB);
+        TGeoIntersection* intersectionNode
+            = new TGeoIntersection(shapeA,  shapeB,
+                                   matrixA, matrixB);
+        theShape = new TGeoCompositeShape("name",intersectionNode);
+        return theShape;
+    }
+
+    // Convert a G4ExtrudedSolid.
+    TGeoShape* CreateExtrudedSolid(EDepSim::RootGeometryManager& manager,
+                                   const std::string& theName,
+                                   const G4VSolid* theSolid,
+                                   TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        //This following only works when using the 'standard'
+        //G4ExtrudedSolid Constructor.
+
+        const G4ExtrudedSolid* extr
+            = dynamic_cast<const G4ExtrudedSolid*>(theSolid);
+
+        //number of z planes
+        const G4int nZ = extr->GetNofZSections();
+        //number of vertices in the polygon
+        const G4int nV = extr->GetNofVertices();
+
+        //define and pointers
+        const int maxVertices = 1000;
+        double vertices_x[maxVertices];
+        double vertices_y[maxVertices];
+        if (maxVertices < nV) {
+            EDepSimThrow("Polygon with more than maxVertices");
+        }
+
+
+        //define an intermediate extrusion constructor with nZ z planes.
+        TGeoXtru *xtru = new TGeoXtru(nZ);
+
+        //Get the polygons points.
+        std::vector<G4TwoVector> polyPoints = extr->GetPolygon();
+
+        //fill the vertices arrays
+        for(int i = 0 ; i < nV ; i++){
+            vertices_x[i]= polyPoints[i].x();
+            vertices_y[i]= polyPoints[i].y();
+        }
+
+        //Define the polygon
+        xtru->DefinePolygon(nV, vertices_x, vertices_y);
+
+        double z_pos, x_off, y_off, scale;
+
+        //fill the parameters to define the Root extruded solid
+        for(int i = 0 ; i < nZ ; i++){
+            z_pos = extr->GetZSection(i).fZ;
+            x_off = extr->GetZSection(i).fOffset.x() ;
+            y_off = extr->GetZSection(i).fOffset.y();
+            scale = extr->GetZSection(i).fScale;
+            xtru->DefineSection(i, z_pos, x_off, y_off, scale);
+        }
+        //now assign 'theShape' to this complete extruded object.
+        theShape = xtru;
+        return theShape;
+    }
+
+    // Convert a G4EllipticalTube.
+    TGeoShape* CreateEllipticalTube(EDepSim::RootGeometryManager& manager,
+                                    const std::string& theName,
+                                    const G4VSolid* theSolid,
+                                    TGeoMatrix** returnMatrix) {
+        TGeoShape* theShape = NULL;
+        const G4EllipticalTube* ellipticalTube
+            = dynamic_cast<const G4EllipticalTube*>(theSolid);
+        theShape = new TGeoEltu(ellipticalTube->GetDx()/CLHEP::mm,
+                                ellipticalTube->GetDy()/CLHEP::mm,
+                                ellipticalTube->GetDz()/CLHEP::mm);
+        return theShape;
+    }
+
+    // Convert a G4CutTubs.
+    TGeoShape* CreateCutTubs(EDepSim::RootGeometryManager& manager,
+                             const std::string& theName,
+                             const G4VSolid* theSolid,
+                             TGeoMatrix** returnMatrix) {
+        const G4CutTubs* tube = dynamic_cast<const G4CutTubs*>(theSolid);
+        double minPhiDeg = tube->GetStartPhiAngle()/CLHEP::degree;
+        double maxPhiDeg = minPhiDeg + tube->GetDeltaPhiAngle()/CLHEP::degree;
+        // The normals to the cut planes are unit vectors.
+        G4ThreeVector lowNorm = tube->GetLowNorm();
+        G4ThreeVector highNorm = tube->GetHighNorm();
+        return new TGeoCtub(tube->GetInnerRadius()/CLHEP::mm,
+                            tube->GetOuterRadius()/CLHEP::mm,
+                            tube->GetZHalfLength()/CLHEP::mm,
+                            minPhiDeg, maxPhiDeg,
+                            lowNorm.x(), lowNorm.y(), lowNorm.z(),
+                            highNorm.x(), highNorm.y(), highNorm.z());
+    }
+
+    // Convert a G4Orb.
+    TGeoShape* CreateOrb(EDepSim::RootGeometryManager& manager,
+                         const std::string& theName,
+                         const G4VSolid* theSolid,
+                         TGeoMatrix** returnMatrix) {
+        const G4Orb* orb = dynamic_cast<const G4Orb*>(theSolid);
+        return new TGeoSphere(0.0, orb->GetRadius()/CLHEP::mm);
+    }
+
+    // Convert a G4Ellipsoid.  This is a unit sphere that is scaled to the
+    // semi-axes, and then intersected with a box if the ellipsoid is cut in
+    // Z.
+    TGeoShape* CreateEllipsoid(EDepSim::RootGeometryManager& manager,
+                               const std::string& theName,
+                               const G4VSolid* theSolid,
+                               TGeoMatrix** returnMatrix) {
+        const G4Ellipsoid* ellipsoid
+            = dynamic_cast<const G4Ellipsoid*>(theSolid);
+        double dx = ellipsoid->GetDx()/CLHEP::mm;
+        double dy = ellipsoid->GetDy()/CLHEP::mm;
+        double dz = ellipsoid->GetDz()/CLHEP::mm;
+        double bottom = std::max(-dz, ellipsoid->GetZBottomCut()/CLHEP::mm);
+        double top = std::min(dz, ellipsoid->GetZTopCut()/CLHEP::mm);
+        TGeoShape* theShape
+            = new TGeoScaledShape(new TGeoSphere(0.0, 1.0),
+                                  new TGeoScale(dx, dy, dz));
+        if (bottom > -dz || top < dz) {
+            TGeoShape* cut = new TGeoBBox(dx, dy, 0.5*(top-bottom));
+            TGeoMatrix* shift = new TGeoTranslation(0.0, 0.0,
+                                                    0.5*(top+bottom));
+            TGeoIntersection* intersectionNode
+                = new TGeoIntersection(theShape, cut, NULL, shift);
+            theShape = new TGeoCompositeShape("name",intersectionNode);
+        }
+        return theShape;
+    }
+
+    // Convert a G4ScaledSolid.
+    TGeoShape* CreateScaledSolid(EDepSim::RootGeometryManager& manager,
+                                 const std::string& theName,
+                                 const G4VSolid* theSolid,
+                                 TGeoMatrix** returnMatrix) {
+        const G4ScaledSolid* scaled
+            = dynamic_cast<const G4ScaledSolid*>(theSolid);
+        TGeoShape* unscaled
+            = manager.CreateShape(theName, scaled->GetUnscaledSolid());
+        G4Scale3D scale = scaled->GetScaleTransform();
+        return new TGeoScaledShape(unscaled,
+                                   new TGeoScale(scale.xx(),
+                                                 scale.yy(),
+                                                 scale.zz()));
+    }
+
+    // Convert a G4MultiUnion into a chain of ROOT unions.
+    TGeoShape* CreateMultiUnion(EDepSim::RootGeometryManager& manager,
+                                const std::string& theName,
+                                const G4VSolid* theSolid,
+                                TGeoMatrix** returnMatrix) {
+        const G4MultiUnion* multi
+            = dynamic_cast<const G4MultiUnion*>(theSolid);
+        TGeoShape* theShape = NULL;
+        TGeoMatrix* theMatrix = NULL;
+        for (int i = 0; i < multi->GetNumberOfSolids(); ++i) {
+            TGeoShape* shape = manager.CreateShape(theName,
+                                                   multi->GetSolid(i));
+            const G4Transform3D& transform = multi->GetTransformation(i);
+            G4ThreeVector displacement = transform.getTranslation();
+            TGeoMatrix* matrix
+                = new TGeoCombiTrans(displacement.x()/CLHEP::mm,
+                                     displacement.y()/CLHEP::mm,
+                                     displacement.z()/CLHEP::mm,
+                                     MakeRotation(transform.getRotation()));
+            if (!theShape) {
+                theShape = shape;
+                theMatrix = matrix;
+                continue;
+            }
+            TGeoUnion* unionNode = new TGeoUnion(theShape, shape,
+                                                 theMatrix, matrix);
+            theShape = new TGeoCompositeShape("name",unionNode);
+            theMatrix = NULL;
+        }
+        // A union of one solid still has the transformation of that solid.
+        // When the caller doesn't take the matrix, the displaced solid is
+        // built as the union of the solid with itself.
+        if (!theMatrix) return theShape;
+        if (returnMatrix) *returnMatrix = theMatrix;
+        else if (theMatrix->IsIdentity()) delete theMatrix;
+        else {
+            TGeoUnion* unionNode = new TGeoUnion(theShape, theShape,
+                                                 theMatrix, theMatrix);
+            theShape = new TGeoCompositeShape("name",unionNode);
+        }
+        return theShape;
+    }
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,26,0)
+    // Convert a G4TessellatedSolid.  The G4 facets are already oriented
+    // with the normals pointing out of the solid which is what ROOT
+    // expects.
+    TGeoShape* CreateTessellatedSolid(EDepSim::RootGeometryManager& manager,
+                                      const std::string& theName,
+                                      const G4VSolid* theSolid,
+                                      TGeoMatrix** returnMatrix) {
+        const G4TessellatedSolid* tessellated
+            = dynamic_cast<const G4TessellatedSolid*>(theSolid);
+        TGeoTessellated* tess
+            = new TGeoTessellated(theName.c_str(),
+                                  tessellated->GetNumberOfFacets());
+        for (int i = 0; i < tessellated->GetNumberOfFacets(); ++i) {
+            const G4VFacet* facet = tessellated->GetFacet(i);
+            std::vector<ROOT::Geom::Vertex_t> vertices;
+            for (int j = 0; j < facet->GetNumberOfVertices(); ++j) {
+                G4ThreeVector v = facet->GetVertex(j);
+                vertices.push_back(ROOT::Geom::Vertex_t(v.x()/CLHEP::mm,
+                                                        v.y()/CLHEP::mm,
+                                                        v.z()/CLHEP::mm));
+            }
+            if (vertices.size() == 3) {
+                tess->AddFacet(vertices[0], vertices[1], vertices[2]);
+            }
+            else if (vertices.size() == 4) {
+                tess->AddFacet(vertices[0], vertices[1],
+                               vertices[2], vertices[3]);
+            }
+            else {
+                EDepSimThrow(theName + " :: facet with unexpected vertices");
+            }
+        }
+        tess->CloseShape(true, true, false);
+        return tess;
+    }
+
+    // Convert a G4Tet into a tessellated shape.  The facet orientation is
+    // fixed when the shape is closed.
+    TGeoShape* CreateTet(EDepSim::RootGeometryManager& manager,
+                         const std::string& theName,
+                         const G4VSolid* theSolid,
+                         TGeoMatrix** returnMatrix) {
+        const G4Tet* tet = dynamic_cast<const G4Tet*>(theSolid);
+        std::vector<G4ThreeVector> corners = tet->GetVertices();
+        std::vector<ROOT::Geom::Vertex_t> v;
+        for (std::size_t i = 0; i < corners.size(); ++i) {
+            v.push_back(ROOT::Geom::Vertex_t(corners[i].x()/CLHEP::mm,
+                                             corners[i].y()/CLHEP::mm,
+                                             corners[i].z()/CLHEP::mm));
+        }
+        TGeoTessellated* tess = new TGeoTessellated(theName.c_str(), 4);
+        tess->AddFacet(v[0], v[2], v[1]);
+        tess->AddFacet(v[0], v[1], v[3]);
+        tess->AddFacet(v[0], v[3], v[2]);
+        tess->AddFacet(v[1], v[2], v[3]);
+        tess->CloseShape(true, true, false);
+        return tess;
+    }
+#endif
+
+    typedef TGeoShape* (*ConverterFunction)(EDepSim::RootGeometryManager&,
+                                            const std::string&,
+                                            const G4VSolid*,
+                                            TGeoMatrix**);
+
+    // Adapt a conversion function to the VRootSolidConverter interface.
+    class FunctionConverter : public EDepSim::VRootSolidConverter {
+    public:
+        FunctionConverter(const std::string& type,
+                          ConverterFunction function)
+            : EDepSim::VRootSolidConverter(type), fFunction(function) {}
+        virtual ~FunctionConverter() {}
+
+        virtual TGeoShape* CreateShape(EDepSim::RootGeometryManager& manager,
+                                       const std::string& theName,
+                                       const G4VSolid* theSolid,
+                                       TGeoMatrix** returnMatrix) {
+            return fFunction(manager, theName, theSolid, returnMatrix);
+        }
+
+    private:
+        ConverterFunction fFunction;
+    };
+}
+
+void EDepSim::RootGeometryManager::AddDefaultSolidConverters() {
+    AddSolidConverter(new FunctionConverter("G4Box", CreateBox));
+    AddSolidConverter(new FunctionConverter("G4Tubs", CreateTubs));
+    AddSolidConverter(new FunctionConverter("G4Sphere", CreateSphere));
+    AddSolidConverter(new FunctionConverter("G4Hype", CreateHype));
+    AddSolidConverter(new FunctionConverter("G4Paraboloid", CreateParaboloid));
+    AddSolidConverter(new FunctionConverter("G4Cons", CreateCons));
+    AddSolidConverter(new FunctionConverter("G4Torus", CreateTorus));
+    AddSolidConverter(new FunctionConverter("G4Para", CreatePara));
+    AddSolidConverter(new FunctionConverter("G4Polyhedra", CreatePolyhedra));
+    AddSolidConverter(new FunctionConverter("G4Polycone", CreatePolycone));
+    AddSolidConverter(new FunctionConverter("G4Trap", CreateTrap));
+    AddSolidConverter(new FunctionConverter("G4Trd", CreateTrd));
+    AddSolidConverter(new FunctionConverter("G4GenericTrap", CreateGenericTrap));
+    AddSolidConverter(new FunctionConverter("G4SubtractionSolid", CreateSubtractionSolid));
+    AddSolidConverter(new FunctionConverter("G4DisplacedSolid", CreateDisplacedSolid));
+    AddSolidConverter(new FunctionConverter("G4UnionSolid", CreateUnionSolid));
+    AddSolidConverter(new FunctionConverter("G4IntersectionSolid", CreateIntersectionSolid));
+    AddSolidConverter(new FunctionConverter("G4ExtrudedSolid", CreateExtrudedSolid));
+    AddSolidConverter(new FunctionConverter("G4EllipticalTube", CreateEllipticalTube));
+    AddSolidConverter(new FunctionConverter("G4CutTubs", CreateCutTubs));
+    AddSolidConverter(new FunctionConverter("G4Orb", CreateOrb));
+    AddSolidConverter(new FunctionConverter("G4Ellipsoid", CreateEllipsoid));
+    AddSolidConverter(new FunctionConverter("G4ScaledSolid", CreateScaledSolid));
+    AddSolidConverter(new FunctionConverter("G4MultiUnion", CreateMultiUnion));
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,26,0)
+    AddSolidConverter(new FunctionConverter("G4TessellatedSolid", CreateTessellatedSolid));
+    AddSolidConverter(new FunctionConverter("G4Tet", CreateTet));
+#endif
+}
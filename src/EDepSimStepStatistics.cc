@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimStepStatistics.hh"
+#include "EDepSimLog.hh"
+
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4Track.hh>
+#include <G4Run.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4VProcess.hh>
+
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+EDepSim::StepStatistics* EDepSim::StepStatistics::fThis = NULL;
+
+namespace {
+    bool CompareTime(
+        const std::pair<std::string, EDepSim::StepStatistics::Entry>& a,
+        const std::pair<std::string, EDepSim::StepStatistics::Entry>& b) {
+        if (a.second.SampledTime != b.second.SampledTime) {
+            return a.second.SampledTime > b.second.SampledTime;
+        }
+        return a.second.Steps > b.second.Steps;
+    }
+
+    bool CompareSteps(
+        const std::pair<std::string, EDepSim::StepStatistics::Entry>& a,
+        const std::pair<std::string, EDepSim::StepStatistics::Entry>& b) {
+        return a.second.Steps > b.second.Steps;
+    }
+
+    void AddStep(EDepSim::StepStatistics::Entry& entry,
+                 double length, double energy, double time) {
+        ++entry.Steps;
+        entry.Length += length;
+        entry.Energy += energy;
+        if (time < 0.0) return;
+        ++entry.Samples;
+        entry.SampledTime += time;
+    }
+}
+
+EDepSim::StepStatistics::StepStatistics()
+    : fEnabled(false), fSamplePeriod(100), fSinceSample(0), fTiming(false),
+      fSampleStart(0), fPrintRows(10) {
+    BeginOfRun();
+}
+
+void EDepSim::StepStatistics::BeginOfRun() {
+    fTotal = Entry();
+    fVolumes.clear();
+    fParticles.clear();
+    fProcesses.clear();
+    fLastVolume = NULL;
+    fLastVolumeEntry = NULL;
+    fLastParticle = NULL;
+    fLastParticleEntry = NULL;
+    fSinceSample = 0;
+    fTiming = false;
+}
+
+void EDepSim::StepStatistics::ProcessStep(const G4Step* theStep) {
+    // Finish timing the step.  The time of steps that aren't timed is
+    // negative.
+    double time = -1.0;
+    if (fTiming) {
+        time = double(std::clock() - fSampleStart)/CLOCKS_PER_SEC;
+        fTiming = false;
+    }
+
+    const G4StepPoint* thePreStep = theStep->GetPreStepPoint();
+    const G4VPhysicalVolume* thePV = thePreStep->GetPhysicalVolume();
+    const G4LogicalVolume* theVolume
+        = thePV ? thePV->GetLogicalVolume() : NULL;
+    const G4ParticleDefinition* theParticle
+        = theStep->GetTrack()->GetDefinition();
+    const G4VProcess* theProcess
+        = theStep->GetPostStepPoint()->GetProcessDefinedStep();
+
+    if (theVolume != fLastVolume || !fLastVolumeEntry) {
+        fLastVolume = theVolume;
+        fLastVolumeEntry = &fVolumes[theVolume];
+    }
+    if (theParticle != fLastParticle || !fLastParticleEntry) {
+        fLastParticle = theParticle;
+        fLastParticleEntry = &fParticles[theParticle];
+    }
+
+    double length = theStep->GetStepLength();
+    double energy = theStep->GetTotalEnergyDeposit();
+    AddStep(fTotal, length, energy, time);
+    AddStep(*fLastVolumeEntry, length, energy, time);
+    AddStep(*fLastParticleEntry, length, energy, time);
+    AddStep(fProcesses[theProcess], length, energy, time);
+
+    // Start timing the next step.  This is done last so the time spent
+    // here is not included.
+    if (fSamplePeriod > 0 && ++fSinceSample >= fSamplePeriod) {
+        fSinceSample = 0;
+        fTiming = true;
+        fSampleStart = std::clock();
+    }
+}
+
+void EDepSim::StepStatistics::Rank(std::vector<NamedEntry>& entries) const {
+    if (fTotal.Samples > 0) {
+        std::stable_sort(entries.begin(), entries.end(), CompareTime);
+    }
+    else {
+        std::stable_sort(entries.begin(), entries.end(), CompareSteps);
+    }
+}
+
+void EDepSim::StepStatistics::MakeTables(
+    std::vector<NamedEntry>& volumes,
+    std::vector<NamedEntry>& particles,
+    std::vector<NamedEntry>& processes) const {
+    volumes.clear();
+    for (std::map<const G4LogicalVolume*, Entry>::const_iterator v
+             = fVolumes.begin(); v != fVolumes.end(); ++v) {
+        std::string name = v->first ? v->first->GetName() : "none";
+        volumes.push_back(NamedEntry(name, v->second));
+    }
+    Rank(volumes);
+
+    particles.clear();
+    for (std::map<const G4ParticleDefinition*, Entry>::const_iterator p
+             = fParticles.begin(); p != fParticles.end(); ++p) {
+        std::string name = p->first ? p->first->GetParticleName() : "none";
+        particles.push_back(NamedEntry(name, p->second));
+    }
+    Rank(particles);
+
+    processes.clear();
+    for (std::map<const G4VProcess*, Entry>::const_iterator p
+             = fProcesses.begin(); p != fProcesses.end(); ++p) {
+        std::string name = p->first ? p->first->GetProcessName() : "none";
+        processes.push_back(NamedEntry(name, p->second));
+    }
+    Rank(processes);
+}
+
+void EDepSim::StepStatistics::WriteTable(
+    std::ostream& out, const std::string& title,
+    const std::vector<NamedEntry>& entries, int rows) const {
+    // The sampled time is scaled by the sampling period to estimate the
+    // total time.
+    double totalTime = fTotal.SampledTime*fSamplePeriod;
+    out << title << std::endl;
+    out << std::setw(32) << std::left << "    Name" << std::right
+        << std::setw(12) << "Steps"
+        << std::setw(8) << "%"
+        << std::setw(12) << "CPU (s)"
+        << std::setw(8) << "%"
+        << std::setw(14) << "Length (m)"
+        << std::setw(14) << "Deposit (MeV)"
+        << std::endl;
+    int row = 0;
+    for (std::vector<NamedEntry>::const_iterator e = entries.begin();
+         e != entries.end(); ++e) {
+        if (rows > 0 && row++ >= rows) break;
+        double time = e->second.SampledTime*fSamplePeriod;
+        out << "    " << std::setw(28) << std::left << e->first
+            << std::right
+            << std::setw(12) << e->second.Steps
+            << std::setw(8) << std::fixed << std::setprecision(2)
+            << (fTotal.Steps > 0 ? 100.0*e->second.Steps/fTotal.Steps : 0.0)
+            << std::setw(12) << std::setprecision(3) << time
+            << std::setw(8) << std::setprecision(2)
+            << (totalTime > 0.0 ? 100.0*time/totalTime : 0.0)
+            << std::setw(14) << std::setprecision(3) << e->second.Length/m
+            << std::setw(14) << e->second.Energy/MeV
+            << std::defaultfloat << std::setprecision(6)
+            << std::endl;
+    }
+}
+
+void EDepSim::StepStatistics::EndOfRun(const G4Run* aRun) {
+    if (!fEnabled) return;
+
+    std::vector<NamedEntry> volumes;
+    std::vector<NamedEntry> particles;
+    std::vector<NamedEntry> processes;
+    MakeTables(volumes, particles, processes);
+
+    std::ostringstream summary;
+    summary << "Step statistics for run " << aRun->GetRunID()
+            << ": " << fTotal.Steps << " steps"
+            << " (" << fTotal.Samples << " timed)";
+    EDepSimLog(summary.str());
+
+    std::ostringstream tables;
+    WriteTable(tables, "  Volumes", volumes, fPrintRows);
+    WriteTable(tables, "  Particles", particles, fPrintRows);
+    WriteTable(tables, "  Processes", processes, fPrintRows);
+    EDepSimLog(tables.str());
+
+    if (fTableFile.empty()) return;
+
+    std::ofstream output(fTableFile.c_str());
+    if (!output.is_open()) {
+        EDepSimError("Unable to write step statistics to " << fTableFile);
+        return;
+    }
+    output << summary.str() << std::endl;
+    WriteTable(output, "  Volumes", volumes, 0);
+    WriteTable(output, "  Particles", particles, 0);
+    WriteTable(output, "  Processes", processes, 0);
+    EDepSimLog("Step statistics written to " << fTableFile);
+}
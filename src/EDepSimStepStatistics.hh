@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_StepStatistics_hh_seen
+#define EDepSim_StepStatistics_hh_seen
+
+#include <ctime>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class G4Step;
+class G4Run;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4VProcess;
+
+namespace EDepSim {class StepStatistics;}
+/// Count the steps taken in each logical volume, by each particle type, and
+/// by each process during a run.  The collector is enabled with
+/// /edep/perf/steps, and is called by EDepSim::SteppingAction for every
+/// step.  At the end of the run, the volumes, particles and processes are
+/// ranked, and the top of each table is printed.  The full tables are
+/// written to a text file when one is set with /edep/perf/stepTable.
+///
+/// The CPU time is estimated by sampling: one step in every
+/// /edep/perf/stepSample steps is timed, and the time is scaled by the
+/// sampling period.  The time of a step is the CPU time since the previous
+/// call to the stepping action, or since the start of the track for the
+/// first step of a track.  The time between tracks (e.g. the end of an
+/// event, the stacking, and the start of the next event) is not charged to
+/// any step.  When the collector is disabled, the stepping action only
+/// makes a single test.
+class EDepSim::StepStatistics {
+public:
+    /// The accumulated statistics for a volume, particle, or process.
+    struct Entry {
+        Entry()
+            : Steps(0), Samples(0), SampledTime(0.0),
+              Length(0.0), Energy(0.0) {}
+        /// The number of steps.
+        long Steps;
+        /// The number of steps that were timed.
+        long Samples;
+        /// The total CPU time of the timed steps (seconds).
+        double SampledTime;
+        /// The total step length.
+        double Length;
+        /// The total energy deposit.
+        double Energy;
+    };
+
+    /// Get the collector.
+    static EDepSim::StepStatistics* Get() {
+        if (!fThis) fThis = new EDepSim::StepStatistics();
+        return fThis;
+    }
+
+    virtual ~StepStatistics() {}
+
+    /// Enable (or disable) the collector.
+    void SetEnabled(bool enabled) {fEnabled = enabled;}
+
+    /// Check if the steps are being counted.
+    bool IsEnabled() const {return fEnabled;}
+
+    /// Set the number of steps between timed steps.  Zero turns off the
+    /// timing.
+    void SetSamplePeriod(int period) {fSamplePeriod = period;}
+
+    /// Set the name of the file where the tables are written at the end of
+    /// the run.  An empty name (the default) doesn't write a file.
+    void SetTableFile(const std::string& name) {fTableFile = name;}
+
+    /// Set the number of rows of each table to print at the end of the run.
+    void SetPrintRows(int rows) {fPrintRows = rows;}
+
+    /// Clear the statistics at the start of a run.
+    void BeginOfRun();
+
+    /// Print (and write) the tables at the end of a run.
+    void EndOfRun(const G4Run* aRun);
+
+    /// Add a step to the statistics.
+    void ProcessStep(const G4Step* theStep);
+
+    /// Restart the clock for a timed step at the start of a track, so the
+    /// time since the last step of the previous track isn't included.  This
+    /// is called by EDepSim::UserTrackingAction.
+    void StartTrack() {if (fTiming) fSampleStart = std::clock();}
+
+private:
+    StepStatistics();
+
+    /// A named entry used to rank the tables.
+    typedef std::pair<std::string, Entry> NamedEntry;
+
+    /// Sort the entries by time when the steps are timed, or by the number
+    /// of steps when they are not.
+    void Rank(std::vector<NamedEntry>& entries) const;
+
+    /// Write a ranked table of entries.
+    void WriteTable(std::ostream& out, const std::string& title,
+                    const std::vector<NamedEntry>& entries, int rows) const;
+
+    /// Find the ranked entries for each table.
+    void MakeTables(std::vector<NamedEntry>& volumes,
+                    std::vector<NamedEntry>& particles,
+                    std::vector<NamedEntry>& processes) const;
+
+    /// The pointer to the collector.
+    static EDepSim::StepStatistics* fThis;
+
+    /// True if the steps are being counted.
+    bool fEnabled;
+
+    /// The number of steps between timed steps.
+    int fSamplePeriod;
+
+    /// The number of steps since the last timed step.
+    int fSinceSample;
+
+    /// True if the next step is timed.
+    bool fTiming;
+
+    /// The CPU clock when the timed step started.
+    std::clock_t fSampleStart;
+
+    /// The file where the tables are written.
+    std::string fTableFile;
+
+    /// The number of rows of each table that are printed.
+    int fPrintRows;
+
+    /// The total for all steps.
+    Entry fTotal;
+
+    /// The statistics for each logical volume (at the start of the step).
+    std::map<const G4LogicalVolume*, Entry> fVolumes;
+
+    /// The statistics for each particle type.
+    std::map<const G4ParticleDefinition*, Entry> fParticles;
+
+    /// The statistics for each process that limited the step.
+    std::map<const G4VProcess*, Entry> fProcesses;
+
+    /// The entries for the previous step.  Most steps are in the same
+    /// volume, and for the same particle, as the previous step, so this
+    /// saves a map lookup.  The map entries don't move when the maps grow.
+    const G4LogicalVolume* fLastVolume;
+    Entry* fLastVolumeEntry;
+    const G4ParticleDefinition* fLastParticle;
+    Entry* fLastParticleEntry;
+};
+#endif
@@ -11,17 +11,23 @@
 #include <G4StepStatus.hh>
 #include <G4RunManager.hh>
 #include <G4OpticalParameters.hh>
+#include <Randomize.hh>
 
 #include <G4SystemOfUnits.hh>
 #include <G4PhysicalConstants.hh>
 
+#include <cmath>
+#include <limits>
+
 #include "EDepSimLog.hh"
 #include "EDepSimSurfaceSD.hh"
 #include "EDepSimHitSurface.hh"
+#include "EDepSimPhotonLibraryManager.hh"
 #include "EDepSimUserStackingAction.hh"
 
 EDepSim::SurfaceSD::SurfaceSD(G4String name)
-    :G4VSensitiveDetector(name), fHits(NULL), fHCID(-1) {
+    :G4VSensitiveDetector(name), fHits(NULL), fHCID(-1),
+     fBinWidth(0.0), fSampleSize(0) {
     // In an surprising interface, the G4VSensitiveDetector class exposes the
     // protected field "std::vector<G4String> collectionName" to the user and
     // expects any derived classes to explicitly fill it with the names of the
@@ -65,6 +71,7 @@ void EDepSim::SurfaceSD::Initialize(G4HCofThisEvent* HCE) {
 
     HCE->AddHitsCollection(fHCID, fHits);
 
+    fBins.clear();
 }
 
 G4bool EDepSim::SurfaceSD::ProcessHits(G4Step* theStep,
@@ -125,10 +132,81 @@ G4bool EDepSim::SurfaceSD::ProcessHits(G4Step* theStep,
                  << ", " << hitEnergy/eV << " eV"
                  << ", " << twopi*hbarc/hitEnergy/nm << " nm");
 
+    EDepSim::PhotonLibraryManager::Get()->AddDetected(GetName(), theStep);
+
     EDepSim::HitSurface* currentHit = new EDepSim::HitSurface(theStep);
+    if (fBinWidth > 0.0) {
+        AccumulateHit(EDepSim::VolumeId(thePostStep->GetTouchableHandle()),
+                      currentHit);
+        return true;
+    }
     fHits->insert(currentHit);
 
     return true;
 }
 
-void EDepSim::SurfaceSD::EndOfEvent(G4HCofThisEvent*) { }
+void EDepSim::SurfaceSD::AddHit(EDepSim::HitSurface* hit) {
+    if (!fHits) {
+        delete hit;
+        return;
+    }
+    if (fBinWidth > 0.0) {
+        // The hit isn't from a step in a volume, so all of the added hits
+        // share a single channel.
+        AccumulateHit(EDepSim::VolumeId(), hit);
+        return;
+    }
+    fHits->insert(hit);
+}
+
+void EDepSim::SurfaceSD::AccumulateHit(const EDepSim::VolumeId& channel,
+                                       EDepSim::HitSurface* hit) {
+    // Clamp the bin before converting to an integer since a photon can have
+    // an arbitrarily late time (the conversion is undefined when out of
+    // range).  Out of range photons share the first or last bin.
+    double timeValue = std::floor(hit->GetPosition().t()/fBinWidth);
+    const double lowBin = std::numeric_limits<int>::min();
+    const double highBin = std::numeric_limits<int>::max();
+    if (!(timeValue > lowBin)) timeValue = lowBin;
+    if (timeValue > highBin) timeValue = highBin;
+    int timeBin = static_cast<int>(timeValue);
+    PhotonBin& bin = fBins[PhotonBinKey(channel,timeBin)];
+    if (!bin.fHit) {
+        bin.fHit = new EDepSim::HitSurface(*hit);
+    }
+    else {
+        bin.fHit->AddPhotons(*hit);
+    }
+
+    // Keep a random sample of the photons using reservoir sampling so the
+    // memory doesn't depend on the number of photons.
+    hit->SetCount(0);
+    int seen = bin.fSeen++;
+    if (seen < fSampleSize) {
+        bin.fSample.push_back(hit);
+        return;
+    }
+    int slot = (fSampleSize > 0) ? CLHEP::RandFlat::shootInt(seen+1) : -1;
+    if (0 <= slot && slot < fSampleSize) {
+        delete bin.fSample[slot];
+        bin.fSample[slot] = hit;
+        return;
+    }
+    delete hit;
+}
+
+void EDepSim::SurfaceSD::EndOfEvent(G4HCofThisEvent*) {
+    if (fBins.empty()) return;
+    for (std::map<PhotonBinKey,PhotonBin,PhotonBinLess>::iterator b = fBins.begin();
+         b != fBins.end(); ++b) {
+        fHits->insert(b->second.fHit);
+        for (std::vector<EDepSim::HitSurface*>::iterator
+                 h = b->second.fSample.begin();
+             h != b->second.fSample.end(); ++h) {
+            fHits->insert(*h);
+        }
+    }
+    EDepSimDebug("Accumulated " << GetName()
+                 << " photons into " << fBins.size() << " bins");
+    fBins.clear();
+}
@@ -7,12 +7,26 @@
 #include "G4VSensitiveDetector.hh"
 #include "EDepSimLog.hh"
 #include "EDepSimHitSurface.hh"
+#include "EDepSimVolumeId.hh"
+
+#include <map>
+#include <utility>
+#include <vector>
 
 class G4HCofThisEvent;
 class G4Step;
 
 namespace EDepSim {class SurfaceSD;}
 /// A sensitive detector to create hits at a surface (mostly optical surfaces).
+///
+/// By default there is one EDepSim::HitSurface for each detected photon.
+/// When a time bin width is set, the photons are accumulated into one hit
+/// for each channel (the physical volume where the photon is detected) and
+/// time bin, so the number of hits scales with the number of channels
+/// instead of the number of photons.  The binned hits have the number of
+/// photons in EDepSim::HitSurface::GetCount().  A sample of the individual
+/// photons in each bin can also be kept, and the sampled photons are added
+/// to the hit collection with a count of zero.
 class EDepSim::SurfaceSD : public G4VSensitiveDetector {
 
 public:
@@ -23,7 +37,52 @@ public:
     G4bool ProcessHits(G4Step*, G4TouchableHistory*);
     void EndOfEvent(G4HCofThisEvent*);
 
+    /// Add a hit that was not made by a step in the detector (e.g. by
+    /// EDepSim::PhotonLibraryManager).  This takes ownership of the hit, and
+    /// must be called during an event.
+    void AddHit(EDepSim::HitSurface* hit);
+
+    /// Set the width of the time bins used to accumulate photons.  If the
+    /// width is zero (the default), a hit is made for each photon.
+    void SetPhotonBinWidth(double width) {fBinWidth = width;}
+    double GetPhotonBinWidth() const {return fBinWidth;}
+
+    /// Set the maximum number of individual photons kept for each channel
+    /// and time bin when photons are accumulated.  The photons are a random
+    /// sample of the photons in the bin.
+    void SetPhotonSampleSize(int n) {fSampleSize = n;}
+    int GetPhotonSampleSize() const {return fSampleSize;}
+
 private:
+    /// The photons accumulated for a channel and time bin.
+    struct PhotonBin {
+        PhotonBin() : fHit(NULL), fSeen(0) {}
+        /// The hit summarizing the photons.
+        EDepSim::HitSurface* fHit;
+        /// The number of photons that were candidates for the sample.
+        int fSeen;
+        /// The sampled photons.
+        std::vector<EDepSim::HitSurface*> fSample;
+    };
+
+    /// A channel (volume) and time bin.
+    typedef std::pair<EDepSim::VolumeId,int> PhotonBinKey;
+
+    /// Order the bins.  The VolumeId comparison is declared in the global
+    /// namespace, so it is called explicitly.
+    struct PhotonBinLess {
+        bool operator()(const PhotonBinKey& a, const PhotonBinKey& b) const {
+            if (::operator<(a.first, b.first)) return true;
+            if (::operator<(b.first, a.first)) return false;
+            return a.second < b.second;
+        }
+    };
+
+    /// Add a photon to the bin for a channel.  This takes ownership of the
+    /// hit.
+    void AccumulateHit(const EDepSim::VolumeId& channel,
+                       EDepSim::HitSurface* hit);
+
     /// The collection of hits that is being filled in the current event.  It
     /// is constructed in Initialize, filled in ProcessHits, and added the the
     /// event in EndOfEvent.
@@ -31,6 +90,17 @@ private:
 
     /// The hit collection id of fHits
     int fHCID;
+
+    /// The width of the time bins used to accumulate photons (zero if each
+    /// photon makes a hit).
+    double fBinWidth;
+
+    /// The number of individual photons sampled in each bin.
+    int fSampleSize;
+
+    /// The bins being filled in the current event.  The hits are added to
+    /// fHits in EndOfEvent.
+    std::map<PhotonBinKey,PhotonBin,PhotonBinLess> fBins;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include "EDepSimUserDetectorConstruction.hh"
 #include "EDepSimDetectorMessenger.hh"
 #include "EDepSimRootGeometryManager.hh"
+#include "EDepSimRegionManager.hh"
 #include "EDepSimSDFactory.hh"
 #include "EDepSimUniformField.hh"
 #include "EDepSimEMFieldSetup.hh"
@@ -47,6 +48,9 @@
 #include <G4RegionStore.hh>
 
 #include <queue>
+#include <map>
+#include <sstream>
+#include <iomanip>
 
 EDepSim::UserDetectorConstruction::UserDetectorConstruction() {
     fDetectorMessenger = new EDepSim::DetectorMessenger(this);
@@ -147,6 +151,40 @@ namespace {
         field.setZ(ParseUnit(elem,"tesla"));
         return field;
     }
+
+    // Check if a logical volume, or any volume inside of it, has an
+    // electric or magnetic field.  The result is cached for each logical
+    // volume.
+    bool HasFieldBelow(G4LogicalVolume* logVolume,
+                       const G4GDMLAuxMapType* auxMap,
+                       std::map<G4LogicalVolume*, bool>& cache) {
+        std::map<G4LogicalVolume*, bool>::iterator found
+            = cache.find(logVolume);
+        if (found != cache.end()) return found->second;
+        bool result = false;
+        G4GDMLAuxMapType::const_iterator aux = auxMap->find(logVolume);
+        if (aux != auxMap->end()) {
+            for (G4GDMLAuxListType::const_iterator auxItem
+                     = aux->second.begin();
+                 auxItem != aux->second.end(); ++auxItem) {
+                if (auxItem->type == "EField"
+                    || auxItem->type == "ArbEField"
+                    || auxItem->type == "BField"
+                    || auxItem->type == "ArbBField") {
+                    result = true;
+                    break;
+                }
+            }
+        }
+        for (std::size_t i=0;
+             !result && i<(std::size_t)logVolume->GetNoDaughters(); ++i) {
+            G4LogicalVolume* daughter
+                = logVolume->GetDaughter(i)->GetLogicalVolume();
+            result = HasFieldBelow(daughter, auxMap, cache);
+        }
+        cache[logVolume] = result;
+        return result;
+    }
 }
 
 G4VPhysicalVolume* EDepSim::UserDetectorConstruction::Construct() {
@@ -196,6 +234,72 @@ G4VPhysicalVolume* EDepSim::UserDetectorConstruction::Construct() {
             aux->first->SetVisAttributes(new G4VisAttributes(color));
         }
 
+        // Check for regions.  The region settings are found in the same
+        // auxiliary list as the "Region" type.
+        EDepSim::RegionManager* regions = EDepSim::RegionManager::Get();
+        regions->ClearGDML();
+        for (G4GDMLAuxMapType::const_iterator
+                 aux = fGDMLParser->GetAuxMap()->begin();
+             aux != fGDMLParser->GetAuxMap()->end();
+             ++aux) {
+            std::string region;
+            for (G4GDMLAuxListType::const_iterator auxItem
+                     = aux->second.begin();
+                 auxItem != aux->second.end();
+                 ++auxItem) {
+                if (auxItem->type != "Region") continue;
+                region = auxItem->value;
+                regions->AddVolume(region, aux->first->GetName(), true);
+            }
+            if (region.empty()) continue;
+            for (G4GDMLAuxListType::const_iterator auxItem
+                     = aux->second.begin();
+                 auxItem != aux->second.end();
+                 ++auxItem) {
+                const G4String& type = auxItem->type;
+                if (type == "RegionCut") {
+                    regions->SetCut(region, "em",
+                                    ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionGammaCut") {
+                    regions->SetCut(region, "gamma",
+                                    ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionElectronCut") {
+                    regions->SetCut(region, "e-",
+                                    ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionPositronCut") {
+                    regions->SetCut(region, "e+",
+                                    ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionProtonCut") {
+                    regions->SetCut(region, "proton",
+                                    ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionMaxStep") {
+                    regions->SetLimit(region, "maxStep",
+                                      ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionMaxTrackLength") {
+                    regions->SetLimit(region, "maxTrackLength",
+                                      ParseUnit(auxItem->value,"mm"), true);
+                }
+                else if (type == "RegionMaxTime") {
+                    regions->SetLimit(region, "maxTime",
+                                      ParseUnit(auxItem->value,"ns"), true);
+                }
+                else if (type == "RegionMinKineticEnergy") {
+                    regions->SetLimit(region, "minKineticEnergy",
+                                      ParseUnit(auxItem->value,"MeV"), true);
+                }
+                else if (type == "RegionMinRange") {
+                    regions->SetLimit(region, "minRange",
+                                      ParseUnit(auxItem->value,"mm"), true);
+                }
+            }
+        }
+
         // Check for step limits
         for (G4GDMLAuxMapType::const_iterator
                  aux = fGDMLParser->GetAuxMap()->begin();
@@ -227,6 +331,10 @@ G4VPhysicalVolume* EDepSim::UserDetectorConstruction::Construct() {
         EDepSimThrow("Physical world not built");
     }
 
+    // Attach the regions to the volumes.  The production cuts are set by
+    // the physics list.
+    EDepSim::RegionManager::Get()->CreateRegions();
+
     EDepSim::RootGeometryManager::Get()->Update(fPhysicalWorld,
                                                 fValidateGeometry);
 
@@ -297,7 +405,16 @@ void EDepSim::UserDetectorConstruction::ConstructSDandField() {
 
     // Add the EM field using a breadth first traversal of the geometry.  This
     // means that the field from parent volumes are applied to children, but
-    // that the children can override the local field.
+    // that the children can override the local field.  A logical volume can
+    // be placed many times (e.g. the modules of a modular detector), so the
+    // field for each logical volume is only built once, volumes with the
+    // same field share a field manager, and each field map file is only
+    // read once.  Daughters without a field below them are not traversed
+    // since they get the field from their parent.
+    std::map<G4LogicalVolume*, G4FieldManager*> volumeFields;
+    std::map<std::string, G4FieldManager*> fieldManagers;
+    std::map<std::string, G4Field*> fieldMaps;
+    std::map<G4LogicalVolume*, bool> fieldBelow;
     std::queue<G4LogicalVolume*> remainingVolumes;
     remainingVolumes.push(fPhysicalWorld->GetLogicalVolume());
     while (!remainingVolumes.empty()) {
@@ -306,9 +423,25 @@ void EDepSim::UserDetectorConstruction::ConstructSDandField() {
         G4LogicalVolume* logVolume = remainingVolumes.front();
         remainingVolumes.pop();
         for (std::size_t i=0; i<(std::size_t)logVolume->GetNoDaughters(); ++i) {
-            G4VPhysicalVolume* daughter = logVolume->GetDaughter(i);
-            remainingVolumes.push(daughter->GetLogicalVolume());
+            G4LogicalVolume* daughter
+                = logVolume->GetDaughter(i)->GetLogicalVolume();
+            if (!HasFieldBelow(daughter, fGDMLParser->GetAuxMap(),
+                               fieldBelow)) {
+                continue;
+            }
+            remainingVolumes.push(daughter);
+        }
+
+        // Reapply the field of a volume that has already been built.  This
+        // keeps the field of the volume when it is also inside of a parent
+        // that was handled after the volume was first seen.
+        std::map<G4LogicalVolume*, G4FieldManager*>::iterator built
+            = volumeFields.find(logVolume);
+        if (built != volumeFields.end()) {
+            if (built->second) logVolume->SetFieldManager(built->second,true);
+            continue;
         }
+        volumeFields[logVolume] = NULL;
 
         // Check to see if there are any auxillary values for this volume.  If
         // not, then we are done.
@@ -390,23 +523,147 @@ void EDepSim::UserDetectorConstruction::ConstructSDandField() {
         // set.
         if (!HasEField && !HasBField) continue;
 
+        // Find the interpolation used for the field maps in the volume.
+        EDepSim::FieldMap::Interpolation interpolation
+            = EDepSim::FieldMap::kCubic;
+        for (G4GDMLAuxListType::const_iterator auxItem = auxItems.begin();
+             auxItem != auxItems.end();
+             ++auxItem) {
+            if (auxItem->type != "FieldInterpolation") continue;
+            if (auxItem->value == "linear") {
+                interpolation = EDepSim::FieldMap::kLinear;
+            }
+            else if (auxItem->value == "cubic") {
+                interpolation = EDepSim::FieldMap::kCubic;
+            }
+            else {
+                EDepSimError("Invalid field interpolation for "
+                             << logVolume->GetName()
+                             << ": " << auxItem->value);
+                throw std::runtime_error("Invalid field interpolation");
+            }
+        }
+
+        // Find the accuracy of the field propagation in the volume.  A
+        // macro setting for the volume overrides the GDML, which overrides
+        // the macro default.
+        EDepSim::EMFieldSetup::Accuracy accuracy = fFieldAccuracy["all"];
+        EDepSim::EMFieldSetup::Accuracy auxAccuracy;
+        for (G4GDMLAuxListType::const_iterator auxItem = auxItems.begin();
+             auxItem != auxItems.end();
+             ++auxItem) {
+            if (auxItem->type == "FieldDeltaChord") {
+                auxAccuracy.fDeltaChord = ParseUnit(auxItem->value,"mm");
+            }
+            else if (auxItem->type == "FieldDeltaOneStep") {
+                auxAccuracy.fDeltaOneStep = ParseUnit(auxItem->value,"mm");
+            }
+            else if (auxItem->type == "FieldDeltaIntersection") {
+                auxAccuracy.fDeltaIntersection
+                    = ParseUnit(auxItem->value,"mm");
+            }
+            else if (auxItem->type == "FieldEpsilonMin") {
+                std::istringstream theStream(auxItem->value);
+                theStream >> auxAccuracy.fEpsilonMin;
+            }
+            else if (auxItem->type == "FieldEpsilonMax") {
+                std::istringstream theStream(auxItem->value);
+                theStream >> auxAccuracy.fEpsilonMax;
+            }
+        }
+        accuracy.Override(auxAccuracy);
+        std::map<std::string, EDepSim::EMFieldSetup::Accuracy>::iterator
+            volumeAccuracy = fFieldAccuracy.find(logVolume->GetName());
+        if (volumeAccuracy != fFieldAccuracy.end()) {
+            accuracy.Override(volumeAccuracy->second);
+        }
+
+        // Choose the cheapest equation of motion and stepper that is correct
+        // for the field.
+        bool electric = !eField_fname.empty() || eField.mag() >= 0.01*volt/cm;
+        bool magnetic = !bField_fname.empty() || bField.mag() > 0.0;
+        EDepSim::EMFieldSetup::FieldType fieldType
+            = EDepSim::EMFieldSetup::kElectroMagnetic;
+        if (!electric && bField_fname.empty()) {
+            fieldType = EDepSim::EMFieldSetup::kUniformMagnetic;
+        }
+        else if (!electric) {
+            fieldType = EDepSim::EMFieldSetup::kMagnetic;
+        }
+
+        // A volume without any field gets a field manager without a field.
+        // This overrides the field of the parent, and the particles are not
+        // integrated through the field.
+        if (!electric && !magnetic) {
+            EDepSimInfo("Set a zero field for " << logVolume->GetName());
+            G4FieldManager*& manager = fieldManagers["none"];
+            if (!manager) manager = new G4FieldManager();
+            volumeFields[logVolume] = manager;
+            logVolume->SetFieldManager(manager,true);
+            continue;
+        }
+
         // The electric field can't be exactly zero, or the equation of
-        // motion fails.
+        // motion fails.  When there isn't an electric field, the magnetic
+        // equation of motion ignores this value, but it is still seen by
+        // EDepSim::DokeBirksSaturation.
         if (eField.mag() < 0.01 * volt/cm) {
             eField.setY(0.01 * volt/cm);
         }
 
+        // Volumes with the same field share a field manager.
+        std::ostringstream fieldKey;
+        fieldKey << std::setprecision(17);
+        fieldKey << "T " << fieldType << " ";
+        if (!eField_fname.empty()) {
+            fieldKey << "E " << eField_fname;
+        }
+        else {
+            fieldKey << "E " << eField.x() << " " << eField.y()
+                     << " " << eField.z();
+        }
+        if (!bField_fname.empty()) {
+            fieldKey << " B " << bField_fname;
+        }
+        else {
+            fieldKey << " B " << bField.x() << " " << bField.y()
+                     << " " << bField.z();
+        }
+        fieldKey << " I " << interpolation;
+        fieldKey << " A " << accuracy.fDeltaChord
+                 << " " << accuracy.fDeltaOneStep
+                 << " " << accuracy.fDeltaIntersection
+                 << " " << accuracy.fEpsilonMin
+                 << " " << accuracy.fEpsilonMax;
+
+        G4FieldManager*& manager = fieldManagers[fieldKey.str()];
+        if (manager) {
+            EDepSimInfo("Share the field manager for "
+                        << logVolume->GetName());
+            volumeFields[logVolume] = manager;
+            logVolume->SetFieldManager(manager,true);
+            continue;
+        }
+
         // Create new field manager and an arbitrary EM field. The ArbEMField
-        // can store fields that inherits from G4ElectroMagneticField.
-        G4FieldManager* manager = new G4FieldManager();
+        // can store fields that inherits from G4ElectroMagneticField.  The
+        // field maps are shared by every ArbEMField that uses the same file,
+        // so they are not owned by the ArbEMField.
+        manager = new G4FieldManager();
         EDepSim::ArbEMField* arbField = new EDepSim::ArbEMField();
 
         if (!eField_fname.empty()) {
-            EDepSim::ArbElecField* eFieldPtr = new EDepSim::ArbElecField();
-            eFieldPtr->ReadFile(eField_fname);
-            eFieldPtr->PrintInfo();
-
-            arbField->SetEField(eFieldPtr);
+            std::ostringstream mapKey;
+            mapKey << "E " << interpolation << " " << eField_fname;
+            G4Field*& eFieldPtr = fieldMaps[mapKey.str()];
+            if (!eFieldPtr) {
+                EDepSim::ArbElecField* eFieldMap = new EDepSim::ArbElecField();
+                eFieldMap->SetInterpolation(interpolation);
+                eFieldMap->ReadFile(eField_fname);
+                eFieldMap->PrintInfo();
+                eFieldPtr = eFieldMap;
+            }
+            arbField->SetEField(eFieldPtr, false);
         }
         else {
             EDepSim::UniformField* eFieldPtr = new EDepSim::UniformField();
@@ -416,11 +673,17 @@ void EDepSim::UserDetectorConstruction::ConstructSDandField() {
         }
 
         if (!bField_fname.empty()) {
-            EDepSim::ArbMagField* bFieldPtr = new EDepSim::ArbMagField();
-            bFieldPtr->ReadFile(bField_fname);
-            bFieldPtr->PrintInfo();
-
-            arbField->SetBField(bFieldPtr);
+            std::ostringstream mapKey;
+            mapKey << "B " << interpolation << " " << bField_fname;
+            G4Field*& bFieldPtr = fieldMaps[mapKey.str()];
+            if (!bFieldPtr) {
+                EDepSim::ArbMagField* bFieldMap = new EDepSim::ArbMagField();
+                bFieldMap->SetInterpolation(interpolation);
+                bFieldMap->ReadFile(bField_fname);
+                bFieldMap->PrintInfo();
+                bFieldPtr = bFieldMap;
+            }
+            arbField->SetBField(bFieldPtr, false);
         }
         else {
             EDepSim::UniformField* bFieldPtr = new EDepSim::UniformField();
@@ -430,11 +693,13 @@ void EDepSim::UserDetectorConstruction::ConstructSDandField() {
         }
 
         EDepSim::EMFieldSetup* fieldSetup
-                         = new EDepSim::EMFieldSetup(arbField, manager);
+            = new EDepSim::EMFieldSetup(arbField, manager, fieldType);
         if (!fieldSetup) {
             EDepSimError("Field not created");
             throw std::runtime_error("Field not created");
         }
+        fieldSetup->SetAccuracy(accuracy);
+        volumeFields[logVolume] = manager;
         logVolume->SetFieldManager(manager,true);
     }
 
@@ -13,6 +13,9 @@ namespace EDepSim {class UserDetectorConstruction;}
 
 #include "EDepSimDetectorMessenger.hh"
 #include "EDepSimBuilder.hh"
+#include "EDepSimEMFieldSetup.hh"
+
+#include <map>
 
 namespace EDepSim {class UserDetectorConstruction;}
 
@@ -58,6 +61,15 @@ public:
         fExcludeAsSensitiveDetector.push_back(exclude);
     }
 
+    /// Get the accuracy of the field propagation for a logical volume that
+    /// is set in a macro.  The accuracy for "all" is the default for every
+    /// volume with a field.  A value set for a volume overrides the GDML
+    /// auxiliary values.
+    EDepSim::EMFieldSetup::Accuracy& GetFieldAccuracy(
+        const std::string& volume) {
+        return fFieldAccuracy[volume];
+    }
+
     class UserUpdateGeometryAction {
     public:
         UserUpdateGeometryAction() {};
@@ -115,6 +127,10 @@ private:
     /// Vector of logical volumes to exclude being sensitive detectors.
     std::vector<std::string> fExcludeAsSensitiveDetector;
 
+    /// The accuracy of the field propagation set in macros for each logical
+    /// volume name.
+    std::map<std::string, EDepSim::EMFieldSetup::Accuracy> fFieldAccuracy;
+
     /// Vector of update actions that need to be called.
     mutable
     std::vector<EDepSim::UserDetectorConstruction::UserUpdateGeometryAction*>
@@ -5,6 +5,9 @@
 #include "EDepSimTrajectoryMap.hh"
 #include "EDepSimTrajectory.hh"
 #include "EDepSimHitSegment.hh"
+#include "EDepSimPhotonLibraryManager.hh"
+#include "EDepSimPerformanceMonitor.hh"
+#include "EDepSimCheckpointManager.hh"
 
 #include "EDepSimLog.hh"
 
@@ -118,11 +121,23 @@ void EDepSim::UserEventAction::BeginOfEventAction(const G4Event* theEvent) {
         action->BeginOfEventAction(theEvent);
     }
 
+    EDepSim::PerformanceMonitor* monitor = EDepSim::PerformanceMonitor::Get();
+    if (monitor->IsEnabled()) {
+        monitor->Start(EDepSim::PerformanceMonitor::kTracking);
+    }
 }
 
 void EDepSim::UserEventAction::EndOfEventAction(const G4Event* theEvent) {
+    EDepSim::PerformanceMonitor* monitor = EDepSim::PerformanceMonitor::Get();
+    if (monitor->IsEnabled()) {
+        monitor->Stop(EDepSim::PerformanceMonitor::kTracking);
+    }
+
     EDepSimInfo("Event " << theEvent->GetEventID() << " completed.");
 
+    // Add the photons to a photon library that is being built.
+    EDepSim::PhotonLibraryManager::Get()->EndOfEvent(theEvent);
+
     // Fill the trajectories with the amount of energy deposited into
     // sensitive detectors.
     G4HCofThisEvent* HCofEvent = theEvent->GetHCofThisEvent();
@@ -185,4 +200,7 @@ void EDepSim::UserEventAction::EndOfEventAction(const G4Event* theEvent) {
     for (G4UserEventAction *action : fExternalActions) {
         action->EndOfEventAction(theEvent);
     }
+
+    // Stop a restarted run after the last event of the original run.
+    EDepSim::CheckpointManager::Get()->EndOfEvent(theEvent);
 }
@@ -4,7 +4,7 @@
 #include <iostream>
 #include "EDepSimUserEventInformation.hh"
 
-EDepSim::UserEventInformation::UserEventInformation() {}
+EDepSim::UserEventInformation::UserEventInformation() : fRandomSeed(0) {}
 
 
 EDepSim::UserEventInformation::~UserEventInformation() {}
@@ -29,6 +29,14 @@ public:
     /// allows the user information to be reset to the default values.
     void InitializeEvent(void);
 
+    /// Set the seed that started the random engine for the event.  This is
+    /// only set when the engine is reseeded for every event.
+    void SetRandomSeed(long long seed) {fRandomSeed = seed;}
+
+    /// Get the seed that started the random engine for the event (zero if
+    /// the engine wasn't reseeded).
+    long long GetRandomSeed() const {return fRandomSeed;}
+
 private:
 
     /// A map to the trajectories information indexed the the track id. Be
@@ -38,5 +46,8 @@ private:
     /// UserEventInformation is also owned by the event.  This is directly
     /// access by TrajectoryMap (which is a friend).
     std::map<int, G4VTrajectory*> fMap;
+
+    /// The seed that started the random engine for the event.
+    long long fRandomSeed;
 };
 #endif
@@ -1,6 +1,10 @@
 #include "EDepSimUserPrimaryGeneratorMessenger.hh"
 #include "EDepSimUserPrimaryGeneratorAction.hh"
 #include "EDepSimException.hh"
+#include "EDepSimPerformanceMonitor.hh"
+#include "EDepSimUserRunAction.hh"
+#include "EDepSimUserEventInformation.hh"
+#include "EDepSimCheckpointManager.hh"
 
 #include "kinem/EDepSimPrimaryGenerator.hh"
 #include "kinem/EDepSimVKinematicsGenerator.hh"
@@ -10,6 +14,7 @@
 #include <G4Event.hh>
 #include <G4StateManager.hh>
 #include <G4RunManager.hh>
+#include <G4Run.hh>
 #include <G4VPrimaryGenerator.hh>
 #include <Randomize.hh>
 
@@ -17,6 +22,7 @@ EDepSim::UserPrimaryGeneratorAction::UserPrimaryGeneratorAction() {
     fMessenger = new EDepSim::UserPrimaryGeneratorMessenger(this);
     fAllowEmptyEvents = true;
     fAddFakeGeantino = false;
+    fFirstEvent = 0;
 }
 
 EDepSim::UserPrimaryGeneratorAction::~UserPrimaryGeneratorAction() {
@@ -24,6 +30,50 @@ EDepSim::UserPrimaryGeneratorAction::~UserPrimaryGeneratorAction() {
 }
 
 void EDepSim::UserPrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent) {
+    // This is the first user code called for an event.
+    EDepSim::PerformanceMonitor::Get()->BeginOfEvent();
+    EDepSim::PerformanceMonitor::Scope timer(
+        EDepSim::PerformanceMonitor::kGeneration);
+
+    // Continue from the checkpoint when the job has been restarted.  The
+    // generators are restored before they are used, and the events are
+    // numbered from the event after the checkpoint.
+    EDepSim::CheckpointManager* checkpoint = EDepSim::CheckpointManager::Get();
+    if (checkpoint->IsRestoring()) {
+        if (fPrimaryGenerators.size()<1) {
+            AddGenerator(fMessenger->CreateGenerator());
+        }
+        fFirstEvent = checkpoint->GetNextEvent() - anEvent->GetEventID();
+        checkpoint->Restore(fPrimaryGenerators);
+    }
+
+    // Shift the event number when the job starts part way through the
+    // kinematics input.  This must be done before the event is seeded.
+    if (fFirstEvent > 0) {
+        anEvent->SetEventID(anEvent->GetEventID() + fFirstEvent);
+    }
+
+    // Reseed the random engine so that the event doesn't depend on the
+    // events before it.  This must be done before anything uses a random
+    // number.  The seed is saved in the event information so it can be
+    // written to the output.
+    const EDepSim::UserRunAction* runAction
+        = dynamic_cast<const EDepSim::UserRunAction*>(
+            G4RunManager::GetRunManager()->GetUserRunAction());
+    const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+    if (runAction && runAction->GetEventSeeding() && run) {
+        long long seed
+            = runAction->SeedEvent(run->GetRunID(), anEvent->GetEventID());
+        EDepSim::UserEventInformation* info
+            = dynamic_cast<EDepSim::UserEventInformation*>(
+                anEvent->GetUserInformation());
+        if (!info) {
+            info = new EDepSim::UserEventInformation;
+            anEvent->SetUserInformation(info);
+        }
+        info->SetRandomSeed(seed);
+    }
+
     // Make sure that at least one generater is in the list.  If the list is
     // empty, then create the default generator.
     if (fPrimaryGenerators.size()<1) {
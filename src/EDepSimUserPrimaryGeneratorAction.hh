@@ -59,6 +59,15 @@ public:
     /// SetAllowEmptyEvents() has been called with true.
     void SetAddFakeGeantino(bool flag) {fAddFakeGeantino = flag;}
 
+    /// Set the number of the first event.  This is added to the event
+    /// number that is assigned by the run manager so that a job which
+    /// starts part way through the kinematics input has the same event
+    /// numbers (and random seeds) as a job that starts at the beginning.
+    void SetFirstEvent(int first) {fFirstEvent = first;}
+
+    /// Get the number of the first event.
+    int GetFirstEvent() const {return fFirstEvent;}
+
 private:
 
     /// A vector of generator sets to use to generate events.  Each of these
@@ -79,6 +88,9 @@ private:
     /// event containing every interaction in the kinematic input file.
     bool fAllowPartialEvents;
 
+    /// The offset added to the event number.
+    int fFirstEvent;
+
     /// The messenger for this action
     EDepSim::UserPrimaryGeneratorMessenger* fMessenger;
 };
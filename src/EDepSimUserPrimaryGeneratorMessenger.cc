@@ -141,6 +141,17 @@ EDepSim::UserPrimaryGeneratorMessenger::UserPrimaryGeneratorMessenger(
                                       " even if it ran out of interactions"
                                       " in the input kinematics file.");
 
+    fFirstEventCMD
+        = new G4UIcmdWithAnInteger("/generator/firstEvent",this);
+    fFirstEventCMD->SetGuidance("Start at an event part way through the"
+                                " kinematics input.  The input records"
+                                " before the first event are skipped, and"
+                                " the event numbers start at the first"
+                                " event.  This must be set before the"
+                                " generators are added.");
+    fFirstEventCMD->SetParameterName("first",false);
+    fFirstEventCMD->SetRange("first >= 0");
+
     //////////////////////////////////
     // Set default values for the factories.
     SetKinematicsFactory("gps");
@@ -166,6 +177,7 @@ EDepSim::UserPrimaryGeneratorMessenger::~UserPrimaryGeneratorMessenger() {
     delete fAllowEmptyEventsCMD;
     delete fAddFakeGeantinoCMD;
     delete fAllowPartialEventsCMD;
+    delete fFirstEventCMD;
 }
 
 void EDepSim::UserPrimaryGeneratorMessenger::SetNewValue(G4UIcommand* command,
@@ -211,6 +223,9 @@ void EDepSim::UserPrimaryGeneratorMessenger::SetNewValue(G4UIcommand* command,
         fAction->SetAllowPartialEvents(
             fAllowPartialEventsCMD->GetNewBoolValue(newValue));
     }
+    else if (command == fFirstEventCMD) {
+        SetFirstEvent(fFirstEventCMD->GetNewIntValue(newValue));
+    }
     else {
         EDepSimThrow("EDepSim::UserPrimaryGeneratorMessenger:: "
                     "Unimplemented command");
@@ -232,6 +247,16 @@ EDepSim::UserPrimaryGeneratorMessenger::CreateGenerator() {
     return gen;
 }
 
+void EDepSim::UserPrimaryGeneratorMessenger::SetFirstEvent(int first) {
+    EDepSimLog("First event is " << first);
+    fAction->SetFirstEvent(first);
+    for (std::map<G4String,EDepSim::VKinematicsFactory*>::iterator k
+             = fKinematicsFactories.begin();
+         k != fKinematicsFactories.end(); ++k) {
+        k->second->SetFirstEvent(first);
+    }
+}
+
 G4String EDepSim::UserPrimaryGeneratorMessenger::GetPath() {
     return fDir->GetCommandPath();
 }
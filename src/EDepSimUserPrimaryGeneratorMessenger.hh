@@ -20,6 +20,7 @@ class G4UIdirectory;
 class G4UIcmdWithoutParameter;
 class G4UIcmdWithAString;
 class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
 
 namespace EDepSim {class UserPrimaryGeneratorMessenger;}
 class EDepSim::UserPrimaryGeneratorMessenger: public G4UImessenger {
@@ -72,6 +73,11 @@ public:
     /// Create a new generator using the current generator factories.
     EDepSim::PrimaryGenerator* CreateGenerator();
 
+    /// Start at an event part way through the kinematics input files.  This
+    /// sets the first record for every kinematics factory, and the offset
+    /// added to the event number.
+    void SetFirstEvent(int first);
+
 private:
     EDepSim::UserPrimaryGeneratorAction*  fAction;
 
@@ -115,6 +121,7 @@ private:
     G4UIcmdWithABool* fAllowEmptyEventsCMD;
     G4UIcmdWithABool* fAddFakeGeantinoCMD;
     G4UIcmdWithABool* fAllowPartialEventsCMD;
+    G4UIcmdWithAnInteger* fFirstEventCMD;
 
 };
 #endif
@@ -3,11 +3,13 @@
 //
 
 #include <ctime>
+#include <cstdint>
 #include <sys/time.h>
 
 #include <Randomize.hh>
 #include <G4Run.hh>
 #include <G4RunManager.hh>
+#include <G4RunManagerKernel.hh>
 #include <G4UImanager.hh>
 #include <G4VVisManager.hh>
 #include <G4ios.hh>
@@ -17,9 +19,15 @@
 
 #include "EDepSimUserRunAction.hh"
 #include "EDepSimUserRunActionMessenger.hh"
+#include "EDepSimPhotonLibraryManager.hh"
+#include "EDepSimStepStatistics.hh"
+#include "EDepSimPhysicsList.hh"
+#include "EDepSimCheckpointManager.hh"
 
 EDepSim::UserRunAction::UserRunAction()
-    : fStartTime("invalid"), fStopTime("invalid"), fSubrunId(-1) {
+    : fStartTime("invalid"), fStopTime("invalid"), fSubrunId(-1),
+      fRunSeed(G4Random::getTheSeed()), fEventSeeding(false),
+      fConditionSeed(false) {
     fTimer = new G4Timer;
     fMessenger= new EDepSim::UserRunActionMessenger(this);
 }
@@ -35,6 +43,23 @@ void EDepSim::UserRunAction::BeginOfRunAction(const G4Run* aRun) {
     fStartTime = ctime(&ltime);
     fTimer->Start();
 
+    // Condition a time based seed.  This waits until the run starts so the
+    // event seeding can be turned on before or after the seed is set.  It
+    // isn't needed when the engine is reseeded for every event since the
+    // event seeds are scrambled.
+    if (fConditionSeed && !fEventSeeding) {
+        for (int i=0; i<10000000; ++i) G4UniformRand();
+    }
+    fConditionSeed = false;
+
+    EDepSim::StepStatistics::Get()->BeginOfRun();
+    EDepSim::CheckpointManager::Get()->BeginOfRun(aRun);
+
+    // The physics tables have been built, so they can be cached.
+    EDepSim::PhysicsList* physics = dynamic_cast<EDepSim::PhysicsList*>(
+        G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList());
+    if (physics) physics->StoreTableCache();
+
     // Run the external actions.  These must not change the state of G4 or
     // EDepSim.
     for (G4UserRunAction *action : fExternalActions) {
@@ -61,6 +86,12 @@ void EDepSim::UserRunAction::EndOfRunAction(const G4Run* aRun) {
     EDepSimLog("Number of events = " << aRun->GetNumberOfEvent());
     EDepSimLog(*fTimer);
 
+    // Write a photon library that is being built.
+    EDepSim::PhotonLibraryManager::Get()->EndOfRun();
+
+    // Print the steps taken in each volume, particle and process.
+    EDepSim::StepStatistics::Get()->EndOfRun(aRun);
+
     // Run the external actions.  These must not change the state of G4 or
     // EDepSim.
     for (G4UserRunAction *action : fExternalActions) {
@@ -80,6 +111,8 @@ void EDepSim::UserRunAction::SetSeed(long seed) {
     if (seed<0) seed = -seed;
     EDepSimLog("### Random seed number set to: " << seed);
     G4Random::setTheSeed(seed);
+    fRunSeed = seed;
+    fConditionSeed = false;
 }
 
 
@@ -106,8 +139,40 @@ void EDepSim::UserRunAction::SetTimeSeed() {
     // Make sure the seed is odd and not zero.
     seed += (seed % 2) + 1;
     SetSeed(long(seed));
-    // Condition the seed.
-    for (int i=0; i<10000000; ++i) G4UniformRand();
+    // The seed is conditioned when the run starts.
+    fConditionSeed = true;
+}
+
+namespace {
+    // The SplitMix64 finalizer.  This scrambles the bits so that nearby
+    // inputs (e.g. consecutive event ids) give unrelated outputs.
+    std::uint64_t MixSeed(std::uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+}
+
+long long EDepSim::UserRunAction::SeedEvent(int runId, int eventId) const {
+    std::uint64_t key = MixSeed(std::uint64_t(fRunSeed));
+    key = MixSeed(key ^ std::uint32_t(runId));
+    key = MixSeed(key ^ std::uint32_t(eventId));
+
+    // The engine seeds are positive 31 bit values so that they are valid
+    // for every CLHEP engine, and the list is terminated by a zero.
+    long seeds[3];
+    seeds[0] = long(key & 0x7FFFFFFF);
+    seeds[1] = long((key >> 32) & 0x7FFFFFFF);
+    seeds[2] = 0;
+    if (seeds[0] == 0) seeds[0] = 1;
+    if (seeds[1] == 0) seeds[1] = 1;
+    G4Random::setTheSeeds(seeds);
+
+    EDepSimNamedInfo("Random", "Seed run " << runId
+                     << " event " << eventId
+                     << " with " << seeds[0] << " " << seeds[1]);
+    return (long long) key;
 }
 
 void EDepSim::UserRunAction::SetDetSimRunId(int v) {
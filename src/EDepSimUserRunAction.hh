@@ -39,9 +39,31 @@ public:
     /// Get the seed that started the low level random generator.
     long GetSeed(void) const;
 
-    /// Build a seed for the generator based on the system time.
+    /// Build a seed for the generator based on the system time.  The seed
+    /// is conditioned at the start of the run unless the engine is reseeded
+    /// for every event, so the order of the seeding commands doesn't
+    /// matter.
     void SetTimeSeed();
 
+    /// Get the seed set by SetSeed (or SetTimeSeed).  This is the seed for
+    /// the run, and is used to derive the seed for each event when the
+    /// engine is reseeded for every event.
+    long GetRunSeed(void) const {return fRunSeed;}
+
+    /// Set if the random engine is reseeded at the start of every event.
+    /// The event seed is derived from the run seed, the run id and the
+    /// event id, so an event can be simulated again without the events
+    /// before it.
+    void SetEventSeeding(bool v) {fEventSeeding = v;}
+
+    /// Check if the random engine is reseeded for every event.
+    bool GetEventSeeding(void) const {return fEventSeeding;}
+
+    /// Reseed the random engine for an event.  The engine state only
+    /// depends on the run seed, the run id and the event id.  This returns
+    /// the 64 bit event seed that the engine seeds are taken from.
+    long long SeedEvent(int runId, int eventId) const;
+
     /// Set the DetSim Run Id to a specific value.  This is the first run id
     /// that will be used by GEANT.  GEANT will automatically increment the
     /// run id everytime it starts a new internal run.  The run id should be
@@ -71,6 +93,16 @@ private:
     /// The cached value of the subrun id.
     int fSubrunId;
 
+    /// The seed that was set for the run.
+    long fRunSeed;
+
+    /// True if the engine is reseeded for every event.
+    bool fEventSeeding;
+
+    /// True if the time based seed needs to be conditioned when the run
+    /// starts.
+    bool fConditionSeed;
+
     // A list of external run actions that will be called.
     mutable std::vector<G4UserRunAction*> fExternalActions;
 
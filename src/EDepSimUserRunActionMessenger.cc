@@ -8,6 +8,7 @@
 #include <G4UIdirectory.hh>
 #include <G4UIcmdWithoutParameter.hh>
 #include <G4UIcmdWithAnInteger.hh>
+#include <G4UIcmdWithABool.hh>
 #include <G4Timer.hh>
 
 #include <EDepSimLog.hh>
@@ -33,6 +34,16 @@ EDepSim::UserRunActionMessenger::UserRunActionMessenger(
         = new G4UIcmdWithoutParameter("/edep/random/showRandomSeed",this);
     fShowRandomSeedCmd->SetGuidance("Show the random number seed.");
 
+    fEventSeedingCmd
+        = new G4UIcmdWithABool("/edep/random/eventSeeding",this);
+    fEventSeedingCmd->SetGuidance("Reseed the random number generator at the"
+                                  " start of every event.  The event seed is"
+                                  " derived from the random seed, the run id"
+                                  " and the event id, and is saved in the"
+                                  " output event.");
+    fEventSeedingCmd->SetParameterName("seeding",true);
+    fEventSeedingCmd->SetDefaultValue(true);
+
     fDetSimRunIdCmd
         = new G4UIcmdWithAnInteger("/edep/runId",this);
     fDetSimRunIdCmd->SetGuidance("This is the first run id that will be used by"
@@ -53,6 +64,7 @@ EDepSim::UserRunActionMessenger::~UserRunActionMessenger() {
     delete fRandomSeedCmd;
     delete fTimeRandomSeedCmd;
     delete fShowRandomSeedCmd;
+    delete fEventSeedingCmd;
     delete fDetSimRunIdCmd;
     delete fDetSimSubrunIdCmd;
 }
@@ -69,6 +81,14 @@ void EDepSim::UserRunActionMessenger::SetNewValue(G4UIcommand* command,
     else if (command == fShowRandomSeedCmd) {
         long seed = fUserRunAction->GetSeed();
         EDepSimLog("### Random number seed: " << seed);
+        if (fUserRunAction->GetEventSeeding()) {
+            EDepSimLog("### Events seeded from: "
+                       << fUserRunAction->GetRunSeed());
+        }
+    }
+    else if (command == fEventSeedingCmd) {
+        fUserRunAction->SetEventSeeding(
+            fEventSeedingCmd->GetNewBoolValue(newValue));
     }
     else if (command == fDetSimRunIdCmd) {
         int runId = fDetSimRunIdCmd->GetNewIntValue(newValue);
@@ -14,6 +14,7 @@ class G4UIdirectory;
 class G4UIcmdWithoutParameter;
 class G4UIcmdWithAString;
 class G4UIcmdWithAnInteger;
+class G4UIcmdWithABool;
 
 namespace EDepSim {class UserRunActionMessenger;}
 class EDepSim::UserRunActionMessenger: public G4UImessenger {
@@ -35,6 +36,7 @@ private:
     G4UIcmdWithAnInteger* fRandomSeedCmd;
     G4UIcmdWithoutParameter* fTimeRandomSeedCmd;
     G4UIcmdWithoutParameter* fShowRandomSeedCmd;
+    G4UIcmdWithABool* fEventSeedingCmd;
     G4UIcmdWithAnInteger* fDetSimRunIdCmd;
     G4UIcmdWithAnInteger* fDetSimSubrunIdCmd;
 
@@ -3,18 +3,167 @@
 //
 
 #include "EDepSimUserStackingAction.hh"
+#include "EDepSimUserStackingActionMessenger.hh"
+#include "EDepSimPhotonLibraryManager.hh"
 #include "EDepSimLog.hh"
 
 #include <globals.hh>
 #include <G4ParticleDefinition.hh>
+#include <G4ParticleTable.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4VTouchable.hh>
+#include <G4UnitsTable.hh>
 
 #include <G4SystemOfUnits.hh>
 #include <G4PhysicalConstants.hh>
 
+#include <cfloat>
+
 EDepSim::UserStackingAction::UserStackingAction()
-    : fKillOpticalPhotons(true) { }
+    : fKillOpticalPhotons(true), fRulesResolved(false),
+      fOpticalPhoton(G4OpticalPhoton::Definition()) {
+    SetDefaultRules();
+    fMessenger = new EDepSim::UserStackingActionMessenger(this);
+}
+
+EDepSim::UserStackingAction::~UserStackingAction() {
+    delete fMessenger;
+}
+
+void EDepSim::UserStackingAction::AddRule(
+    G4ClassificationOfNewTrack classification,
+    const std::string& particle, double maxEnergy,
+    Location location, const std::string& volume) {
+    if (particle == "em") {
+        AddRule(classification, "gamma", maxEnergy, location, volume);
+        AddRule(classification, "e-", maxEnergy, location, volume);
+        AddRule(classification, "e+", maxEnergy, location, volume);
+        return;
+    }
+    Rule rule;
+    rule.fClassification = classification;
+    rule.fParticleName = particle;
+    rule.fParticle = NULL;
+    rule.fMaxEnergy = maxEnergy;
+    rule.fLocation = location;
+    rule.fVolumeName = volume;
+    rule.fVolume = NULL;
+    rule.fRegion = NULL;
+    rule.fValid = false;
+    rule.fOptional = false;
+    fRules.push_back(rule);
+    fRulesResolved = false;
+}
+
+void EDepSim::UserStackingAction::ClearRules() {
+    fRules.clear();
+    fRulesResolved = false;
+}
+
+void EDepSim::UserStackingAction::SetDefaultRules() {
+    ClearRules();
+    // Drop photons below the "lowest" nuclear lines.  The lowest I know if
+    // is about 6 keV, and atomic shells start messing with the cross section
+    // at about 70 keV.
+    AddRule(fKill, "gamma", 10.*CLHEP::keV);
+    // The NEST thermal electrons are not tracked.  They only exist when
+    // NEST is used.
+    AddRule(fKill, "thermalelectron", DBL_MAX);
+    fRules.back().fOptional = true;
+}
+
+void EDepSim::UserStackingAction::ResolveRules() {
+    fRulesResolved = true;
+    G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+    for (std::vector<Rule>::iterator rule = fRules.begin();
+         rule != fRules.end(); ++rule) {
+        rule->fValid = true;
+        rule->fParticle = NULL;
+        if (rule->fParticleName != "all") {
+            rule->fParticle = particleTable->FindParticle(rule->fParticleName);
+            if (!rule->fParticle) {
+                if (!rule->fOptional) {
+                    EDepSimError("Stacking rule particle "
+                                 << rule->fParticleName
+                                 << " does not exist");
+                }
+                rule->fValid = false;
+            }
+        }
+        rule->fVolume = NULL;
+        rule->fRegion = NULL;
+        switch (rule->fLocation) {
+        case kInside: case kOutside:
+            rule->fVolume = G4LogicalVolumeStore::GetInstance()
+                ->GetVolume(rule->fVolumeName, false);
+            if (!rule->fVolume) {
+                EDepSimError("Stacking rule volume " << rule->fVolumeName
+                             << " does not exist");
+                rule->fValid = false;
+            }
+            break;
+        case kInsideRegion: case kOutsideRegion:
+            rule->fRegion = G4RegionStore::GetInstance()
+                ->GetRegion(rule->fVolumeName, false);
+            if (!rule->fRegion) {
+                EDepSimError("Stacking rule region " << rule->fVolumeName
+                             << " does not exist");
+                rule->fValid = false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
 
-EDepSim::UserStackingAction::~UserStackingAction() { }
+void EDepSim::UserStackingAction::ListRules() const {
+    EDepSimLog("Stacking rules (first match is used):");
+    for (std::vector<Rule>::const_iterator rule = fRules.begin();
+         rule != fRules.end(); ++rule) {
+        const char* classification = "unknown";
+        switch (rule->fClassification) {
+        case fUrgent: classification = "urgent"; break;
+        case fWaiting: classification = "waiting"; break;
+        case fPostpone: classification = "postpone"; break;
+        case fKill: classification = "kill"; break;
+        default: break;
+        }
+        const char* location = "";
+        switch (rule->fLocation) {
+        case kInside: location = " inside "; break;
+        case kOutside: location = " outside "; break;
+        case kInsideRegion: location = " inside region "; break;
+        case kOutsideRegion: location = " outside region "; break;
+        default: break;
+        }
+        EDepSimLog("   " << classification << " " << rule->fParticleName
+                   << " below " << G4BestUnit(rule->fMaxEnergy,"Energy")
+                   << location << rule->fVolumeName);
+    }
+}
+
+void EDepSim::UserStackingAction::PrepareNewEvent() {
+    if (!fRulesResolved) ResolveRules();
+}
+
+bool EDepSim::UserStackingAction::IsInside(const Rule& rule,
+                                           const G4Track* aTrack) const {
+    const G4VTouchable* touchable = aTrack->GetTouchable();
+    if (rule.fRegion) {
+        const G4VPhysicalVolume* pv = touchable->GetVolume();
+        return pv && pv->GetLogicalVolume()->GetRegion() == rule.fRegion;
+    }
+    for (int depth = 0; depth < touchable->GetHistoryDepth(); ++depth) {
+        const G4VPhysicalVolume* pv = touchable->GetVolume(depth);
+        if (pv && pv->GetLogicalVolume() == rule.fVolume) return true;
+    }
+    return false;
+}
 
 G4ClassificationOfNewTrack
 EDepSim::UserStackingAction::ClassifyNewTrack(const G4Track* aTrack) {
@@ -25,15 +174,9 @@ EDepSim::UserStackingAction::ClassifyNewTrack(const G4Track* aTrack) {
 
     if (aTrack->GetParentID() <= 0) return fUrgent;
 
-    // This is where we can throw away particles that we don't want to track.
-    // Drop photons below the "lowest" nuclear lines.  The lowest I know if is
-    // about 6 keV, and atomic shells start messing with the cross section at
-    // about 70 keV.
-    if (particle->GetParticleName() == "gamma") {
-        if (aTrack->GetKineticEnergy() < 10.*CLHEP::keV) return fKill;
-    }
-
-    if (particle->GetParticleName() == "opticalphoton") {
+    if (particle == fOpticalPhoton) {
+        // The photon hits are made by the photon library.
+        if (EDepSim::PhotonLibraryManager::Get()->IsApplying()) return fKill;
         if (GetKillOpticalPhotons()) {
             static int throttle = 5;
             if (throttle > 0) {
@@ -45,8 +188,22 @@ EDepSim::UserStackingAction::ClassifyNewTrack(const G4Track* aTrack) {
         }
     }
 
-    if (particle->GetParticleName() == "thermalelectron") {
-        return fKill;
+    // This is where we can throw away particles that we don't want to track.
+    if (!fRulesResolved) ResolveRules();
+    for (std::vector<Rule>::const_iterator rule = fRules.begin();
+         rule != fRules.end(); ++rule) {
+        if (!rule->fValid) continue;
+        if (rule->fParticle && rule->fParticle != particle) continue;
+        if (aTrack->GetKineticEnergy() >= rule->fMaxEnergy) continue;
+        if (rule->fLocation != kAnywhere) {
+            // The location of a new track isn't always known, and then the
+            // rule isn't applied.
+            if (!aTrack->GetTouchable()) continue;
+            bool inside = IsInside(*rule, aTrack);
+            if (inside != (rule->fLocation == kInside
+                           || rule->fLocation == kInsideRegion)) continue;
+        }
+        return rule->fClassification;
     }
 
     return G4UserStackingAction::ClassifyNewTrack(aTrack);
@@ -5,8 +5,29 @@
 #include "G4UserStackingAction.hh"
 #include "G4ClassificationOfNewTrack.hh"
 
+#include <string>
+#include <vector>
+
+class G4ParticleDefinition;
+class G4LogicalVolume;
+class G4Region;
+
+namespace EDepSim {class UserStackingActionMessenger;}
+
 namespace EDepSim {class UserStackingAction;}
 /// Control which particles are actually tracked by G4.
+///
+/// The secondary particles are classified using an ordered list of rules,
+/// and the first rule that matches a new track decides if it is killed,
+/// tracked immediately (urgent), or tracked after the urgent stack is
+/// empty (waiting).  A rule matches tracks of a particle type with a
+/// kinetic energy below a threshold, and can be limited to tracks created
+/// inside (or outside) of a logical volume or a region.  The rules are set
+/// using the /edep/stack/ commands, and the default rules kill gammas below
+/// 10 keV and the NEST thermal electrons.  Primary particles are always
+/// urgent.  The particle names, volumes and regions are looked up when the
+/// first track is classified, so the classification only compares
+/// pointers.
 class EDepSim::UserStackingAction : public G4UserStackingAction {
 public:
     UserStackingAction();
@@ -15,6 +36,10 @@ public:
     /// Check if a new track should be tracked.
     virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
 
+    /// Start a new event.  This looks up any rules that were added since
+    /// the last event.
+    virtual void PrepareNewEvent();
+
     /// Set a flag to kill optical photons.  They should be killed if there
     /// aren't any HitSurface sensitive detectors.  This is used by SurfaceSD
     /// to make sure photons are tracked.
@@ -23,9 +48,79 @@ public:
     /// Check if optical photons should be killed
     bool GetKillOpticalPhotons() {return fKillOpticalPhotons;}
 
+    /// Where a rule applies.
+    enum Location {
+        kAnywhere,      ///< Everywhere.
+        kInside,        ///< Inside of a logical volume.
+        kOutside,       ///< Outside of a logical volume.
+        kInsideRegion,  ///< Inside of a region.
+        kOutsideRegion, ///< Outside of a region.
+    };
+
+    /// Add a rule to the end of the list.  The particle is a particle name,
+    /// "all" for every particle, or "em" for gammas, electrons and
+    /// positrons.  The rule applies to tracks with a kinetic energy less
+    /// than maxEnergy, and the volume is the name of the logical volume or
+    /// region for rules limited to a location.
+    void AddRule(G4ClassificationOfNewTrack classification,
+                 const std::string& particle, double maxEnergy,
+                 Location location = kAnywhere,
+                 const std::string& volume = "");
+
+    /// Remove all of the rules (including the default rules).
+    void ClearRules();
+
+    /// Replace the rules with the default rules.
+    void SetDefaultRules();
+
+    /// Print the rules.
+    void ListRules() const;
+
 private:
 
+    /// A classification rule.
+    struct Rule {
+        /// The classification for matching tracks.
+        G4ClassificationOfNewTrack fClassification;
+        /// The particle name (or "all").
+        std::string fParticleName;
+        /// The particle (NULL for all particles).
+        const G4ParticleDefinition* fParticle;
+        /// The kinetic energy threshold.
+        double fMaxEnergy;
+        /// Where the rule applies.
+        Location fLocation;
+        /// The name of the volume or region.
+        std::string fVolumeName;
+        /// The volume for kInside and kOutside.
+        const G4LogicalVolume* fVolume;
+        /// The region for kInsideRegion and kOutsideRegion.
+        const G4Region* fRegion;
+        /// False if the particle, volume or region doesn't exist.
+        bool fValid;
+        /// True if the particle is expected to be missing from some
+        /// physics lists, so the rule is quietly ignored without it.
+        bool fOptional;
+    };
+
+    /// Look up the particles, volumes and regions for the rules.
+    void ResolveRules();
+
+    /// Check if a track is inside of the volume or region for a rule.
+    bool IsInside(const Rule& rule, const G4Track* aTrack) const;
+
     bool fKillOpticalPhotons;
 
+    /// The classification rules in the order they are checked.
+    std::vector<Rule> fRules;
+
+    /// True if the pointers in fRules have been looked up.
+    bool fRulesResolved;
+
+    /// The optical photon definition.
+    const G4ParticleDefinition* fOpticalPhoton;
+
+    EDepSim::UserStackingActionMessenger* fMessenger;
+
 };
 #endif
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////
+//
+#include "EDepSimUserStackingActionMessenger.hh"
+#include "EDepSimUserStackingAction.hh"
+#include "EDepSimException.hh"
+#include "EDepSimLog.hh"
+
+#include <G4UIdirectory.hh>
+#include <G4UIcommand.hh>
+#include <G4UIparameter.hh>
+#include <G4UIcmdWithoutParameter.hh>
+#include <G4UnitsTable.hh>
+
+#include <sstream>
+
+EDepSim::UserStackingActionMessenger::UserStackingActionMessenger(
+    EDepSim::UserStackingAction* action)
+    : fAction(action) {
+    fDirectory = new G4UIdirectory("/edep/stack/");
+    fDirectory->SetGuidance(
+        "Control which secondary particles are tracked, and when.");
+
+    fAddRuleCMD = new G4UIcommand("/edep/stack/addRule",this);
+    fAddRuleCMD->SetGuidance(
+        "Add a rule to classify new secondary tracks.  The first rule"
+        " that matches a track is used.");
+    fAddRuleCMD->SetGuidance(
+        "  kill: Don't track the particle.");
+    fAddRuleCMD->SetGuidance(
+        "  urgent: Track the particle immediately.");
+    fAddRuleCMD->SetGuidance(
+        "  waiting: Track the particle after the urgent tracks.");
+    fAddRuleCMD->SetGuidance(
+        "The particle can be a particle name, \"all\", or \"em\" for"
+        " gammas, electrons and positrons.  The rule applies to tracks"
+        " with less kinetic energy than the threshold, and can be limited"
+        " to tracks created inside or outside of a logical volume or a"
+        " region.");
+    fAddRuleCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+    G4UIparameter* param = new G4UIparameter("classification",'s',false);
+    param->SetParameterCandidates("kill urgent waiting");
+    fAddRuleCMD->SetParameter(param);
+    param = new G4UIparameter("particle",'s',false);
+    fAddRuleCMD->SetParameter(param);
+    param = new G4UIparameter("energy",'d',false);
+    param->SetParameterRange("energy>0");
+    fAddRuleCMD->SetParameter(param);
+    param = new G4UIparameter("unit",'s',false);
+    fAddRuleCMD->SetParameter(param);
+    param = new G4UIparameter("location",'s',true);
+    param->SetParameterCandidates(
+        "anywhere inside outside insideRegion outsideRegion");
+    param->SetDefaultValue("anywhere");
+    fAddRuleCMD->SetParameter(param);
+    param = new G4UIparameter("volume",'s',true);
+    param->SetDefaultValue("none");
+    fAddRuleCMD->SetParameter(param);
+
+    fClearRulesCMD = new G4UIcmdWithoutParameter("/edep/stack/clearRules",
+                                                 this);
+    fClearRulesCMD->SetGuidance(
+        "Remove all of the rules, including the default rules.");
+    fClearRulesCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fDefaultRulesCMD = new G4UIcmdWithoutParameter(
+        "/edep/stack/defaultRules",this);
+    fDefaultRulesCMD->SetGuidance(
+        "Replace the rules with the default rules (kill gammas below"
+        " 10 keV, and thermal electrons).");
+    fDefaultRulesCMD->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+    fListRulesCMD = new G4UIcmdWithoutParameter("/edep/stack/listRules",
+                                                this);
+    fListRulesCMD->SetGuidance("Print the rules.");
+}
+
+EDepSim::UserStackingActionMessenger::~UserStackingActionMessenger() {
+    delete fAddRuleCMD;
+    delete fClearRulesCMD;
+    delete fDefaultRulesCMD;
+    delete fListRulesCMD;
+    delete fDirectory;
+}
+
+void EDepSim::UserStackingActionMessenger::SetNewValue(G4UIcommand* command,
+                                                       G4String newValue) {
+    if (command == fAddRuleCMD) {
+        std::string classificationName;
+        std::string particle;
+        double energy;
+        std::string unitName;
+        std::string locationName;
+        std::string volume;
+        std::istringstream input((const char*)newValue);
+        input >> classificationName >> particle >> energy >> unitName
+              >> locationName >> volume;
+        energy *= G4UnitDefinition::GetValueOf(unitName);
+
+        G4ClassificationOfNewTrack classification = fUrgent;
+        if (classificationName == "kill") classification = fKill;
+        else if (classificationName == "waiting") classification = fWaiting;
+
+        EDepSim::UserStackingAction::Location location
+            = EDepSim::UserStackingAction::kAnywhere;
+        if (locationName == "inside") {
+            location = EDepSim::UserStackingAction::kInside;
+        }
+        else if (locationName == "outside") {
+            location = EDepSim::UserStackingAction::kOutside;
+        }
+        else if (locationName == "insideRegion") {
+            location = EDepSim::UserStackingAction::kInsideRegion;
+        }
+        else if (locationName == "outsideRegion") {
+            location = EDepSim::UserStackingAction::kOutsideRegion;
+        }
+        if (location != EDepSim::UserStackingAction::kAnywhere
+            && volume == "none") {
+            EDepSimError("Stacking rule for " << locationName
+                         << " needs a volume");
+            EDepSimThrow("Invalid stacking rule");
+        }
+        fAction->AddRule(classification, particle, energy, location, volume);
+    }
+    else if (command == fClearRulesCMD) {
+        fAction->ClearRules();
+    }
+    else if (command == fDefaultRulesCMD) {
+        fAction->SetDefaultRules();
+    }
+    else if (command == fListRulesCMD) {
+        fAction->ListRules();
+    }
+}
@@ -0,0 +1,32 @@
+////////////////////////////////////////////////////////////
+//
+#ifndef EDepSim_UserStackingActionMessenger_hh_seen
+#define EDepSim_UserStackingActionMessenger_hh_seen
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+
+namespace EDepSim {class UserStackingAction;}
+
+namespace EDepSim {class UserStackingActionMessenger;}
+/// Control the rules used to classify new tracks.
+class EDepSim::UserStackingActionMessenger: public G4UImessenger {
+public:
+    UserStackingActionMessenger(EDepSim::UserStackingAction* action);
+    virtual ~UserStackingActionMessenger();
+
+    void SetNewValue(G4UIcommand* command, G4String newValue);
+
+private:
+    EDepSim::UserStackingAction* fAction;
+
+    G4UIdirectory*            fDirectory;
+    G4UIcommand*              fAddRuleCMD;
+    G4UIcmdWithoutParameter*  fClearRulesCMD;
+    G4UIcmdWithoutParameter*  fDefaultRulesCMD;
+    G4UIcmdWithoutParameter*  fListRulesCMD;
+};
+#endif
@@ -1,4 +1,7 @@
 #include "EDepSimUserSteppingAction.hh"
+#include "EDepSimPhotonLibraryManager.hh"
+#include "EDepSimPerformanceMonitor.hh"
+#include "EDepSimStepStatistics.hh"
 #include "EDepSimLog.hh"
 
 #include <G4SystemOfUnits.hh>
@@ -9,8 +12,30 @@
 #include <G4Step.hh>
 #include <G4VProcess.hh>
 
+namespace {
+    // Return the name of a volume for a message.  This is only called when a
+    // message is printed.
+    const G4String& VolumeName(const G4VPhysicalVolume* pv) {
+        static const G4String missing("MissingVolume");
+        if (pv == nullptr) return missing;
+        return pv->GetName();
+    }
+
+    // Return the name and type of a process for a message.  This is only
+    // called when a message is printed.
+    G4String ProcessName(const G4VProcess* process) {
+        if (process == nullptr) return "UnknownProcess";
+        return process->GetProcessName()
+            + "/"
+            + process->GetProcessTypeName(process->GetProcessType());
+    }
+}
+
 EDepSim::SteppingAction::SteppingAction()
-    : fStenchAndRot(0), fSteps(0), fThrottle(1000), fGovernor(0) {}
+    : fStenchAndRot(0), fSteps(0), fThrottle(1000), fGovernor(0),
+      fPhotonLibrary(EDepSim::PhotonLibraryManager::Get()),
+      fPerformance(EDepSim::PerformanceMonitor::Get()),
+      fStepStatistics(EDepSim::StepStatistics::Get()) {}
 
 void EDepSim::SteppingAction::UserSteppingAction(const G4Step* theStep) {
 
@@ -20,37 +45,35 @@ void EDepSim::SteppingAction::UserSteppingAction(const G4Step* theStep) {
         action->UserSteppingAction(theStep);
     }
 
+    // Make the photon hits for the step when optical photons are not
+    // tracked.
+    if (fPhotonLibrary->IsApplying()) fPhotonLibrary->ProcessStep(theStep);
+
     G4Track* theTrack = theStep->GetTrack();
 
+    if (fPerformance->IsEnabled()) {
+        fPerformance->CountStep(theTrack->GetCurrentStepNumber() == 1);
+    }
+    if (fStepStatistics->IsEnabled()) fStepStatistics->ProcessStep(theStep);
+
     const G4StepPoint* thePreStep = theStep->GetPreStepPoint();
     const G4StepPoint* thePostStep = theStep->GetPostStepPoint();
 
     const G4VPhysicalVolume* thePrePV = thePreStep->GetPhysicalVolume();
     const G4VPhysicalVolume* thePostPV = thePostStep->GetPhysicalVolume();
 
-    G4String theParticleName = theTrack->GetDefinition()->GetParticleName();
-
-    G4String theCurrentVolumeName{"MissingVolume"};
-    if (thePrePV != nullptr) theCurrentVolumeName = thePrePV->GetName();
-
-    G4String theNextVolumeName{"MissingVolume"};
-    if (thePostPV != nullptr) theNextVolumeName = thePostPV->GetName();
-
+    // Only pointers are kept for the normal path.  The names are looked up
+    // inside of the message macros so they are only built when a message is
+    // printed.
+    const G4ParticleDefinition* theParticle = theTrack->GetDefinition();
     const G4VProcess* theProcess = thePostStep->GetProcessDefinedStep();
 
-    G4String theProcessName{"UnknownProcess"};
-    if (theProcess != nullptr) {
-        theProcessName = theProcess->GetProcessName()
-            + "/"
-            + theProcess->GetProcessTypeName(theProcess->GetProcessType());
-    }
-
     EDepSimTrace("Stepping " << theTrack->GetTrackID()
                  << " (step " << theTrack->GetCurrentStepNumber() << ")"
-                 << " " << theProcessName
+                 << " " << ProcessName(theProcess)
                  << " deposit " << theStep->GetTotalEnergyDeposit());
-    EDepSimTrace("    From " << theCurrentVolumeName);
-    EDepSimTrace("    To   " << theNextVolumeName);
+    EDepSimTrace("    From " << VolumeName(thePrePV));
+    EDepSimTrace("    To   " << VolumeName(thePostPV));
 
     if (thePostPV == nullptr) {
         // Out of this world!
@@ -62,31 +85,33 @@ void EDepSim::SteppingAction::UserSteppingAction(const G4Step* theStep) {
         return;
     }
 
-    if (fSteps%fThrottle == 0 && fSteps>0) {
+    // The throttle doubles after each report, so the reports are when the
+    // step count reaches the throttle.
+    if (fSteps == fThrottle) {
         EDepSimWarn("EDepSimUserSteppingAction:: Excessive Steps "
                   << " " << fSteps
-                  << " for " << theParticleName
+                  << " for " << theParticle->GetParticleName()
                   << " Length: " << theTrack->GetTrackLength()/m << " m"
                   << " Time: " << theTrack->GetGlobalTime()/ns << " ns"
                   << " Energy: " << theTrack->GetTotalEnergy()/MeV << " MeV"
-                  << " Volume: " << theCurrentVolumeName);
+                  << " Volume: " << VolumeName(thePrePV));
         fThrottle *= 2;
         fGovernor = 5;
     }
     if (fGovernor>0) {
         // Print a few steps to help the user see what is happening.
         --fGovernor;
-        EDepSimDebug("    " << theCurrentVolumeName
-                   << ": " << theParticleName
+        EDepSimDebug("    " << VolumeName(thePrePV)
+                   << ": " << theParticle->GetParticleName()
                    << " -- Step: " << theStep->GetStepLength()/mm << " mm"
                    << " Energy Loss: "<< theStep->GetTotalEnergyDeposit()/MeV
                    << " MeV");
     }
 
-    if (theStep->GetTrack()->GetTrackLength() > 1000*m) {
+    if (theTrack->GetTrackLength() > 1000*m) {
         theTrack->SetTrackStatus(fStopAndKill);
         EDepSimSevere("Stop and kill a very long track for "
-                    << theParticleName << " w/ "
+                    << theParticle->GetParticleName() << " w/ "
                     << G4BestUnit(theTrack->GetKineticEnergy(),"Energy")
                     << " (" << G4BestUnit(theTrack->GetTrackLength(),
                                           "Length")
@@ -102,15 +127,15 @@ void EDepSim::SteppingAction::UserSteppingAction(const G4Step* theStep) {
         if (theTrack->GetKineticEnergy() > 1*MeV) {
             theTrack->SetTrackStatus(fStopAndKill);
             EDepSimSevere("Stop and kill track w/ too many steps for "
-                        << theParticleName << " in "
-                        << theCurrentVolumeName << " w/ "
+                        << theParticle->GetParticleName() << " in "
+                        << VolumeName(thePrePV) << " w/ "
                         << G4BestUnit(theTrack->GetKineticEnergy(),"Energy"));
         }
         else {
             theTrack->SetTrackStatus(fStopButAlive);
             EDepSimSevere("Stop w/ too many steps for "
-                        << theParticleName << " in "
-                        << theCurrentVolumeName << " w/ "
+                        << theParticle->GetParticleName() << " in "
+                        << VolumeName(thePrePV) << " w/ "
                         << G4BestUnit(theTrack->GetKineticEnergy(),"Energy"));
         }
         fStenchAndRot = 0;
@@ -144,8 +169,8 @@ void EDepSim::SteppingAction::UserSteppingAction(const G4Step* theStep) {
     if (theTrack->GetKineticEnergy() > 1*MeV) {
         theTrack->SetTrackStatus(fStopAndKill);
         EDepSimSevere("Stop and kill stuck "
-                    << theParticleName << " in "
-                    << theCurrentVolumeName << " w/ "
+                    << theParticle->GetParticleName() << " in "
+                    << VolumeName(thePrePV) << " w/ "
                     << G4BestUnit(theTrack->GetKineticEnergy(),"Energy")
                     << " MeV");
         fStenchAndRot = 0;
@@ -156,8 +181,8 @@ void EDepSim::SteppingAction::UserSteppingAction(const G4Step* theStep) {
 
     theTrack->SetTrackStatus(fStopButAlive);
     EDepSimSevere("Stop stuck track "
-                  << theParticleName << " in "
-                  << theCurrentVolumeName << " w/ "
+                  << theParticle->GetParticleName() << " in "
+                  << VolumeName(thePrePV) << " w/ "
                   << G4BestUnit(theTrack->GetKineticEnergy(),"Energy")
                   << " MeV");
 
@@ -9,6 +9,10 @@
 
 #include <vector>
 
+namespace EDepSim {class PhotonLibraryManager;}
+namespace EDepSim {class PerformanceMonitor;}
+namespace EDepSim {class StepStatistics;}
+
 namespace EDepSim {class SteppingAction;}
 /// An action called for each step to make sure the MC isn't caught in some
 /// loop, the particle is still near to the detector, and the stepping has not
@@ -47,6 +51,16 @@ private:
     /// Control a summary of steps for the user.
     int fGovernor;
 
+    /// The photon library used to make photon hits when the optical photons
+    /// are not tracked.
+    EDepSim::PhotonLibraryManager* fPhotonLibrary;
+
+    /// The monitor that counts the steps and tracks in the event.
+    EDepSim::PerformanceMonitor* fPerformance;
+
+    /// The collector for the steps in each volume, particle and process.
+    EDepSim::StepStatistics* fStepStatistics;
+
     // A list of external stepping actions that will be called.
     mutable std::vector<G4UserSteppingAction*> fExternalActions;
 
@@ -4,6 +4,7 @@
 #include "EDepSimUserTrackingAction.hh"
 #include "EDepSimTrajectory.hh"
 #include "EDepSimTrajectoryMap.hh"
+#include "EDepSimStepStatistics.hh"
 #include "EDepSimLog.hh"
 #include "EDepSimBacktrace.hh"
 
@@ -27,6 +28,10 @@ EDepSim::UserTrackingAction::PreUserTrackingAction(const G4Track* theTrack) {
     int trackId = theTrack->GetTrackID();
     EDepSimTrace("Pre-tracking action for " << trackId);
 
+    // A timed step must not include the time between tracks.
+    EDepSim::StepStatistics* statistics = EDepSim::StepStatistics::Get();
+    if (statistics->IsEnabled()) statistics->StartTrack();
+
     // Run the external actions first.  These must not change the state of G4,
     // or EDepSim.
     for (G4UserTrackingAction *action : fExternalActions) {
@@ -0,0 +1,77 @@
+#ifndef EDepSim_VRootSolidConverter_hh_Seen
+#define EDepSim_VRootSolidConverter_hh_Seen
+
+#include <string>
+
+class TGeoShape;
+class TGeoMatrix;
+class G4VSolid;
+
+namespace EDepSim {class RootGeometryManager;}
+
+namespace EDepSim {class VRootSolidConverter;}
+/// A base class for the objects used by EDepSim::RootGeometryManager to
+/// translate a G4 solid into a ROOT shape.  Each converter handles a single
+/// G4 solid type which is specified by the value returned by
+/// G4VSolid::GetEntityType() (e.g. "G4Box").  The converters are registered
+/// using EDepSim::RootGeometryManager::AddSolidConverter(), and the
+/// converters for the standard G4 solids are registered when the geometry
+/// manager is created.  A converter registered for a type that already has
+/// a converter replaces the existing one.
+///
+/// External converters can be loaded from a shared library using the
+/// /edep/actions/loadSolidConverter macro command.  The library must provide
+/// a C function with the signature `EDepSim::VRootSolidConverter*
+/// (*)(const char* option)`.
+class EDepSim::VRootSolidConverter {
+public:
+    VRootSolidConverter(const std::string& entityType)
+        : fEntityType(entityType) {}
+    virtual ~VRootSolidConverter() {}
+
+    /// Create a new ROOT shape for theSolid.  If the solid needs to be
+    /// displaced relative to the volume (e.g. for the constituents of boolean
+    /// solids), then the displacement is returned in returnMatrix (if it is
+    /// not NULL).  The manager can be used to convert the constituent solids
+    /// (see EDepSim::RootGeometryManager::CreateShape).  This should return
+    /// NULL if the solid cannot be converted.
+    virtual TGeoShape* CreateShape(EDepSim::RootGeometryManager& manager,
+                                   const std::string& theName,
+                                   const G4VSolid* theSolid,
+                                   TGeoMatrix** returnMatrix) = 0;
+
+    /// Return the G4 entity type handled by this converter.
+    const std::string& GetEntityType() const {return fEntityType;}
+
+    /// Record the shared library, symbol and option used to create an
+    /// external converter.  These (and a checksum of the library) are part
+    /// of the geometry cache key, so a geometry converted with a different
+    /// converter isn't read from the cache.
+    void SetExternalSource(const std::string& library,
+                           const std::string& symbol,
+                           const std::string& option) {
+        fLibrary = library;
+        fSymbol = symbol;
+        fOption = option;
+    }
+
+    /// Return the library used to create an external converter (empty for
+    /// a built in converter).
+    const std::string& GetLibrary() const {return fLibrary;}
+
+    /// Return the symbol used to create an external converter.
+    const std::string& GetSymbol() const {return fSymbol;}
+
+    /// Return the option used to create an external converter.
+    const std::string& GetOption() const {return fOption;}
+
+private:
+    /// The G4 solid type that is handled by this converter.
+    std::string fEntityType;
+
+    /// The library, symbol and option for an external converter.
+    std::string fLibrary;
+    std::string fSymbol;
+    std::string fOption;
+};
+#endif
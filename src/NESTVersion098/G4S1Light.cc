@@ -54,6 +54,9 @@
 
 #include "G4S1Light.hh"
 
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+
 #define MIN_ENE -1*CLHEP::eV //lets you turn NEST off BELOW a certain energy
 #define MAX_ENE 1.*CLHEP::TeV //lets you turn NEST off ABOVE a certain energy
 #define HIENLIM 5*CLHEP::MeV //energy at which Doke model used exclusively
@@ -72,8 +75,6 @@ G4double UnivScreenFunc ( G4double E, G4double Z, G4double A );
 
 G4int BinomFluct(G4int N0, G4double prob); //function for doing fluctuations
 
-void InitMatPropValues ( G4MaterialPropertiesTable* nobleElementMat );
-
 #define Density_LXe 2.9 //reference density for density-dep. effects
 #define Density_LAr 1.393
 #define Density_LNe 1.207
@@ -89,6 +90,9 @@ G4S1Light::G4S1Light(const G4String& processName,
         fTrackSecondariesFirst = false;
         //particles die first, then scintillation is generated
 
+        fSiteRunID = -1; //no interaction sites saved yet
+        fSiteEventCount = -1;
+
         if (verboseLevel>0) {
           G4cout << GetProcessName() << " is created " << G4endl;
         }
@@ -96,6 +100,38 @@ G4S1Light::G4S1Light(const G4String& processName,
 
 G4S1Light::~G4S1Light(){} //destructor needed to avoid linker error
 
+G4S1Light::InteractionSite::InteractionSite()
+  : numExc(0), numIon(0), numPho(0), numEle(0),
+    trackL(0*CLHEP::um), energy(0*CLHEP::eV),
+    time0(DBL_MAX), time1(-1*CLHEP::ns) {
+  pos[0] = pos[1] = pos[2] = 999*CLHEP::km;
+}
+
+G4S1Light::SiteState&
+G4S1Light::GetSiteState(const G4MaterialPropertiesTable* table) {
+  return fSiteStates[table];
+}
+
+void G4S1Light::ResetSiteStates() {
+  // the sites never span events, so drop whatever was not dumped (but keep
+  // the memory for the next event)
+  // the events are counted by the run as they finish, so the count is the
+  // index of the current event in the run
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  G4int runID = run ? run->GetRunID() : -1;
+  G4int eventCount = run ? run->GetNumberOfEvent() : -1;
+  if ( runID == fSiteRunID && eventCount == fSiteEventCount ) return;
+  fSiteRunID = runID;
+  fSiteEventCount = eventCount;
+  std::map<const G4MaterialPropertiesTable*,SiteState>::iterator st;
+  for ( st = fSiteStates.begin(); st != fSiteStates.end(); ++st ) {
+    st->second.numSites = 0;
+    st->second.sites.clear();
+    st->second.energyTot = 0*CLHEP::keV;
+    st->second.energyGol = 0*CLHEP::MeV;
+  }
+}
+
 G4VParticleChange*
 G4S1Light::AtRestDoIt(const G4Track& aTrack, const G4Step& aStep)
 
@@ -114,6 +150,8 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         if ( !YieldFactor ) //set YF=0 when you want S1Light off in your sim
           return G4VRestDiscreteProcess::PostStepDoIt(aTrack, aStep);
 
+        ResetSiteStates(); //interaction sites are kept for one event
+
         if( aTrack.GetParentID() == 0 && aTrack.GetCurrentStepNumber() == 1 ) {
           fExcitedNucleus = false; //an initialization or reset
           fVeryHighEnergy = false; //initializes or (later) resets this
@@ -152,21 +190,12 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         if (ElementB) z2 = (G4int)(ElementB->GetZ()); else z2 = -1;
         if ( z1==2 || z1==10 || z1==18 || z1==36 || z1==54 ) {
           NobleNow = true;
-          j = (G4int)aMaterial->GetMaterialPropertiesTable()->
-            GetConstProperty("TOTALNUM_INT_SITES"); //get current number
-          if ( j < 0 ) {
-            InitMatPropValues(aMaterial->GetMaterialPropertiesTable());
-            j = 0; //no sites yet
-          } //material properties initialized
+          j = GetSiteState(aMaterial->GetMaterialPropertiesTable()).
+            numSites; //get current number
         } //end of atomic number check
         if ( z2==2 || z2==10 || z2==18 || z2==36 || z2==54 ) {
           NobleLater = true;
-          j = (G4int)bMaterial->GetMaterialPropertiesTable()->
-            GetConstProperty("TOTALNUM_INT_SITES");
-          if ( j < 0 ) {
-            InitMatPropValues(bMaterial->GetMaterialPropertiesTable());
-            j = 0; //no sites yet
-          } //material properties initialized
+          j = GetSiteState(bMaterial->GetMaterialPropertiesTable()).numSites;
         } //end of atomic number check
 
         if ( !NobleNow && !NobleLater )
@@ -195,6 +224,7 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
           ElementA = ElementB;
           aMaterialPropertiesTable = bMaterial->GetMaterialPropertiesTable();
         }
+        SiteState& aSites = GetSiteState(aMaterialPropertiesTable);
         if ( NobleNow && NobleLater &&
              aMaterial->GetDensity() != bMaterial->GetDensity() )
           InsAndOuts = true;
@@ -360,7 +390,7 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         G4double anExcitationEnergy = ((const G4Ions*)(pDef))->
           GetExcitationEnergy(); //grab nuclear energy level
         G4double TotalEnergyDeposit = //total energy deposited so far
-          aMaterialPropertiesTable->GetConstProperty( "ENERGY_DEPOSIT_TOT" );
+          aSites.energyTot;
         G4bool convert = false, annihil = false;
         //set up special cases for pair production and positron annihilation
         if(pPreStepPoint->GetKineticEnergy()>=(2*CLHEP::electron_mass_c2) &&
@@ -381,16 +411,14 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
           return G4VRestDiscreteProcess::PostStepDoIt(aTrack, aStep);
         //add current deposit to total energy budget
         if ( !annihil ) TotalEnergyDeposit += aStep.GetTotalEnergyDeposit();
-        if ( !convert ) aMaterialPropertiesTable->
-          AddConstProperty( "ENERGY_DEPOSIT_TOT", TotalEnergyDeposit );
+        if ( !convert ) aSites.energyTot = TotalEnergyDeposit;
         //save current deposit for determining number of quanta produced now
         TotalEnergyDeposit = aStep.GetTotalEnergyDeposit();
 
         // check what the current "goal" E is for dumping scintillation,
         // often the initial kinetic energy of the parent particle, and deal
         // with all other energy-related matters in this block of code
-        G4double InitialKinetEnergy = aMaterialPropertiesTable->
-          GetConstProperty( "ENERGY_DEPOSIT_GOL" );
+        G4double InitialKinetEnergy = aSites.energyGol;
         //if zero, add up initial potential and kinetic energies now
         if ( InitialKinetEnergy == 0 ) {
           G4double tE = pPreStepPoint->GetKineticEnergy()+anExcitationEnergy;
@@ -399,8 +427,7 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
                Phase == kStateLiquid && z1 == 54 ) tE = 9.4*CLHEP::keV;
           if ( fKr83m && ElectricField != 0 )
             DokeBirks[2] = 0.10;
-          aMaterialPropertiesTable->
-            AddConstProperty ( "ENERGY_DEPOSIT_GOL", tE );
+          aSites.energyGol = tE;
           //excited nucleus is special case where accuracy reduced for total
           //energy deposition because of G4 inaccuracies and scintillation is
           //forced-dumped when that nucleus is fully de-excited
@@ -408,44 +435,35 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         }
         //if a particle is leaving, remove its kinetic energy from the goal
         //energy, as this will never get deposited (if depositable)
-        if(outside){ aMaterialPropertiesTable->
-            AddConstProperty("ENERGY_DEPOSIT_GOL",
-            InitialKinetEnergy-pPostStepPoint->GetKineticEnergy());
-          if(aMaterialPropertiesTable->
-             GetConstProperty("ENERGY_DEPOSIT_GOL")<0)
-            aMaterialPropertiesTable->AddConstProperty("ENERGY_DEPOSIT_GOL",0);
+        if(outside){
+          aSites.energyGol =
+            InitialKinetEnergy-pPostStepPoint->GetKineticEnergy();
+          if(aSites.energyGol<0) aSites.energyGol = 0;
         }
         //if a particle is coming back into your scintillator, then add its
         //energy to the goal energy
-        if(inside) { aMaterialPropertiesTable->
-            AddConstProperty("ENERGY_DEPOSIT_GOL",
-            InitialKinetEnergy+pPreStepPoint->GetKineticEnergy());
+        if(inside) {
+          aSites.energyGol =
+            InitialKinetEnergy+pPreStepPoint->GetKineticEnergy();
           if ( TotalEnergyDeposit > 0 && InitialKinetEnergy == 0 ) {
-            aMaterialPropertiesTable->AddConstProperty("ENERGY_DEPOSIT_GOL",0);
+            aSites.energyGol = 0;
             TotalEnergyDeposit = .000000;
           }
         }
         if ( InsAndOuts ) {
           //G4double dribble = pPostStepPoint->GetKineticEnergy() -
           //pPreStepPoint->GetKineticEnergy();
-          aMaterialPropertiesTable->
-            AddConstProperty("ENERGY_DEPOSIT_GOL",(-0.1*CLHEP::keV)+
-            InitialKinetEnergy-pPostStepPoint->GetKineticEnergy());
-          InitialKinetEnergy = bMaterial->GetMaterialPropertiesTable()->
-            GetConstProperty("ENERGY_DEPOSIT_GOL");
-          bMaterial->GetMaterialPropertiesTable()->
-            AddConstProperty("ENERGY_DEPOSIT_GOL",(-0.1*CLHEP::keV)+
-            InitialKinetEnergy+pPreStepPoint->GetKineticEnergy());
-          if(aMaterialPropertiesTable->
-             GetConstProperty("ENERGY_DEPOSIT_GOL")<0)
-            aMaterialPropertiesTable->AddConstProperty("ENERGY_DEPOSIT_GOL",0);
-          if ( bMaterial->GetMaterialPropertiesTable()->
-             GetConstProperty("ENERGY_DEPOSIT_GOL") < 0 )
-            bMaterial->GetMaterialPropertiesTable()->
-             AddConstProperty ( "ENERGY_DEPOSIT_GOL", 0 );
+          SiteState& bSites =
+            GetSiteState(bMaterial->GetMaterialPropertiesTable());
+          aSites.energyGol = (-0.1*CLHEP::keV)+
+            InitialKinetEnergy-pPostStepPoint->GetKineticEnergy();
+          InitialKinetEnergy = bSites.energyGol;
+          bSites.energyGol = (-0.1*CLHEP::keV)+
+            InitialKinetEnergy+pPreStepPoint->GetKineticEnergy();
+          if ( aSites.energyGol < 0 ) aSites.energyGol = 0;
+          if ( bSites.energyGol < 0 ) bSites.energyGol = 0;
         }
-        InitialKinetEnergy = aMaterialPropertiesTable->
-          GetConstProperty("ENERGY_DEPOSIT_GOL"); //grab current goal E
+        InitialKinetEnergy = aSites.energyGol; //grab current goal E
         if ( annihil ) { //if an annihilation occurred, add energy of two gammas
             InitialKinetEnergy += 2*CLHEP::electron_mass_c2;
         }
@@ -455,11 +473,9 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
             InitialKinetEnergy -= 2*CLHEP::electron_mass_c2;
         }
         //update the relevant material property (goal energy)
-        aMaterialPropertiesTable->
-          AddConstProperty("ENERGY_DEPOSIT_GOL",InitialKinetEnergy);
+        aSites.energyGol = InitialKinetEnergy;
         if (anExcitationEnergy < 1e-100 && aStep.GetTotalEnergyDeposit()==0 &&
-        aMaterialPropertiesTable->GetConstProperty("ENERGY_DEPOSIT_GOL")==0 &&
-        aMaterialPropertiesTable->GetConstProperty("ENERGY_DEPOSIT_TOT")==0)
+            aSites.energyGol==0 && aSites.energyTot==0)
         return G4VRestDiscreteProcess::PostStepDoIt(aTrack, aStep);
 
         G4String procName;
@@ -479,31 +495,24 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
           x1 = x0; //prevents generation of quanta outside active volume
         } //no scint. for e-'s that leave
 
-        char xCoord[80]; char yCoord[80]; char zCoord[80];
         G4bool exists = false; //for querying whether set-up of new site needed
         for(i=0;i<j;i++) { //loop over all saved interaction sites
           counter = i; //save site# for later use in storing properties
-          sprintf(xCoord,"POS_X_%d",i); sprintf(yCoord,"POS_Y_%d",i);
-          sprintf(zCoord,"POS_Z_%d",i);
-          pos[0] = aMaterialPropertiesTable->GetConstProperty(xCoord);
-          pos[1] = aMaterialPropertiesTable->GetConstProperty(yCoord);
-          pos[2] = aMaterialPropertiesTable->GetConstProperty(zCoord);
-          if ( sqrt(pow(x1[0]-pos[0],2.)+pow(x1[1]-pos[1],2.)+
-                    pow(x1[2]-pos[2],2.)) < delta ) {
+          const InteractionSite& site = aSites.Site(i);
+          pos[0] = x1[0]-site.pos[0];
+          pos[1] = x1[1]-site.pos[1];
+          pos[2] = x1[2]-site.pos[2];
+          if ( sqrt(pos[0]*pos[0]+pos[1]*pos[1]+pos[2]*pos[2]) < delta ) {
             exists = true; break; //we find interaction is close to an old one
           }
         }
         if(!exists && TotalEnergyDeposit) { //current interaction too far away
           counter = j;
-          sprintf(xCoord,"POS_X_%i",j); sprintf(yCoord,"POS_Y_%i",j);
-          sprintf(zCoord,"POS_Z_%i",j);
           //save 3-space coordinates of the new interaction site
-          aMaterialPropertiesTable->AddConstProperty( xCoord, x1[0] );
-          aMaterialPropertiesTable->AddConstProperty( yCoord, x1[1] );
-          aMaterialPropertiesTable->AddConstProperty( zCoord, x1[2] );
+          InteractionSite& site = aSites.Site(j);
+          site.pos[0] = x1[0]; site.pos[1] = x1[1]; site.pos[2] = x1[2];
           j++; //increment number of sites
-          aMaterialPropertiesTable-> //save
-            AddConstProperty( "TOTALNUM_INT_SITES", j );
+          aSites.numSites = j; //save
         }
 
         // this is where nuclear recoil "L" factor is handled: total yield is
@@ -621,56 +630,39 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
         // be redundant by saving seemingly no longer needed exciton and ion
         // counts, these having been already used to calculate the number of ph
         // and e- above, whereas it does need this later for Thomas-Imel model
-        char numExc[80]; char numIon[80]; char numPho[80]; char numEle[80];
-        sprintf(numExc,"N_EXC_%i",counter); sprintf(numIon,"N_ION_%i",counter);
-        NumExcitons += (G4int)aMaterialPropertiesTable->
-          GetConstProperty( numExc );
-        NumIons     += (G4int)aMaterialPropertiesTable->
-          GetConstProperty( numIon );
-        aMaterialPropertiesTable->AddConstProperty( numExc, NumExcitons );
-        aMaterialPropertiesTable->AddConstProperty( numIon, NumIons     );
-        sprintf(numPho,"N_PHO_%i",counter); sprintf(numEle,"N_ELE_%i",counter);
-        NumPhotons   +=(G4int)aMaterialPropertiesTable->
-          GetConstProperty( numPho );
-        NumElectrons +=(G4int)aMaterialPropertiesTable->
-          GetConstProperty( numEle );
-        aMaterialPropertiesTable->AddConstProperty( numPho, NumPhotons   );
-        aMaterialPropertiesTable->AddConstProperty( numEle, NumElectrons );
+        InteractionSite& current = aSites.Site(counter);
+        NumExcitons += current.numExc;
+        NumIons     += current.numIon;
+        current.numExc = NumExcitons;
+        current.numIon = NumIons;
+        NumPhotons   += current.numPho;
+        NumElectrons += current.numEle;
+        current.numPho = NumPhotons;
+        current.numEle = NumElectrons;
 
         // increment and save the total track length, and save interaction
         // times for later, when generating the scintillation quanta
-        char trackL[80]; char time00[80]; char time01[80]; char energy[80];
-        sprintf(trackL,"TRACK_%i",counter); sprintf(energy,"ENRGY_%i",counter);
-        sprintf(time00,"TIME0_%i",counter); sprintf(time01,"TIME1_%i",counter);
-        delta = aMaterialPropertiesTable->GetConstProperty( trackL );
-        G4double energ = aMaterialPropertiesTable->GetConstProperty( energy );
+        delta = current.trackL;
+        G4double energ = current.energy;
         delta += dx*CLHEP::cm; energ += dE*CLHEP::MeV;
-        aMaterialPropertiesTable->AddConstProperty( trackL, delta );
-        aMaterialPropertiesTable->AddConstProperty( energy, energ );
+        current.trackL = delta;
+        current.energy = energ;
         if ( TotalEnergyDeposit > 0 ) {
-          G4double deltaTime = aMaterialPropertiesTable->
-            GetConstProperty( time00 );
           //for charged particles, which continuously lose energy, use initial
           //interaction time as the minimum time, otherwise use only the final
           if (aParticle->GetCharge() != 0) {
-            if (t0 < deltaTime)
-              aMaterialPropertiesTable->AddConstProperty( time00, t0 );
+            if (t0 < current.time0) current.time0 = t0;
           }
           else {
-            if (t1 < deltaTime)
-              aMaterialPropertiesTable->AddConstProperty( time00, t1 );
+            if (t1 < current.time0) current.time0 = t1;
           }
-          deltaTime = aMaterialPropertiesTable->GetConstProperty( time01 );
           //find the maximum possible scintillation "birth" time
-          if (t1 > deltaTime)
-            aMaterialPropertiesTable->AddConstProperty( time01, t1 );
+          if (t1 > current.time1) current.time1 = t1;
         }
 
         // begin the process of setting up creation of scint./ionization
-        TotalEnergyDeposit=aMaterialPropertiesTable->
-          GetConstProperty("ENERGY_DEPOSIT_TOT"); //get the total E deposited
-        InitialKinetEnergy=aMaterialPropertiesTable->
-          GetConstProperty("ENERGY_DEPOSIT_GOL"); //E that should have been
+        TotalEnergyDeposit=aSites.energyTot; //get the total E deposited
+        InitialKinetEnergy=aSites.energyGol; //E that should have been
         if(InitialKinetEnergy > HIENLIM &&
            abs(aParticle->GetPDGcode()) != 2112) fVeryHighEnergy=true;
         G4double safety; //margin of error for TotalE.. - InitialKinetEnergy
@@ -694,15 +686,12 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
           //interactions so that the number of secondaries gets set correctly
           NumPhotons = 0; NumElectrons = 0;
           for(i=0;i<j;i++) {
-            sprintf(numPho,"N_PHO_%d",i); sprintf(numEle,"N_ELE_%d",i);
-            NumPhotons  +=(G4int)aMaterialPropertiesTable->
-              GetConstProperty( numPho );
-            NumElectrons+=(G4int)aMaterialPropertiesTable->
-              GetConstProperty( numEle );
-            sprintf(trackL,"TRACK_%d",i); sprintf(energy,"ENRGY_%d",i);
+            const InteractionSite& site = aSites.Site(i);
+            NumPhotons  += site.numPho;
+            NumElectrons+= site.numEle;
             //add up track lengths of all sites, for a total LET calc (later)
-            dx += aMaterialPropertiesTable->GetConstProperty(trackL);
-            dE += aMaterialPropertiesTable->GetConstProperty(energy);
+            dx += site.trackL;
+            dE += site.energy;
           }
           G4int buffer = 100; if ( fVeryHighEnergy ) buffer = 1;
           aParticleChange.SetNumberOfSecondaries(
@@ -716,20 +705,13 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
           for(i=0;i<j;i++) {
             // get the position X,Y,Z, exciton and ion numbers, total track
             // length of the site, and interaction times
-            sprintf(xCoord,"POS_X_%d",i); sprintf(yCoord,"POS_Y_%d",i);
-            sprintf(zCoord,"POS_Z_%d",i);
-            sprintf(numExc,"N_EXC_%d",i); sprintf(numIon,"N_ION_%d",i);
-            sprintf(numPho,"N_PHO_%d",i); sprintf(numEle,"N_ELE_%d",i);
-            NumExcitons = (G4int)aMaterialPropertiesTable->
-              GetConstProperty( numExc );
-            NumIons     = (G4int)aMaterialPropertiesTable->
-              GetConstProperty( numIon );
-            sprintf(trackL,"TRACK_%d",i); sprintf(energy,"ENRGY_%d",i);
-            sprintf(time00,"TIME0_%d",i); sprintf(time01,"TIME1_%d",i);
-            delta = aMaterialPropertiesTable->GetConstProperty( trackL );
-            energ = aMaterialPropertiesTable->GetConstProperty( energy );
-            t0 = aMaterialPropertiesTable->GetConstProperty( time00 );
-            t1 = aMaterialPropertiesTable->GetConstProperty( time01 );
+            InteractionSite& site = aSites.Site(i);
+            NumExcitons = site.numExc;
+            NumIons     = site.numIon;
+            delta = site.trackL;
+            energ = site.energy;
+            t0 = site.time0;
+            t1 = site.time1;
 
             //if site is small enough, override the Doke/Birks' model with
             //Thomas-Imel, but not if we're dealing with super-high energy
@@ -780,18 +762,14 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
               NumPhotons = NumExcitons + BinomFluct(NumIons,recombProb);
               NumElectrons = (NumExcitons + NumIons) - NumPhotons;
               //override Doke NumPhotons and NumElectrons
-              aMaterialPropertiesTable->
-                AddConstProperty( numPho, NumPhotons   );
-              aMaterialPropertiesTable->
-                AddConstProperty( numEle, NumElectrons );
+              site.numPho = NumPhotons;
+              site.numEle = NumElectrons;
             }
 
             // grab NumPhotons/NumElectrons, which come from Birks if
             // the Thomas-Imel block of code above was not executed
-            NumPhotons  = (G4int)aMaterialPropertiesTable->
-              GetConstProperty( numPho );
-            NumElectrons =(G4int)aMaterialPropertiesTable->
-              GetConstProperty( numEle );
+            NumPhotons  = site.numPho;
+            NumElectrons = site.numEle;
 
             // extra Fano factor caused by recomb. fluct.
             G4double FanoFactor =0; //ionization channel
@@ -829,12 +807,12 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
             if ( SinglePhase ) //for a 1-phase det. don't propagate e-'s
               NumElectrons = 0; //saves simulation time
 
-            // reset material properties numExc, numIon, numPho, numEle, as
-            // their values have been used or stored elsewhere already
-            aMaterialPropertiesTable->AddConstProperty( numExc, 0 );
-            aMaterialPropertiesTable->AddConstProperty( numIon, 0 );
-            aMaterialPropertiesTable->AddConstProperty( numPho, 0 );
-            aMaterialPropertiesTable->AddConstProperty( numEle, 0 );
+            // reset the site numExc, numIon, numPho, numEle, as their
+            // values have been used or stored elsewhere already
+            site.numExc = 0;
+            site.numIon = 0;
+            site.numPho = 0;
+            site.numEle = 0;
 
             // start particle creation loop
             if( InitialKinetEnergy < MAX_ENE && InitialKinetEnergy > MIN_ENE &&
@@ -995,9 +973,9 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
 	      // being mistakenly generated outside of your active region by
 	      // Geant4, but real-life finite detector position resolution
 	      // wipes out any effects from here anyway...
-	      x0[0] = aMaterialPropertiesTable->GetConstProperty( xCoord );
-	      x0[1] = aMaterialPropertiesTable->GetConstProperty( yCoord );
-	      x0[2] = aMaterialPropertiesTable->GetConstProperty( zCoord );
+	      x0[0] = site.pos[0];
+	      x0[1] = site.pos[1];
+	      x0[2] = site.pos[2];
 	      G4double radius = sqrt(pow(x0[0],2.)+pow(x0[1],2.));
 	      //re-scale radius to ensure no generation of quanta outside
               //the active volume of your simulation due to Geant4 rounding
@@ -1053,13 +1031,7 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
 	    }
 
 	    //reset bunch of things when done with an interaction site
-	    aMaterialPropertiesTable->AddConstProperty( xCoord, 999*CLHEP::km );
-	    aMaterialPropertiesTable->AddConstProperty( yCoord, 999*CLHEP::km );
-	    aMaterialPropertiesTable->AddConstProperty( zCoord, 999*CLHEP::km );
-	    aMaterialPropertiesTable->AddConstProperty( trackL, 0*CLHEP::um );
-	    aMaterialPropertiesTable->AddConstProperty( energy, 0*CLHEP::eV );
-	    aMaterialPropertiesTable->AddConstProperty( time00, DBL_MAX );
-	    aMaterialPropertiesTable->AddConstProperty( time01, -1*CLHEP::ns );
+	    site = InteractionSite();
 
 	    if (verboseLevel>0) { //more verbose stuff
 	      G4cout << "\n Exiting from G4S1Light::DoIt -- "
@@ -1069,12 +1041,9 @@ G4S1Light::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
 	  } //end of interaction site loop
 
 	  //more things to reset...
-	  aMaterialPropertiesTable->
-	    AddConstProperty( "TOTALNUM_INT_SITES", 0 );
-	  aMaterialPropertiesTable->
-              AddConstProperty( "ENERGY_DEPOSIT_TOT", 0*CLHEP::keV );
-	  aMaterialPropertiesTable->
-              AddConstProperty( "ENERGY_DEPOSIT_GOL", 0*CLHEP::MeV );
+	  aSites.numSites = 0;
+	  aSites.energyTot = 0*CLHEP::keV;
+	  aSites.energyGol = 0*CLHEP::MeV;
 	  fExcitedNucleus = false;
 	  fAlpha = false;
 	}
@@ -1262,41 +1231,6 @@ G4int BinomFluct ( G4int N0, G4double prob ) {
   return N1;
 }
 
-void InitMatPropValues ( G4MaterialPropertiesTable *nobleElementMat ) {
-  char xCoord[80]; char yCoord[80]; char zCoord[80];
-  char numExc[80]; char numIon[80]; char numPho[80]; char numEle[80];
-  char trackL[80]; char time00[80]; char time01[80]; char energy[80];
-
-  // for loop to initialize the interaction site mat'l properties
-  for( G4int i=0; i<10000; i++ ) {
-    sprintf(xCoord,"POS_X_%d",i); sprintf(yCoord,"POS_Y_%d",i);
-    sprintf(zCoord,"POS_Z_%d",i);
-    nobleElementMat->AddConstProperty( xCoord, 999*CLHEP::km );
-    nobleElementMat->AddConstProperty( yCoord, 999*CLHEP::km );
-    nobleElementMat->AddConstProperty( zCoord, 999*CLHEP::km );
-    sprintf(numExc,"N_EXC_%d",i); sprintf(numIon,"N_ION_%d",i);
-    sprintf(numPho,"N_PHO_%d",i); sprintf(numEle,"N_ELE_%d",i);
-    nobleElementMat->AddConstProperty( numExc, 0 );
-    nobleElementMat->AddConstProperty( numIon, 0 );
-    nobleElementMat->AddConstProperty( numPho, 0 );
-    nobleElementMat->AddConstProperty( numEle, 0 );
-    sprintf(trackL,"TRACK_%d",i); sprintf(energy,"ENRGY_%d",i);
-    sprintf(time00,"TIME0_%d",i); sprintf(time01,"TIME1_%d",i);
-    nobleElementMat->AddConstProperty( trackL, 0*CLHEP::um );
-    nobleElementMat->AddConstProperty( energy, 0*CLHEP::eV );
-    nobleElementMat->AddConstProperty( time00, DBL_MAX );
-    nobleElementMat->AddConstProperty( time01,-1*CLHEP::ns );
-  }
-
-  // we initialize the total number of interaction sites, a variable for
-  // updating the amount of energy deposited thus far in the medium, and a
-  // variable for storing the amount of energy expected to be deposited
-  nobleElementMat->AddConstProperty( "TOTALNUM_INT_SITES", 0 );
-  nobleElementMat->AddConstProperty( "ENERGY_DEPOSIT_TOT", 0*CLHEP::keV );
-  nobleElementMat->AddConstProperty( "ENERGY_DEPOSIT_GOL", 0*CLHEP::MeV );
-  return;
-}
-
 G4double UnivScreenFunc ( G4double E, G4double Z, G4double A ) {
     G4double a_0 = 5.29e-11*CLHEP::m; G4double a = 0.626*a_0*pow(Z,(-1./3.));
     G4double epsilon_0 = 8.854e-12*(CLHEP::farad/CLHEP::m);
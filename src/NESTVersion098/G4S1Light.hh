@@ -16,6 +16,9 @@
 #include "G4PhysicsOrderedFreeVector.hh"
 #include "G4ThermalElectron.hh"
 
+#include <map>
+#include <vector>
+
 #include <G4SystemOfUnits.hh>
 #include <G4PhysicalConstants.hh>
 
@@ -113,6 +116,42 @@ protected:
         G4double YieldFactor; // turns scint. on/off
         G4double ExcitationRatio; // N_ex/N_i, the dimensionless ratio of
         //initial excitons to ions
+
+        // an interaction site, where the quanta from all of the nearby
+        // energy deposits are accumulated until the site is dumped
+        struct InteractionSite {
+          InteractionSite();
+          G4double pos[3]; // position of the site
+          G4int numExc, numIon, numPho, numEle; // quanta so far
+          G4double trackL, energy; // summed track length and energy
+          G4double time0, time1; // earliest and latest deposit times
+        };
+
+        // the interaction sites and the energy budget for one scintillating
+        // material (keyed by its material properties table); a site past
+        // numSites keeps the quanta added before the site was created
+        struct SiteState {
+          SiteState() : numSites(0), energyTot(0), energyGol(0) {}
+          InteractionSite& Site(G4int i) {
+            if (i >= (G4int)sites.size()) sites.resize(i+1);
+            return sites[i];
+          }
+          G4int numSites; // number of saved interaction sites
+          std::vector<InteractionSite> sites;
+          G4double energyTot; // total energy deposited so far
+          G4double energyGol; // energy expected to be deposited
+        };
+
+        // get the site state for a material, and reset all of the states
+        // when a new event starts
+        SiteState& GetSiteState(const G4MaterialPropertiesTable* table);
+        void ResetSiteStates();
+
+        std::map<const G4MaterialPropertiesTable*,SiteState> fSiteStates;
+        // the run, and the event in the run, the site states belong to (the
+        // event ID can repeat, e.g. from a HEPEVT file or a new run)
+        G4int fSiteRunID;
+        G4int fSiteEventCount;
 private:
         //LUXSimManager *luxManager;
 };
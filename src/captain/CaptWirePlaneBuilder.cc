@@ -18,6 +18,7 @@
 #include <G4Tubs.hh>
 
 #include <cmath>
+#include <vector>
 
 class CaptWirePlaneMessenger
     : public EDepSim::BuilderMessenger {
@@ -26,7 +27,7 @@ private:
     G4UIcmdWithADoubleAndUnit* fApothemCMD;
     G4UIcmdWithADoubleAndUnit* fSpacingCMD;
     G4UIcmdWithAnInteger* fMaxWireCountCMD;
-
+    G4UIcmdWithABool* fSharedWiresCMD;
 
 public:
     CaptWirePlaneMessenger(CaptWirePlaneBuilder* c)
@@ -52,12 +53,22 @@ public:
             "Set the maximum number of wires in a plane.");
         fMaxWireCountCMD->SetParameterName("count",false);
 
+        fSharedWiresCMD = new G4UIcmdWithABool(
+            CommandName("sharedWires"),this);
+        fSharedWiresCMD->SetGuidance(
+            "Share the logical volume of wires with the same length (the"
+            "\nmirror image wires).  Every wire is still placed, and the"
+            "\ncopy number of each wire is the wire number.");
+        fSharedWiresCMD->SetParameterName("shared",true);
+        fSharedWiresCMD->SetDefaultValue(true);
+
     }
 
     virtual ~CaptWirePlaneMessenger() {
         delete fApothemCMD;
         delete fSpacingCMD;
         delete fMaxWireCountCMD;
+        delete fSharedWiresCMD;
     }
 
     void SetNewValue(G4UIcommand *cmd, G4String val) {
@@ -70,6 +81,10 @@ public:
         else if (cmd==fMaxWireCountCMD) {
             fBuilder->SetMaxWireCount(fMaxWireCountCMD->GetNewIntValue(val));
         }
+        else if (cmd==fSharedWiresCMD) {
+            fBuilder->SetSharedWires(
+                fSharedWiresCMD->GetNewBoolValue(val));
+        }
         else {
             EDepSim::BuilderMessenger::SetNewValue(cmd,val);
         }
@@ -83,6 +98,7 @@ void CaptWirePlaneBuilder::Init(void) {
     SetSpacing(3*mm);
     SetHeight(1*mm);
     SetMaxWireCount(0);   // default value used to see if limit is set.
+    SetSharedWires(false);
     SetSensitiveDetector("drift","segment");
     SetMaximumHitLength(1*mm);
     SetMaximumHitSagitta(0.5*CLHEP::mm);
@@ -133,36 +149,45 @@ G4LogicalVolume *CaptWirePlaneBuilder::GetPiece(void) {
                     << " < " << GetMaxWireCount());
     }
 
-    G4RotationMatrix* wireRotation = NULL;
+    // The offset of the first wire.
+    double baseOffset = - 0.5*GetSpacing()*(wires-1);
+    double wireDiameter = std::min(GetHeight()/2, GetSpacing()/4);
 
     // The core needs to be rotated into the wire volume.  The core is not
     // used inside the geometry.
     G4RotationMatrix* coreRotation = new G4RotationMatrix();
     coreRotation->rotateX(90*CLHEP::degree);
 
-    // The offset of the first wire.
-    double baseOffset = - 0.5*GetSpacing()*(wires-1);
+    G4RotationMatrix* wireRotation = NULL;
+
+    // The wires that are shared.  The wires are symmetric around the center
+    // of the plane, so a wire has the same length as its mirror image.
+    std::vector<G4LogicalVolume*> sharedWires((wires+1)/2, NULL);
+
     for (int wire = 0; wire<wires; ++wire) {
         // The position of the wire.
         double wireOffset = baseOffset + wire*GetSpacing();
-        double wireLength = maxLength-2*std::abs(wireOffset)*std::tan(30*CLHEP::degree);
-        double wireDiameter = std::min(GetHeight()/2, GetSpacing()/4);
-
-        // Apply a correction to the length account for the corners of the
-        // wire box.
-        wireLength -= 2*GetSpacing()*std::cos(30*CLHEP::degree);
-
-        G4LogicalVolume* logWire
-            = new G4LogicalVolume(new G4Box(GetName()+"/Wire",
-                                            GetSpacing()/2,
-                                            wireLength/2,
-                                            GetHeight()/2),
-                                  FindMaterial("Argon_Liquid"),
-                                  GetName()+"/Wire");
-        logWire->SetVisAttributes(G4VisAttributes::GetInvisible());
-
-        if (GetSensitiveDetector()) {
-            logWire->SetSensitiveDetector(GetSensitiveDetector());
+        int copyNumber = 0;
+
+        // The wire that determines the length.  This is the wire itself
+        // unless the wires are shared.
+        int lengthWire = wire;
+        if (GetSharedWires()) {
+            lengthWire = std::min(wire, wires-1-wire);
+            copyNumber = wire;
+        }
+        G4LogicalVolume* logWire = NULL;
+        if (GetSharedWires()) logWire = sharedWires[lengthWire];
+
+        if (!logWire) {
+            // The wire length includes a correction to account for the
+            // corners of the wire box.
+            double lengthOffset = baseOffset + lengthWire*GetSpacing();
+            double wireLength = maxLength
+                - 2*std::abs(lengthOffset)*std::tan(30*CLHEP::degree);
+            wireLength -= 2*GetSpacing()*std::cos(30*CLHEP::degree);
+            logWire = BuildWire(wireLength, wireDiameter, coreRotation);
+            if (GetSharedWires()) sharedWires[lengthWire] = logWire;
         }
 
         new G4PVPlacement(wireRotation,                  // rotation.
@@ -171,31 +196,47 @@ G4LogicalVolume *CaptWirePlaneBuilder::GetPiece(void) {
                           logWire->GetName(),            // name
                           logVolume,                     // mother  volume
                           false,                         // (not used)
-                          0,                             // Copy number (zero)
+                          copyNumber,                    // Copy number
                           false);                         // Check overlaps.
+    }
 
-        G4LogicalVolume* logCore
-            = new G4LogicalVolume(new G4Tubs(GetName()+"/Wire/Core",
-                                             0.0, wireDiameter/2.0,
-                                             wireLength/2,
-                                             0*CLHEP::degree, 360*CLHEP::degree),
-                                  FindMaterial("Captain_Wire"),
-                                  GetName()+"/Wire/Core");
-        // Draw this as if it was a wire plane.
-        logCore->SetVisAttributes(GetColor(logCore));
-
-        new G4PVPlacement(coreRotation,         // rotation.
-                          G4ThreeVector(0,0,0), // position
-                          logCore,              // logical volume
-                          logCore->GetName(),   // name
-                          logWire,              // mother  volume
-                          false,                // (not used)
-                          0,                    // Copy number (zero)
-                          false);               // Check overlaps.
-
+    return logVolume;
+}
 
+G4LogicalVolume* CaptWirePlaneBuilder::BuildWire(
+    double wireLength, double wireDiameter,
+    G4RotationMatrix* coreRotation) {
+    G4LogicalVolume* logWire
+        = new G4LogicalVolume(new G4Box(GetName()+"/Wire",
+                                        GetSpacing()/2,
+                                        wireLength/2,
+                                        GetHeight()/2),
+                              FindMaterial("Argon_Liquid"),
+                              GetName()+"/Wire");
+    logWire->SetVisAttributes(G4VisAttributes::GetInvisible());
 
+    if (GetSensitiveDetector()) {
+        logWire->SetSensitiveDetector(GetSensitiveDetector());
     }
 
-    return logVolume;
+    G4LogicalVolume* logCore
+        = new G4LogicalVolume(new G4Tubs(GetName()+"/Wire/Core",
+                                         0.0, wireDiameter/2.0,
+                                         wireLength/2,
+                                         0*CLHEP::degree, 360*CLHEP::degree),
+                              FindMaterial("Captain_Wire"),
+                              GetName()+"/Wire/Core");
+    // Draw this as if it was a wire plane.
+    logCore->SetVisAttributes(GetColor(logCore));
+
+    new G4PVPlacement(coreRotation,         // rotation.
+                      G4ThreeVector(0,0,0), // position
+                      logCore,              // logical volume
+                      logCore->GetName(),   // name
+                      logWire,              // mother  volume
+                      false,                // (not used)
+                      0,                    // Copy number (zero)
+                      false);               // Check overlaps.
+
+    return logWire;
 }
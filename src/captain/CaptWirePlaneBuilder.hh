@@ -63,9 +63,30 @@ public:
     int GetMaxWireCount() const {return fMaxWireCount;}
     /// @}
 
+    /// Get or set if the wires share logical volumes.  When this is false
+    /// (the default), each wire is a separate logical volume with copy
+    /// number zero.  When this is true, a wire shares its logical volume
+    /// with the wire that has the same length (its mirror image across the
+    /// center of the plane), and the copy number is the wire number
+    /// (counting from negative X).  This is navigationally equivalent, and
+    /// halves the number of logical volumes and solids, but every wire is
+    /// still placed separately, so the number of physical volumes is not
+    /// changed.  The wires are not parameterised since the sensitive wire
+    /// volume contains the core, and GEANT4 doesn't allow daughters in a
+    /// parameterised volume with a varying size.
+    /// @{
+    void SetSharedWires(bool v) {fSharedWires = v;}
+    bool GetSharedWires() const {return fSharedWires;}
+    /// @}
+
 private:
     void Init(void);
 
+    /// Build the logical volume for a wire of a given length, with the wire
+    /// core placed inside.
+    G4LogicalVolume* BuildWire(double wireLength, double wireDiameter,
+                               G4RotationMatrix* coreRotation);
+
     /// The radius of the circle that can fit inside the wire plane
     double fApothem;
 
@@ -77,5 +98,8 @@ private:
 
     /// The maximum number of wires in the plane. 
     int fMaxWireCount;
+
+    /// Flag that wires with the same length share a logical volume.
+    bool fSharedWires;
 };
 #endif
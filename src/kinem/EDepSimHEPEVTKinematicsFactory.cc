@@ -7,9 +7,11 @@ EDepSim::HEPEVTKinematicsFactory::HEPEVTKinematicsFactory(
       fInputFile("not-open"),
       fFlavorName("pythia"),
       fVerbosity(0),
+      fFirstEvent(0),
       fInputFileCMD(NULL),
       fFlavorCMD(NULL),
-      fVerboseCMD(NULL) {
+      fVerboseCMD(NULL),
+      fFirstEventCMD(NULL) {
 
     fInputFileCMD = new G4UIcmdWithAString(CommandName("input"),this);
     fInputFileCMD->SetGuidance("Set the input file.");
@@ -23,12 +25,17 @@ EDepSim::HEPEVTKinematicsFactory::HEPEVTKinematicsFactory(
     fVerboseCMD = new G4UIcmdWithAnInteger(CommandName("verbose"),this);
     fVerboseCMD->SetGuidance("Set verbosity level (0 is default, 2 is max).");
     fVerboseCMD->SetParameterName("number",false);
+
+    fFirstEventCMD = new G4UIcmdWithAnInteger(CommandName("first"),this);
+    fFirstEventCMD->SetGuidance("Set the first event to generate.");
+    fFirstEventCMD->SetParameterName("number",false);
 }
 
 EDepSim::HEPEVTKinematicsFactory::~HEPEVTKinematicsFactory() {
     if (fInputFileCMD) delete fInputFileCMD;
     if (fFlavorCMD)    delete fFlavorCMD;
     if (fVerboseCMD)   delete fVerboseCMD;
+    if (fFirstEventCMD) delete fFirstEventCMD;
 }
 
 EDepSim::VKinematicsGenerator*
@@ -37,7 +44,8 @@ EDepSim::HEPEVTKinematicsFactory::GetGenerator() {
         = new EDepSim::HEPEVTKinematicsGenerator(GetName(),
                                                  GetInputFile(),
                                                  GetFlavor(),
-                                                 GetVerbose());
+                                                 GetVerbose(),
+                                                 GetFirstEvent());
     return kine;
 }
 
@@ -52,6 +60,9 @@ void EDepSim::HEPEVTKinematicsFactory::SetNewValue(G4UIcommand* command,
     else if (command == fVerboseCMD) {
         SetVerbose(fVerboseCMD->GetNewIntValue(newValue));
     }
+    else if (command == fFirstEventCMD) {
+        SetFirstEvent(fFirstEventCMD->GetNewIntValue(newValue));
+    }
     else{
         EDepSimError("Nothing to set the value.");
         EDepSimThrow("EDepSim::HEPKinematicsFactory::SetNewValue(): Error");
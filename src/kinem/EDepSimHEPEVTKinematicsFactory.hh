@@ -35,6 +35,12 @@ public:
     /// Get the input HEPEVT format flavor
     virtual const G4String& GetFlavor() const {return fFlavorName;}
 
+    /// Set the first event to read.
+    virtual void SetFirstEvent(int f) {fFirstEvent = f;}
+
+    /// Get the first event to read.
+    virtual int GetFirstEvent() const {return fFirstEvent;}
+
     /// Handle the macro command inputs.
     virtual void SetNewValue(G4UIcommand* command,G4String newValue);
 
@@ -49,6 +55,9 @@ private:
     /// The verbosity of the event reading.
     G4int fVerbosity;
 
+    /// The number of event records to skip at the start of the file.
+    int fFirstEvent;
+
     /// A command to get the file name to read for the HEPEVT records.
     G4UIcmdWithAString* fInputFileCMD;
 
@@ -59,5 +68,8 @@ private:
     /// A command to set the HEPEVT verbosity.
     G4UIcmdWithAnInteger* fVerboseCMD;
 
+    /// A command to set the first event to read.
+    G4UIcmdWithAnInteger* fFirstEventCMD;
+
 };
 #endif
@@ -16,10 +16,10 @@
 
 EDepSim::HEPEVTKinematicsGenerator::HEPEVTKinematicsGenerator(
     const G4String& name, const G4String& fileName,
-    const G4String& flavor, int verbosity)
+    const G4String& flavor, int verbosity, int firstEvent)
     : EDepSim::VKinematicsGenerator(name), fGenerator(NULL),
       fFileName(fileName), fFlavor(flavor),
-      fVerbosity(verbosity) {}
+      fVerbosity(verbosity), fFirstEvent(firstEvent) {}
 
 EDepSim::HEPEVTKinematicsGenerator::~HEPEVTKinematicsGenerator() {
 #ifdef USE_G4HEPEvtInterface
@@ -53,6 +53,117 @@ int EDepSim::HEPEVTKinematicsGenerator::GetTokens(
     return 0;
 }
 
+bool EDepSim::HEPEVTKinematicsGenerator::SkipLine() {
+    std::string line;
+    while (std::getline(fInput,line)) {
+        ++fCurrentLine;
+        std::string::size_type first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        if (line[first] == '#') continue;
+        return true;
+    }
+    return false;
+}
+
+int EDepSim::HEPEVTKinematicsGenerator::ParticleLines(
+    const std::vector<std::string>& tokens) {
+    switch (tokens.size()) {
+    case 1: case 5:
+        return AsInteger(tokens[0]);
+    case 2:
+        return AsInteger(tokens[1]);
+    case 3: case 7:
+        return AsInteger(tokens[2]);
+    default:
+        return -1;
+    }
+}
+
+void EDepSim::HEPEVTKinematicsGenerator::SkipEvents(int events) {
+    EDepSimLog("Skip " << events << " events in " << fFileName);
+    std::vector<std::string> tokens;
+    int skipped = 0;
+    bool inEvent = false;
+    int eventId = 0;
+    while (skipped < events) {
+        // Remember the start of the record so the first vertex of the next
+        // event can be read again.
+        std::streampos position = fInput.tellg();
+        int currentLine = fCurrentLine;
+        if (!GetTokens(tokens)) {
+            EDepSimError("First event is after the last event in "
+                         << fFileName);
+            throw EDepSim::NoMoreEvents();
+        }
+        int lines = ParticleLines(tokens);
+        if (lines < 0) {
+            EDepSimError("Syntax error at "
+                         << fFileName << ":" << fCurrentLine);
+            throw EDepSim::NoMoreEvents();
+        }
+        // The multi-vertex headers have the event ID and the vertex ID, and
+        // an event is every record with the same event ID.  The other
+        // headers have one record for each event.
+        bool multiVertex = (tokens.size() == 3 || tokens.size() == 7);
+        if (multiVertex) {
+            int id = AsInteger(tokens[0]);
+            if (inEvent && id != eventId && ++skipped == events) {
+                fInput.seekg(position);
+                fCurrentLine = currentLine;
+                return;
+            }
+            inEvent = true;
+            eventId = id;
+        }
+        for (int line = 0; line < lines; ++line) {
+            if (SkipLine()) continue;
+            EDepSimError("Incomplete record at "
+                         << fFileName << ":" << fCurrentLine);
+            throw EDepSim::NoMoreEvents();
+        }
+        if (!multiVertex) ++skipped;
+    }
+}
+
+void EDepSim::HEPEVTKinematicsGenerator::SaveState(
+    std::ostream& output) const {
+    // The file hasn't been opened yet, so it starts at the first event.
+    if (!fInput.is_open()) {
+        output << "closed";
+        return;
+    }
+    std::ifstream& input = const_cast<std::ifstream&>(fInput);
+    if (input.eof()) {
+        output << "end";
+        return;
+    }
+    output << "offset " << input.tellg() << " " << fCurrentLine;
+}
+
+void EDepSim::HEPEVTKinematicsGenerator::RestoreState(std::istream& input) {
+    std::string key;
+    input >> key;
+    if (key == "closed") return;
+    if (fInput.is_open()) fInput.close();
+    fInput.open(fFileName,std::ifstream::in);
+    if (!fInput.is_open()) {
+        EDepSimThrow("File not open: " << fFileName);
+    }
+    if (key == "end") {
+        fInput.seekg(0, std::ios::end);
+        fInput.get();
+        return;
+    }
+    long long offset = 0;
+    input >> offset >> fCurrentLine;
+    if (key != "offset" || !input) {
+        EDepSimThrow("Invalid HEPEVT state for " << fFileName);
+    }
+    fInput.seekg(offset);
+    EDepSimNamedLog("HEPEVT", "Restart " << fFileName
+                    << " at line " << fCurrentLine);
+}
+
 int EDepSim::HEPEVTKinematicsGenerator::AsInteger(const std::string& token) {
     std::istringstream input(token);
     int value;
@@ -99,6 +210,7 @@ EDepSim::HEPEVTKinematicsGenerator::GeneratePrimaryVertex(
             EDepSimThrow("File not open: " << fFileName);
         }
         EDepSimNamedLog("HEPEVT", "Open HEPEVT file: " << fFileName);
+        if (fFirstEvent > 0) SkipEvents(fFirstEvent);
     }
 
 
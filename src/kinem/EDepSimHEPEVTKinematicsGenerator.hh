@@ -21,7 +21,8 @@ public:
     HEPEVTKinematicsGenerator(const G4String& name,
                               const G4String& fileName,
                               const G4String& flavor,
-                              int verbosity = 0);
+                              int verbosity = 0,
+                              int firstEvent = 0);
     virtual ~HEPEVTKinematicsGenerator();
 
     /// Add a primary vertex to the event.
@@ -29,6 +30,12 @@ public:
     GeneratePrimaryVertex(G4Event* evt,
                           const G4LorentzVector& position);
 
+    /// Save the offset of the next record in the input file.
+    virtual void SaveState(std::ostream& output) const;
+
+    /// Reopen the input file at the saved offset.
+    virtual void RestoreState(std::istream& input);
+
 private:
     /// The primary generator when G4HEPEvtInterface is used (usually NULL).
     G4VPrimaryGenerator* fGenerator;
@@ -45,6 +52,9 @@ private:
     /// The verbosity of the output
     int fVerbosity;
 
+    /// The number of event records to skip when the file is opened.
+    int fFirstEvent;
+
     /// The input stream to be read.
     std::ifstream fInput;
 
@@ -58,6 +68,22 @@ private:
     /// Lines that are empty, or only have comments are skipped,
     int GetTokens(std::vector<std::string>& tokens);
 
+    /// Skip the next line that isn't empty or a comment without breaking it
+    /// into tokens.  This returns false when the file is empty.
+    bool SkipLine();
+
+    /// Get the number of particle lines that follow a record header.  The
+    /// count depends on the input flavor, which is found from the number of
+    /// tokens in the header.  This returns a negative value if the header
+    /// isn't valid.
+    int ParticleLines(const std::vector<std::string>& tokens);
+
+    /// Skip events at the start of the file to reach the first event.  An
+    /// event is one record, except for the multi-vertex headers (with an
+    /// event and vertex ID) where it is every record with the same event
+    /// ID.  The particle lines are skipped without being parsed.
+    void SkipEvents(int events);
+
     /// Parse a token as an integer.  This will throw an error if the string
     /// is not a valid integer.
     int AsInteger(const std::string& token);
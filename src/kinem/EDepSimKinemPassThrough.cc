@@ -2,6 +2,7 @@
 
 #include <TROOT.h>
 #include <TList.h>
+#include <TKey.h>
 
 #include "EDepSimLog.hh"
 
@@ -105,7 +106,9 @@ bool EDepSim::KinemPassThrough::AddInputTree(const TTree * inputTreePtr,
     // of clones (as for a TChain this always returns false). 
     if (fPersistentTree == NULL) {
         EDepSimNamedDebug("PassThru", "Clone the input TTree");
+        TDirectory* directory = gDirectory;
         fPersistentTree = (TTree*) fInputTreeChain->CloneTree(0);
+        RestorePersistentTree(directory);
     }
 
     // Add the input file to the file list so it can be saved in the output
@@ -130,7 +133,7 @@ bool EDepSim::KinemPassThrough::AddInputTree(const TTree * inputTreePtr,
     fInputFileTreeName[sizeof(fInputFileTreeName)-1] = 0;
     fInputFilePOT = inputTreePtr->GetWeight();
     fInputFileEntries = inputTreePtr->GetEntries();
-    fInputFilesTree->Fill();
+    if (fFileList.size() > fSavedFiles) fInputFilesTree->Fill();
 
     EDepSimNamedDebug("PassThru", 
                     "Have added a " << fFirstTreeName 
@@ -149,7 +152,8 @@ void EDepSim::KinemPassThrough::CreateInternalTrees() {
         if (!file) continue;
         if (!file->IsOpen()) continue;
         std::string fileOption(file->GetOption());
-        if (fileOption.find("CREATE") != std::string::npos) {
+        if (fileOption.find("CREATE") != std::string::npos
+            || fileOption == "UPDATE") {
             output = file;
             continue;
         }
@@ -169,6 +173,33 @@ void EDepSim::KinemPassThrough::CreateInternalTrees() {
     // Make sure we are in the pass-thru directory.
     output->cd(PASSTHRUDIR);
 
+    // Use the trees saved before a restart.
+    if (fInputKinemTree == NULL) {
+        fInputKinemTree = dynamic_cast<TTree*>(gDirectory->Get("InputKinem"));
+        if (fInputKinemTree) {
+            EDepSimNamedDebug("PassThru", "Use saved InputKinem TTree");
+            fInputKinemTree->SetBranchAddress("inputFileNum",
+                                              &fInputFileNumber);
+            fInputKinemTree->SetBranchAddress("inputEntryNum",
+                                              &fOrigEntryNumber);
+        }
+    }
+
+    if (fInputFilesTree == NULL) {
+        fInputFilesTree = dynamic_cast<TTree*>(gDirectory->Get("InputFiles"));
+        if (fInputFilesTree) {
+            EDepSimNamedDebug("PassThru", "Use saved InputFiles TTree");
+            fInputFilesTree->SetBranchAddress("fileName", fInputFileName);
+            fInputFilesTree->SetBranchAddress("generatorName",
+                                              fInputFileGenerator);
+            fInputFilesTree->SetBranchAddress("treeName", fInputFileTreeName);
+            fInputFilesTree->SetBranchAddress("filePOT", &fInputFilePOT);
+            fInputFilesTree->SetBranchAddress("fileEntries",
+                                              &fInputFileEntries);
+            fSavedFiles = fInputFilesTree->GetEntries();
+        }
+    }
+
     // Create the book keeping three that connects a particular entry to the
     // entry in the original file.
     if (fInputKinemTree == NULL) {
@@ -195,6 +226,27 @@ void EDepSim::KinemPassThrough::CreateInternalTrees() {
     }
 }
 
+void EDepSim::KinemPassThrough::RestorePersistentTree(TDirectory* directory) {
+    if (!directory || !fPersistentTree) return;
+    std::string name(fPersistentTree->GetName());
+
+    // Only look at the keys since the new tree has the same name in memory.
+    TKey* key = directory->GetKey(name.c_str());
+    if (!key) return;
+    TTree* saved = dynamic_cast<TTree*>(key->ReadObj());
+    if (!saved) return;
+    fPersistentTree->CopyEntries(saved);
+    EDepSimNamedLog("PassThru", "Restored " << saved->GetEntries()
+                    << " entries in " << name);
+    delete saved;
+
+    // The new tree replaces the saved tree when the file is written.
+    while ((key = directory->GetKey(name.c_str()))) {
+        key->Delete();
+        delete key;
+    }
+}
+
 bool 
 EDepSim::KinemPassThrough::AddEntry(const TTree* inputTree, int origEntry) {
     if (!fPersistentTree) {       
@@ -281,6 +333,7 @@ void EDepSim::KinemPassThrough::Init() {
     fInputTreeChain = NULL;
     fFirstTreeName.clear();
     fFileList.clear();
+    fSavedFiles = 0;
     fInputFileNumber = -1;
     fOrigEntryNumber = -1;
     fInputFileName[0] = 0;
@@ -85,9 +85,15 @@ private:
     static EDepSim::KinemPassThrough * fKinemPassThrough;
   
     /// Create the bookkeeping and file list trees.  This also creates the
-    /// directory.
+    /// directory.  When a job is restarted from a checkpoint, the trees
+    /// already in the output file are used.
     void CreateInternalTrees();
 
+    /// Copy the entries of a pass-through tree that was saved in the output
+    /// file before a restart into the persistent tree, and remove the saved
+    /// tree from the file.
+    void RestorePersistentTree(TDirectory* directory);
+
     /// Clean up all of the allocated pointers.
     void CleanUp(); 
 
@@ -115,6 +121,10 @@ private:
     /// Used to store list of files before they are written to tree.
     std::vector<std::string> fFileList;
 
+    /// The number of input files that were saved in the output file before
+    /// a restart.  These are not added to the file list tree again.
+    std::size_t fSavedFiles;
+
     // =====================================
     /// Tree relating all events in the persistent tree to an input file
     TTree* fInputKinemTree;
@@ -37,6 +37,11 @@ public:
         return fKinematics;
     }
 
+    /// Return the kinematics generator so that its state can be restored.
+    EDepSim::VKinematicsGenerator* GetKinematicsGenerator() {
+        return fKinematics;
+    }
+
     /// Return the count generator.
     const EDepSim::VCountGenerator* GetCountGenerator() const {
         return fCount;
@@ -29,6 +29,7 @@
 #include "kinem/EDepSimRooTrackerKinematicsGenerator.hh"
 
 #include "EDepSimLog.hh"
+#include "EDepSimException.hh"
 
 
 EDepSim::RooTrackerKinematicsGenerator::RooTrackerKinematicsGenerator(
@@ -184,6 +185,31 @@ G4String EDepSim::RooTrackerKinematicsGenerator::GetInputName() {
     return G4String(fInput->GetName());
 }
 
+void EDepSim::RooTrackerKinematicsGenerator::SaveState(
+    std::ostream& output) const {
+    output << fEntryVector.size() - fNextEntry;
+    for (std::size_t i = fNextEntry; i < fEntryVector.size(); ++i) {
+        output << " " << fEntryVector[i];
+    }
+}
+
+void EDepSim::RooTrackerKinematicsGenerator::RestoreState(
+    std::istream& input) {
+    std::size_t entries = 0;
+    if (!(input >> entries)) {
+        EDepSimThrow("Invalid rooTracker state for " << GetName());
+    }
+    std::vector<int> entryVector(entries);
+    for (std::size_t i = 0; i < entries; ++i) {
+        if (input >> entryVector[i]) continue;
+        EDepSimThrow("Truncated rooTracker state for " << GetName());
+    }
+    fEntryVector.swap(entryVector);
+    fNextEntry = 0;
+    EDepSimLog("Restored " << GetName() << " with "
+               << fEntryVector.size() << " entries left");
+}
+
 EDepSim::VKinematicsGenerator::GeneratorStatus
 EDepSim::RooTrackerKinematicsGenerator::GeneratePrimaryVertex(
     G4Event* anEvent,
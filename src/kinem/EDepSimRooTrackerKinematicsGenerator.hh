@@ -45,6 +45,12 @@ public:
     /// Get the name of the open kinematics file.
     virtual G4String GetInputName();
 
+    /// Save the entries that haven't been used yet.
+    virtual void SaveState(std::ostream& output) const;
+
+    /// Restore the entries that haven't been used yet.
+    virtual void RestoreState(std::istream& input);
+
 private:
     /// The static part of the file name field.
     std::string fFilename;
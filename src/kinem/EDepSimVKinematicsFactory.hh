@@ -17,5 +17,10 @@ public:
     /// generator method is pure virtual so it must be implemented by derived
     /// classes.
     virtual EDepSim::VKinematicsGenerator* GetGenerator() = 0;
+
+    /// Set the first record to read from the kinematics input.  This is
+    /// used to split a run between several jobs (see /generator/firstEvent).
+    /// Factories that don't read an input file ignore it.
+    virtual void SetFirstEvent(int) {}
 };
 #endif
@@ -9,6 +9,8 @@
 
 #include "EDepSimException.hh"
 
+#include <iostream>
+
 class G4Event;
 
 namespace EDepSim {class VKinematicsGenerator;}
@@ -62,6 +64,16 @@ public:
     /// Return the name of the generator.
     G4String GetName() const {return fName;}
 
+    /// Save the position of the generator in its input so that a job can be
+    /// restarted from a checkpoint (see EDepSim::CheckpointManager).  The
+    /// state must be written on a single line.  The default is for
+    /// generators that don't read an input file.
+    virtual void SaveState(std::ostream& /* output */) const {}
+
+    /// Restore the position of the generator from the state written by
+    /// SaveState.
+    virtual void RestoreState(std::istream& /* input */) {}
+
 private:
     /// The name of the generator.
     G4String fName;
@@ -0,0 +1,265 @@
+#! /usr/bin/env python3
+#
+# Run the edep-sim benchmarks.  Each benchmark runs a representative
+# macro with a fixed seed and the performance monitor enabled
+# (/edep/perf/enable), and the EDepSimPerformance tree is summarized
+# into a JSON file with the events per second, the time per stage, the
+# peak memory, and the output bytes per event.  Each benchmark is run
+# several times, and the median of the runs is used.  The summary can be
+# saved as a baseline, and later runs compared against it.
+#
+# This is normally run with "make benchmark" (or "make
+# benchmark-baseline" to save the baseline), but can be run by hand
+#
+#    edep-sim-benchmark.py --output bench --baseline baseline.json
+#
+# The exit status is 1 if a benchmark is slower (or bigger) than the
+# baseline by more than the tolerance, and 2 if a benchmark fails.
+#
+
+import argparse, json, os, platform, statistics, subprocess, sys, time
+
+# The source directory (the benchmark is in validate/benchmark).
+SOURCE = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+BENCHMARK = os.path.join(SOURCE, "validate", "benchmark")
+INPUTS = os.path.join(SOURCE, "inputs")
+
+# The benchmarks as (name, macro, gdml, events).  The geometry is the
+# default geometry when the gdml is None.
+CASES = [
+    ("muon-10000", os.path.join(INPUTS, "muon-10000.mac"), None, 20),
+    ("muon-burst-10000", os.path.join(INPUTS, "muon-burst-10000.mac"),
+     None, 20),
+    ("rooTracker-overlay", os.path.join(INPUTS, "rooTracker-overlay.mac"),
+     None, 100),
+    ("optical-photons", os.path.join(INPUTS, "optical-photons.mac"),
+     None, 200),
+    ("em-shower", os.path.join(BENCHMARK, "em-shower.mac"),
+     os.path.join(BENCHMARK, "em-shower.gdml"), 50),
+]
+
+# The seed used for every benchmark.
+SEED = 20100
+
+# The metrics where a smaller value is better, and the tolerance that
+# applies to them.  The events per second are compared separately.
+TIME_METRICS = ["seconds_per_event", "cpu_per_event"]
+SIZE_METRICS = ["peak_memory_mb", "output_bytes_per_event"]
+
+def write_macro(name, macro):
+    """Write the macro that fixes the seed and enables the monitor."""
+    wrapper = name + "-benchmark.mac"
+    with open(wrapper, "w") as output:
+        output.write("/edep/random/randomSeed %d\n" % SEED)
+        output.write("/edep/random/eventSeeding true\n")
+        output.write("/edep/perf/enable true\n")
+        output.write("/control/execute %s\n" % macro)
+    return wrapper
+
+def run_case(edepsim, name, macro, gdml, events, run):
+    """Run one benchmark and return the name of the output file and the
+    wall time for the job."""
+    output = "%s-%d.root" % (name, run)
+    if os.path.exists(output): os.remove(output)
+    if name == "rooTracker-overlay":
+        subprocess.check_call([sys.executable,
+                               os.path.join(BENCHMARK, "make-rooTracker.py"),
+                               "rooTracker_overlay.root"])
+    command = [edepsim, "-C", "-u", "-o", output, "-e", str(events)]
+    if gdml: command += ["-g", gdml]
+    command.append(write_macro(name, macro))
+    print("## Run", " ".join(command), flush=True)
+    start = time.time()
+    with open("%s-%d.log" % (name, run), "w") as log:
+        subprocess.check_call(command, stdout=log, stderr=subprocess.STDOUT)
+    return output, time.time() - start
+
+def summarize(output, jobSeconds):
+    """Summarize the performance tree in an output file."""
+    import ROOT
+    rootFile = ROOT.TFile(output)
+    events = rootFile.Get("EDepSimEvents")
+    perf = rootFile.Get("EDepSimPerformance")
+    if not events or not perf:
+        raise RuntimeError("No performance tree in " + output)
+    entries = perf.GetEntries()
+    if entries < 1: raise RuntimeError("No events in " + output)
+
+    stages = [branch.GetName()[:-len("Wall")]
+              for branch in perf.GetListOfBranches()
+              if branch.GetName().endswith("Wall")]
+    wall = dict((stage, 0.0) for stage in stages)
+    cpu = dict((stage, 0.0) for stage in stages)
+    peakMemory = 0.0
+    steps = 0
+    hits = 0
+    for entry in range(entries):
+        perf.GetEntry(entry)
+        for stage in stages:
+            wall[stage] += getattr(perf, stage + "Wall")
+            cpu[stage] += getattr(perf, stage + "CPU")
+        peakMemory = max(peakMemory, perf.PeakMemory)
+        steps += perf.Steps
+        hits += perf.Hits
+
+    # The file also holds the geometry (and the other trees), so only
+    # the compressed size of the events is used.
+    summary = {
+        "events": int(events.GetEntries()),
+        "job_seconds": jobSeconds,
+        "events_per_second": entries/wall["Event"] if wall["Event"] > 0
+            else 0.0,
+        "seconds_per_event": wall["Event"]/entries,
+        "cpu_per_event": cpu["Event"]/entries,
+        "stage_seconds_per_event":
+            dict((stage, wall[stage]/entries) for stage in stages),
+        "peak_memory_mb": peakMemory,
+        "output_bytes_per_event": events.GetZipBytes()/entries,
+        "steps_per_event": steps/entries,
+        "hits_per_event": hits/entries,
+    }
+    rootFile.Close()
+    return summary
+
+def combine(summaries):
+    """Combine the summaries for repeated runs of a benchmark using the
+    median of each value, so one slow run doesn't cause a regression."""
+    combined = {"runs": len(summaries)}
+    for key, value in summaries[0].items():
+        if isinstance(value, dict):
+            combined[key] = dict(
+                (stage, statistics.median(s[key][stage] for s in summaries))
+                for stage in value)
+        else:
+            combined[key] = statistics.median(s[key] for s in summaries)
+    combined["events"] = summaries[0]["events"]
+    return combined
+
+def compare(results, baseline, timeTolerance, sizeTolerance):
+    """Compare the results to the baseline, and return the number of
+    regressions."""
+    regressions = 0
+    print("%-20s %-24s %12s %12s %8s" % ("benchmark", "metric",
+                                         "baseline", "current", "change"))
+    for name, current in sorted(results["cases"].items()):
+        reference = baseline.get("cases", {}).get(name)
+        if not reference:
+            print("%-20s -- not in the baseline" % name)
+            continue
+        checks = [("events_per_second", -1, timeTolerance)]
+        checks += [(metric, 1, timeTolerance) for metric in TIME_METRICS]
+        checks += [(metric, 1, sizeTolerance) for metric in SIZE_METRICS]
+        checks += [("steps_per_event", 0, 0.0), ("hits_per_event", 0, 0.0)]
+        for metric, sign, tolerance in checks:
+            old = reference.get(metric)
+            new = current.get(metric)
+            if old is None or new is None: continue
+            change = (new - old)/old if old else 0.0
+            status = ""
+            if sign != 0 and sign*change > tolerance:
+                status = "REGRESSION"
+                regressions += 1
+            elif sign == 0 and new != old:
+                # The events aren't the same, so the times can't be
+                # compared directly.
+                status = "CHANGED"
+            print("%-20s %-24s %12.4g %12.4g %+7.1f%% %s"
+                  % (name, metric, old, new, 100.0*change, status))
+    return regressions
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Run the edep-sim benchmarks.")
+    parser.add_argument("--edep-sim", dest="edepsim", default="edep-sim",
+                        help="The edep-sim executable")
+    parser.add_argument("--output", default="benchmark",
+                        help="The directory for the output files")
+    parser.add_argument("--case", action="append", default=[],
+                        help="Only run this benchmark (can be repeated)")
+    parser.add_argument("--scale", type=float, default=1.0,
+                        help="Scale the number of events")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="The number of runs for each benchmark")
+    parser.add_argument("--baseline",
+                        help="The baseline to compare against (or save)")
+    parser.add_argument("--save-baseline", action="store_true",
+                        help="Save the results as the baseline")
+    parser.add_argument("--tolerance", type=float, default=0.10,
+                        help="The allowed fractional slow down")
+    parser.add_argument("--size-tolerance", type=float, default=0.02,
+                        help="The allowed fractional memory and output"
+                        " growth")
+    args = parser.parse_args(argv)
+
+    cases = [case for case in CASES if not args.case or case[0] in args.case]
+    if not cases:
+        print("No benchmarks selected")
+        return 2
+
+    edepsim = args.edepsim
+    if os.path.sep in edepsim: edepsim = os.path.abspath(edepsim)
+    baselineName = os.path.abspath(args.baseline) if args.baseline else None
+
+    if not os.path.isdir(args.output): os.makedirs(args.output)
+    os.chdir(args.output)
+
+    results = {
+        "version": 2,
+        "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "host": platform.node(),
+        "machine": platform.machine(),
+        "seed": SEED,
+        "cases": {},
+    }
+    failures = 0
+    for name, macro, gdml, events in cases:
+        events = max(1, int(events*args.scale))
+        try:
+            summaries = []
+            for run in range(max(1, args.repeat)):
+                output, jobSeconds = run_case(edepsim, name, macro, gdml,
+                                              events, run)
+                summaries.append(summarize(output, jobSeconds))
+            results["cases"][name] = combine(summaries)
+        except (subprocess.CalledProcessError,
+                RuntimeError, OSError, ImportError) as error:
+            print("FAIL:", name, "--", error)
+            failures += 1
+
+    with open("benchmark.json", "w") as output:
+        json.dump(results, output, indent=2, sort_keys=True)
+    print("## Results in", os.path.abspath("benchmark.json"))
+    for name, summary in sorted(results["cases"].items()):
+        print("%-20s %8.3f events/s %8.1f MB %10.0f bytes/event"
+              % (name, summary["events_per_second"],
+                 summary["peak_memory_mb"],
+                 summary["output_bytes_per_event"]))
+
+    if failures: return 2
+
+    if baselineName and args.save_baseline:
+        with open(baselineName, "w") as output:
+            json.dump(results, output, indent=2, sort_keys=True)
+        print("## Saved the baseline in", baselineName)
+        return 0
+
+    if baselineName and os.path.exists(baselineName):
+        with open(baselineName) as baselineFile:
+            baseline = json.load(baselineFile)
+        if baseline.get("version") != results["version"]:
+            print("## The baseline in", baselineName, "is an old version",
+                  "(save a new one with --save-baseline)")
+            return 0
+        regressions = compare(results, baseline,
+                              args.tolerance, args.size_tolerance)
+        if regressions:
+            print("## %d regressions against %s" % (regressions, baselineName))
+            return 1
+    elif baselineName:
+        print("## No baseline in", baselineName,
+              "(save one with --save-baseline)")
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,113 @@
+#! /usr/bin/env python3
+#
+# Write a synthetic rooTracker overlay file for the benchmarks.  Each
+# event has a few muon and proton interactions in the default
+# geometry, followed by an end-of-event marker (a single particle with
+# a negative status).  The file is made with a fixed seed so every
+# benchmark run reads the same interactions.
+#
+
+import argparse, math, random, sys
+from array import array
+
+import ROOT
+
+# The maximum number of particles in an interaction.
+kNPmax = 10
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Write a synthetic rooTracker overlay file.")
+    parser.add_argument("output", nargs="?", default="rooTracker_overlay.root")
+    parser.add_argument("--events", type=int, default=200,
+                        help="Number of overlay events")
+    parser.add_argument("--seed", type=int, default=20100,
+                        help="Random seed")
+    args = parser.parse_args(argv)
+
+    rng = random.Random(args.seed)
+
+    output = ROOT.TFile(args.output, "RECREATE")
+    tree = ROOT.TTree("gRooTracker", "Synthetic rooTracker overlay")
+
+    evtNum = array("i", [0])
+    evtCode = ROOT.TObjString("")
+    evtFlags = ROOT.TBits()
+    evtXSec = array("d", [0.0])
+    evtDXSec = array("d", [0.0])
+    evtWght = array("d", [1.0])
+    evtProb = array("d", [1.0])
+    evtVtx = array("d", [0.0]*4)
+    stdHepN = array("i", [0])
+    stdHepPdg = array("i", [0]*kNPmax)
+    stdHepStatus = array("i", [0]*kNPmax)
+    stdHepX4 = array("d", [0.0]*(4*kNPmax))
+    stdHepP4 = array("d", [0.0]*(4*kNPmax))
+    stdHepPolz = array("d", [0.0]*(3*kNPmax))
+    stdHepFd = array("i", [-1]*kNPmax)
+    stdHepLd = array("i", [-1]*kNPmax)
+    stdHepFm = array("i", [-1]*kNPmax)
+    stdHepLm = array("i", [-1]*kNPmax)
+
+    tree.Branch("EvtNum", evtNum, "EvtNum/I")
+    tree.Branch("EvtFlags", evtFlags)
+    tree.Branch("EvtCode", evtCode)
+    tree.Branch("EvtXSec", evtXSec, "EvtXSec/D")
+    tree.Branch("EvtDXSec", evtDXSec, "EvtDXSec/D")
+    tree.Branch("EvtWght", evtWght, "EvtWght/D")
+    tree.Branch("EvtProb", evtProb, "EvtProb/D")
+    tree.Branch("EvtVtx", evtVtx, "EvtVtx[4]/D")
+    tree.Branch("StdHepN", stdHepN, "StdHepN/I")
+    tree.Branch("StdHepPdg", stdHepPdg, "StdHepPdg[StdHepN]/I")
+    tree.Branch("StdHepStatus", stdHepStatus, "StdHepStatus[StdHepN]/I")
+    tree.Branch("StdHepX4", stdHepX4, "StdHepX4[StdHepN][4]/D")
+    tree.Branch("StdHepP4", stdHepP4, "StdHepP4[StdHepN][4]/D")
+    tree.Branch("StdHepPolz", stdHepPolz, "StdHepPolz[StdHepN][3]/D")
+    tree.Branch("StdHepFd", stdHepFd, "StdHepFd[StdHepN]/I")
+    tree.Branch("StdHepLd", stdHepLd, "StdHepLd[StdHepN]/I")
+    tree.Branch("StdHepFm", stdHepFm, "StdHepFm[StdHepN]/I")
+    tree.Branch("StdHepLm", stdHepLm, "StdHepLm[StdHepN]/I")
+
+    # The particles are (pdg, mass in GeV).
+    particles = [(13, 0.10566), (2212, 0.93827), (211, 0.13957)]
+
+    entry = 0
+    for event in range(args.events):
+        for interaction in range(rng.randint(2, 5)):
+            evtNum[0] = entry
+            evtCode.SetString("synthetic")
+            # Vertex in meters and seconds.
+            for i in range(3): evtVtx[i] = rng.uniform(-0.3, 0.3)
+            evtVtx[3] = rng.uniform(0.0, 1.0e-5)
+            stdHepN[0] = rng.randint(1, kNPmax)
+            for p in range(stdHepN[0]):
+                pdg, mass = particles[rng.randrange(len(particles))]
+                stdHepPdg[p] = pdg
+                stdHepStatus[p] = 1
+                momentum = rng.uniform(0.1, 2.0)
+                cosTheta = rng.uniform(-1.0, 1.0)
+                sinTheta = math.sqrt(1.0 - cosTheta*cosTheta)
+                phi = rng.uniform(0.0, 2.0*math.pi)
+                stdHepP4[4*p+0] = momentum*sinTheta*math.cos(phi)
+                stdHepP4[4*p+1] = momentum*sinTheta*math.sin(phi)
+                stdHepP4[4*p+2] = momentum*cosTheta
+                stdHepP4[4*p+3] = math.sqrt(momentum*momentum + mass*mass)
+            tree.Fill()
+            entry += 1
+
+        # The end-of-event marker.
+        evtNum[0] = entry
+        stdHepN[0] = 1
+        stdHepPdg[0] = 0
+        stdHepStatus[0] = -1
+        for i in range(4): stdHepP4[i] = 0.0
+        tree.Fill()
+        entry += 1
+
+    tree.Write()
+    output.Close()
+    print("Wrote", entry, "entries to", args.output)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,98 @@
+#!/bin/bash
+#
+# Check that the tabulated electron LET used for the LAr recombination
+# agrees with the parameterization.  The same electrons are simulated
+# with the table, and with the LET calculated directly, and the visible
+# (secondary) energy of each event must agree within the table
+# tolerance.
+#
+
+TOLERANCE=1E-4
+TABLE=040ElectronLETTable.root
+ANALYTIC=040ElectronLETAnalytic.root
+
+for i in ${TABLE} ${ANALYTIC}; do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+cat > 040Kinematics.mac <<EOF
+/edep/update
+
+/edep/random/randomSeed 13579
+/edep/random/eventSeeding true
+
+/gps/particle e-
+/gps/energy 50 MeV
+/gps/position 0.0 0.0 0.0 cm
+/gps/pos/type Volume
+/gps/pos/shape Para
+/gps/pos/halfx 20 cm
+/gps/pos/halfy 20 cm
+/gps/pos/halfz 20 cm
+/gps/ang/type iso
+EOF
+
+cat > 040ElectronLETTable.mac <<EOF
+/edep/phys/letTolerance ${TOLERANCE}
+/control/execute 040Kinematics.mac
+EOF
+
+cat > 040ElectronLETAnalytic.mac <<EOF
+/edep/phys/letTolerance 0.0
+/control/execute 040Kinematics.mac
+EOF
+
+edep-sim -C -o ${TABLE} -e 20 040ElectronLETTable.mac | \
+    tee 040ElectronLET.output
+grep "Electron LET table validated" 040ElectronLET.output || exit 1
+
+edep-sim -C -o ${ANALYTIC} -e 20 040ElectronLETAnalytic.mac || exit 1
+
+python3 - ${TABLE} ${ANALYTIC} ${TOLERANCE} <<EOF || exit 1
+import sys
+import ROOT
+ROOT.gSystem.Load("libedepsim_io.so")
+
+# Sum the total and visible energy deposit of each event.
+def sumEnergy(name):
+    inputFile = ROOT.TFile(name)
+    inputTree = inputFile.Get("EDepSimEvents")
+    event = ROOT.TG4Event()
+    inputTree.SetBranchAddress("Event",event)
+    sums = []
+    for jentry in range(inputTree.GetEntries()):
+        inputTree.GetEntry(jentry)
+        total = 0.0
+        visible = 0.0
+        for detector, segments in event.SegmentDetectors:
+            for segment in segments:
+                total += segment.GetEnergyDeposit()
+                visible += segment.GetSecondaryDeposit()
+        sums.append((total, visible))
+    return sums
+
+table = sumEnergy(sys.argv[1])
+analytic = sumEnergy(sys.argv[2])
+tolerance = float(sys.argv[3])
+if len(table) != len(analytic):
+    print("Different number of events")
+    sys.exit(1)
+if sum(v for t, v in analytic) <= 0.0:
+    print("No visible energy to compare")
+    sys.exit(1)
+for i, (t, a) in enumerate(zip(table, analytic)):
+    # The tracking doesn't depend on the LET, so the total deposit is
+    # the same.
+    if abs(t[0] - a[0]) > 1E-9*max(abs(a[0]), 1.0):
+        print("Event", i, "total deposit differs:", t[0], a[0])
+        sys.exit(1)
+    difference = abs(t[1] - a[1])
+    if difference > tolerance*a[1]:
+        print("Event", i, "visible energy differs:", t[1], a[1])
+        sys.exit(1)
+    print("Event", i, "visible energy", t[1], "and", a[1])
+EOF
+
+echo SUCCESS
@@ -0,0 +1,66 @@
+#!/bin/bash
+#
+# Check that a job restarted from a checkpoint produces the same events
+# as a job that wasn't stopped.  The checkpointed job is killed after
+# the first checkpoint is saved, and is then restarted with "-R".
+#
+
+REFERENCE=120CheckpointReference.root
+OUTPUT=120CheckpointRestart.root
+EVENTS=200
+
+for i in ${REFERENCE} ${OUTPUT} ${OUTPUT}.checkpoint ${OUTPUT}.checkpoint.tmp
+do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+cat > 120CheckpointRestart.mac <<EOF
+/edep/random/randomSeed 12345
+/edep/random/eventSeeding true
+/edep/db/checkpoint 5
+/edep/update
+
+/gps/particle mu+
+/gps/energy 700 MeV
+/gps/position 0.0 0.0 -50.0 cm
+/gps/pos/type Volume
+/gps/pos/shape Para
+/gps/pos/halfx 20 cm
+/gps/pos/halfy 20 cm
+/gps/pos/halfz 20 cm
+/gps/ang/type iso
+EOF
+
+# The job that isn't stopped.
+edep-sim -C -o ${REFERENCE} -e ${EVENTS} 120CheckpointRestart.mac || exit 1
+
+# Start the same job, and kill it once a checkpoint has been saved.
+edep-sim -C -o ${OUTPUT} -e ${EVENTS} 120CheckpointRestart.mac &
+JOB=$!
+while kill -0 ${JOB} 2> /dev/null; do
+    if [ -f ${OUTPUT}.checkpoint ]; then
+        kill -KILL ${JOB}
+        break
+    fi
+    sleep 0.1
+done
+wait ${JOB}
+
+if [ ! -f ${OUTPUT}.checkpoint ]; then
+    echo "Job finished before it could be stopped"
+    exit 1
+fi
+
+# Restart the job from the checkpoint.
+edep-sim -C -R -o ${OUTPUT} -e ${EVENTS} 120CheckpointRestart.mac || exit 1
+
+if [ -f ${OUTPUT}.checkpoint ]; then
+    echo "Checkpoint not removed by the restarted job"
+    exit 1
+fi
+
+$(dirname $0)/compare-events.py ${REFERENCE} ${OUTPUT} || exit 1
+
+echo SUCCESS
@@ -0,0 +1,52 @@
+#!/bin/bash
+#
+# Check that the captain wire planes built with shared wire volumes are
+# navigationally equivalent to the planes with a volume for every wire.
+# The same events are simulated in both geometries and compared.
+#
+
+REFERENCE=121SeparateWires.root
+OUTPUT=121SharedWires.root
+
+for i in ${REFERENCE} ${OUTPUT}; do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+cat > 121Kinematics.mac <<EOF
+/edep/random/randomSeed 4321
+/edep/random/eventSeeding true
+
+/gps/particle mu-
+/gps/energy 1 GeV
+/gps/position 0.0 0.0 0.0 cm
+/gps/pos/type Volume
+/gps/pos/shape Para
+/gps/pos/halfx 30 cm
+/gps/pos/halfy 30 cm
+/gps/pos/halfz 30 cm
+/gps/ang/type iso
+EOF
+
+cat > 121SeparateWires.mac <<EOF
+/edep/update
+/control/execute 121Kinematics.mac
+EOF
+
+cat > 121SharedWires.mac <<EOF
+/Captain/Cryostat/Immersed/Drift/XPlane/sharedWires true
+/Captain/Cryostat/Immersed/Drift/VPlane/sharedWires true
+/Captain/Cryostat/Immersed/Drift/UPlane/sharedWires true
+/Captain/Cryostat/Immersed/Drift/GridPlane/sharedWires true
+/Captain/Cryostat/Immersed/Drift/GroundPlane/sharedWires true
+/edep/update
+/control/execute 121Kinematics.mac
+EOF
+
+edep-sim -C -o ${REFERENCE} -e 20 121SeparateWires.mac || exit 1
+edep-sim -C -o ${OUTPUT} -e 20 121SharedWires.mac || exit 1
+
+$(dirname $0)/compare-events.py ${REFERENCE} ${OUTPUT} || exit 1
+
+echo SUCCESS
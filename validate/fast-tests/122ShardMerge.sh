@@ -0,0 +1,47 @@
+#!/bin/bash
+#
+# Check that a run split into two jobs with -F and -e, and merged with
+# edep-merge, has the same events as a single job.  Each event uses one
+# HEPEVT record, so the shards start at the right input record.
+#
+
+REFERENCE=122SingleJob.root
+SHARD0=122Shard0.root
+SHARD1=122Shard1.root
+OUTPUT=122Merged.root
+
+for i in ${REFERENCE} ${SHARD0} ${SHARD1} ${OUTPUT}; do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+# Write one muon per record with a different momentum for every event.
+rm -f 122ShardMerge.txt
+for i in $(seq 1 20); do
+    echo "         1" >> 122ShardMerge.txt
+    echo "   1        13    0    0  0.0 0.0 0.${i}5  0.10566000e+00" \
+         >> 122ShardMerge.txt
+done
+
+cat > 122ShardMerge.mac <<EOF
+/edep/random/randomSeed 2468
+/edep/random/eventSeeding true
+/edep/update
+
+/generator/kinematics/hepevt/input 122ShardMerge.txt
+/generator/kinematics/set hepevt
+
+/generator/count/fixed/number 1
+/generator/count/set fixed
+/generator/add
+EOF
+
+edep-sim -C -o ${REFERENCE} -e 20 122ShardMerge.mac || exit 1
+edep-sim -C -o ${SHARD0} -F 0 -e 10 122ShardMerge.mac || exit 1
+edep-sim -C -o ${SHARD1} -F 10 -e 10 122ShardMerge.mac || exit 1
+edep-merge ${OUTPUT} ${SHARD0} ${SHARD1} || exit 1
+
+$(dirname $0)/compare-events.py ${REFERENCE} ${OUTPUT} || exit 1
+
+echo SUCCESS
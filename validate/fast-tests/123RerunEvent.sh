@@ -0,0 +1,49 @@
+#!/bin/bash
+#
+# Check that an event can be simulated again by itself when the random
+# engine is reseeded for every event.  The seeding commands are given
+# in a different order for the rerun since the order must not matter.
+#
+
+REFERENCE=123AllEvents.root
+OUTPUT=123RerunEvent.root
+EVENT=7
+
+for i in ${REFERENCE} ${OUTPUT}; do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+cat > 123Kinematics.mac <<EOF
+/edep/update
+
+/gps/particle proton
+/gps/energy 500 MeV
+/gps/position 0.0 0.0 -50.0 cm
+/gps/pos/type Volume
+/gps/pos/shape Para
+/gps/pos/halfx 20 cm
+/gps/pos/halfy 20 cm
+/gps/pos/halfz 20 cm
+/gps/ang/type iso
+EOF
+
+cat > 123AllEvents.mac <<EOF
+/edep/random/randomSeed 97531
+/edep/random/eventSeeding true
+/control/execute 123Kinematics.mac
+EOF
+
+cat > 123RerunEvent.mac <<EOF
+/edep/random/eventSeeding true
+/edep/random/randomSeed 97531
+/control/execute 123Kinematics.mac
+EOF
+
+edep-sim -C -o ${REFERENCE} -e 10 123AllEvents.mac || exit 1
+edep-sim -C -o ${OUTPUT} -F ${EVENT} -e 1 123RerunEvent.mac || exit 1
+
+$(dirname $0)/compare-events.py -e ${EVENT} ${REFERENCE} ${OUTPUT} || exit 1
+
+echo SUCCESS
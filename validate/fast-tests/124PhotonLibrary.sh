@@ -0,0 +1,93 @@
+#!/bin/bash
+#
+# Build a small photon library with a detector on the +Z face of a liquid
+# argon box, and check that the visibility and the arrival times make
+# sense: photons are seen from every voxel, the voxels near the detector
+# see more photons, and the photons from the far voxels arrive later.
+#
+
+GDML=$(dirname $0)/124PhotonLibrary.gdml
+OUTPUT=124PhotonLibrary.root
+LIBRARY=124PhotonLibrary.bin
+
+for i in ${OUTPUT} ${LIBRARY}; do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+cat > 124PhotonLibrary.mac <<EOF
+/process/optical/boundary/setInvokeSD true
+/edep/random/randomSeed 8642
+/edep/update
+
+/edep/photonLibrary/box -50 -50 -50 50 50 50 cm
+/edep/photonLibrary/voxels 1 1 2
+/edep/photonLibrary/timeBins 20 0.5 ns
+/edep/photonLibrary/build ${LIBRARY}
+
+/gps/particle opticalphoton
+/gps/number 1000
+/gps/polarization 1 1 1
+/gps/energy 2.5 eV
+/gps/position 0.0 0.0 0.0 cm
+/gps/pos/type Volume
+/gps/pos/shape Para
+/gps/pos/halfx 50 cm
+/gps/pos/halfy 50 cm
+/gps/pos/halfz 50 cm
+/gps/ang/type iso
+EOF
+
+edep-sim -C -o ${OUTPUT} -g ${GDML} -e 20 124PhotonLibrary.mac || exit 1
+
+python3 - ${LIBRARY} <<EOF || exit 1
+import struct
+import sys
+
+# Read the library written by EDepSim::PhotonLibrary::Write.
+data = open(sys.argv[1], "rb").read()
+header = struct.Struct("=8sII3iiii3d3dd")
+(magic, version, byteOrder, nx, ny, nz, timeBins, detectors, padding,
+ lx, ly, lz, dx, dy, dz, binWidth) = header.unpack_from(data, 0)
+if magic.rstrip(b"\0") != b"EDSPLIB":
+    print("Not a photon library")
+    sys.exit(1)
+record = struct.Struct("=64s3dd")
+offset = header.size
+names = []
+for d in range(detectors):
+    name, px, py, pz, energy = record.unpack_from(data, offset)
+    names.append(name.rstrip(b"\0").decode())
+    offset += record.size
+if names != ["Sensor"]:
+    print("Unexpected photon detectors", names)
+    sys.exit(1)
+voxels = nx*ny*nz
+visibility = struct.unpack_from("=%df" % voxels, data, offset)
+offset += 4*voxels
+cdf = struct.unpack_from("=%df" % (voxels*timeBins), data, offset)
+
+# The mean arrival time for each voxel from the time distribution.
+def meanTime(voxel):
+    mean = 0.0
+    previous = 0.0
+    for b in range(timeBins):
+        value = cdf[voxel*timeBins + b]
+        mean += (value - previous)*(b + 0.5)*binWidth
+        previous = value
+    return mean
+
+# Voxel 0 is the far (-Z) half of the box, and voxel 1 is the near half.
+far, near = visibility
+print("Visibility", far, near)
+print("Mean arrival time", meanTime(0), meanTime(1))
+if not (0.0 < far < near < 1.0):
+    print("The visibilities don't make sense")
+    sys.exit(1)
+if not (0.0 < meanTime(1) < meanTime(0)):
+    print("The arrival times don't make sense")
+    sys.exit(1)
+EOF
+
+echo SUCCESS
@@ -0,0 +1,57 @@
+#!/bin/bash
+#
+# Export a GDML geometry with a parameterised volume, and check that every
+# copy is saved in the ROOT geometry with its own size and position.
+#
+
+GDML=$(dirname $0)/125ParameterisedExport.gdml
+OUTPUT=125ParameterisedExport.root
+EXPORT=125ParameterisedGeometry.root
+
+for i in ${OUTPUT} ${EXPORT}; do
+    if [ -f ${i} ]; then
+        rm ${i}
+    fi
+done
+
+cat > 125ParameterisedExport.mac <<EOF
+/edep/update
+/edep/export ${EXPORT}
+EOF
+
+edep-sim -C -o ${OUTPUT} -g ${GDML} 125ParameterisedExport.mac || exit 1
+
+python3 - ${EXPORT} <<EOF || exit 1
+import sys
+import ROOT
+
+geometry = ROOT.TGeoManager.Import(sys.argv[1])
+if not geometry:
+    print("Geometry not exported")
+    sys.exit(1)
+
+# Find the copies of the block (the steel volumes) in the geometry.
+def findBlocks(volume, blocks):
+    for i in range(volume.GetNdaughters()):
+        node = volume.GetNode(i)
+        daughter = node.GetVolume()
+        if "Steel" in daughter.GetMaterial().GetName():
+            shape = daughter.GetShape()
+            position = node.GetMatrix().GetTranslation()
+            blocks.append((round(position[0]),
+                           round(shape.GetDX()),
+                           round(shape.GetDY()),
+                           round(shape.GetDZ())))
+        findBlocks(daughter, blocks)
+    return blocks
+
+# The X position and the half sizes are in mm.
+blocks = sorted(findBlocks(geometry.GetTopVolume(), []))
+expected = [(-300, 50, 50, 50), (0, 100, 100, 100), (300, 150, 150, 150)]
+print("Blocks", blocks)
+if blocks != expected:
+    print("The parameterised copies were not exported correctly")
+    sys.exit(1)
+EOF
+
+echo SUCCESS
@@ -0,0 +1,112 @@
+#! /usr/bin/env python3
+#
+# Compare the events in two edep-sim output files.  The events are
+# matched by the event number, and every primary, trajectory and hit
+# segment must be the same.  This is used by the fast tests that check
+# that a job can be reproduced (e.g. after a restart, or by a merged
+# set of shards).
+#
+#   compare-events.py [-e event,event,...] reference.root test.root
+#
+# The "-e" option only compares the listed events, otherwise every
+# event in both files must match.
+
+import sys, getopt
+
+import ROOT
+
+# Load the EDepSim IO library.
+ROOT.gSystem.Load("libedepsim_io.so")
+
+def fourVector(v):
+    return (v.X(), v.Y(), v.Z(), v.T())
+
+# Make a summary of an event that can be compared exactly.
+def summarizeEvent(event):
+    summary = []
+    for vertex in event.Primaries:
+        summary.append(("vertex", fourVector(vertex.GetPosition()),
+                        str(vertex.GetReaction())))
+        for particle in vertex.Particles:
+            summary.append(("particle", particle.GetTrackId(),
+                            particle.GetPDGCode(),
+                            fourVector(particle.GetMomentum())))
+    for trajectory in event.Trajectories:
+        summary.append(("trajectory", trajectory.GetTrackId(),
+                        trajectory.GetParentId(),
+                        trajectory.GetPDGCode(),
+                        fourVector(trajectory.GetInitialMomentum()),
+                        trajectory.Points.size()))
+        for point in trajectory.Points:
+            summary.append(("point", fourVector(point.GetPosition()),
+                            point.GetProcess(), point.GetSubprocess()))
+    for name, segments in event.SegmentDetectors:
+        summary.append(("detector", str(name), segments.size()))
+        for segment in segments:
+            summary.append(("segment", segment.GetPrimaryId(),
+                            segment.GetEnergyDeposit(),
+                            segment.GetSecondaryDeposit(),
+                            segment.GetTrackLength(),
+                            fourVector(segment.GetStart()),
+                            fourVector(segment.GetStop()),
+                            tuple(c for c in segment.Contrib)))
+    return summary
+
+# Read the summaries of the events in a file, keyed by the event number.
+def readEvents(name, selected):
+    inputFile = ROOT.TFile(name)
+    if not inputFile.IsOpen():
+        print("Cannot open", name)
+        sys.exit(1)
+    inputTree = inputFile.Get("EDepSimEvents")
+    if not inputTree:
+        print("No EDepSimEvents tree in", name)
+        sys.exit(1)
+    event = ROOT.TG4Event()
+    inputTree.SetBranchAddress("Event",event)
+    events = {}
+    for jentry in range(inputTree.GetEntries()):
+        if inputTree.GetEntry(jentry) <= 0: continue
+        if selected and event.EventId not in selected: continue
+        if event.EventId in events:
+            print("Duplicate event", event.EventId, "in", name)
+            sys.exit(1)
+        events[event.EventId] = summarizeEvent(event)
+    return events
+
+def main(argv=None):
+    if argv is None:
+        argv = sys.argv
+
+    selected = None
+    options, arguments = getopt.getopt(argv[1:], "e:")
+    for option, value in options:
+        if option == "-e":
+            selected = set(int(e) for e in value.split(","))
+    if len(arguments) != 2:
+        print("Usage: compare-events.py [-e events] reference test")
+        return 1
+
+    reference = readEvents(arguments[0], selected)
+    test = readEvents(arguments[1], selected)
+    if not reference:
+        print("No events to compare in", arguments[0])
+        return 1
+    if sorted(reference.keys()) != sorted(test.keys()):
+        print("Different events:", sorted(reference.keys()),
+              "and", sorted(test.keys()))
+        return 1
+    for eventId in sorted(reference.keys()):
+        if reference[eventId] == test[eventId]: continue
+        for r, t in zip(reference[eventId], test[eventId]):
+            if r == t: continue
+            print("Event", eventId, "differs:", r, "and", t)
+            break
+        else:
+            print("Event", eventId, "has a different number of objects")
+        return 1
+    print("Compared", len(reference), "events")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())